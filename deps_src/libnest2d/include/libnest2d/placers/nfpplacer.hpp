@@ -8,6 +8,10 @@
 #include <iterator>
 #include <future>
 #include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #ifndef NDEBUG
 #include <iostream>
@@ -26,6 +30,135 @@
 namespace libnest2d {
 namespace placers {
 
+/**
+ * @brief Cache of convex no-fit polygons shared by all the placers of one
+ * arrange call.
+ *
+ * The NFP of two convex shapes only depends on their outlines, not on where
+ * they are, so the cached polygon is stored relative to the rightmost top
+ * vertex of the stationary shape and moved back on lookup. Shapes are
+ * identified by their (rotated) contour and holes taken relative to the first
+ * vertex of the contour, so the rotation of an item is part of its key. The
+ * hash of the outline only selects the candidates, a hit is confirmed by
+ * comparing the outlines. Filling a bed with copies of the same part this way
+ * computes only a handful of NFPs.
+ */
+template<class RawShape>
+class NfpCache {
+public:
+    using Vertex = TPoint<RawShape>;
+
+    // Shape moved to have the first vertex of its contour at the origin.
+    struct ShapeKey {
+        uint64_t hash = 0;
+        RawShape outline;
+    };
+
+    static ShapeKey shapeKey(const RawShape& sh)
+    {
+        ShapeKey key;
+        key.outline = sh;
+        auto first = sl::cbegin(sh), last = sl::cend(sh);
+        if (first != last) {
+            Vertex v0 = *first;
+            sl::translate(key.outline, Vertex{-getX(v0), -getY(v0)});
+        }
+
+        uint64_t h = 0xcbf29ce484222325ull;
+        auto mix = [&h](uint64_t v) { h = (h ^ v) * 0x100000001b3ull; };
+        auto mixPath = [&mix](const TContour<RawShape>& path) {
+            auto begin = sl::cbegin(path), end = sl::cend(path);
+            mix(uint64_t(end - begin));
+            for (auto it = begin; it != end; ++it) {
+                mix(uint64_t(getX(*it)));
+                mix(uint64_t(getY(*it)));
+            }
+        };
+        mixPath(sl::contour(key.outline));
+        for (const auto& hole : sl::holes(key.outline))
+            mixPath(hole);
+        key.hash = h;
+        return key;
+    }
+
+    // Returns true and the NFP placed at the stationary reference if found.
+    bool find(const ShapeKey& stationary, const ShapeKey& orbiter,
+              const Vertex& ref, RawShape& nfp) const
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto range = map_.equal_range(Key{stationary.hash, orbiter.hash});
+        for (auto it = range.first; it != range.second; ++it) {
+            const Entry& entry = it->second;
+            if (sameOutline(entry.stationary, stationary.outline) &&
+                sameOutline(entry.orbiter, orbiter.outline)) {
+                nfp = entry.nfp;
+                sl::translate(nfp, ref);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void insert(const ShapeKey& stationary, const ShapeKey& orbiter,
+                const Vertex& ref, RawShape nfp)
+    {
+        sl::translate(nfp, Vertex{-getX(ref), -getY(ref)});
+        std::lock_guard<std::mutex> lk(mutex_);
+        // Distinct shapes on a crowded bed may produce a lot of pairs, stop
+        // growing rather than hogging memory.
+        if (map_.size() < MaxEntries)
+            map_.emplace(Key{stationary.hash, orbiter.hash},
+                         Entry{stationary.outline, orbiter.outline, std::move(nfp)});
+    }
+
+private:
+    static constexpr size_t MaxEntries = 1 << 16;
+
+    static bool samePath(const TContour<RawShape>& a, const TContour<RawShape>& b)
+    {
+        auto ia = sl::cbegin(a), ea = sl::cend(a);
+        auto ib = sl::cbegin(b), eb = sl::cend(b);
+        if (ea - ia != eb - ib) return false;
+        for (; ia != ea; ++ia, ++ib)
+            if (getX(*ia) != getX(*ib) || getY(*ia) != getY(*ib))
+                return false;
+        return true;
+    }
+
+    static bool sameOutline(const RawShape& a, const RawShape& b)
+    {
+        const auto& holes_a = sl::holes(a);
+        const auto& holes_b = sl::holes(b);
+        if (holes_a.size() != holes_b.size() ||
+            !samePath(sl::contour(a), sl::contour(b)))
+            return false;
+        for (size_t i = 0; i < holes_a.size(); ++i)
+            if (!samePath(holes_a[i], holes_b[i]))
+                return false;
+        return true;
+    }
+
+    struct Key {
+        uint64_t stationary, orbiter;
+        bool operator==(const Key& o) const {
+            return stationary == o.stationary && orbiter == o.orbiter;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            return size_t(k.stationary ^ (k.orbiter * 0x9e3779b97f4a7c15ull));
+        }
+    };
+
+    struct Entry {
+        RawShape stationary, orbiter, nfp;
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_multimap<Key, Entry, KeyHash> map_;
+};
+
 template<class RawShape>
 struct NfpPConfig {
 
@@ -130,6 +263,12 @@ struct NfpPConfig {
     _ItemGroup<RawShape> m_excluded_items;
     std::vector < _Item<RawShape> > m_nonprefered_regions;
 
+    /**
+     * @brief Optional NFP cache, copies of this config (one per bin) share
+     * it. No caching if empty.
+     */
+    std::shared_ptr<NfpCache<RawShape>> nfp_cache;
+
     NfpPConfig(): rotations({0.0, Pi/2.0, Pi, 3*Pi/2}),
         alignment(Alignment::CENTER), starting_point(Alignment::CENTER) {}
 };
@@ -575,12 +714,10 @@ private:
 
     using Shapes = TMultiShape<RawShape>;
 
-    Shapes calcnfp(const Item &trsh, const Box& bed ,Lvl<nfp::NfpLevel::CONVEX_ONLY>)
+    // Fill the lazily computed members of the placed items so that the
+    // NFP calculation can read them from several threads at once.
+    void prepareItems(const Item &trsh)
     {
-        using namespace nfp;
-
-        Shapes nfps(items_.size());
-
         // /////////////////////////////////////////////////////////////////////
         // TODO: this is a workaround and should be solved in Item with mutexes
         // guarding the mutable members when writing them.
@@ -597,15 +734,58 @@ private:
             itm.leftmostBottomVertex();
         }
         // /////////////////////////////////////////////////////////////////////
+    }
+
+    using ShapeKey = typename NfpCache<RawShape>::ShapeKey;
+
+    std::vector<ShapeKey> itemKeys()
+    {
+        std::vector<ShapeKey> keys;
+        if (!config_.nfp_cache) return keys;
 
+        keys.resize(items_.size());
         __parallel::enumerate(items_.begin(), items_.end(),
-                              [&nfps, &trsh](const Item& sh, size_t n)
+                              [&keys](const Item& sh, size_t n) {
+            keys[n] = NfpCache<RawShape>::shapeKey(sh.transformedShape());
+        });
+        return keys;
+    }
+
+    Shapes calcnfp(const Item &trsh, const Box& bed ,Lvl<nfp::NfpLevel::CONVEX_ONLY>,
+                   const std::vector<ShapeKey> *item_keys = nullptr)
+    {
+        using namespace nfp;
+
+        Shapes nfps(items_.size());
+
+        prepareItems(trsh);
+
+        NfpCache<RawShape> *cache = config_.nfp_cache.get();
+        std::vector<ShapeKey> keys;
+        ShapeKey trsh_key;
+        if (cache) {
+            if (item_keys == nullptr || item_keys->size() != items_.size()) {
+                keys = itemKeys();
+                item_keys = &keys;
+            }
+            trsh_key = NfpCache<RawShape>::shapeKey(trsh.transformedShape());
+        }
+
+        __parallel::enumerate(items_.begin(), items_.end(),
+                              [&nfps, &trsh, cache, item_keys, &trsh_key](const Item& sh, size_t n)
         {
+            auto ref = sh.rightmostTopVertex();
+            if (cache && cache->find((*item_keys)[n], trsh_key, ref, nfps[n]))
+                return;
+
             auto& fixedp = sh.transformedShape();
             auto& orbp = trsh.transformedShape();
             auto subnfp_r = noFitPolygon<NfpLevel::CONVEX_ONLY>(fixedp, orbp);
             correctNfpPosition(subnfp_r, sh, trsh);
             nfps[n] = subnfp_r.first;
+
+            if (cache)
+                cache->insert((*item_keys)[n], trsh_key, ref, nfps[n]);
         });
 
         RawShape innerNfp = nfpInnerRectBed(bed, trsh.transformedShape()).first;
@@ -619,10 +799,29 @@ private:
         Shapes nfps(stationarys.size());
         Item   slidingItem(sliding);
         slidingItem.transformedShape();
-        __parallel::enumerate(stationarys.begin(), stationarys.end(), [&nfps, sliding, &slidingItem](const RawShape &stationary, size_t n) {
+        slidingItem.rightmostTopVertex();
+        slidingItem.leftmostBottomVertex();
+
+        NfpCache<RawShape> *cache = config_.nfp_cache.get();
+        ShapeKey sliding_key;
+        if (cache)
+            sliding_key = NfpCache<RawShape>::shapeKey(sliding);
+
+        __parallel::enumerate(stationarys.begin(), stationarys.end(), [&nfps, &sliding, &slidingItem, cache, &sliding_key](const RawShape &stationary, size_t n) {
+            ShapeKey stationary_key;
+            auto ref = rightmostUpVertex(stationary);
+            if (cache) {
+                stationary_key = NfpCache<RawShape>::shapeKey(stationary);
+                if (cache->find(stationary_key, sliding_key, ref, nfps[n]))
+                    return;
+            }
+
             auto subnfp_r = noFitPolygon<NfpLevel::CONVEX_ONLY>(stationary, sliding);
             correctNfpPosition(subnfp_r, stationary, slidingItem);
             nfps[n] = subnfp_r.first;
+
+            if (cache)
+                cache->insert(stationary_key, sliding_key, ref, nfps[n]);
         });
 
         RawShape innerNfp = nfpInnerRectBed(bed, sliding).first;
@@ -767,9 +966,33 @@ private:
         }
         if (can_pack == false) {
 
-            Pile merged_pile = merged_pile_;
+            // The callback only sees the pile and the packed items which are
+            // the same for every rotation, so it is called once up front.
+            if(config_.before_packing)
+                config_.before_packing(merged_pile_, items_, remlist);
 
-            for(auto rot : config_.rotations) {
+            prepareItems(item);
+            const std::vector<ShapeKey> item_keys = itemKeys();
+
+            // Outcome of the search for one candidate rotation.
+            struct RotationResult {
+                double score = std::numeric_limits<double>::max();
+                double overfit = std::numeric_limits<double>::max();
+                Vertex tr = {0, 0};
+                Shapes nfps;
+            };
+
+            std::vector<RotationResult> rot_results(config_.rotations.size());
+            const Item initial_item = item;
+
+            // Every rotation works on its own copy of the item and the pile,
+            // so they can be evaluated concurrently.
+            auto evalRotation = [&](Radians rot, size_t rot_idx)
+            {
+                RotationResult& rot_result = rot_results[rot_idx];
+                Item item = initial_item;
+                Pile merged_pile = merged_pile_;
+                double best_overfit = std::numeric_limits<double>::max();
 
                 item.translation(initial_tr);
                 item.rotation(initial_rot + rot);
@@ -779,7 +1002,7 @@ private:
                 // it is disjunct from the current merged pile
                 placeOutsideOfBin(item);
 
-                nfps = calcnfp(item, binbb, Lvl<MaxNfpLevel::value>());
+                Shapes nfps = calcnfp(item, binbb, Lvl<MaxNfpLevel::value>(), &item_keys);
 
 
                 auto iv = item.referenceVertex();
@@ -835,9 +1058,6 @@ private:
                 std::launch policy = std::launch::deferred;
                 if(config_.parallel) policy |= std::launch::async;
 
-                if(config_.before_packing)
-                    config_.before_packing(merged_pile, items_, remlist);
-
                 using OptResult = opt::Result<double>;
                 using OptResults = std::vector<OptResult>;
 
@@ -948,15 +1168,36 @@ private:
                     }
                 }
 
-                if( best_score < global_score) {
-                    auto d = (getNfpPoint(optimum) - iv) + startpos;
-                    final_tr = d;
-                    final_rot = initial_rot + rot;
+                rot_result.overfit = best_overfit;
+                if(best_score < rot_result.score) {
+                    rot_result.score = best_score;
+                    rot_result.tr = (getNfpPoint(optimum) - iv) + startpos;
+                }
+                rot_result.nfps = std::move(nfps);
+            };
+
+            std::launch rot_policy = std::launch::deferred;
+            if(config_.parallel) rot_policy |= std::launch::async;
+            __parallel::enumerate(config_.rotations.begin(),
+                                  config_.rotations.end(),
+                                  evalRotation, rot_policy);
+
+            // Reduce in the order of the rotations, so the outcome is the
+            // same as if they were tried one after another.
+            for(size_t r = 0; r < rot_results.size(); ++r) {
+                const RotationResult& rr = rot_results[r];
+                best_overfit = std::min(rr.overfit, best_overfit);
+                if( rr.score < global_score) {
+                    final_tr = rr.tr;
+                    final_rot = initial_rot + config_.rotations[r];
                     can_pack = true;
-                    global_score = best_score;
+                    global_score = rr.score;
                 }
             }
 
+            if (!rot_results.empty())
+                nfps = std::move(rot_results.back().nfps);
+
             item.translation(final_tr);
             item.rotation(final_rot);
         }
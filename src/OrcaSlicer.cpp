@@ -18,6 +18,7 @@
 #endif /* WIN32 */
 
 #include <cstdio>
+#include <deque>
 #include <string>
 #include <cstring>
 #include <iostream>
@@ -50,11 +51,14 @@ using namespace nlohmann;
 #include "libslic3r/Geometry.hpp"
 #include "libslic3r/GCode.hpp"
 #include "libslic3r/GCode/PostProcessor.hpp"
+#include "libslic3r/GCode/BinaryGCode.hpp"
+#include "libslic3r/GCode/ThumbnailRenderer.hpp"
 #include "libslic3r/Model.hpp"
 #include "libslic3r/ModelArrange.hpp"
 #include "libslic3r/Platform.hpp"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/SLAPrint.hpp"
+#include "libslic3r/SliceDataCache.hpp"
 #include "libslic3r/TriangleMesh.hpp"
 #include "libslic3r/Format/AMF.hpp"
 #include "libslic3r/Format/3mf.hpp"
@@ -148,6 +152,7 @@ std::map<int, std::string> cli_errors = {
     {CLI_FILAMENT_CAN_NOT_MAP, "Some filaments cannot be mapped to correct extruders for multi-extruder Printer."},
     {CLI_ONLY_ONE_TPU_SUPPORTED, "Not support printing 2 or more TPU filaments."},
     {CLI_FILAMENTS_NOT_SUPPORTED_BY_EXTRUDER, "Some filaments cannot be printed on the extruder mapped to."},
+    {CLI_CONVERT_GCODE_ERROR, "Failed converting the G-code."},
     {CLI_SLICING_ERROR, "Failed slicing the model. Please verify the slicing of all plates on Orca Slicer before uploading."},
     {CLI_GCODE_PATH_CONFLICTS, " G-code conflicts detected after slicing. Please make sure the 3mf file can be successfully sliced in the latest Orca Slicer. If the file slices normally in Orca Slicer, try moving the wipe tower further from other models, as we use more conservative parameters for it during upload."},
     {CLI_GCODE_PATH_IN_UNPRINTABLE_AREA, "Found G-code in unprintable area of multi-extruder printers after slicing. Please make sure the 3mf file can be successfully sliced in the latest Orca Slicer."}
@@ -159,6 +164,11 @@ typedef struct  _sliced_plate_info{
     size_t sliced_time_with_cache {0};
     size_t triangle_count{0};
     std::string warning_message;
+    //objects restored from / stored into the slicing cache
+    size_t slice_cache_hits{0};
+    size_t slice_cache_misses{0};
+    size_t slice_cache_stored{0};
+    size_t slice_cache_evicted{0};
 }sliced_plate_info_t;
 
 typedef struct _sliced_info {
@@ -435,6 +445,12 @@ void record_exit_reson(std::string outputdir, int code, int plate_id, std::strin
             plate_json["sliced_time_with_cache"] = sliced_info.sliced_plates[index].sliced_time_with_cache;
             plate_json["triangle_count"] = sliced_info.sliced_plates[index].triangle_count;
             plate_json["warning_message"] = sliced_info.sliced_plates[index].warning_message;
+            if (sliced_info.sliced_plates[index].slice_cache_hits + sliced_info.sliced_plates[index].slice_cache_misses > 0) {
+                plate_json["slice_cache_hits"] = sliced_info.sliced_plates[index].slice_cache_hits;
+                plate_json["slice_cache_misses"] = sliced_info.sliced_plates[index].slice_cache_misses;
+                plate_json["slice_cache_stored"] = sliced_info.sliced_plates[index].slice_cache_stored;
+                plate_json["slice_cache_evicted"] = sliced_info.sliced_plates[index].slice_cache_evicted;
+            }
             j["sliced_plates"].push_back(plate_json);
         }
         for (auto& iter: key_values)
@@ -489,6 +505,119 @@ static void glfw_callback(int error_code, const char* description)
     BOOST_LOG_TRIVIAL(error) << "error_code " <<error_code <<", description: " <<description<< std::endl;
 }
 
+//Orca: CPU counterpart of GLCanvas3D::render_thumbnail_internal(), used with --software_thumbnails on headless machines
+static void render_thumbnail_software(ThumbnailData& thumbnail_data, unsigned int w, unsigned int h, const ThumbnailsParams& thumbnail_params,
+    Slic3r::GUI::PartPlateList& partplate_list, const Model& model, const std::vector<ColorRGBA>& extruder_colors,
+    Slic3r::GUI::Camera::ViewAngleType camera_view_angle_type, bool for_picking = false, bool ban_light = false)
+{
+    BoundingBoxf3 plate_build_volume = partplate_list.get_plate(thumbnail_params.plate_id)->get_build_volume();
+    plate_build_volume.min -= BuildVolume::SceneEpsilon * Vec3d::Ones();
+    plate_build_volume.max += BuildVolume::SceneEpsilon * Vec3d::Ones();
+    BoundingBoxf3 plate_bbox = plate_build_volume;
+    plate_bbox.min(2) = -1e10;
+
+    // same colors as GLVolume::simple_render()
+    auto extruder_color = [&extruder_colors, ban_light](int extruder_id) {
+        if (extruder_id < 1 || extruder_id > (int)extruder_colors.size())
+            extruder_id = 1;
+        ColorRGBA color = extruder_colors.empty() ? ColorRGBA::WHITE() : adjust_color_for_rendering(extruder_colors[extruder_id - 1]);
+        if (ban_light)
+            color[3] = (255 - (extruder_id - 1)) / 255.0f;
+        return color;
+    };
+
+    // meshes of the painted volumes split by color, referenced by the render items
+    std::deque<indexed_triangle_set> mmu_meshes;
+    // same visibility rules as the GLVolumes filtered in render_thumbnail_internal()
+    std::vector<GCodeThumbnails::RenderItem> items;
+    for (const ModelObject* model_object : model.objects) {
+        for (const ModelInstance* model_instance : model_object->instances) {
+            if (!model_instance->printable)
+                continue;
+            for (const ModelVolume* model_volume : model_object->volumes) {
+                if (!model_volume->is_model_part())
+                    continue;
+                const Transform3d   trafo       = model_instance->get_matrix() * model_volume->get_matrix();
+                const BoundingBoxf3 volume_bbox = model_volume->mesh().transformed_bounding_box(trafo);
+                if (!plate_bbox.contains(volume_bbox) || volume_bbox.max(2) <= 0)
+                    continue;
+
+                if (for_picking) {
+                    unsigned int id = (model_instance->loaded_id > 0) ? model_instance->loaded_id : model_instance->id().id;
+                    ColorRGBA color((unsigned char)(id & 0xFF), (unsigned char)((id >> 8) & 0xFF), (unsigned char)((id >> 16) & 0xFF), (unsigned char)0xFF);
+                    items.push_back({ &model_volume->mesh().its, trafo, color });
+                }
+                else if (!model_volume->mmu_segmentation_facets.empty()) {
+                    // painted volume: the first mesh has the volume extruder, the others the extruder of their index
+                    std::vector<indexed_triangle_set> its_per_color;
+                    model_volume->mmu_segmentation_facets.get_facets(*model_volume, its_per_color);
+                    for (size_t idx = 0; idx < its_per_color.size(); ++ idx) {
+                        if (its_per_color[idx].indices.empty())
+                            continue;
+                        mmu_meshes.emplace_back(std::move(its_per_color[idx]));
+                        items.push_back({ &mmu_meshes.back(), trafo, extruder_color(idx == 0 ? std::max(1, model_volume->extruder_id()) : int(idx)) });
+                    }
+                }
+                else
+                    items.push_back({ &model_volume->mesh().its, trafo, extruder_color(std::max(1, model_volume->extruder_id())) });
+            }
+        }
+    }
+    BOOST_LOG_TRIVIAL(info) << boost::format("render_thumbnail_software: plate_idx %1% volumes size %2%, view %3%, for_picking=%4%")
+        % thumbnail_params.plate_id % items.size() % (int)camera_view_angle_type % for_picking;
+
+    GCodeThumbnails::RenderParams render_params;
+    render_params.ban_light = ban_light || for_picking;
+    // picking colors encode ids, they must not be blended
+    render_params.supersampling = for_picking ? 1 : 2;
+    if (camera_view_angle_type == Slic3r::GUI::Camera::ViewAngleType::Top_Plate) {
+        render_params.view = GCodeThumbnails::RenderView::Top;
+        render_params.view_box = plate_build_volume;
+        render_params.view_box.min(2) = render_params.view_box.max(2) = 0.;
+    }
+    else {
+        render_params.view = GCodeThumbnails::RenderView::Iso;
+        render_params.view_box = GCodeThumbnails::render_items_bounding_box(items);
+    }
+
+    // picking colors encode ids, neither the bed nor the background may be mistaken for an object
+    indexed_triangle_set bed_mesh;
+    if (!for_picking) {
+        if (!thumbnail_params.transparent_background)
+            render_params.background = ColorRGBA::WHITE();
+        if (thumbnail_params.show_bed) {
+            const BoundingBoxf3 bed_box = partplate_list.get_plate(thumbnail_params.plate_id)->get_build_volume();
+            const BoundingBoxf3 bed_rect(Vec3d(bed_box.min.x(), bed_box.min.y(), -BuildVolume::SceneEpsilon), Vec3d(bed_box.max.x(), bed_box.max.y(), 0.));
+            bed_mesh.vertices = { Vec3f(float(bed_rect.min.x()), float(bed_rect.min.y()), 0.f), Vec3f(float(bed_rect.max.x()), float(bed_rect.min.y()), 0.f),
+                                  Vec3f(float(bed_rect.max.x()), float(bed_rect.max.y()), 0.f), Vec3f(float(bed_rect.min.x()), float(bed_rect.max.y()), 0.f) };
+            bed_mesh.indices  = { stl_triangle_vertex_indices(0, 1, 2), stl_triangle_vertex_indices(0, 2, 3) };
+            // rendered first, so that the bottoms of the objects resting on the bed win the depth test
+            items.insert(items.begin(), GCodeThumbnails::RenderItem{ &bed_mesh, Transform3d::Identity(), Slic3r::GUI::PartPlate::UNSELECT_COLOR, false });
+            if (render_params.view == GCodeThumbnails::RenderView::Iso)
+                render_params.view_box.merge(bed_rect);
+        }
+    }
+    GCodeThumbnails::render_thumbnail(thumbnail_data, w, h, items, render_params);
+}
+
+//Orca: extruder colors for thumbnails, parsed from filament_colour
+static std::vector<ColorRGBA> thumbnail_extruder_colors(const DynamicPrintConfig& config)
+{
+    std::vector<std::string> colors;
+    if (const ConfigOptionStrings* filament_color = config.option<ConfigOptionStrings>("filament_colour"))
+        colors = filament_color->vserialize();
+    else
+        colors.push_back("#FFFFFFFF");
+
+    std::vector<ColorRGBA> colors_out(colors.size());
+    unsigned char rgb_color[4] = {};
+    for (size_t color_idx = 0; color_idx < colors.size(); ++ color_idx) {
+        Slic3r::GUI::BitmapCache::parse_color4(colors[color_idx], rgb_color);
+        colors_out[color_idx] = ColorRGBA(float(rgb_color[0]) / 255.f, float(rgb_color[1]) / 255.f, float(rgb_color[2]) / 255.f, float(rgb_color[3]) / 255.f);
+    }
+    return colors_out;
+}
+
 const float bed3d_ax3s_default_stem_radius = 0.5f;
 const float bed3d_ax3s_default_stem_length = 25.0f;
 const float bed3d_ax3s_default_tip_radius = 2.5f * bed3d_ax3s_default_stem_radius;
@@ -1216,6 +1345,27 @@ int CLI::run(int argc, char **argv)
     std::string temp_path = wxFileName::GetTempDir().utf8_str().data();
     set_temporary_dir(temp_path);
 
+    // Converting a G-code does not need any model or preset, it is done before loading them.
+    if (const ConfigOptionStrings *opt = m_config.option<ConfigOptionStrings>("convert_gcode"); opt != nullptr && !opt->values.empty()) {
+        if (opt->values.size() != 2) {
+            boost::nowide::cerr << "convert_gcode expects an input and an output file" << std::endl;
+            return CLI_INVALID_PARAMS;
+        }
+        const std::string &src = opt->values[0];
+        const std::string &dst = opt->values[1];
+        try {
+            if (BinaryGCode::is_binary_gcode_file(src))
+                BinaryGCode::convert_binary_to_ascii(src, dst);
+            else
+                BinaryGCode::convert_ascii_to_binary(src, dst);
+        } catch (const std::exception &ex) {
+            boost::nowide::cerr << "Failed converting " << src << ": " << ex.what() << std::endl;
+            return CLI_CONVERT_GCODE_ERROR;
+        }
+        BOOST_LOG_TRIVIAL(info) << "converted " << src << " to " << dst;
+        return CLI_SUCCESS;
+    }
+
     m_extra_config.apply(m_config, true);
     m_extra_config.normalize_fdm();
 
@@ -1330,7 +1480,7 @@ int CLI::run(int argc, char **argv)
     //int arrange_option;
     int plate_to_slice = 0, filament_count = 0, duplicate_count = 0, real_duplicate_count = 0, current_extruder_count = 1, new_extruder_count = 1, current_printer_variant_count = 1, current_print_variant_count = 1, new_printer_variant_count = 1;
     bool first_file = true, is_bbl_3mf = false, need_arrange = true, has_thumbnails = false, up_config_to_date = false, normative_check = true, duplicate_single_object = false, use_first_fila_as_default = false, minimum_save = false, enable_timelapse = false;
-    bool allow_rotations = true, skip_modified_gcodes = false, avoid_extrusion_cali_region = false, skip_useless_pick = false, allow_newer_file = false, current_is_multi_extruder = false, new_is_multi_extruder = false, allow_mix_temp = false, enable_wrapping_detect = false;
+    bool allow_rotations = true, skip_modified_gcodes = false, avoid_extrusion_cali_region = false, skip_useless_pick = false, software_thumbnails = false, allow_newer_file = false, current_is_multi_extruder = false, new_is_multi_extruder = false, allow_mix_temp = false, enable_wrapping_detect = false;
     Semver file_version;
     std::map<size_t, bool> orients_requirement;
     std::vector<Preset*> project_presets;
@@ -1389,6 +1539,19 @@ int CLI::run(int argc, char **argv)
     if (skip_useless_picks_option)
         skip_useless_pick = skip_useless_picks_option->value;
 
+    ConfigOptionBool* software_thumbnails_option = m_config.option<ConfigOptionBool>("software_thumbnails");
+    if (software_thumbnails_option)
+        software_thumbnails = software_thumbnails_option->value;
+
+    std::unique_ptr<SliceDataCache> slice_data_cache;
+    ConfigOptionString* slice_cache_dir_option = m_config.option<ConfigOptionString>("slice_cache_dir");
+    if (slice_cache_dir_option && !slice_cache_dir_option->value.empty()) {
+        ConfigOptionInt* slice_cache_size_limit_option = m_config.option<ConfigOptionInt>("slice_cache_size_limit");
+        uint64_t size_limit = uint64_t(std::max(0, slice_cache_size_limit_option ? slice_cache_size_limit_option->value : 10240)) << 20;
+        slice_data_cache = std::make_unique<SliceDataCache>(slice_cache_dir_option->value, size_limit);
+        BOOST_LOG_TRIVIAL(info) << boost::format("use slicing cache directory %1%, size limit %2% bytes")%slice_cache_dir_option->value %size_limit;
+    }
+
     ConfigOptionBool* allow_newer_file_option = m_config.option<ConfigOptionBool>("allow_newer_file");
     if (allow_newer_file_option)
         allow_newer_file = allow_newer_file_option->value;
@@ -4438,6 +4601,7 @@ int CLI::run(int argc, char **argv)
     BOOST_LOG_TRIVIAL(info) << "finished model pre-process commands\n";
     bool oriented_or_arranged = false;
     //BBS: add orient and arrange logic here
+    ModelObjectPtrs objects_to_orient;
     for (auto& model : m_models)
     {
         for (ModelObject* o : model.objects)
@@ -4445,7 +4609,7 @@ int CLI::run(int argc, char **argv)
             if (orients_requirement[o->id().id])
             {
                 BOOST_LOG_TRIVIAL(info) << "Before process command, Orient object, name=" << o->name <<",id="<<o->id().id<<std::endl;
-                orientation::orient(o);
+                objects_to_orient.push_back(o);
                 oriented_or_arranged = true;
             }
             else
@@ -4454,6 +4618,7 @@ int CLI::run(int argc, char **argv)
             }
         }
     }
+    orientation::orient(objects_to_orient);
     //BBS: clear the orient objects lists
     orients_requirement.clear();
 
@@ -5439,6 +5604,8 @@ int CLI::run(int argc, char **argv)
             this->print_help(true, ptSLA);
         } else if (opt_key == "pipe") {
             //already processed before
+        } else if (opt_key == "convert_gcode") {
+            //already processed before
         } else if (opt_key == "load_slicedata") {
             load_slicedata = true;
             load_slice_data_dir = m_config.opt_string(opt_key);
@@ -6041,6 +6208,23 @@ int CLI::run(int argc, char **argv)
                                         BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ": finished print::process.";
                                     }
                                 }
+                                else if (slice_data_cache && print_fff) {
+                                    int ret = slice_data_cache->load(*print_fff);
+                                    if (ret || (slice_data_cache->stats().hits == 0)) {
+                                        BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ": nothing restored from the slicing cache, ret=" << ret;
+                                        print->process(&time_using_cache);
+                                    }
+                                    else {
+                                        BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ": restored " << slice_data_cache->stats().hits << " objects from the slicing cache, go on.";
+#if defined(__linux__) || defined(__LINUX__)
+                                        if (g_cli_callback_mgr.is_started()) {
+                                            PrintBase::SlicingStatus slicing_status{69, "Cache data loaded"};
+                                            cli_status_callback(slicing_status);
+                                        }
+#endif
+                                        print->process(nullptr, true);
+                                    }
+                                }
                                 else {
                                     print->process(&time_using_cache);
                                     BOOST_LOG_TRIVIAL(info) << "print::process: first time_using_cache is " << time_using_cache << " secs.";
@@ -6096,7 +6280,22 @@ int CLI::run(int argc, char **argv)
                                     }
                                     BOOST_LOG_TRIVIAL(info) << "process finished, will export gcode temporily to " << outfile << std::endl;
                                     temp_time = (long long)Slic3r::Utils::get_current_time_utc();
-                                    outfile = print_fff->export_gcode(outfile, gcode_result, nullptr);
+                                    ThumbnailsGeneratorCallback thumbnail_cb = nullptr;
+                                    if (software_thumbnails) {
+                                        thumbnail_cb = [this, &partplate_list](const ThumbnailsParams& params) {
+                                            ThumbnailsList thumbnails;
+                                            std::vector<ColorRGBA> extruder_colors = thumbnail_extruder_colors(m_print_config);
+                                            for (const Vec2d& size : params.sizes) {
+                                                thumbnails.push_back(ThumbnailData());
+                                                render_thumbnail_software(thumbnails.back(), (unsigned int)size.x(), (unsigned int)size.y(), params, partplate_list, m_models[0],
+                                                    extruder_colors, Slic3r::GUI::Camera::ViewAngleType::Iso);
+                                                if (!thumbnails.back().is_valid())
+                                                    thumbnails.pop_back();
+                                            }
+                                            return thumbnails;
+                                        };
+                                    }
+                                    outfile = print_fff->export_gcode(outfile, gcode_result, thumbnail_cb);
                                     time_using_cache = time_using_cache + ((long long)Slic3r::Utils::get_current_time_utc() - temp_time);
                                     BOOST_LOG_TRIVIAL(info) << "export_gcode finished: time_using_cache update to " << time_using_cache << " secs.";
                                     if (gcode_result && gcode_result->gcode_check_result.error_code) {
@@ -6152,6 +6351,17 @@ int CLI::run(int argc, char **argv)
                                         flush_and_exit(ret);
                                     }
                                 }
+                                if (slice_data_cache && print_fff && !load_slicedata) {
+                                    //the slicing cache is an optimization only, failing to store into it is not an error
+                                    int ret = slice_data_cache->store(*print_fff);
+                                    if (ret)
+                                        BOOST_LOG_TRIVIAL(warning) << "plate "<< index+1<< ": store into the slicing cache error, ret=" << ret;
+                                    const SliceDataCache::Stats &cache_stats = slice_data_cache->stats();
+                                    sliced_plate_info.slice_cache_hits = cache_stats.hits;
+                                    sliced_plate_info.slice_cache_misses = cache_stats.misses;
+                                    sliced_plate_info.slice_cache_stored = cache_stats.stored;
+                                    sliced_plate_info.slice_cache_evicted = cache_stats.evicted;
+                                }
                                 end_time = (long long)Slic3r::Utils::get_current_time_utc();
                                 sliced_plate_info.sliced_time = end_time - start_time;
                                 sliced_plate_info.sliced_time_with_cache = time_using_cache;
@@ -6374,66 +6584,57 @@ int CLI::run(int argc, char **argv)
         }
 
         if (need_regenerate_thumbnail || need_regenerate_no_light_thumbnail || need_regenerate_top_thumbnail) {
-            std::vector<std::string> colors;
-            if (filament_color) {
-                colors= filament_color->vserialize();
-            }
-            else
-                colors.push_back("#FFFFFFFF");
-
-            std::vector<ColorRGBA> colors_out(colors.size());
-            unsigned char rgb_color[4] = {};
-            for (const std::string& color : colors) {
-                Slic3r::GUI::BitmapCache::parse_color4(color, rgb_color);
-                size_t color_idx = &color - &colors.front();
-                colors_out[color_idx] = ColorRGBA(float(rgb_color[0]) / 255.f, float(rgb_color[1]) / 255.f, float(rgb_color[2]) / 255.f, float(rgb_color[3]) / 255.f);
-            }
-
-            int gl_major, gl_minor, gl_verbos;
-            glfwGetVersion(&gl_major, &gl_minor, &gl_verbos);
-            BOOST_LOG_TRIVIAL(info) << boost::format("opengl version %1%.%2%.%3%")%gl_major %gl_minor %gl_verbos;
+            std::vector<ColorRGBA> colors_out = thumbnail_extruder_colors(m_print_config);
 
-            glfwSetErrorCallback(glfw_callback);
-            int ret = glfwInit();
-            if (ret == GLFW_FALSE) {
-                int code = glfwGetError(NULL);
-                BOOST_LOG_TRIVIAL(error) << "glfwInit return error, code " <<code<< std::endl;
-            }
+            if (software_thumbnails)
+                BOOST_LOG_TRIVIAL(info) << "software_thumbnails: skip glfw and opengl initialization";
             else {
-                BOOST_LOG_TRIVIAL(info) << "glfwInit Success."<< std::endl;
-                glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, gl_major);
-                glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, gl_minor);
-                glfwWindowHint(GLFW_RED_BITS, 8);
-                glfwWindowHint(GLFW_GREEN_BITS, 8);
-                glfwWindowHint(GLFW_BLUE_BITS, 8);
-                glfwWindowHint(GLFW_ALPHA_BITS, 8);
-                glfwWindowHint(GLFW_VISIBLE, false);
-                //glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-                //glfwDisable(GLFW_AUTO_POLL_EVENTS);
+                int gl_major, gl_minor, gl_verbos;
+                glfwGetVersion(&gl_major, &gl_minor, &gl_verbos);
+                BOOST_LOG_TRIVIAL(info) << boost::format("opengl version %1%.%2%.%3%")%gl_major %gl_minor %gl_verbos;
+
+                glfwSetErrorCallback(glfw_callback);
+                int ret = glfwInit();
+                if (ret == GLFW_FALSE) {
+                    int code = glfwGetError(NULL);
+                    BOOST_LOG_TRIVIAL(error) << "glfwInit return error, code " <<code<< std::endl;
+                }
+                else {
+                    BOOST_LOG_TRIVIAL(info) << "glfwInit Success."<< std::endl;
+                    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, gl_major);
+                    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, gl_minor);
+                    glfwWindowHint(GLFW_RED_BITS, 8);
+                    glfwWindowHint(GLFW_GREEN_BITS, 8);
+                    glfwWindowHint(GLFW_BLUE_BITS, 8);
+                    glfwWindowHint(GLFW_ALPHA_BITS, 8);
+                    glfwWindowHint(GLFW_VISIBLE, false);
+                    //glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+                    //glfwDisable(GLFW_AUTO_POLL_EVENTS);
 #ifdef __WXMAC__
-                glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-                glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+                    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+                    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #else
-                glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_COMPAT_PROFILE);
+                    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_COMPAT_PROFILE);
 #endif
 
 #ifdef __linux__
-                glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+                    glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
 #endif
 
-                GLFWwindow* window = glfwCreateWindow(640, 480, "base_window", NULL, NULL);
-                if (window == NULL)
-                {
-                    BOOST_LOG_TRIVIAL(error) << "Failed to create GLFW window" << std::endl;
+                    GLFWwindow* window = glfwCreateWindow(640, 480, "base_window", NULL, NULL);
+                    if (window == NULL)
+                    {
+                        BOOST_LOG_TRIVIAL(error) << "Failed to create GLFW window" << std::endl;
+                    }
+                    else
+                        glfwMakeContextCurrent(window);
                 }
-                else
-                    glfwMakeContextCurrent(window);
             }
 
             //opengl manager related logic
             {
                 Slic3r::GUI::OpenGLManager opengl_mgr;
-                bool opengl_valid = opengl_mgr.init_gl(false);
+                bool opengl_valid = software_thumbnails || opengl_mgr.init_gl(false);
                 if (!opengl_valid) {
                     BOOST_LOG_TRIVIAL(error) << "init opengl failed! skip thumbnail generating" << std::endl;
                 }
@@ -6441,55 +6642,81 @@ int CLI::run(int argc, char **argv)
                     BOOST_LOG_TRIVIAL(info) << "glewInit Sucess." << std::endl;
                     GLVolumeCollection glvolume_collection;
                     Model &model = m_models[0];
-                    int obj_extruder_id = 1, volume_extruder_id = 1;
-                    for (unsigned int obj_idx = 0; obj_idx < (unsigned int)model.objects.size(); ++ obj_idx) {
-                        const ModelObject &model_object = *model.objects[obj_idx];
-                        const ConfigOption* option = model_object.config.option("extruder");
-                        if (option)
-                            obj_extruder_id = (dynamic_cast<const ConfigOptionInt *>(option))->getInt();
-                        else
-                            obj_extruder_id = 1;
-                        for (int volume_idx = 0; volume_idx < (int)model_object.volumes.size(); ++ volume_idx) {
-                            const ModelVolume &model_volume = *model_object.volumes[volume_idx];
-                            option = model_volume.config.option("extruder");
+                    if (!software_thumbnails) {
+                        int obj_extruder_id = 1, volume_extruder_id = 1;
+                        for (unsigned int obj_idx = 0; obj_idx < (unsigned int)model.objects.size(); ++ obj_idx) {
+                            const ModelObject &model_object = *model.objects[obj_idx];
+                            const ConfigOption* option = model_object.config.option("extruder");
                             if (option)
-                                volume_extruder_id = (dynamic_cast<const ConfigOptionInt *>(option))->getInt();
+                                obj_extruder_id = (dynamic_cast<const ConfigOptionInt *>(option))->getInt();
                             else
-                                volume_extruder_id = obj_extruder_id;
-
-                            BOOST_LOG_TRIVIAL(debug) << boost::format("volume %1%'s extruder_id %2%")%volume_idx %volume_extruder_id;
-                            //if (!model_volume.is_model_part())
-                            //    continue;
-                            for (int instance_idx = 0; instance_idx < (int)model_object.instances.size(); ++ instance_idx) {
-                                const ModelInstance &model_instance = *model_object.instances[instance_idx];
-                                glvolume_collection.load_object_volume(&model_object, obj_idx, volume_idx, instance_idx, "volume", true, false, true);
-                                //glvolume_collection.volumes.back()->geometry_id = key.geometry_id;
-                                std::string color = filament_color?filament_color->get_at(volume_extruder_id - 1):"#00FF00FF";
-
-                                BOOST_LOG_TRIVIAL(debug) << boost::format("volume %1%'s color %2%")%volume_idx %color;
-
-                                unsigned char  rgb_color[4] = {};
-                                Slic3r::GUI::BitmapCache::parse_color4(color, rgb_color);
-
-                                ColorRGBA new_color;
-                                new_color.r(float(rgb_color[0]) / 255.f);
-                                new_color.g(float(rgb_color[1]) / 255.f);
-                                new_color.b(float(rgb_color[2]) / 255.f);
-                                new_color.a(float(rgb_color[3]) / 255.f);
-
-                                glvolume_collection.volumes.back()->set_render_color(new_color);
-                                glvolume_collection.volumes.back()->set_color(new_color);
-                                glvolume_collection.volumes.back()->printable = model_instance.printable;
+                                obj_extruder_id = 1;
+                            for (int volume_idx = 0; volume_idx < (int)model_object.volumes.size(); ++ volume_idx) {
+                                const ModelVolume &model_volume = *model_object.volumes[volume_idx];
+                                option = model_volume.config.option("extruder");
+                                if (option)
+                                    volume_extruder_id = (dynamic_cast<const ConfigOptionInt *>(option))->getInt();
+                                else
+                                    volume_extruder_id = obj_extruder_id;
+
+                                BOOST_LOG_TRIVIAL(debug) << boost::format("volume %1%'s extruder_id %2%")%volume_idx %volume_extruder_id;
+                                //if (!model_volume.is_model_part())
+                                //    continue;
+                                for (int instance_idx = 0; instance_idx < (int)model_object.instances.size(); ++ instance_idx) {
+                                    const ModelInstance &model_instance = *model_object.instances[instance_idx];
+                                    glvolume_collection.load_object_volume(&model_object, obj_idx, volume_idx, instance_idx, "volume", true, false, true);
+                                    //glvolume_collection.volumes.back()->geometry_id = key.geometry_id;
+                                    std::string color = filament_color?filament_color->get_at(volume_extruder_id - 1):"#00FF00FF";
+
+                                    BOOST_LOG_TRIVIAL(debug) << boost::format("volume %1%'s color %2%")%volume_idx %color;
+
+                                    unsigned char  rgb_color[4] = {};
+                                    Slic3r::GUI::BitmapCache::parse_color4(color, rgb_color);
+
+                                    ColorRGBA new_color;
+                                    new_color.r(float(rgb_color[0]) / 255.f);
+                                    new_color.g(float(rgb_color[1]) / 255.f);
+                                    new_color.b(float(rgb_color[2]) / 255.f);
+                                    new_color.a(float(rgb_color[3]) / 255.f);
+
+                                    glvolume_collection.volumes.back()->set_render_color(new_color);
+                                    glvolume_collection.volumes.back()->set_color(new_color);
+                                    glvolume_collection.volumes.back()->printable = model_instance.printable;
+                                }
                             }
                         }
                     }
 
-                    ThumbnailsParams thumbnail_params;
-                    GLShaderProgram* shader = opengl_mgr.get_shader("thumbnail");
-                    if (!shader) {
+                    GLShaderProgram* shader = software_thumbnails ? nullptr : opengl_mgr.get_shader("thumbnail");
+                    if (!software_thumbnails && !shader) {
                         BOOST_LOG_TRIVIAL(error) << boost::format("can not get shader for rendering thumbnail");
                     }
                     else {
+                        auto render_plate_thumbnail = [&](ThumbnailData& data, const ThumbnailsParams& params, Slic3r::GUI::Camera::ViewAngleType view_type, bool for_picking, bool ban_light) {
+                            const unsigned int thumbnail_width = 512, thumbnail_height = 512;
+                            if (software_thumbnails) {
+                                BOOST_LOG_TRIVIAL(info) << boost::format("framebuffer_type: software");
+                                render_thumbnail_software(data, thumbnail_width, thumbnail_height, params, partplate_list, model, colors_out, view_type, for_picking, ban_light);
+                                return;
+                            }
+                            switch (Slic3r::GUI::OpenGLManager::get_framebuffers_type())
+                            {
+                            case Slic3r::GUI::OpenGLManager::EFramebufferType::Arb:
+                                BOOST_LOG_TRIVIAL(info) << boost::format("framebuffer_type: ARB");
+                                Slic3r::GUI::GLCanvas3D::render_thumbnail_framebuffer(data, thumbnail_width, thumbnail_height, params, partplate_list, model.objects,
+                                    glvolume_collection, colors_out, shader, Slic3r::GUI::Camera::EType::Ortho, view_type, for_picking, ban_light);
+                                break;
+                            case Slic3r::GUI::OpenGLManager::EFramebufferType::Ext:
+                                BOOST_LOG_TRIVIAL(info) << boost::format("framebuffer_type: EXT");
+                                Slic3r::GUI::GLCanvas3D::render_thumbnail_framebuffer_ext(data, thumbnail_width, thumbnail_height, params, partplate_list, model.objects,
+                                    glvolume_collection, colors_out, shader, Slic3r::GUI::Camera::EType::Ortho, view_type, for_picking, ban_light);
+                                break;
+                            default:
+                                BOOST_LOG_TRIVIAL(info) << boost::format("framebuffer_type: unknown");
+                                break;
+                            }
+                        };
+
                         for (int i = 0; i < partplate_list.get_plate_count(); i++) {
                             Slic3r::GUI::PartPlate *part_plate      = partplate_list.get_plate(i);
                             PlateData *plate_data = plate_data_list[i];
@@ -6527,32 +6754,10 @@ int CLI::run(int argc, char **argv)
                                     BOOST_LOG_TRIVIAL(info) << boost::format("Line %1%: regenerate thumbnail, Skip plate %2%.")%__LINE__%(i+1);
                                 }
                                 else {
-                                    unsigned int thumbnail_width = 512, thumbnail_height = 512;
                                     const ThumbnailsParams thumbnail_params = {{}, false, true, true, true, i};
 
                                     BOOST_LOG_TRIVIAL(info) << boost::format("plate %1%'s thumbnail, need to regenerate")%(i+1);
-                                    switch (Slic3r::GUI::OpenGLManager::get_framebuffers_type())
-                                    {
-                                    case Slic3r::GUI::OpenGLManager::EFramebufferType::Arb:
-                                            {
-                                                BOOST_LOG_TRIVIAL(info) << boost::format("framebuffer_type: ARB");
-                                                Slic3r::GUI::GLCanvas3D::render_thumbnail_framebuffer(*thumbnail_data,
-                                                   thumbnail_width, thumbnail_height, thumbnail_params,
-                                                   partplate_list, model.objects, glvolume_collection, colors_out, shader, Slic3r::GUI::Camera::EType::Ortho);
-                                                break;
-                                            }
-                                    case Slic3r::GUI::OpenGLManager::EFramebufferType::Ext:
-                                            {
-                                                BOOST_LOG_TRIVIAL(info) << boost::format("framebuffer_type: EXT");
-                                                Slic3r::GUI::GLCanvas3D::render_thumbnail_framebuffer_ext(*thumbnail_data,
-                                                   thumbnail_width, thumbnail_height, thumbnail_params,
-                                                   partplate_list, model.objects, glvolume_collection, colors_out, shader, Slic3r::GUI::Camera::EType::Ortho);
-                                                break;
-                                            }
-                                    default:
-                                            BOOST_LOG_TRIVIAL(info) << boost::format("framebuffer_type: unknown");
-                                            break;
-                                    }
+                                    render_plate_thumbnail(*thumbnail_data, thumbnail_params, Slic3r::GUI::Camera::ViewAngleType::Iso, false, false);
                                     BOOST_LOG_TRIVIAL(info) << boost::format("plate %1%'s thumbnail,finished rendering")%(i+1);
                                 }
                             }
@@ -6579,36 +6784,10 @@ int CLI::run(int argc, char **argv)
                                     plate_data->no_light_thumbnail_file.clear();
                                 }
                                 else {
-                                    unsigned int thumbnail_width = 512, thumbnail_height = 512;
                                     const ThumbnailsParams thumbnail_params = { {}, false, true, false, true, i };
 
                                     BOOST_LOG_TRIVIAL(info) << boost::format("plate %1%'s no_light_thumbnail_file missed, need to regenerate")%(i+1);
-                                    switch (Slic3r::GUI::OpenGLManager::get_framebuffers_type())
-                                    {
-                                        case Slic3r::GUI::OpenGLManager::EFramebufferType::Arb:
-                                            {
-                                                BOOST_LOG_TRIVIAL(info) << boost::format("framebuffer_type: ARB");
-                                                Slic3r::GUI::GLCanvas3D::render_thumbnail_framebuffer(*no_light_thumbnail,
-                                                   thumbnail_width, thumbnail_height, thumbnail_params,
-                                                                                                  partplate_list, model.objects, glvolume_collection, colors_out, shader,
-                                                                                                  Slic3r::GUI::Camera::EType::Ortho, Slic3r::GUI::Camera::ViewAngleType::Iso,
-                                                                                                  false, true);
-                                                break;
-                                            }
-                                        case Slic3r::GUI::OpenGLManager::EFramebufferType::Ext:
-                                            {
-                                                BOOST_LOG_TRIVIAL(info) << boost::format("framebuffer_type: EXT");
-                                                Slic3r::GUI::GLCanvas3D::render_thumbnail_framebuffer_ext(*no_light_thumbnail,
-                                                   thumbnail_width, thumbnail_height, thumbnail_params,
-                                                                                                      partplate_list, model.objects, glvolume_collection, colors_out, shader,
-                                                                                                      Slic3r::GUI::Camera::EType::Ortho, Slic3r::GUI::Camera::ViewAngleType::Iso,
-                                                                                                      false, true);
-                                                break;
-                                            }
-                                        default:
-                                            BOOST_LOG_TRIVIAL(info) << boost::format("framebuffer_type: unknown");
-                                            break;
-                                    }
+                                    render_plate_thumbnail(*no_light_thumbnail, thumbnail_params, Slic3r::GUI::Camera::ViewAngleType::Iso, false, true);
                                     plate_data->no_light_thumbnail_file = "valid_no_light";
                                     BOOST_LOG_TRIVIAL(info) << boost::format("plate %1%'s no_light thumbnail,finished rendering")%(i+1);
                                 }
@@ -6657,7 +6836,6 @@ int CLI::run(int argc, char **argv)
                                     plate_data->pick_file.clear();
                                 }
                                 else {
-                                    unsigned int thumbnail_width = 512, thumbnail_height = 512;
                                     const ThumbnailsParams thumbnail_params = { {}, false, true, false, true, i };
 
                                     BOOST_LOG_TRIVIAL(info) << boost::format("plate %1%'s top/pick thumbnail missed, need to regenerate, objects count %2%, skip_useless_pick %3%")%(i+1) %plate_object_count[i] %skip_useless_pick;
@@ -6671,43 +6849,8 @@ int CLI::run(int argc, char **argv)
                                         BOOST_LOG_TRIVIAL(info) << boost::format("skip rendering for top&&pick");
                                     }
                                     else {
-                                        switch (Slic3r::GUI::OpenGLManager::get_framebuffers_type())
-                                        {
-                                            case Slic3r::GUI::OpenGLManager::EFramebufferType::Arb:
-                                                {
-                                                    BOOST_LOG_TRIVIAL(info) << boost::format("framebuffer_type: ARB");
-                                                    Slic3r::GUI::GLCanvas3D::render_thumbnail_framebuffer(*top_thumbnail,
-                                                       thumbnail_width, thumbnail_height, thumbnail_params,
-                                                                                                      partplate_list, model.objects, glvolume_collection, colors_out, shader,
-                                                                                                      Slic3r::GUI::Camera::EType::Ortho, Slic3r::GUI::Camera::ViewAngleType::Top_Plate,
-                                                                                                      false);
-                                                    Slic3r::GUI::GLCanvas3D::render_thumbnail_framebuffer(*picking_thumbnail,
-                                                       thumbnail_width, thumbnail_height, thumbnail_params,
-                                                                                                          partplate_list, model.objects, glvolume_collection, colors_out, shader,
-                                                                                                          Slic3r::GUI::Camera::EType::Ortho,
-                                                                                                          Slic3r::GUI::Camera::ViewAngleType::Top_Plate, true, true);
-                                                    break;
-                                                }
-                                            case Slic3r::GUI::OpenGLManager::EFramebufferType::Ext:
-                                                {
-                                                    BOOST_LOG_TRIVIAL(info) << boost::format("framebuffer_type: EXT");
-                                                    Slic3r::GUI::GLCanvas3D::render_thumbnail_framebuffer_ext(*top_thumbnail,
-                                                       thumbnail_width, thumbnail_height, thumbnail_params,
-                                                                                                          partplate_list, model.objects, glvolume_collection, colors_out, shader,
-                                                                                                          Slic3r::GUI::Camera::EType::Ortho,
-                                                                                                          Slic3r::GUI::Camera::ViewAngleType::Top_Plate, false);
-                                                    Slic3r::GUI::GLCanvas3D::render_thumbnail_framebuffer_ext(*picking_thumbnail,
-                                                       thumbnail_width, thumbnail_height, thumbnail_params, partplate_list, model.objects,
-                                                                                                              glvolume_collection, colors_out, shader,
-                                                                                                              Slic3r::GUI::Camera::EType::Ortho,
-                                                                                                              Slic3r::GUI::Camera::ViewAngleType::Top_Plate,
-                                                                                                              true,true);
-                                                    break;
-                                                }
-                                            default:
-                                                BOOST_LOG_TRIVIAL(info) << boost::format("framebuffer_type: unknown");
-                                                break;
-                                        }
+                                        render_plate_thumbnail(*top_thumbnail, thumbnail_params, Slic3r::GUI::Camera::ViewAngleType::Top_Plate, false, false);
+                                        render_plate_thumbnail(*picking_thumbnail, thumbnail_params, Slic3r::GUI::Camera::ViewAngleType::Top_Plate, true, true);
                                         plate_data->top_file = "valid_top";
                                         plate_data->pick_file = "valid_pick";
                                         BOOST_LOG_TRIVIAL(info) << boost::format("plate %1%'s top_thumbnail,finished rendering")%(i+1);
@@ -14,8 +14,9 @@ namespace Slic3r {
 
 class AABBMesh::AABBImpl {
 private:
-    AABBTreeIndirect::Tree3f m_tree;
-    double                   m_triangle_ray_epsilon;
+    // Wide tree collapsed from the balanced binary tree, it is faster to query.
+    AABBTreeIndirect::WideTree3f m_tree;
+    double                       m_triangle_ray_epsilon;
 
 public:
     void init(const indexed_triangle_set &its, bool calculate_epsilon)
@@ -27,8 +28,8 @@ public:
             if (l > 0)
                 m_triangle_ray_epsilon = 0.000001 * l * l;
         }
-        m_tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(
-            its.vertices, its.indices);
+        m_tree.build(AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(
+            its.vertices, its.indices));
     }
 
     void intersect_ray(const indexed_triangle_set &its,
@@ -7,6 +7,7 @@
 #define slic3r_AABBTreeIndirect_hpp_
 
 #include <algorithm>
+#include <array>
 #include <limits>
 #include <type_traits>
 #include <vector>
@@ -218,6 +219,142 @@ using Tree3f = Tree<3, float>;
 using Tree2d = Tree<2, double>;
 using Tree3d = Tree<3, double>;
 
+// Wide AABB tree, built by collapsing the binary Tree above, so that a single node stores the bounding boxes
+// of up to AWidth children. The children boxes are stored in a structure of arrays layout: a query is tested
+// against all the children of a node by a single loop over the lanes, which the compiler vectorizes.
+// The wide tree is shallower than the binary one and it is traversed with an explicit stack, visiting
+// the children front to back. Only the ray casting and the closest point queries are implemented for the wide tree.
+template<int ANumDimensions, typename ACoordType, int AWidth = 4>
+class WideTree
+{
+public:
+    static constexpr int    NumDimensions = ANumDimensions;
+    static constexpr int    Width         = AWidth;
+    using                   CoordType     = ACoordType;
+    using                   VectorType    = Eigen::Matrix<CoordType, NumDimensions, 1, Eigen::DontAlign>;
+    using                   BoundingBox   = Eigen::AlignedBox<CoordType, NumDimensions>;
+    using                   BinaryTree    = Tree<NumDimensions, CoordType>;
+    static_assert(Width >= 2 && Width <= 16, "WideTree: Width shall be in <2, 16>");
+
+    enum : size_t {
+        // Lane is not used.
+        npos      = size_t(-1),
+        // Flag of a lane referencing an external source entity instead of a child node.
+        leaf_flag = size_t(1) << (sizeof(size_t) * 8 - 1)
+    };
+
+    // Upper bound of the traversal stack: the wide tree is not deeper than the binary tree
+    // and each visited node pushes at most (Width - 1) more nodes than it pops.
+    static constexpr size_t max_stack_size = 64 * (Width - 1) + 1;
+
+    struct Node {
+        // Bounding boxes of the children, lane by lane.
+        alignas(16) CoordType   min[NumDimensions][Width];
+        alignas(16) CoordType   max[NumDimensions][Width];
+        // Index of a child node, or index of the external source entity with leaf_flag set, or npos.
+        size_t                  child[Width];
+
+        bool        is_valid(int lane)   const { return this->child[lane] != npos; }
+        bool        is_leaf(int lane)    const { return this->is_valid(lane) && (this->child[lane] & leaf_flag) != 0; }
+        bool        is_inner(int lane)   const { return (this->child[lane] & leaf_flag) == 0; }
+        size_t      entity_idx(int lane) const { assert(this->is_leaf(lane)); return this->child[lane] & ~size_t(leaf_flag); }
+        BoundingBox bbox(int lane) const {
+            BoundingBox out;
+            for (int dim = 0; dim < NumDimensions; ++ dim) {
+                out.min()(dim) = this->min[dim][lane];
+                out.max()(dim) = this->max[dim][lane];
+            }
+            return out;
+        }
+    };
+
+    WideTree() = default;
+    explicit WideTree(const BinaryTree &tree) { this->build(tree); }
+
+    void build(const BinaryTree &tree)
+    {
+        this->clear();
+        if (! tree.empty()) {
+            // A wide node replaces at least (Width - 1) binary nodes.
+            m_nodes.reserve(tree.nodes().size() / (Width - 1) + 1);
+            build_recursive(tree, 0);
+        }
+    }
+
+    void                        clear() { m_nodes.clear(); }
+    const std::vector<Node>&    nodes() const { return m_nodes; }
+    const Node&                 node(size_t idx) const { return m_nodes[idx]; }
+    bool                        empty() const { return m_nodes.empty(); }
+
+private:
+    // Collapse the binary subtree starting at binary_idx into a wide node, returns the index of the wide node.
+    size_t build_recursive(const BinaryTree &tree, size_t binary_idx)
+    {
+        // Open the binary subtree until Width nodes are gathered, always opening the inner node
+        // with the largest bounding box.
+        std::array<size_t, Width> gathered;
+        int                       num_gathered = 0;
+        if (tree.node(binary_idx).is_leaf())
+            gathered[num_gathered ++] = binary_idx;
+        else {
+            gathered[num_gathered ++] = BinaryTree::left_child_idx(binary_idx);
+            gathered[num_gathered ++] = BinaryTree::right_child_idx(binary_idx);
+            while (num_gathered < Width) {
+                int       to_open  = -1;
+                CoordType max_size = CoordType(-1);
+                for (int i = 0; i < num_gathered; ++ i)
+                    if (const typename BinaryTree::Node &n = tree.node(gathered[i]); n.is_inner()) {
+                        CoordType size = n.bbox.diagonal().squaredNorm();
+                        if (size > max_size) {
+                            max_size = size;
+                            to_open  = i;
+                        }
+                    }
+                if (to_open == -1)
+                    break;
+                size_t opened = gathered[to_open];
+                gathered[to_open]         = BinaryTree::left_child_idx(opened);
+                gathered[num_gathered ++] = BinaryTree::right_child_idx(opened);
+            }
+        }
+
+        size_t node_idx = m_nodes.size();
+        m_nodes.emplace_back();
+        for (int lane = 0; lane < Width; ++ lane) {
+            Node &node = m_nodes[node_idx];
+            if (lane >= num_gathered) {
+                node.child[lane] = npos;
+                for (int dim = 0; dim < NumDimensions; ++ dim) {
+                    node.min[dim][lane] = std::numeric_limits<CoordType>::max();
+                    node.max[dim][lane] = std::numeric_limits<CoordType>::lowest();
+                }
+                continue;
+            }
+            const typename BinaryTree::Node &src = tree.node(gathered[lane]);
+            assert(src.is_valid());
+            for (int dim = 0; dim < NumDimensions; ++ dim) {
+                node.min[dim][lane] = src.bbox.min()(dim);
+                node.max[dim][lane] = src.bbox.max()(dim);
+            }
+            if (src.is_leaf()) {
+                assert((src.idx & leaf_flag) == 0);
+                node.child[lane] = src.idx | leaf_flag;
+            } else {
+                // m_nodes may be reallocated by the recursive call.
+                size_t child_idx = build_recursive(tree, gathered[lane]);
+                m_nodes[node_idx].child[lane] = child_idx;
+            }
+        }
+        return node_idx;
+    }
+
+    // Root is the first node, the children are stored depth first.
+    std::vector<Node> m_nodes;
+};
+
+using WideTree3f = WideTree<3, float>;
+using WideTree3d = WideTree<3, double>;
+
 // Wrap a 2D Slic3r own BoundingBox to be passed to Tree::build() and similar
 // to build an AABBTree over coord_t 2D bounding boxes.
 class BoundingBoxWrapper {
@@ -631,6 +768,203 @@ namespace detail {
 		return up_sqr_d;
 	}
 
+    // Slab test of a ray against the bounding boxes of all children of a wide tree node.
+    // Returns a bit mask of the children intersected, fills in the ray parameters of entering the children boxes.
+    // The loops over lanes are kept free of branches, so that they are vectorized.
+    template<typename WideNode, int Width, typename VectorType, typename Scalar>
+    inline unsigned int ray_boxes_intersect_invdir(
+        const WideNode                  &node,
+        const VectorType                &origin,
+        const VectorType                &inv_dir,
+        const Scalar                     t0,
+        const Scalar                     t1,
+        Scalar                         (&t_entry)[Width])
+    {
+        Scalar t_exit[Width];
+        for (int lane = 0; lane < Width; ++ lane) {
+            t_entry[lane] = -std::numeric_limits<Scalar>::infinity();
+            t_exit[lane]  =  std::numeric_limits<Scalar>::infinity();
+        }
+        for (int dim = 0; dim < VectorType::RowsAtCompileTime; ++ dim) {
+            const Scalar o = origin(dim);
+            const Scalar d = inv_dir(dim);
+            for (int lane = 0; lane < Width; ++ lane) {
+                Scalar ta = (Scalar(node.min[dim][lane]) - o) * d;
+                Scalar tb = (Scalar(node.max[dim][lane]) - o) * d;
+                t_entry[lane] = std::max(t_entry[lane], std::min(ta, tb));
+                t_exit[lane]  = std::min(t_exit[lane],  std::max(ta, tb));
+            }
+        }
+        unsigned int mask = 0;
+        for (int lane = 0; lane < Width; ++ lane) {
+            mask |= unsigned(t_entry[lane] <= t_exit[lane] && t_entry[lane] < t1 && t_exit[lane] > t0 && node.is_valid(lane)) << lane;
+            t_entry[lane] = std::max(t_entry[lane], t0);
+        }
+        return mask;
+    }
+
+    // Squared distances of a point to the bounding boxes of all children of a wide tree node, zero if inside.
+    // Returns a bit mask of the valid children.
+    template<typename WideNode, int Width, typename VectorType, typename Scalar>
+    inline unsigned int point_boxes_squared_distance(const WideNode &node, const VectorType &point, Scalar (&sqr_d)[Width])
+    {
+        for (int lane = 0; lane < Width; ++ lane)
+            sqr_d[lane] = Scalar(0);
+        for (int dim = 0; dim < VectorType::RowsAtCompileTime; ++ dim) {
+            const Scalar p = point(dim);
+            for (int lane = 0; lane < Width; ++ lane) {
+                Scalar d = std::max(std::max(Scalar(node.min[dim][lane]) - p, p - Scalar(node.max[dim][lane])), Scalar(0));
+                sqr_d[lane] += d * d;
+            }
+        }
+        unsigned int mask = 0;
+        for (int lane = 0; lane < Width; ++ lane)
+            mask |= unsigned(node.is_valid(lane)) << lane;
+        return mask;
+    }
+
+    // Push the inner children of a wide node marked by mask to the traversal stack, the nearest one last,
+    // so that it will be popped first.
+    template<typename Stack, int Width, typename WideNode, typename Scalar>
+    inline void push_inner_far_to_near(Stack &stack, size_t &stack_size, const WideNode &node, unsigned int mask, const Scalar (&key)[Width])
+    {
+        int lanes[Width];
+        int num_lanes = 0;
+        for (int lane = 0; lane < Width; ++ lane)
+            if ((mask & (1u << lane)) != 0 && node.is_inner(lane)) {
+                // Insertion sort by descending key.
+                int i = num_lanes ++;
+                for (; i > 0 && key[lanes[i - 1]] < key[lane]; -- i)
+                    lanes[i] = lanes[i - 1];
+                lanes[i] = lane;
+            }
+        for (int i = 0; i < num_lanes; ++ i) {
+            assert(stack_size < stack.size());
+            stack[stack_size ++] = { node.child[lanes[i]], key[lanes[i]] };
+        }
+    }
+
+    template<typename RayIntersectorType, typename Scalar>
+    static inline bool intersect_ray_wide_first_hit(
+        const RayIntersectorType   &ray_intersector,
+        Scalar                      min_t,
+        igl::Hit                   &hit)
+    {
+        using TreeType = typename RayIntersectorType::TreeType;
+        constexpr int Width = TreeType::Width;
+
+        std::array<std::pair<size_t, Scalar>, TreeType::max_stack_size> stack;
+        size_t stack_size = 0;
+        stack[stack_size ++] = { size_t(0), Scalar(0) };
+        bool found = false;
+        while (stack_size > 0) {
+            auto [node_idx, t_node] = stack[-- stack_size];
+            if (t_node >= min_t)
+                // The node was pushed before a closer hit was found.
+                continue;
+            const auto  &node = ray_intersector.tree.node(node_idx);
+            Scalar       t_entry[Width];
+            unsigned int mask = ray_boxes_intersect_invdir<typename TreeType::Node, Width>(
+                node, ray_intersector.origin, ray_intersector.invdir, Scalar(0), min_t, t_entry);
+            // Leaves first, they may shorten the ray and cull the inner children.
+            for (int lane = 0; lane < Width; ++ lane)
+                if ((mask & (1u << lane)) != 0 && node.is_leaf(lane)) {
+                    size_t entity_idx = node.entity_idx(lane);
+                    auto   face = ray_intersector.faces[entity_idx];
+                    double t, u, v;
+                    if (intersect_triangle(
+                            ray_intersector.origin, ray_intersector.dir,
+                            ray_intersector.vertices[face(0)], ray_intersector.vertices[face(1)], ray_intersector.vertices[face(2)],
+                            t, u, v, ray_intersector.eps)
+                        && t > 0. && t < min_t) {
+                        hit   = igl::Hit { int(entity_idx), -1, float(u), float(v), float(t) };
+                        min_t = Scalar(t);
+                        found = true;
+                    }
+                }
+            for (int lane = 0; lane < Width; ++ lane)
+                if (t_entry[lane] >= min_t)
+                    mask &= ~(1u << lane);
+            push_inner_far_to_near(stack, stack_size, node, mask, t_entry);
+        }
+        return found;
+    }
+
+    template<typename RayIntersectorType>
+    static inline void intersect_ray_wide_all_hits(RayIntersectorType &ray_intersector)
+    {
+        using Scalar   = typename RayIntersectorType::VectorType::Scalar;
+        using TreeType = typename RayIntersectorType::TreeType;
+        constexpr int Width = TreeType::Width;
+
+        std::array<size_t, TreeType::max_stack_size> stack;
+        size_t stack_size = 0;
+        stack[stack_size ++] = 0;
+        while (stack_size > 0) {
+            const auto  &node = ray_intersector.tree.node(stack[-- stack_size]);
+            Scalar       t_entry[Width];
+            unsigned int mask = ray_boxes_intersect_invdir<typename TreeType::Node, Width>(
+                node, ray_intersector.origin, ray_intersector.invdir, Scalar(0), std::numeric_limits<Scalar>::infinity(), t_entry);
+            for (int lane = 0; lane < Width; ++ lane) {
+                if ((mask & (1u << lane)) == 0)
+                    continue;
+                if (node.is_inner(lane)) {
+                    assert(stack_size < stack.size());
+                    stack[stack_size ++] = node.child[lane];
+                    continue;
+                }
+                size_t entity_idx = node.entity_idx(lane);
+                auto   face = ray_intersector.faces[entity_idx];
+                double t, u, v;
+                if (intersect_triangle(
+                        ray_intersector.origin, ray_intersector.dir,
+                        ray_intersector.vertices[face(0)], ray_intersector.vertices[face(1)], ray_intersector.vertices[face(2)],
+                        t, u, v, ray_intersector.eps)
+                    && t > 0.)
+                    ray_intersector.hits.emplace_back(igl::Hit{ int(entity_idx), -1, float(u), float(v), float(t) });
+            }
+        }
+    }
+
+    template<typename IndexedPrimitivesDistancerType, typename Scalar>
+    static inline Scalar squared_distance_to_indexed_primitives_wide(
+        const IndexedPrimitivesDistancerType &distancer,
+        Scalar                                up_sqr_d,
+        size_t                               &i,
+        Eigen::PlainObjectBase<typename IndexedPrimitivesDistancerType::VectorType> &c)
+    {
+        using Vector   = typename IndexedPrimitivesDistancerType::VectorType;
+        using TreeType = typename IndexedPrimitivesDistancerType::TreeType;
+        constexpr int Width = TreeType::Width;
+
+        std::array<std::pair<size_t, Scalar>, TreeType::max_stack_size> stack;
+        size_t stack_size = 0;
+        stack[stack_size ++] = { size_t(0), Scalar(0) };
+        while (stack_size > 0) {
+            auto [node_idx, node_sqr_d] = stack[-- stack_size];
+            if (node_sqr_d >= up_sqr_d)
+                continue;
+            const auto  &node = distancer.tree.node(node_idx);
+            Scalar       sqr_d[Width];
+            unsigned int mask = point_boxes_squared_distance<typename TreeType::Node, Width>(node, distancer.origin, sqr_d);
+            for (int lane = 0; lane < Width; ++ lane)
+                if ((mask & (1u << lane)) != 0 && node.is_leaf(lane) && sqr_d[lane] < up_sqr_d) {
+                    Scalar sqr_dist;
+                    Vector c_candidate = distancer.closest_point_to_origin(node.entity_idx(lane), sqr_dist);
+                    if (sqr_dist < up_sqr_d) {
+                        i        = node.entity_idx(lane);
+                        c        = c_candidate;
+                        up_sqr_d = sqr_dist;
+                    }
+                }
+            for (int lane = 0; lane < Width; ++ lane)
+                if (sqr_d[lane] >= up_sqr_d)
+                    mask &= ~(1u << lane);
+            push_inner_far_to_near(stack, stack_size, node, mask, sqr_d);
+        }
+        return up_sqr_d;
+    }
+
     template<typename IndexedPrimitivesDistancerType, typename Scalar>
     static inline void indexed_primitives_within_distance_squared_recurisve(const IndexedPrimitivesDistancerType &distancer,
                                                                             size_t                                node_idx,
@@ -876,6 +1210,73 @@ inline std::vector<size_t> all_triangles_in_radius(
 }
 
 
+// Following are the variants of intersect_ray_first_hit(), intersect_ray_all_hits() and squared_distance_to_indexed_triangle_set()
+// over the wide tree. They return the same results as the binary tree queries, though if multiple triangles are hit
+// at the very same distance, a different one of them may be reported.
+template<typename VertexType, typename IndexedFaceType, int Dims, typename CoordType, int Width, typename VectorType>
+inline bool intersect_ray_first_hit(
+	const std::vector<VertexType> 		&vertices,
+	const std::vector<IndexedFaceType> 	&faces,
+	const WideTree<Dims, CoordType, Width> &tree,
+	const VectorType					&origin,
+	const VectorType 					&dir,
+	igl::Hit 							&hit,
+	const double 						 eps = 0.000001)
+{
+    using Scalar = typename VectorType::Scalar;
+    auto ray_intersector = detail::RayIntersector<VertexType, IndexedFaceType, WideTree<Dims, CoordType, Width>, VectorType> {
+        vertices, faces, tree,
+        origin, dir, VectorType(dir.cwiseInverse()),
+        eps
+    };
+    return ! tree.empty() && detail::intersect_ray_wide_first_hit(ray_intersector, std::numeric_limits<Scalar>::infinity(), hit);
+}
+
+template<typename VertexType, typename IndexedFaceType, int Dims, typename CoordType, int Width, typename VectorType>
+inline bool intersect_ray_all_hits(
+	const std::vector<VertexType> 		&vertices,
+	const std::vector<IndexedFaceType> 	&faces,
+	const WideTree<Dims, CoordType, Width> &tree,
+	const VectorType					&origin,
+	const VectorType 					&dir,
+	std::vector<igl::Hit> 				&hits,
+	const double 						 eps = 0.000001)
+{
+    auto ray_intersector = detail::RayIntersectorHits<VertexType, IndexedFaceType, WideTree<Dims, CoordType, Width>, VectorType> {
+        { vertices, faces, tree,
+        origin, dir, VectorType(dir.cwiseInverse()),
+        eps }
+    };
+    if (tree.empty()) {
+        hits.clear();
+    } else {
+        // Reusing the output memory if there is some memory already pre-allocated.
+        ray_intersector.hits = std::move(hits);
+        ray_intersector.hits.clear();
+        ray_intersector.hits.reserve(8);
+        detail::intersect_ray_wide_all_hits(ray_intersector);
+        hits = std::move(ray_intersector.hits);
+        std::sort(hits.begin(), hits.end(), [](const auto &l, const auto &r) { return l.t < r.t; });
+    }
+    return ! hits.empty();
+}
+
+template<typename VertexType, typename IndexedFaceType, int Dims, typename CoordType, int Width, typename VectorType>
+inline typename VectorType::Scalar squared_distance_to_indexed_triangle_set(
+	const std::vector<VertexType> 		&vertices,
+	const std::vector<IndexedFaceType> 	&faces,
+	const WideTree<Dims, CoordType, Width> &tree,
+	const VectorType					&point,
+	size_t 								&hit_idx_out,
+	Eigen::PlainObjectBase<VectorType>	&hit_point_out)
+{
+    using Scalar = typename VectorType::Scalar;
+    auto distancer = detail::IndexedTriangleSetDistancer<VertexType, IndexedFaceType, WideTree<Dims, CoordType, Width>, VectorType>
+        { vertices, faces, tree, point };
+    return tree.empty() ? Scalar(-1) :
+        detail::squared_distance_to_indexed_primitives_wide(distancer, std::numeric_limits<Scalar>::infinity(), hit_idx_out, hit_point_out);
+}
+
 // Traverse the tree and return the index of an entity whose bounding box
 // contains a given point. Returns size_t(-1) when the point is outside.
 template<typename TreeType, typename VectorType>
@@ -41,15 +41,19 @@ void ArcFitter::do_arc_fitting(const Points& points, std::vector<PathFittingData
     bool can_fit = false;
     Points current_segment;
     current_segment.reserve(points.size());
+    // Length of current_segment, summed the same way as Polyline::length() does.
+    double current_length = 0.;
     ArcSegment target_arc;
     for (size_t i = 0; i < points.size(); i++) {
         //BBS: point in stack is not enough, build stack first
         back_index = i;
         current_segment.push_back(points[i]);
+        if (current_segment.size() > 1)
+            current_length += Line(current_segment[current_segment.size() - 2], current_segment.back()).length();
         if (back_index - front_index < 2)
             continue;
 
-        can_fit = ArcSegment::try_create_arc(current_segment, target_arc, Polyline(current_segment).length(),
+        can_fit = ArcSegment::try_create_arc(current_segment, target_arc, current_length,
                                              DEFAULT_SCALED_MAX_RADIUS,
                                              tolerance,
                                              DEFAULT_ARC_LENGTH_PERCENT_TOLERANCE);
@@ -82,6 +86,7 @@ void ArcFitter::do_arc_fitting(const Points& points, std::vector<PathFittingData
             current_segment.clear();
             current_segment.push_back(points[front_index]);
             current_segment.push_back(points[front_index + 1]);
+            current_length = Line(current_segment.front(), current_segment.back()).length();
         }
     }
 	//BBS: handle the remain data
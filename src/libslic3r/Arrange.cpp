@@ -305,6 +305,9 @@ void fill_config(PConf& pcfg, const ArrangeParams &params) {
     // Allow parallel execution.
     pcfg.parallel = params.parallel;
 
+    // NFPs of identical parts are computed once per arrange call.
+    pcfg.nfp_cache = std::make_shared<placers::NfpCache<ExPolygon>>();
+
     // BBS: excluded regions in BBS bed
     for (auto& poly : params.excluded_regions)
         process_arrangeable(poly, pcfg.m_excluded_regions);
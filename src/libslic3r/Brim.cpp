@@ -1,5 +1,6 @@
 #include "clipper/clipper_z.hpp"
 
+#include "Brim.hpp"
 #include "ClipperUtils.hpp"
 #include "EdgeGrid.hpp"
 #include "Layer.hpp"
@@ -12,8 +13,11 @@
 #include <algorithm>
 #include <numeric>
 #include <unordered_set>
+#include <memory>
+#include <tbb/blocked_range.h>
 #include <tbb/parallel_for.h>
 
+#include <boost/functional/hash.hpp>
 #include <boost/log/trivial.hpp>
 
 #ifndef NDEBUG
@@ -885,6 +889,272 @@ static ExPolygons make_brim_ears(const PrintObject* object, const double& flowWi
     return mouse_ears_ex;
 }
 
+bool PrintObjectBrimAreas::Inputs::operator==(const Inputs &rhs) const
+{
+    auto same_meshes = [](const std::vector<std::weak_ptr<const TriangleMesh>> &lhs, const std::vector<std::weak_ptr<const TriangleMesh>> &rhs) {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](const auto &l, const auto &r) {
+            return ! l.owner_before(r) && ! r.owner_before(l);
+        });
+    };
+    return this->options          == rhs.options
+        && this->trafos           == rhs.trafos
+        && this->brim_points      == rhs.brim_points
+        && this->volume_ids       == rhs.volume_ids
+        && same_meshes(this->volume_meshes, rhs.volume_meshes)
+        && this->group_volume_ids == rhs.group_volume_ids
+        && this->support_type     == rhs.support_type
+        && this->group_slices     == rhs.group_slices
+        && this->lslices          == rhs.lslices
+        && this->support_lslices  == rhs.support_lslices
+        && this->support_points   == rhs.support_points;
+}
+
+// Everything the brim areas of an object depend on, but the positions of its instances.
+static PrintObjectBrimAreas::Inputs object_brim_areas_inputs(const Print& print, const PrintObject* object, const float no_brim_offset)
+{
+    PrintObjectBrimAreas::Inputs inputs;
+    auto append_matrix = [&inputs](const Transform3d &trafo) {
+        inputs.trafos.insert(inputs.trafos.end(), trafo.matrix().data(), trafo.matrix().data() + 16);
+    };
+
+    const PrintObjectConfig &config = object->config();
+    inputs.options = { double(config.brim_type.value), config.brim_width.value, config.brim_object_gap.value, config.brim_ears_detection_length.value,
+                       config.brim_ears_max_angle.value, double(print.brim_flow().scaled_spacing()), double(no_brim_offset) };
+    if (config.brim_type == btAutoBrim) {
+        inputs.options.emplace_back(getadhesionCoeff(object));
+        inputs.options.emplace_back(Model::findMaxSpeed(object->model_object()));
+    }
+
+    // Painted ears and the auto brim width depend on the orientation of the object and on its volumes.
+    const ModelInstance &model_instance = *object->model_object()->instances.front();
+    append_matrix(model_instance.get_matrix_no_offset());
+    inputs.trafos.emplace_back(model_instance.get_offset().z());
+    for (const BrimPoint &pt : object->model_object()->brim_points)
+        inputs.brim_points.insert(inputs.brim_points.end(), { pt.pos.x(), pt.pos.y(), pt.pos.z(), pt.head_front_radius });
+    const PrintObject *shared_object = object->get_shared_object() ? object->get_shared_object() : object;
+    for (const ModelVolume *volume : shared_object->model_object()->volumes) {
+        inputs.volume_ids.emplace_back(volume->id().id);
+        inputs.volume_meshes.emplace_back(volume->mesh_ptr());
+        append_matrix(volume->get_matrix());
+    }
+
+    // First layer of the object and of its support.
+    for (const groupedVolumeSlices &group : object->firstLayerObjGroups()) {
+        inputs.group_volume_ids.emplace_back();
+        for (const ObjectID &volume_id : group.volume_ids)
+            inputs.group_volume_ids.back().emplace_back(volume_id.id);
+        inputs.group_slices.emplace_back(group.slices);
+    }
+    inputs.lslices = object->layers().front()->lslices;
+    if (! object->support_layers().empty()) {
+        const SupportLayer *support_layer = object->support_layers().front();
+        inputs.support_type    = int(support_layer->support_type);
+        inputs.support_lslices = support_layer->lslices;
+        support_layer->support_fills.collect_points(inputs.support_points);
+    }
+    return inputs;
+}
+
+static uint64_t object_brim_areas_key(const PrintObjectBrimAreas::Inputs &inputs)
+{
+    size_t seed = 0;
+    auto   hash_points = [&seed](const Points &points) {
+        boost::hash_combine(seed, points.size());
+        for (const Point &pt : points) {
+            boost::hash_combine(seed, pt.x());
+            boost::hash_combine(seed, pt.y());
+        }
+    };
+    auto hash_expolygons = [&seed, &hash_points](const ExPolygons &expolys) {
+        boost::hash_combine(seed, expolys.size());
+        for (const ExPolygon &expoly : expolys) {
+            hash_points(expoly.contour.points);
+            boost::hash_combine(seed, expoly.holes.size());
+            for (const Polygon &hole : expoly.holes)
+                hash_points(hole.points);
+        }
+    };
+    auto hash_range = [&seed](const auto &values) {
+        boost::hash_combine(seed, values.size());
+        boost::hash_range(seed, values.begin(), values.end());
+    };
+
+    hash_range(inputs.options);
+    hash_range(inputs.trafos);
+    hash_range(inputs.brim_points);
+    hash_range(inputs.volume_ids);
+    for (const std::vector<size_t> &volume_ids : inputs.group_volume_ids)
+        hash_range(volume_ids);
+    for (const ExPolygons &slices : inputs.group_slices)
+        hash_expolygons(slices);
+    hash_expolygons(inputs.lslices);
+    boost::hash_combine(seed, inputs.support_type);
+    hash_expolygons(inputs.support_lslices);
+    hash_points(inputs.support_points);
+    return uint64_t(seed);
+}
+
+// Brim areas of a single object and of its support, not translated to the instances yet.
+static PrintObjectBrimAreas object_brim_areas(const Print& print, const PrintObject* object, const float no_brim_offset)
+{
+    PrintObjectBrimAreas areas;
+    Flow                 flow = print.brim_flow();
+    const BrimType       brim_type = object->config().brim_type.value;
+    float                brim_offset = scale_(object->config().brim_object_gap.value);
+    double               flowWidth = print.brim_flow().scaled_spacing() * SCALING_FACTOR;
+    float                brim_width = scale_(floor(object->config().brim_width.value / flowWidth / 2) * flowWidth * 2);
+    const float          scaled_flow_width = print.brim_flow().scaled_spacing();
+    const float          scaled_additional_brim_width = scale_(floor(5 / flowWidth / 2) * flowWidth * 2);
+    const float          scaled_half_min_adh_length = scale_(1.1);
+    bool                 has_brim_auto = object->config().brim_type == btAutoBrim;
+    const bool           use_auto_brim_ears = object->config().brim_type == btEar;
+    const bool           use_brim_ears = object->config().brim_type == btPainted;
+    const bool           has_inner_brim = brim_type == btInnerOnly || brim_type == btOuterAndInner || use_auto_brim_ears || use_brim_ears;
+    const bool           has_outer_brim = brim_type == btOuterOnly || brim_type == btOuterAndInner || brim_type == btAutoBrim || use_auto_brim_ears || use_brim_ears;
+    coord_t              ear_detection_length = scale_(object->config().brim_ears_detection_length.value);
+    coordf_t             brim_ears_max_angle = object->config().brim_ears_max_angle.value;
+
+    double adhesion = getadhesionCoeff(object);
+    double maxSpeed = Model::findMaxSpeed(object->model_object());
+    // BBS: brims are generated by volume groups
+    for (const auto& volumeGroup : object->firstLayerObjGroups()) {
+        // find volumePtrs included in this group
+        std::vector<ModelVolume*> groupVolumePtrs;
+        for (auto& volumeID : volumeGroup.volume_ids) {
+            ModelVolume* currentModelVolumePtr = nullptr;
+            //BBS: support shared object logic
+            const PrintObject* shared_object = object->get_shared_object();
+            if (!shared_object)
+                shared_object = object;
+            for (auto volumePtr : shared_object->model_object()->volumes) {
+                if (volumePtr->id() == volumeID) {
+                    currentModelVolumePtr = volumePtr;
+                    break;
+                }
+            }
+            if (currentModelVolumePtr != nullptr) groupVolumePtrs.push_back(currentModelVolumePtr);
+        }
+        if (groupVolumePtrs.empty()) continue;
+        double groupHeight = 0.;
+        // config brim width in auto-brim mode
+        if (has_brim_auto) {
+            double brimWidthRaw = configBrimWidthByVolumeGroups(adhesion, maxSpeed, groupVolumePtrs, volumeGroup.slices, groupHeight);
+            brim_width = scale_(floor(brimWidthRaw / flowWidth / 2) * flowWidth * 2);
+        }
+        for (const ExPolygon& ex_poly : volumeGroup.slices) {
+            // BBS: additional brim width will be added if part's adhesion area is too small and brim is not generated
+            float brim_width_mod;
+            if (brim_width < scale_(5.) && has_brim_auto && groupHeight > 10.) {
+                brim_width_mod = ex_poly.area() / ex_poly.contour.length() < scaled_half_min_adh_length
+                    && brim_width < scaled_flow_width ? brim_width + scaled_additional_brim_width : brim_width;
+            }
+            else {
+                brim_width_mod = brim_width;
+            }
+            //BBS: brim width should be limited to the 1.5*boundingboxSize of a single polygon.
+            if (has_brim_auto) {
+                BoundingBox bbox2 = ex_poly.contour.bounding_box();
+                brim_width_mod = std::min(brim_width_mod, float(std::max(bbox2.size()(0), bbox2.size()(1))));
+            }
+            brim_width_mod = floor(brim_width_mod / scaled_flow_width / 2) * scaled_flow_width * 2;
+
+            Polygons ex_poly_holes_reversed = ex_poly.holes;
+            polygons_reverse(ex_poly_holes_reversed);
+
+            if (has_outer_brim) {
+                // BBS: inner and outer boundary are offset from the same polygon incase of round off error.
+                auto innerExpoly = offset_ex(ex_poly.contour, brim_offset, jtRound, SCALED_RESOLUTION);
+                ExPolygons outerExpoly;
+                if (use_brim_ears) {
+                    outerExpoly = make_brim_ears(object, flowWidth, brim_offset, flow, true);
+                    //outerExpoly = offset_ex(outerExpoly, brim_width_mod, jtRound, SCALED_RESOLUTION);
+                } else if (use_auto_brim_ears) {
+                    coord_t size_ear = (brim_width_mod - brim_offset - flow.scaled_spacing());
+                    outerExpoly = make_brim_ears_auto(innerExpoly, size_ear, ear_detection_length, brim_ears_max_angle, true);
+                }else {
+                    outerExpoly = offset_ex(innerExpoly, brim_width_mod, jtRound, SCALED_RESOLUTION);
+                }
+                append(areas.brim_area, diff_ex(outerExpoly, innerExpoly));
+            }
+            if (has_inner_brim) {
+                ExPolygons outerExpoly;
+                auto innerExpoly = offset_ex(ex_poly_holes_reversed, -brim_width - brim_offset);
+                if (use_brim_ears) {
+                    outerExpoly = make_brim_ears(object, flowWidth, brim_offset, flow, false);
+                } else if (use_auto_brim_ears) {
+                    coord_t size_ear = (brim_width - brim_offset - flow.scaled_spacing());
+                    outerExpoly = make_brim_ears_auto(offset_ex(ex_poly_holes_reversed, -brim_offset), size_ear, ear_detection_length, brim_ears_max_angle, false);
+                }else {
+                    outerExpoly = offset_ex(ex_poly_holes_reversed, -brim_offset);
+                }
+                append(areas.brim_area, intersection_ex(diff_ex(outerExpoly, innerExpoly), ex_poly_holes_reversed));
+            }
+            if (!has_inner_brim) {
+                // BBS: brim should be apart from holes
+                append(areas.no_brim_area, diff_ex(ex_poly_holes_reversed, offset_ex(ex_poly_holes_reversed, -no_brim_offset)));
+            }
+            if (!has_outer_brim)
+                append(areas.no_brim_area, diff_ex(offset(ex_poly.contour, no_brim_offset), ex_poly_holes_reversed));
+            append(areas.holes, ex_poly_holes_reversed);
+        }
+    }
+    areas.island = offset_ex(object->layers().front()->lslices, brim_offset, jtRound, SCALED_RESOLUTION);
+    append(areas.no_brim_area, areas.island);
+
+    // Brim will not be generated for supports, the support only blocks the brims of the other objects.
+    if (!object->support_layers().empty() && object->support_layers().front()->support_type==stInnerNormal) {
+        for (const Polygon& support_contour : object->support_layers().front()->support_fills.polygons_covered_by_spacing())
+            areas.support_no_brim_area.emplace_back(support_contour);
+    }
+    // BBS
+    if (!object->support_layers().empty() && object->support_layers().front()->support_type == stInnerTree) {
+        for (const ExPolygon &ex_poly : object->support_layers().front()->lslices) {
+            if (!has_outer_brim)
+                append(areas.support_no_brim_area, diff_ex(offset(ex_poly.contour, no_brim_offset), ex_poly.holes));
+            if (!has_inner_brim && !has_outer_brim)
+                append(areas.support_no_brim_area, offset_ex(ex_poly.holes, -no_brim_offset));
+            append(areas.support_holes, ex_poly.holes);
+            if (has_inner_brim || has_outer_brim)
+                append(areas.support_no_brim_area, offset_ex(ex_poly.contour, 0));
+            areas.support_no_brim_area.emplace_back(ex_poly.contour);
+        }
+    }
+    return areas;
+}
+
+// Brim areas of the objects, produced in parallel or taken from the objects if their first layer and brim settings did not change.
+static std::map<ObjectID, std::shared_ptr<const PrintObjectBrimAreas>> objects_brim_areas(const Print& print,
+    const float no_brim_offset, const std::vector<std::pair<ObjectID, unsigned int>>& objPrintVec)
+{
+    std::vector<PrintObject*> objects;
+    for (const auto& objectWithExtruder : objPrintVec) {
+        // make_brim() is the only user of the brim areas, serialized with the other steps of the Print.
+        PrintObject *object = const_cast<PrintObject*>(print.get_object(objectWithExtruder.first));
+        if (std::find(objects.begin(), objects.end(), object) == objects.end())
+            objects.emplace_back(object);
+    }
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, objects.size()), [&print, &objects, no_brim_offset](const tbb::blocked_range<size_t>& range) {
+        for (size_t object_idx = range.begin(); object_idx < range.end(); ++ object_idx) {
+            PrintObject                  *object = objects[object_idx];
+            PrintObjectBrimAreas::Inputs  inputs = object_brim_areas_inputs(print, object, no_brim_offset);
+            const uint64_t                key    = object_brim_areas_key(inputs);
+            // The hash only rejects quickly, the inputs are compared to confirm a match.
+            if (object->brim_areas_cache && object->brim_areas_cache->key == key && object->brim_areas_cache->inputs == inputs)
+                continue;
+            auto areas = std::make_shared<PrintObjectBrimAreas>(object_brim_areas(print, object, no_brim_offset));
+            areas->key    = key;
+            areas->inputs = std::move(inputs);
+            object->brim_areas_cache = std::move(areas);
+        }
+    });
+
+    std::map<ObjectID, std::shared_ptr<const PrintObjectBrimAreas>> out;
+    for (const PrintObject *object : objects)
+        out.emplace(object->id(), object->brim_areas_cache);
+    return out;
+}
+
 //BBS: create all brims
 static ExPolygons outer_inner_brim_area(const Print& print,
     const float no_brim_offset, std::map<ObjectID, ExPolygons>& brimAreaMap,
@@ -893,7 +1163,6 @@ static ExPolygons outer_inner_brim_area(const Print& print,
     std::vector<unsigned int>& printExtruders)
 {
     unsigned int support_material_extruder = printExtruders.front() + 1;
-    Flow flow = print.brim_flow();
 
     ExPolygons brim_area;
     ExPolygons no_brim_area;
@@ -907,127 +1176,23 @@ static ExPolygons outer_inner_brim_area(const Print& print,
     for (const auto& objectWithExtruder : objPrintVec)
         brimToWrite.insert({ objectWithExtruder.first, {true,true} });
 
+    // The areas of the objects do not depend on each other, only their placement and clipping below are sequential.
+    const std::map<ObjectID, std::shared_ptr<const PrintObjectBrimAreas>> objects_areas = objects_brim_areas(print, no_brim_offset, objPrintVec);
+
     ExPolygons objectIslands;
     for (unsigned int extruderNo : printExtruders) {
         ++extruderNo;
         for (const auto& objectWithExtruder : objPrintVec) {
-            const PrintObject* object = print.get_object(objectWithExtruder.first);
-            const BrimType     brim_type = object->config().brim_type.value;
-            float              brim_offset = scale_(object->config().brim_object_gap.value);
-            double             flowWidth = print.brim_flow().scaled_spacing() * SCALING_FACTOR;
-            float              brim_width = scale_(floor(object->config().brim_width.value / flowWidth / 2) * flowWidth * 2);
-            const float        scaled_flow_width = print.brim_flow().scaled_spacing();
-            const float        scaled_additional_brim_width = scale_(floor(5 / flowWidth / 2) * flowWidth * 2);
-            const float        scaled_half_min_adh_length = scale_(1.1);
-            bool               has_brim_auto = object->config().brim_type == btAutoBrim;
-            const bool         use_auto_brim_ears = object->config().brim_type == btEar;
-            const bool         use_brim_ears = object->config().brim_type == btPainted;
-            const bool         has_inner_brim = brim_type == btInnerOnly || brim_type == btOuterAndInner || use_auto_brim_ears || use_brim_ears;
-            const bool         has_outer_brim = brim_type == btOuterOnly || brim_type == btOuterAndInner || brim_type == btAutoBrim || use_auto_brim_ears || use_brim_ears;
-            coord_t            ear_detection_length = scale_(object->config().brim_ears_detection_length.value);
-            coordf_t           brim_ears_max_angle = object->config().brim_ears_max_angle.value;
-
-            ExPolygons         brim_area_object;
-            ExPolygons         no_brim_area_object;
-            ExPolygons         brim_area_support;
-            ExPolygons         no_brim_area_support;
-            Polygons           holes_object;
-            Polygons           holes_support;
+            const PrintObject*          object = print.get_object(objectWithExtruder.first);
+            const PrintObjectBrimAreas &areas  = *objects_areas.at(object->id());
             if (objectWithExtruder.second == extruderNo && brimToWrite.at(object->id()).obj) {
-                double             adhesion = getadhesionCoeff(object);
-                double             maxSpeed = Model::findMaxSpeed(object->model_object());
-                // BBS: brims are generated by volume groups
-                for (const auto& volumeGroup : object->firstLayerObjGroups()) {
-                    // find volumePtrs included in this group
-                    std::vector<ModelVolume*> groupVolumePtrs;
-                    for (auto& volumeID : volumeGroup.volume_ids) {
-                        ModelVolume* currentModelVolumePtr = nullptr;
-                        //BBS: support shared object logic
-                        const PrintObject* shared_object = object->get_shared_object();
-                        if (!shared_object)
-                            shared_object = object;
-                        for (auto volumePtr : shared_object->model_object()->volumes) {
-                            if (volumePtr->id() == volumeID) {
-                                currentModelVolumePtr = volumePtr;
-                                break;
-                            }
-                        }
-                        if (currentModelVolumePtr != nullptr) groupVolumePtrs.push_back(currentModelVolumePtr);
-                    }
-                    if (groupVolumePtrs.empty()) continue;
-                    double groupHeight = 0.;
-                    // config brim width in auto-brim mode
-                    if (has_brim_auto) {
-                        double brimWidthRaw = configBrimWidthByVolumeGroups(adhesion, maxSpeed, groupVolumePtrs, volumeGroup.slices, groupHeight);
-                        brim_width = scale_(floor(brimWidthRaw / flowWidth / 2) * flowWidth * 2);
-                    }
-                    for (const ExPolygon& ex_poly : volumeGroup.slices) {
-                        // BBS: additional brim width will be added if part's adhesion area is too small and brim is not generated
-                        float brim_width_mod;
-                        if (brim_width < scale_(5.) && has_brim_auto && groupHeight > 10.) {
-                            brim_width_mod = ex_poly.area() / ex_poly.contour.length() < scaled_half_min_adh_length
-                                && brim_width < scaled_flow_width ? brim_width + scaled_additional_brim_width : brim_width;
-                        }
-                        else {
-                            brim_width_mod = brim_width;
-                        }
-                        //BBS: brim width should be limited to the 1.5*boundingboxSize of a single polygon.
-                        if (has_brim_auto) {
-                            BoundingBox bbox2 = ex_poly.contour.bounding_box();
-                            brim_width_mod = std::min(brim_width_mod, float(std::max(bbox2.size()(0), bbox2.size()(1))));
-                        }
-                        brim_width_mod = floor(brim_width_mod / scaled_flow_width / 2) * scaled_flow_width * 2;
-
-                        Polygons ex_poly_holes_reversed = ex_poly.holes;
-                        polygons_reverse(ex_poly_holes_reversed);
-
-                        if (has_outer_brim) {
-                            // BBS: inner and outer boundary are offset from the same polygon incase of round off error.
-                            auto innerExpoly = offset_ex(ex_poly.contour, brim_offset, jtRound, SCALED_RESOLUTION);
-                            ExPolygons outerExpoly;
-                            if (use_brim_ears) {
-                                outerExpoly = make_brim_ears(object, flowWidth, brim_offset, flow, true);
-                                //outerExpoly = offset_ex(outerExpoly, brim_width_mod, jtRound, SCALED_RESOLUTION);
-                            } else if (use_auto_brim_ears) {
-                                coord_t size_ear = (brim_width_mod - brim_offset - flow.scaled_spacing());
-                                outerExpoly = make_brim_ears_auto(innerExpoly, size_ear, ear_detection_length, brim_ears_max_angle, true);
-                            }else {
-                                outerExpoly = offset_ex(innerExpoly, brim_width_mod, jtRound, SCALED_RESOLUTION);
-                            }
-                            append(brim_area_object, diff_ex(outerExpoly, innerExpoly));
-                        }
-                        if (has_inner_brim) {
-                            ExPolygons outerExpoly;
-                            auto innerExpoly = offset_ex(ex_poly_holes_reversed, -brim_width - brim_offset);
-                            if (use_brim_ears) {
-                                outerExpoly = make_brim_ears(object, flowWidth, brim_offset, flow, false);
-                            } else if (use_auto_brim_ears) {
-                                coord_t size_ear = (brim_width - brim_offset - flow.scaled_spacing());
-                                outerExpoly = make_brim_ears_auto(offset_ex(ex_poly_holes_reversed, -brim_offset), size_ear, ear_detection_length, brim_ears_max_angle, false);
-                            }else {
-                                outerExpoly = offset_ex(ex_poly_holes_reversed, -brim_offset);
-                            }
-                            append(brim_area_object, intersection_ex(diff_ex(outerExpoly, innerExpoly), ex_poly_holes_reversed));
-                        }
-                        if (!has_inner_brim) {
-                            // BBS: brim should be apart from holes
-                            append(no_brim_area_object, diff_ex(ex_poly_holes_reversed, offset_ex(ex_poly_holes_reversed, -no_brim_offset)));
-                        }
-                        if (!has_outer_brim)
-                            append(no_brim_area_object, diff_ex(offset(ex_poly.contour, no_brim_offset), ex_poly_holes_reversed));
-                        append(holes_object, ex_poly_holes_reversed);
-                    }
-                }
-                auto objectIsland = offset_ex(object->layers().front()->lslices, brim_offset, jtRound, SCALED_RESOLUTION);
-                append(no_brim_area_object, objectIsland);
-
                 brimToWrite.at(object->id()).obj = false;
                 for (const PrintInstance& instance : object->instances()) {
-                    if (!brim_area_object.empty())
-                        append_and_translate(brim_area, brim_area_object, instance, print, brimAreaMap);
-                    append_and_translate(no_brim_area, no_brim_area_object, instance);
-                    append_and_translate(holes, holes_object, instance);
-                    append_and_translate(objectIslands, objectIsland, instance);
+                    if (!areas.brim_area.empty())
+                        append_and_translate(brim_area, areas.brim_area, instance, print, brimAreaMap);
+                    append_and_translate(no_brim_area, areas.no_brim_area, instance);
+                    append_and_translate(holes, areas.holes, instance);
+                    append_and_translate(objectIslands, areas.island, instance);
 
                 }
                 if (brimAreaMap.find(object->id()) != brimAreaMap.end())
@@ -1041,50 +1206,12 @@ static ExPolygons outer_inner_brim_area(const Print& print,
                     support_material_extruder = printExtruders.front() + 1;
             }
             if (support_material_extruder == extruderNo && brimToWrite.at(object->id()).sup) {
-                if (!object->support_layers().empty() && object->support_layers().front()->support_type==stInnerNormal) {
-                    for (const Polygon& support_contour : object->support_layers().front()->support_fills.polygons_covered_by_spacing()) {
-                        // Brim will not be generated for supports
-                        /*
-                        if (has_outer_brim) {
-                            append(brim_area_support, diff_ex(offset_ex(support_contour, brim_width + brim_offset, jtRound, SCALED_RESOLUTION), offset_ex(support_contour, brim_offset)));
-                        }
-                        if (has_inner_brim || has_outer_brim)
-                            append(no_brim_area_support, offset_ex(support_contour, 0));
-                        */
-                        no_brim_area_support.emplace_back(support_contour);
-                    }
-                }
-                // BBS
-                if (!object->support_layers().empty() && object->support_layers().front()->support_type == stInnerTree) {
-                    for (const ExPolygon &ex_poly : object->support_layers().front()->lslices) {
-                        // BBS: additional brim width will be added if adhesion area is too small without brim
-                        float brim_width_mod = ex_poly.area() / ex_poly.contour.length() < scaled_half_min_adh_length
-                            && brim_width < scaled_flow_width ? brim_width + scaled_additional_brim_width : brim_width;
-                        brim_width_mod = floor(brim_width_mod / scaled_flow_width / 2) * scaled_flow_width * 2;
-                        // Brim will not be generated for supports
-                        /*
-                        if (has_outer_brim) {
-                            append(brim_area_support, diff_ex(offset_ex(ex_poly.contour, brim_width_mod + brim_offset, jtRound, SCALED_RESOLUTION), offset_ex(ex_poly.contour, brim_offset)));
-                        }
-                        if (has_inner_brim)
-                            append(brim_area_support, diff_ex(offset_ex(ex_poly.holes, -brim_offset), offset_ex(ex_poly.holes, -brim_width - brim_offset)));
-                        */
-                        if (!has_outer_brim)
-                            append(no_brim_area_support, diff_ex(offset(ex_poly.contour, no_brim_offset), ex_poly.holes));
-                        if (!has_inner_brim && !has_outer_brim)
-                            append(no_brim_area_support, offset_ex(ex_poly.holes, -no_brim_offset));
-                        append(holes_support, ex_poly.holes);
-                        if (has_inner_brim || has_outer_brim)
-                            append(no_brim_area_support, offset_ex(ex_poly.contour, 0));
-                        no_brim_area_support.emplace_back(ex_poly.contour);
-                    }
-                }
                 brimToWrite.at(object->id()).sup = false;
                 for (const PrintInstance& instance : object->instances()) {
-                    if (!brim_area_support.empty())
-                        append_and_translate(brim_area, brim_area_support, instance, print, supportBrimAreaMap);
-                    append_and_translate(no_brim_area, no_brim_area_support, instance);
-                    append_and_translate(holes, holes_support, instance);
+                    if (!areas.support_brim_area.empty())
+                        append_and_translate(brim_area, areas.support_brim_area, instance, print, supportBrimAreaMap);
+                    append_and_translate(no_brim_area, areas.support_no_brim_area, instance);
+                    append_and_translate(holes, areas.support_holes, instance);
                 }
                 if (supportBrimAreaMap.find(object->id()) != supportBrimAreaMap.end())
                     expolygons_append(brim_area, supportBrimAreaMap[object->id()]);
@@ -1110,30 +1237,39 @@ static ExPolygons outer_inner_brim_area(const Print& print,
         expolygons_append(no_brim_area, expolyFromLines);
     }
 
-    for (const PrintObject* object : print.objects()) {
-        ExPolygons extruder_no_brim_area = no_brim_area;
-        auto iter = std::find_if(objPrintVec.begin(), objPrintVec.end(), [object](const std::pair<ObjectID, unsigned int>& item) {
-            return item.first == object->id();
-        });
+    // Clip the brims of each object by the no brim area of all the objects, in parallel as the maps are not modified but their values.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, print.objects().size()),
+        [&print, &objPrintVec, &no_brim_area, &filament_map, &extruder_unprintable_area, &brimAreaMap, &supportBrimAreaMap](const tbb::blocked_range<size_t>& range) {
+        for (size_t object_idx = range.begin(); object_idx < range.end(); ++ object_idx) {
+            const PrintObject* object = print.objects()[object_idx];
+            auto it_brim = brimAreaMap.find(object->id());
+            auto it_support_brim = supportBrimAreaMap.find(object->id());
+            if (it_brim == brimAreaMap.end() && it_support_brim == supportBrimAreaMap.end())
+                continue;
+
+            ExPolygons extruder_no_brim_area = no_brim_area;
+            auto iter = std::find_if(objPrintVec.begin(), objPrintVec.end(), [object](const std::pair<ObjectID, unsigned int>& item) {
+                return item.first == object->id();
+            });
+
+            if (iter != objPrintVec.end()) {
+                int extruder_id = filament_map[iter->second - 1] - 1;
+                auto bedPoly = extruder_unprintable_area[extruder_id];
+                auto bedExPoly   = diff_ex((offset(bedPoly, scale_(30.), jtRound, SCALED_RESOLUTION)), {bedPoly});
+                if (!bedExPoly.empty()) {
+                    extruder_no_brim_area.push_back(bedExPoly.front());
+                }
+                //extruder_no_brim_area = offset2_ex(extruder_no_brim_area, scaled_flow_width, -scaled_flow_width); // connect scattered small areas to prevent generating very small brims
 
-        if (iter != objPrintVec.end()) {
-            int extruder_id = filament_map[iter->second - 1] - 1;
-            auto bedPoly = extruder_unprintable_area[extruder_id];
-            auto bedExPoly   = diff_ex((offset(bedPoly, scale_(30.), jtRound, SCALED_RESOLUTION)), {bedPoly});
-            if (!bedExPoly.empty()) {
-                extruder_no_brim_area.push_back(bedExPoly.front());
             }
-            //extruder_no_brim_area = offset2_ex(extruder_no_brim_area, scaled_flow_width, -scaled_flow_width); // connect scattered small areas to prevent generating very small brims
 
-        }
+            if (it_brim != brimAreaMap.end())
+                it_brim->second = diff_ex(it_brim->second, extruder_no_brim_area);
 
-        if (brimAreaMap.find(object->id()) != brimAreaMap.end()) {
-            brimAreaMap[object->id()] = diff_ex(brimAreaMap[object->id()], extruder_no_brim_area);
+            if (it_support_brim != supportBrimAreaMap.end())
+                it_support_brim->second = diff_ex(it_support_brim->second, extruder_no_brim_area);
         }
-
-        if (supportBrimAreaMap.find(object->id()) != supportBrimAreaMap.end())
-            supportBrimAreaMap[object->id()] = diff_ex(supportBrimAreaMap[object->id()], extruder_no_brim_area);
-    }
+    });
 
     brim_area.clear();
     for (const PrintObject* object : print.objects()) {
@@ -1764,16 +1900,22 @@ void make_brim(const Print& print, PrintTryCancel try_cancel, Polygons& islands_
     for (size_t iia = 0; iia < islands_area.size(); ++iia)
         islands_area[iia].translate(plate_shift);
 
-    for (auto iter = brimAreaMap.begin(); iter != brimAreaMap.end(); ++iter) {
-        if (!iter->second.empty()) {
-            brimMap.insert(std::make_pair(iter->first, makeBrimInfill(iter->second, print, islands_area)));
-        };
-    }
-    for (auto iter = supportBrimAreaMap.begin(); iter != supportBrimAreaMap.end(); ++iter) {
-        if (!iter->second.empty()) {
-            supportBrimMap.insert(std::make_pair(iter->first, makeBrimInfill(iter->second, print, islands_area)));
-        };
-    }
+    // Fill the brim areas of the objects in parallel.
+    auto make_brim_infills = [&print, &islands_area](const std::map<ObjectID, ExPolygons>& areaMap, std::map<ObjectID, ExtrusionEntityCollection>& infillMap) {
+        std::vector<std::pair<ObjectID, const ExPolygons*>> areas;
+        for (auto iter = areaMap.begin(); iter != areaMap.end(); ++iter)
+            if (!iter->second.empty())
+                areas.emplace_back(iter->first, &iter->second);
+        std::vector<ExtrusionEntityCollection> infills(areas.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, areas.size()), [&print, &islands_area, &areas, &infills](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                infills[i] = makeBrimInfill(*areas[i].second, print, islands_area);
+        });
+        for (size_t i = 0; i < areas.size(); ++ i)
+            infillMap.insert(std::make_pair(areas[i].first, std::move(infills[i])));
+    };
+    make_brim_infills(brimAreaMap, brimMap);
+    make_brim_infills(supportBrimAreaMap, supportBrimMap);
 
     size_t          num_loops = size_t(floor(brim_width_max / flow.spacing()));
     BOOST_LOG_TRIVIAL(debug) << "brim_width_max, num_loops: " << brim_width_max << ", " << num_loops;
@@ -1,9 +1,12 @@
 #ifndef slic3r_Brim_hpp_
 #define slic3r_Brim_hpp_
 
+#include "ExPolygon.hpp"
 #include "Point.hpp"
 
+#include<cstdint>
 #include<map>
+#include<memory>
 #include<vector>
 
 namespace Slic3r {
@@ -12,6 +15,50 @@ class Print;
 class ExtrusionEntityCollection;
 class PrintTryCancel;
 class ObjectID;
+class TriangleMesh;
+
+// Brim areas of a single PrintObject in the object coordinates, before being translated to the instances
+// and clipped by the other objects. Produced by make_brim() and cached on the PrintObject.
+struct PrintObjectBrimAreas
+{
+    // Everything the areas depend on but the positions of the instances.
+    struct Inputs
+    {
+        // Brim settings of the object.
+        std::vector<double>     options;
+        // Matrix of the first instance without its offset and its z offset, followed by the matrices of the volumes.
+        std::vector<double>     trafos;
+        // Positions and radii of the painted brim ears.
+        std::vector<float>      brim_points;
+        // Volumes of the object, their meshes are compared by identity.
+        std::vector<size_t>     volume_ids;
+        std::vector<std::weak_ptr<const TriangleMesh>> volume_meshes;
+        // First layer of the object, grouped by volumes.
+        std::vector<std::vector<size_t>> group_volume_ids;
+        std::vector<ExPolygons> group_slices;
+        ExPolygons              lslices;
+        // First layer of the support.
+        int                     support_type { -1 };
+        ExPolygons              support_lslices;
+        Points                  support_points;
+
+        bool operator==(const Inputs &rhs) const;
+        bool operator!=(const Inputs &rhs) const { return ! (*this == rhs); }
+    };
+
+    // Hash of the inputs, a different hash rejects the cached areas without comparing the inputs.
+    uint64_t   key { 0 };
+    Inputs     inputs;
+
+    ExPolygons brim_area;
+    ExPolygons no_brim_area;
+    Polygons   holes;
+    ExPolygons island;
+
+    ExPolygons support_brim_area;
+    ExPolygons support_no_brim_area;
+    Polygons   support_holes;
+};
 
 // Produce brim lines around those objects, that have the brim enabled.
 // Collect islands_area to be merged into the final 1st layer convex hull.
@@ -1,9 +1,19 @@
 #ifndef PERFORMCSGMESHBOOLEANS_HPP
 #define PERFORMCSGMESHBOOLEANS_HPP
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <stack>
+#include <string_view>
 #include <vector>
 
+#include <boost/log/trivial.hpp>
+#include <tbb/parallel_invoke.h>
+
 #include "CSGMesh.hpp"
 
 #include "libslic3r/Execution/ExecutionTBB.hpp"
@@ -68,6 +78,7 @@ MeshBoolean::mcut::McutMeshPtr get_mcutmesh(const CSGPartT& csgpart)
 
 namespace detail_cgal {
 
+using MeshBoolean::cgal::CGALMesh;
 using MeshBoolean::cgal::CGALMeshPtr;
 
 inline void perform_csg(CSGType op, CGALMeshPtr &dst, CGALMeshPtr &src)
@@ -93,23 +104,373 @@ inline void perform_csg(CSGType op, CGALMeshPtr &dst, CGALMeshPtr &src)
     }
 }
 
-template<class Ex, class It>
-std::vector<CGALMeshPtr> get_cgalptrs(Ex policy, const Range<It> &csgrange)
+// Identity of a boolean operand: digest of a transformed part mesh, or of an operation and the identities of its
+// operands for an intermediate result. Two independent 64 bit digests make a collision practically impossible.
+struct CSGKey
 {
-    std::vector<CGALMeshPtr> ret(csgrange.size());
-    execution::for_each(policy, size_t(0), csgrange.size(),
-                        [&csgrange, &ret](size_t i) {
-        auto it = csgrange.begin();
-        std::advance(it, i);
-        auto &csgpart = *it;
-        ret[i]        = get_cgalmesh(csgpart);
-    });
+    uint64_t h1 = 0xcbf29ce484222325ull;
+    uint64_t h2 = 0x84222325cbf29ce4ull;
+
+    // Both digests are computed in a single pass over the data, a 64 bit word at a time.
+    void append(const void *data, size_t size)
+    {
+        const char *bytes = static_cast<const char *>(data);
+        size_t      i     = 0;
+        for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, bytes + i, sizeof(uint64_t));
+            mix(word);
+        }
+        if (i < size) {
+            uint64_t word = 0;
+            std::memcpy(&word, bytes + i, size - i);
+            mix(word ^ (uint64_t(size - i) << 56));
+        }
+    }
+    template<class T> void append(const T &value) { append(&value, sizeof(T)); }
+
+    bool operator==(const CSGKey &rhs) const { return h1 == rhs.h1 && h2 == rhs.h2; }
+
+private:
+    void mix(uint64_t word)
+    {
+        // FNV-1a over words and a multiply-rotate hash.
+        h1 = (h1 ^ word) * 0x100000001b3ull;
+        h2 ^= word * 0x9e3779b97f4a7c15ull;
+        h2 = ((h2 << 27) | (h2 >> 37)) * 0xff51afd7ed558ccdull + 0x2545f4914f6cdd1dull;
+    }
+};
+
+inline CSGKey csg_part_key(const indexed_triangle_set &its, const Transform3f &trafo)
+{
+    CSGKey key;
+    key.append(its.vertices.size());
+    key.append(its.vertices.data(), its.vertices.size() * sizeof(stl_vertex));
+    key.append(its.indices.size());
+    key.append(its.indices.data(), its.indices.size() * sizeof(stl_triangle_vertex_indices));
+    key.append(trafo.matrix().data(), trafo.matrix().size() * sizeof(float));
+    return key;
+}
+
+inline CSGKey csg_operation_key(CSGType op, const CSGKey &lhs, const CSGKey &rhs)
+{
+    CSGKey key;
+    key.append(op);
+    key.append(lhs);
+    key.append(rhs);
+    return key;
+}
+
+// Converted part meshes and results of boolean operations of a single job, e.g. the export of a model object, passed
+// to check_csgmesh_booleans() and to perform_csgmesh_booleans(). The parts are converted once, and an operation
+// repeated in the CSG collection is computed once. The part meshes must not change while the cache is in use.
+class CGALMeshCache
+{
+public:
+    explicit CGALMeshCache(size_t max_bytes = 128 * 1024 * 1024) : m_max_bytes(max_bytes) {}
+
+    // Digest of a part, computed once for a mesh and transformation.
+    CSGKey part_key(const indexed_triangle_set &its, const Transform3f &trafo)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = std::find_if(m_part_keys.begin(), m_part_keys.end(), [&its, &trafo](const PartKey &part) {
+                return part.its == &its && part.trafo == trafo.matrix();
+            });
+            if (it != m_part_keys.end())
+                return it->key;
+        }
+        CSGKey key = csg_part_key(its, trafo);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_part_keys.push_back({&its, trafo.matrix(), key});
+        return key;
+    }
+
+    // Copy of the cached mesh, nullptr if the key is not cached.
+    CGALMeshPtr find(const CSGKey &key)
+    {
+        std::shared_ptr<const CGALMesh> mesh;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = std::find_if(m_entries.begin(), m_entries.end(), [&key](const Entry &entry) { return entry.key == key; });
+            if (it == m_entries.end())
+                return {};
+            m_entries.splice(m_entries.begin(), m_entries, it);
+            mesh = it->mesh;
+        }
+        return MeshBoolean::cgal::clone(*mesh);
+    }
+
+    void store(const CSGKey &key, const CGALMesh &mesh)
+    {
+        const size_t bytes = MeshBoolean::cgal::memory_size(mesh);
+        if (bytes > m_max_bytes)
+            return;
+        std::shared_ptr<const CGALMesh> copy(MeshBoolean::cgal::clone(mesh).release(), MeshBoolean::cgal::CGALMeshDeleter{});
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (std::any_of(m_entries.begin(), m_entries.end(), [&key](const Entry &entry) { return entry.key == key; }))
+            return;
+        m_entries.push_front({key, bytes, std::move(copy)});
+        m_bytes += bytes;
+        while (m_bytes > m_max_bytes) {
+            m_bytes -= m_entries.back().bytes;
+            m_entries.pop_back();
+        }
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+        m_part_keys.clear();
+        m_bytes = 0;
+    }
+
+    size_t size() const { std::lock_guard<std::mutex> lock(m_mutex); return m_entries.size(); }
+    // Estimated memory held by the cached meshes.
+    size_t bytes() const { std::lock_guard<std::mutex> lock(m_mutex); return m_bytes; }
+
+private:
+    struct Entry
+    {
+        CSGKey                          key;
+        size_t                          bytes;
+        std::shared_ptr<const CGALMesh> mesh;
+    };
+
+    struct PartKey
+    {
+        const indexed_triangle_set *its;
+        Matrix4f                    trafo;
+        CSGKey                      key;
+    };
+
+    const size_t          m_max_bytes;
+    mutable std::mutex    m_mutex;
+    std::list<Entry>      m_entries; // most recently used first
+    std::vector<PartKey>  m_part_keys;
+    size_t                m_bytes = 0;
+};
+
+// Without a cache the part is just converted.
+template<class CSGPartT>
+CGALMeshPtr get_cgalmesh_cached(const CSGPartT &csgpart, const CSGKey &key, CGALMeshCache *cache)
+{
+    if (!cache)
+        return get_cgalmesh(csgpart);
+
+    if (CGALMeshPtr ret = cache->find(key))
+        return ret;
+
+    CGALMeshPtr ret = get_cgalmesh(csgpart);
+    if (ret)
+        cache->store(key, *ret);
 
     return ret;
 }
 
+template<class CSGPartT>
+CGALMeshPtr get_cgalmesh_cached(const CSGPartT &csgpart, CGALMeshCache *cache)
+{
+    const indexed_triangle_set *its = get_mesh(csgpart);
+    return its && cache ? get_cgalmesh_cached(csgpart, cache->part_key(*its, get_transform(csgpart)), cache) : get_cgalmesh(csgpart);
+}
+
+// Binary expression tree of a CSG part collection. A run of consecutive parts with the same operation is
+// reduced by a balanced tree: A - B - C - D is evaluated as A - ((B + C) + D) with B + C and the other
+// independent branches computed in parallel. The parts are converted ahead: a part without a mesh (the stack
+// push and pop parts) or failing to convert is skipped as perform_csg() skips a missing operand, and empty meshes
+// are folded away. With a cache, each node is looked up in the cache before being computed.
+template<class It>
+class CSGTree
+{
+public:
+    explicit CSGTree(const Range<It> &csgrange, CGALMeshCache *cache = nullptr) : m_cache(cache)
+    {
+        for (auto it = csgrange.begin(); it != csgrange.end(); ++it)
+            m_parts.emplace_back(it);
+
+        m_meshes.resize(m_parts.size());
+        m_keys.resize(m_parts.size());
+        execution::for_each(ex_tbb, size_t(0), m_parts.size(), [this](size_t i) {
+            const auto                 &csgpart = *m_parts[i];
+            const indexed_triangle_set *its     = get_mesh(csgpart);
+            if (its && !its->indices.empty()) {
+                if (m_cache)
+                    m_keys[i] = m_cache->part_key(*its, get_transform(csgpart));
+                m_meshes[i] = get_cgalmesh_cached(csgpart, m_keys[i], m_cache);
+            }
+        });
+
+        struct Frame
+        {
+            CSGType          op;
+            int              acc = EmptyMesh;
+            CSGType          run_op = CSGType::Union;
+            std::vector<int> run;
+        };
+
+        std::stack opstack{std::vector<Frame>{}};
+        opstack.push(Frame{CSGType::Union});
+
+        for (size_t part_idx = 0; part_idx < m_parts.size(); ++part_idx) {
+            const auto &csgpart = *m_parts[part_idx];
+
+            if (get_stack_operation(csgpart) == CSGStackOp::Push)
+                opstack.push(Frame{get_operation(csgpart)});
+
+            add_operand(opstack.top(), get_operation(csgpart), make_leaf(part_idx));
+
+            if (get_stack_operation(csgpart) == CSGStackOp::Pop && opstack.size() > 1) {
+                Frame frame = std::move(opstack.top());
+                opstack.pop();
+                flush(frame);
+                add_operand(opstack.top(), frame.op, frame.acc);
+            }
+        }
+
+        while (opstack.size() > 1) {
+            // Unbalanced push, close the sub-expression.
+            Frame frame = std::move(opstack.top());
+            opstack.pop();
+            flush(frame);
+            add_operand(opstack.top(), frame.op, frame.acc);
+        }
+        flush(opstack.top());
+        m_root = opstack.top().acc;
+    }
+
+    // nullptr if the result is empty.
+    CGALMeshPtr evaluate() { return m_root < 0 ? CGALMeshPtr{} : evaluate(m_root); }
+
+private:
+    // Operands which are not nodes.
+    static constexpr int EmptyMesh = -1;
+    static constexpr int NoMesh    = -2;
+
+    struct Node
+    {
+        CSGType op   = CSGType::Union;
+        // Operands of an operation, -1 for a leaf.
+        int     lhs  = -1;
+        int     rhs  = -1;
+        // Part of a leaf.
+        size_t  part = 0;
+        CSGKey  key;
+    };
+
+    int make_leaf(size_t part_idx)
+    {
+        const indexed_triangle_set *its = get_mesh(*m_parts[part_idx]);
+        if (!its)
+            return NoMesh;
+        if (its->indices.empty())
+            return EmptyMesh;
+        if (!m_meshes[part_idx])
+            return NoMesh;
+
+        Node node;
+        node.part = part_idx;
+        node.key  = m_keys[part_idx];
+        m_nodes.emplace_back(node);
+        return int(m_nodes.size()) - 1;
+    }
+
+    int make_operation(CSGType op, int lhs, int rhs)
+    {
+        // A missing operand leaves the other one unchanged, whatever the operation.
+        if (rhs == NoMesh || lhs == NoMesh)
+            return rhs == NoMesh ? lhs : rhs;
+
+        switch (op) {
+        case CSGType::Union:
+            if (lhs < 0 || rhs < 0)
+                return lhs < 0 ? rhs : lhs;
+            break;
+        case CSGType::Difference:
+            if (lhs < 0 || rhs < 0)
+                return lhs;
+            break;
+        case CSGType::Intersection:
+            if (lhs < 0 || rhs < 0)
+                return EmptyMesh;
+            break;
+        }
+
+        Node node;
+        node.op  = op;
+        node.lhs = lhs;
+        node.rhs = rhs;
+        if (m_cache)
+            node.key = csg_operation_key(op, m_nodes[lhs].key, m_nodes[rhs].key);
+        m_nodes.emplace_back(node);
+        return int(m_nodes.size()) - 1;
+    }
+
+    template<class Frame> void add_operand(Frame &frame, CSGType op, int operand)
+    {
+        if (!frame.run.empty() && frame.run_op != op)
+            flush(frame);
+        frame.run_op = op;
+        frame.run.emplace_back(operand);
+    }
+
+    // Apply the run of operands with the same operation to the result of the frame.
+    template<class Frame> void flush(Frame &frame)
+    {
+        if (frame.run.empty())
+            return;
+
+        // (A - B) - C == A - (B + C), (A * B) * C == A * (B * C)
+        const CSGType    reduce_op = frame.run_op == CSGType::Intersection ? CSGType::Intersection : CSGType::Union;
+        std::vector<int> level     = std::move(frame.run);
+        while (level.size() > 1) {
+            std::vector<int> next;
+            next.reserve((level.size() + 1) / 2);
+            for (size_t i = 0; i + 1 < level.size(); i += 2)
+                next.emplace_back(make_operation(reduce_op, level[i], level[i + 1]));
+            if (level.size() % 2 == 1)
+                next.emplace_back(level.back());
+            level = std::move(next);
+        }
+        frame.acc = make_operation(frame.run_op, frame.acc, level.front());
+        frame.run.clear();
+    }
+
+    CGALMeshPtr evaluate(int node_idx)
+    {
+        const Node &node = m_nodes[node_idx];
+        if (node.lhs < 0)
+            return std::move(m_meshes[node.part]);
+
+        CGALMeshPtr ret = m_cache ? m_cache->find(node.key) : CGALMeshPtr{};
+        if (ret)
+            return ret;
+
+        CGALMeshPtr rhs;
+        tbb::parallel_invoke([this, &node, &ret] { ret = evaluate(node.lhs); },
+                             [this, &node, &rhs] { rhs = evaluate(node.rhs); });
+        perform_csg(node.op, ret, rhs);
+        if (ret && m_cache)
+            m_cache->store(node.key, *ret);
+
+        return ret;
+    }
+
+    CGALMeshCache           *m_cache;
+    std::vector<It>          m_parts;
+    // Converted parts, moved to the leaves when evaluated.
+    std::vector<CGALMeshPtr> m_meshes;
+    std::vector<CSGKey>      m_keys;
+    std::vector<Node>        m_nodes;
+    int                      m_root = EmptyMesh;
+};
+
 } // namespace detail
 
+using detail_cgal::CGALMeshCache;
+
 namespace detail_mcut {
 
     using MeshBoolean::mcut::McutMeshPtr;
@@ -157,51 +518,12 @@ namespace detail_mcut {
 // Process the sequence of CSG parts with CGAL.
 template<class It>
 void perform_csgmesh_booleans_cgal(MeshBoolean::cgal::CGALMeshPtr &cgalm,
-                              const Range<It>                &csgrange)
+                              const Range<It>                &csgrange,
+                              CGALMeshCache                  *cache = nullptr)
 {
-    using MeshBoolean::cgal::CGALMesh;
-    using MeshBoolean::cgal::CGALMeshPtr;
-    using namespace detail_cgal;
-
-    struct Frame {
-        CSGType op; CGALMeshPtr cgalptr;
-        explicit Frame(CSGType csgop = CSGType::Union)
-            : op{ csgop }
-            , cgalptr{ MeshBoolean::cgal::triangle_mesh_to_cgal(indexed_triangle_set{}) }
-        {}
-    };
-
-    std::stack opstack{ std::vector<Frame>{} };
-
-    opstack.push(Frame{});
-
-    std::vector<CGALMeshPtr> cgalmeshes = get_cgalptrs(ex_tbb, csgrange);
-
-    size_t csgidx = 0;
-    for (auto& csgpart : csgrange) {
-
-        auto op = get_operation(csgpart);
-        CGALMeshPtr& cgalptr = cgalmeshes[csgidx++];
-
-        if (get_stack_operation(csgpart) == CSGStackOp::Push) {
-            opstack.push(Frame{ op });
-            op = CSGType::Union;
-        }
-
-        Frame* top = &opstack.top();
-
-        perform_csg(get_operation(csgpart), top->cgalptr, cgalptr);
-
-        if (get_stack_operation(csgpart) == CSGStackOp::Pop) {
-            CGALMeshPtr src = std::move(top->cgalptr);
-            auto popop = opstack.top().op;
-            opstack.pop();
-            CGALMeshPtr& dst = opstack.top().cgalptr;
-            perform_csg(popop, dst, src);
-        }
-    }
-
-    cgalm = std::move(opstack.top().cgalptr);
+    cgalm = detail_cgal::CSGTree<It>{csgrange, cache}.evaluate();
+    if (!cgalm)
+        cgalm = MeshBoolean::cgal::triangle_mesh_to_cgal(indexed_triangle_set{});
 }
 
 // Process the sequence of CSG parts with mcut.
@@ -256,19 +578,20 @@ void perform_csgmesh_booleans_mcut(MeshBoolean::mcut::McutMeshPtr& mcutm,
 }
 
 
+// The parts converted for the check are stored into the cache, if provided, for perform_csgmesh_booleans().
 template<class It, class Visitor>
-std::tuple<BooleanFailReason,std::string, It> check_csgmesh_booleans(const Range<It> &csgrange, Visitor &&vfn)
+std::tuple<BooleanFailReason,std::string, It> check_csgmesh_booleans(const Range<It> &csgrange, Visitor &&vfn, CGALMeshCache *cache = nullptr)
 {
     using namespace detail_cgal;
     BooleanFailReason fail_reason = BooleanFailReason::OK;
     std::string fail_part_name;
     std::vector<CGALMeshPtr> cgalmeshes(csgrange.size());
-    auto check_part = [&csgrange, &cgalmeshes,&fail_reason,&fail_part_name](size_t i)
+    auto check_part = [&csgrange, &cgalmeshes,&fail_reason,&fail_part_name, cache](size_t i)
     {
         auto it = csgrange.begin();
         std::advance(it, i);
         auto &csgpart = *it;
-        auto m = get_cgalmesh(csgpart);
+        auto m = get_cgalmesh_cached(csgpart, cache);
 
         // mesh can be nullptr if this is a stack push or pull
         if (!get_mesh(csgpart) && get_stack_operation(csgpart) != CSGStackOp::Continue) {
@@ -320,10 +643,10 @@ std::tuple<BooleanFailReason,std::string, It> check_csgmesh_booleans(const Range
 }
 
 template<class It>
-std::tuple<BooleanFailReason, std::string, It> check_csgmesh_booleans(const Range<It> &csgrange, bool use_mcut=false)
+std::tuple<BooleanFailReason, std::string, It> check_csgmesh_booleans(const Range<It> &csgrange, bool use_mcut=false, CGALMeshCache *cache = nullptr)
 {
     if(!use_mcut)
-        return check_csgmesh_booleans(csgrange, [](auto &) {});
+        return check_csgmesh_booleans(csgrange, [](auto &) {}, cache);
     else {
         using namespace detail_mcut;
         BooleanFailReason fail_reason = BooleanFailReason::OK;
@@ -359,11 +682,11 @@ std::tuple<BooleanFailReason, std::string, It> check_csgmesh_booleans(const Rang
 }
 
 template<class It>
-MeshBoolean::cgal::CGALMeshPtr perform_csgmesh_booleans(const Range<It> &csgparts)
+MeshBoolean::cgal::CGALMeshPtr perform_csgmesh_booleans(const Range<It> &csgparts, CGALMeshCache *cache = nullptr)
 {
     auto ret = MeshBoolean::cgal::triangle_mesh_to_cgal(indexed_triangle_set{});
     if (ret)
-        perform_csgmesh_booleans_cgal(ret, csgparts);
+        perform_csgmesh_booleans_cgal(ret, csgparts, cache);
     return ret;
 }
 
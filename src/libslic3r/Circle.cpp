@@ -2,6 +2,7 @@
 
 #include <cmath>
 #include <cassert>
+#include <algorithm>
 #include "Geometry.hpp"
 
 
@@ -12,6 +13,67 @@ namespace Slic3r {
 //BBS: threshold used to judge collineation
 static const double Parallel_area_threshold = 0.0001;
 
+// Number of the points tested against a circle at once. The deviations of a block are calculated without branches,
+// so that the loop is vectorized, and the tolerance is tested once per block.
+static constexpr const size_t Deviation_block_size = 8;
+
+// Margin of the bounds of the distance of the foot of a perpendicular from the center of a circle in scaled coordinates,
+// covering rounding of the foot to integer coordinates and of the squared distances.
+static constexpr const double Perpendicular_bound_margin = 4.;
+
+// Deviations of count <= Deviation_block_size points from the circle, returns true if any of them is over the tolerance.
+static inline bool block_over_deviation(const Point *points, size_t count, const Point &center, double radius, double tolerance, double *deviations)
+{
+    assert(count <= Deviation_block_size);
+    bool over = false;
+    for (size_t i = 0; i < count; ++ i) {
+        const Point temp = points[i] - center;
+        deviations[i] = std::fabs(sqrt((double)temp.x() * (double)temp.x() + (double)temp.y() * (double)temp.y()) - radius);
+        over |= deviations[i] > tolerance;
+    }
+    return over;
+}
+
+// Circle::get_deviation_sum_squared() returning the index of the first point over the tolerance,
+// or 0 if the points are within the tolerance or if a segment between them is over the tolerance.
+static bool deviation_sum_squared(const Circle &circle, const Points &points, const double tolerance, double &total_deviation, size_t &over_deviation_index)
+{
+    total_deviation      = 0;
+    over_deviation_index = 0;
+    // BBS: skip the first and last points since they are on the circle
+    double deviations[Deviation_block_size];
+    for (size_t begin = 1; begin + 1 < points.size(); begin += Deviation_block_size) {
+        const size_t count = std::min(Deviation_block_size, points.size() - 1 - begin);
+        if (block_over_deviation(points.data() + begin, count, circle.center, circle.radius, tolerance, deviations)) {
+            for (size_t i = 0; i < count; ++ i)
+                if (deviations[i] > tolerance) {
+                    over_deviation_index = begin + i;
+                    break;
+                }
+            return false;
+        }
+        // Summed in the order of the points, so that the sum does not depend on the blocks.
+        for (size_t i = 0; i < count; ++ i)
+            total_deviation += deviations[i] * deviations[i];
+    }
+    Point temp;
+    Point closest_point;
+    double distance_from_center, deviation;
+    //BBS: check the point perpendicular from the segment to the circle's center
+    for (size_t index = 0; index + 1 < points.size(); index++)
+    {
+        if (Circle::get_closest_perpendicular_point(points[index], points[index + 1], circle.center, closest_point)) {
+            temp = closest_point - circle.center;
+            distance_from_center = sqrt((double)temp.x() * (double)temp.x() + (double)temp.y() * (double)temp.y());
+            deviation = std::fabs(distance_from_center - circle.radius);
+            total_deviation += deviation * deviation;
+            if (deviation > tolerance)
+                return false;
+        }
+    }
+    return true;
+}
+
 bool Circle::try_create_circle(const Point& p1, const Point& p2, const Point& p3, const double max_radius, Circle& new_circle)
 {
     double x1 = p1.x();
@@ -75,13 +137,23 @@ bool Circle::try_create_circle(const Points& points, const double max_radius, co
     double least_deviation;
     bool found_circle = false;
     double current_deviation;
+    // Index of the point over the tolerance of the last rejected circle. The circles through the neighbouring points
+    // mostly fail at the same point, thus testing it first rejects them without testing the whole window.
+    size_t over_deviation_index = 0;
+    double witness_deviation[1];
     for (int index = 1; index < count - 1; index++)
     {
         if (index == middle_index)
             // BBS: We already checked this one, and it failed. don't need to do again
             continue;
 
-        if (Circle::try_create_circle(points[0], points[index], points[count - 1], max_radius, test_circle) && test_circle.get_deviation_sum_squared(points, tolerance, current_deviation))
+        if (!Circle::try_create_circle(points[0], points[index], points[count - 1], max_radius, test_circle))
+            continue;
+        if (over_deviation_index != 0 &&
+            block_over_deviation(points.data() + over_deviation_index, 1, test_circle.center, test_circle.radius, tolerance, witness_deviation))
+            continue;
+        size_t test_over_deviation_index;
+        if (deviation_sum_squared(test_circle, points, tolerance, current_deviation, test_over_deviation_index))
         {
             if (!found_circle || current_deviation < least_deviation)
             {
@@ -89,7 +161,8 @@ bool Circle::try_create_circle(const Points& points, const double max_radius, co
                 least_deviation = current_deviation;
                 new_circle = test_circle;
             }
-        }
+        } else if (test_over_deviation_index != 0)
+            over_deviation_index = test_over_deviation_index;
     }
     return found_circle;
 }
@@ -104,23 +177,35 @@ double Circle::get_polar_radians(const Point& p1) const
 
 bool Circle::is_over_deviation(const Points& points, const double tolerance)
 {
+    // BBS: skip the first and last points since they has fit perfectly.
+    double deviations[Deviation_block_size];
+    for (size_t begin = 1; begin + 1 < points.size(); begin += Deviation_block_size)
+        if (block_over_deviation(points.data() + begin, std::min(Deviation_block_size, points.size() - 1 - begin), center, radius, tolerance, deviations))
+            return true;
+
+    // The foot of the perpendicular from the center to a segment is not farther from the center than the end points
+    // of the segment and not closer than sqrt(d^2 - l^2), d being the distance of the farther end point and l the length of the segment.
+    // If both bounds are within the tolerance, the foot is not calculated. The margin covers rounding of the foot to integers.
+    const double inner = radius - tolerance + Perpendicular_bound_margin;
+    const double outer = radius + tolerance - Perpendicular_bound_margin;
+    auto         distance_sqr = [this](const Point &pt) {
+        const Point temp = pt - center;
+        return (double)temp.x() * (double)temp.x() + (double)temp.y() * (double)temp.y();
+    };
+    double next_distance_sqr = distance_sqr(points.front());
+
     Point closest_point;
     Point temp;
     double distance_from_center;
-    // BBS: skip the first and last points since they has fit perfectly.
-    for (size_t index = 0; index < points.size() - 1; index++)
+    //BBS: Check the point perpendicular from the segment to the circle's center
+    for (size_t index = 0; index + 1 < points.size(); index++)
     {
-        if (index != 0)
-        {
-            //BBS: check fitting tolerance
-            temp = points[index] - center;
-            distance_from_center = sqrt((double)temp.x() * (double)temp.x() + (double)temp.y() * (double)temp.y());
-            if (std::fabs(distance_from_center - radius) > tolerance)
-                return true;
-        }
-
-        //BBS: Check the point perpendicular from the segment to the circle's center
-        if (get_closest_perpendicular_point(points[index], points[(size_t)index + 1], center, closest_point)) {
+        const double distance_sqr_a = next_distance_sqr;
+        const double distance_sqr_b = next_distance_sqr = distance_sqr(points[index + 1]);
+        if (outer > 0 && std::min(distance_sqr_a, distance_sqr_b) <= outer * outer &&
+            (inner <= 0 || std::max(distance_sqr_a, distance_sqr_b) - (points[index + 1] - points[index]).cast<double>().squaredNorm() >= inner * inner))
+            continue;
+        if (get_closest_perpendicular_point(points[index], points[index + 1], center, closest_point)) {
             temp = closest_point - center;
             distance_from_center = sqrt((double)temp.x() * (double)temp.x() + (double)temp.y() * (double)temp.y());
             if (std::fabs(distance_from_center - radius) > tolerance)
@@ -154,36 +239,8 @@ bool Circle::get_closest_perpendicular_point(const Point& p1, const Point& p2, c
 
 bool Circle::get_deviation_sum_squared(const Points& points, const double tolerance, double& total_deviation)
 {
-    total_deviation = 0;
-    Point temp;
-    double distance_from_center,  deviation;
-    // BBS: skip the first and last points since they are on the circle
-    for (int index = 1; index < points.size() - 1; index++)
-    {
-        //BBS: make sure the length from the center of our circle to the test point is 
-        // at or below our max distance.
-        temp = points[index] - center;
-        distance_from_center = sqrt((double)temp.x() * (double)temp.x() + (double)temp.y() * (double)temp.y());
-        deviation = std::fabs(distance_from_center - radius);
-        total_deviation += deviation * deviation;
-        if (deviation > tolerance)
-            return false;
-
-    }
-    Point closest_point;
-    //BBS: check the point perpendicular from the segment to the circle's center
-    for (int index = 0; index < points.size() - 1; index++)
-    {
-        if (get_closest_perpendicular_point(points[index], points[(size_t)index + 1], center, closest_point)) {
-            temp = closest_point - center;
-            distance_from_center = sqrt((double)temp.x() * (double)temp.x() + (double)temp.y() * (double)temp.y());
-            deviation = std::fabs(distance_from_center - radius);
-            total_deviation += deviation * deviation;
-            if (deviation > tolerance)
-                return false;
-        }
-    }
-    return true;
+    size_t over_deviation_index;
+    return deviation_sum_squared(*this, points, tolerance, total_deviation, over_deviation_index);
 }
 
 //BBS: only support calculate on X-Y plane, Z is useless
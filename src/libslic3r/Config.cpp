@@ -3,6 +3,7 @@
 #include "Utils.hpp"
 #include "LocalesUtils.hpp"
 #include "Preset.hpp"
+#include "GCode/BinaryGCode.hpp"
 
 #include <assert.h>
 #include <fstream>
@@ -1325,9 +1326,47 @@ private:
     pos_type                 m_file_pos   = 0;
 };
 
+// Load the config keys from the print metadata of a binary G-code file, which holds the config block of the G-code.
+static size_t load_from_binary_gcode_file(ConfigBase &config, const std::string &file, ConfigSubstitutionContext &substitutions)
+{
+    BinaryGCode::Reader reader(file);
+
+    const BinaryGCode::Metadata &file_metadata = reader.file_metadata();
+    auto it_generated_by = std::find_if(file_metadata.begin(), file_metadata.end(), [](const auto &kvp) { return kvp.first == "generated by"; });
+    if (it_generated_by == file_metadata.end() || ! boost::starts_with(it_generated_by->second, SLIC3R_APP_NAME)) {
+        std::string error_message = "Not a gcode file generated by ";
+        error_message += SLIC3R_APP_FULL_NAME;
+        error_message += ".";
+        BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << error_message;
+        throw Slic3r::RuntimeError(error_message.c_str());
+    }
+
+    size_t key_value_pairs = 0;
+    for (const auto &[key, value] : reader.print_metadata()) {
+        try {
+            config.set_deserialize(key, value, substitutions);
+            ++ key_value_pairs;
+        } catch (UnknownOptionException & /* e */) {
+            // ignore
+        }
+    }
+    return key_value_pairs;
+}
+
 // Load the config keys from the tail of a G-code file.
 ConfigSubstitutions ConfigBase::load_from_gcode_file(const std::string &file, ForwardCompatibilitySubstitutionRule compatibility_rule)
 {
+    if (BinaryGCode::is_binary_gcode_file(file)) {
+        ConfigSubstitutionContext substitutions_ctxt(compatibility_rule);
+        const size_t              key_value_pairs = load_from_binary_gcode_file(*this, file, substitutions_ctxt);
+        if (key_value_pairs < 80) {
+            BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << format("Suspiciously low number of configuration values extracted from %1%: %2%", file, key_value_pairs);
+            throw Slic3r::RuntimeError(format("Suspiciously low number of configuration values extracted from %1%: %2%", file, key_value_pairs));
+        }
+        this->handle_legacy_composite();
+        return std::move(substitutions_ctxt.substitutions);
+    }
+
     // Read a 64k block from the end of the G-code.
 	boost::nowide::ifstream ifs(file);
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  before parse_file %1%") % file.c_str();
@@ -1511,8 +1550,10 @@ void ConfigBase::null_nullables()
 
 DynamicConfig::DynamicConfig(const ConfigBase& rhs, const t_config_option_keys& keys)
 {
-	for (const t_config_option_key& opt_key : keys)
+	for (const t_config_option_key& opt_key : keys) {
 		this->options[opt_key] = std::unique_ptr<ConfigOption>(rhs.option(opt_key)->clone());
+		this->touch_group(opt_key);
+	}
 }
 
 bool DynamicConfig::operator==(const DynamicConfig &rhs) const
@@ -1534,6 +1575,7 @@ size_t DynamicConfig::remove_nil_options()
 	size_t cnt_removed = 0;
 	for (auto it = options.begin(); it != options.end();)
 		if (it->second->is_nil()) {
+			this->touch_group(it->first);
 			it = options.erase(it);
 			++ cnt_removed;
 		} else
@@ -1544,9 +1586,11 @@ size_t DynamicConfig::remove_nil_options()
 ConfigOption* DynamicConfig::optptr(const t_config_option_key &opt_key, bool create)
 {
     auto it = options.find(opt_key);
-    if (it != options.end())
-        // Option was found.
+    if (it != options.end()) {
+        // Option was found. The caller may modify it.
+        this->touch_group(opt_key);
         return it->second.get();
+    }
     if (! create)
         // Option was not found and a new option shall not be created.
         return nullptr;
@@ -1560,10 +1604,62 @@ ConfigOption* DynamicConfig::optptr(const t_config_option_key &opt_key, bool cre
         // Let the parent decide what to do if the opt_key is not defined by this->def().
         return nullptr;
     ConfigOption *opt = optdef->create_default_option();
+    this->touch_group(opt_key);
     this->options.emplace_hint(it, opt_key, std::unique_ptr<ConfigOption>(opt));
     return opt;
 }
 
+std::pair<DynamicConfig::OptionsMap::const_iterator, DynamicConfig::OptionsMap::const_iterator> DynamicConfig::group_range(std::string_view group) const
+{
+    auto begin = options.lower_bound(std::string(group));
+    if (group.back() != '_')
+        // Single option group.
+        return { begin, begin != options.end() && begin->first == group ? std::next(begin) : begin };
+    // '`' follows '_', thus the first key not starting with the group prefix.
+    std::string after(group);
+    after.back() = '`';
+    return { begin, options.lower_bound(after) };
+}
+
+std::atomic<uint64_t> DynamicConfig::s_last_group_timestamp { 0 };
+
+uint64_t DynamicConfig::group_timestamp(std::string_view group) const
+{
+    auto it = m_group_timestamps.find(group);
+    return it == m_group_timestamps.end() ? 0 : it->second;
+}
+
+void DynamicConfig::touch_group(std::string_view opt_key)
+{
+    const std::string_view group     = option_group(opt_key);
+    const uint64_t         timestamp = ++ s_last_group_timestamp;
+    if (auto it = m_group_timestamps.find(group); it != m_group_timestamps.end())
+        it->second = timestamp;
+    else
+        m_group_timestamps.emplace(std::string(group), timestamp);
+}
+
+void DynamicConfig::apply(const ConfigBase &other, bool ignore_nonexistent)
+{
+    this->apply_only(other, other.keys(), ignore_nonexistent);
+
+    const DynamicConfig *other_dynamic = dynamic_cast<const DynamicConfig*>(&other);
+    if (other_dynamic == nullptr)
+        return;
+    // A group holding exactly the keys of the same group of other holds copies of its options, it takes over its timestamp.
+    for (auto it_other = other_dynamic->options.cbegin(); it_other != other_dynamic->options.cend();) {
+        const std::string_view group     = option_group(it_other->first);
+        const auto             end_other = other_dynamic->group_range(group).second;
+        auto [it, end] = this->group_range(group);
+        bool same_keys = true;
+        for (; same_keys && (it_other != end_other || it != end); ++ it_other, ++ it)
+            same_keys = it_other != end_other && it != end && it->first == it_other->first;
+        if (const uint64_t timestamp = other_dynamic->group_timestamp(group); same_keys && timestamp != 0)
+            m_group_timestamps[std::string(group)] = timestamp;
+        it_other = end_other;
+    }
+}
+
 const ConfigOption* DynamicConfig::optptr(const t_config_option_key &opt_key) const
 {
     auto it = options.find(opt_key);
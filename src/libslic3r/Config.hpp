@@ -8,8 +8,10 @@
 #include <cstdlib>
 #include <functional>
 #include <iostream>
+#include <atomic>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "libslic3r.h"
 #include "clonable_ptr.hpp"
@@ -2746,7 +2748,8 @@ class DynamicConfig : public virtual ConfigBase
 public:
     DynamicConfig() = default;
     DynamicConfig(const DynamicConfig &rhs) { *this = rhs; }
-    DynamicConfig(DynamicConfig &&rhs) noexcept : options(std::move(rhs.options)) { rhs.options.clear(); }
+    DynamicConfig(DynamicConfig &&rhs) noexcept : options(std::move(rhs.options)), m_group_timestamps(std::move(rhs.m_group_timestamps))
+        { rhs.options.clear(); rhs.m_group_timestamps.clear(); }
 	explicit DynamicConfig(const ConfigBase &rhs, const t_config_option_keys &keys);
 	explicit DynamicConfig(const ConfigBase& rhs) : DynamicConfig(rhs, rhs.keys()) {}
 	virtual ~DynamicConfig() override = default;
@@ -2759,6 +2762,8 @@ public:
         this->clear();
         for (const auto &kvp : rhs.options)
             this->options[kvp.first].reset(kvp.second->clone());
+        // The content was copied, thus the timestamps are copied as well.
+        m_group_timestamps = rhs.m_group_timestamps;
         return *this;
     }
 
@@ -2770,6 +2775,8 @@ public:
         this->clear();
         this->options = std::move(rhs.options);
         rhs.options.clear();
+        m_group_timestamps = std::move(rhs.m_group_timestamps);
+        rhs.m_group_timestamps.clear();
         return *this;
     }
 
@@ -2779,6 +2786,7 @@ public:
     {
         assert(this->def() == nullptr || this->def() == rhs.def());
         for (const auto &kvp : rhs.options) {
+            this->touch_group(kvp.first);
             auto it = this->options.find(kvp.first);
             if (it == this->options.end())
                 this->options[kvp.first].reset(kvp.second->clone());
@@ -2799,6 +2807,7 @@ public:
     {
         assert(this->def() == nullptr || this->def() == rhs.def());
         for (auto &kvp : rhs.options) {
+            this->touch_group(kvp.first);
             auto it = this->options.find(kvp.first);
             if (it == this->options.end()) {
                 this->options.insert(std::make_pair(kvp.first, std::move(kvp.second)));
@@ -2807,7 +2816,7 @@ public:
                 it->second = std::move(kvp.second);
             }
         }
-        rhs.options.clear();
+        rhs.clear();
         return *this;
     }
 
@@ -2817,11 +2826,13 @@ public:
     void swap(DynamicConfig &other)
     {
         std::swap(this->options, other.options);
+        std::swap(m_group_timestamps, other.m_group_timestamps);
     }
 
     void clear()
     {
         this->options.clear();
+        m_group_timestamps.clear();
     }
 
     bool erase(const t_config_option_key &opt_key)
@@ -2829,6 +2840,7 @@ public:
         auto it = this->options.find(opt_key);
         if (it == this->options.end())
             return false;
+        this->touch_group(opt_key);
         this->options.erase(it);
         return true;
     }
@@ -2851,11 +2863,16 @@ public:
     t_config_option_keys    keys() const override;
     bool                    empty() const { return options.empty(); }
 
+    // Hides ConfigBase::apply(). The groups of options of a DynamicConfig other copied as a whole keep their timestamps,
+    // thus a config composed of unmodified groups of other configs is known to be equal to them in these groups.
+    void                    apply(const ConfigBase &other, bool ignore_nonexistent = false);
+
     // Set a value for an opt_key. Returns true if the value did not exist yet.
     // This DynamicConfig will take ownership of opt.
     // Be careful, as this method does not test the existence of opt_key in this->def().
     bool                    set_key_value(const std::string &opt_key, ConfigOption *opt)
     {
+        this->touch_group(opt_key);
         auto it = this->options.find(opt_key);
         if (it == this->options.end()) {
             this->options[opt_key].reset(opt);
@@ -2874,10 +2891,32 @@ public:
     // Returns options being equal in the two configs, ignoring options not present in both configs.
     t_config_option_keys equal(const DynamicConfig &other) const;
 
+    // Call fn(key, this_option, other_option) for the options of this config in the groups changed against other,
+    // other_option being nullptr if missing in other. A group is unchanged if it has the same timestamp in both configs,
+    // that is if one config holds a copy of the group of the other config not modified since, and its options are skipped.
+    // Walking the groups of configs diffed repeatedly, e.g. the current and the new config of a Print, compares only
+    // the options of the groups modified.
+    template<typename Fn>
+    void                 iterate_changed_groups(const DynamicConfig &other, Fn &&fn) const
+    {
+        for (auto it = options.cbegin(); it != options.cend();) {
+            const std::string_view group = option_group(it->first);
+            const auto             end   = this->group_range(group).second;
+            const uint64_t         timestamp = this->group_timestamp(group);
+            if (timestamp == 0 || timestamp != other.group_timestamp(group))
+                for (auto it_other = other.options.lower_bound(it->first); it != end; ++ it) {
+                    while (it_other != other.options.cend() && it_other->first < it->first)
+                        ++ it_other;
+                    fn(it->first, it->second.get(), it_other != other.options.cend() && it_other->first == it->first ? it_other->second.get() : nullptr);
+                }
+            it = end;
+        }
+    }
+
     std::string&        opt_string(const t_config_option_key &opt_key, bool create = false)     { return this->option<ConfigOptionString>(opt_key, create)->value; }
-    const std::string&  opt_string(const t_config_option_key &opt_key) const                    { return const_cast<DynamicConfig*>(this)->opt_string(opt_key); }
+    const std::string&  opt_string(const t_config_option_key &opt_key) const                    { return this->option<ConfigOptionString>(opt_key)->value; }
     std::string&        opt_string(const t_config_option_key &opt_key, unsigned int idx)        { return this->option<ConfigOptionStrings>(opt_key)->get_at(idx); }
-    const std::string&  opt_string(const t_config_option_key &opt_key, unsigned int idx) const  { return const_cast<DynamicConfig*>(this)->opt_string(opt_key, idx); }
+    const std::string&  opt_string(const t_config_option_key &opt_key, unsigned int idx) const  { return this->option<ConfigOptionStrings>(opt_key)->get_at(idx); }
 
     double&             opt_float(const t_config_option_key &opt_key)                           { return this->option<ConfigOptionFloat>(opt_key)->value; }
     const double&       opt_float(const t_config_option_key &opt_key) const                     { return dynamic_cast<const ConfigOptionFloat*>(this->option(opt_key))->value; }
@@ -2941,10 +2980,24 @@ public:
     DynamicConfigDifference diff_report(const DynamicConfig& rhs) const;
 
 private:
-    std::map<t_config_option_key, std::unique_ptr<ConfigOption>> options;
+    using OptionsMap = std::map<t_config_option_key, std::unique_ptr<ConfigOption>>;
+
+    // Modifications of options are tracked by groups of the keys sharing the prefix up to the first '_', e.g. "filament_"
+    // or "wipe_tower_". The options of a group are contiguous in the sorted options map.
+    static std::string_view option_group(std::string_view opt_key)
+        { size_t pos = opt_key.find('_'); return pos == std::string_view::npos ? opt_key : opt_key.substr(0, pos + 1); }
+    std::pair<OptionsMap::const_iterator, OptionsMap::const_iterator> group_range(std::string_view group) const;
+    // Timestamp identifying the content of a group, zero if unknown. Equal timestamps of a group in two configs mean equal options.
+    uint64_t                group_timestamp(std::string_view group) const;
+    // To be called by any method providing write access to an option or adding or removing options.
+    void                    touch_group(std::string_view opt_key);
+
+    OptionsMap                                         options;
+    std::map<std::string, uint64_t, std::less<>>       m_group_timestamps;
+    static std::atomic<uint64_t>                       s_last_group_timestamp;
 
 	friend class cereal::access;
-	template<class Archive> void serialize(Archive &ar) { ar(options); }
+	template<class Archive> void serialize(Archive &ar) { m_group_timestamps.clear(); ar(options); }
 };
 
 std::ostream& operator<<(std::ostream& os, const DynamicConfig::DynamicConfigDifference& diff);
@@ -15,6 +15,9 @@
 
 #include "libnoise/noise.h"
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 // #define DEBUG_FUZZY
 
 using namespace Slic3r;
@@ -30,74 +33,142 @@ static double random_value() {
     return dist(gen);
 }
 
-class UniformNoise: public noise::module::Module {
-    public:
-        UniformNoise(): Module (GetSourceModuleCount ()) {};
+// Evaluates the noise of a fuzzy skin configuration for a batch of points.
+// The libnoise module is resolved once per batch, so that the points are evaluated by a non-virtual call
+// to the concrete module, in parallel for long batches. The values are the same as returned by GetValue().
+class NoiseBatch
+{
+public:
+    explicit NoiseBatch(const FuzzySkinConfig& cfg) : m_type(cfg.noise_type)
+    {
+        switch (m_type) {
+        case NoiseType::Perlin:
+            m_perlin.SetFrequency(1 / cfg.noise_scale);
+            m_perlin.SetOctaveCount(cfg.noise_octaves);
+            m_perlin.SetPersistence(cfg.noise_persistence);
+            break;
+        case NoiseType::Billow:
+            m_billow.SetFrequency(1 / cfg.noise_scale);
+            m_billow.SetOctaveCount(cfg.noise_octaves);
+            m_billow.SetPersistence(cfg.noise_persistence);
+            break;
+        case NoiseType::RidgedMulti:
+            m_ridged_multi.SetFrequency(1 / cfg.noise_scale);
+            m_ridged_multi.SetOctaveCount(cfg.noise_octaves);
+            break;
+        case NoiseType::Voronoi:
+            m_voronoi.SetFrequency(1 / cfg.noise_scale);
+            m_voronoi.SetDisplacement(1.0);
+            break;
+        default: break;
+        }
+    }
 
-        virtual int GetSourceModuleCount() const { return 0; }
-        virtual double GetValue(double x, double y, double z) const { return random_value() * 2 - 1; }
-};
+    // out[i] is the noise at (points[i].x(), points[i].y(), z), points being unscaled.
+    void evaluate(const std::vector<Vec2d>& points, double z, std::vector<double>& out) const
+    {
+        out.resize(points.size());
+        switch (m_type) {
+        case NoiseType::Perlin:      evaluate(m_perlin, points, z, out); break;
+        case NoiseType::Billow:      evaluate(m_billow, points, z, out); break;
+        case NoiseType::RidgedMulti: evaluate(m_ridged_multi, points, z, out); break;
+        case NoiseType::Voronoi:     evaluate(m_voronoi, points, z, out); break;
+        default:
+            // Classic uniform noise, drawn from the thread local generator in order.
+            for (double& v : out)
+                v = random_value() * 2 - 1;
+            break;
+        }
+    }
 
-static std::unique_ptr<noise::module::Module> get_noise_module(const FuzzySkinConfig& cfg) {
-    if (cfg.noise_type == NoiseType::Perlin) {
-        auto perlin_noise = noise::module::Perlin();
-        perlin_noise.SetFrequency(1 / cfg.noise_scale);
-        perlin_noise.SetOctaveCount(cfg.noise_octaves);
-        perlin_noise.SetPersistence(cfg.noise_persistence);
-        return std::make_unique<noise::module::Perlin>(perlin_noise);
-    } else if (cfg.noise_type == NoiseType::Billow) {
-        auto billow_noise = noise::module::Billow();
-        billow_noise.SetFrequency(1 / cfg.noise_scale);
-        billow_noise.SetOctaveCount(cfg.noise_octaves);
-        billow_noise.SetPersistence(cfg.noise_persistence);
-        return std::make_unique<noise::module::Billow>(billow_noise);
-    } else if (cfg.noise_type == NoiseType::RidgedMulti) {
-        auto ridged_multi_noise = noise::module::RidgedMulti();
-        ridged_multi_noise.SetFrequency(1 / cfg.noise_scale);
-        ridged_multi_noise.SetOctaveCount(cfg.noise_octaves);
-        return std::make_unique<noise::module::RidgedMulti>(ridged_multi_noise);
-    } else if (cfg.noise_type == NoiseType::Voronoi) {
-        auto voronoi_noise = noise::module::Voronoi();
-        voronoi_noise.SetFrequency(1 / cfg.noise_scale);
-        voronoi_noise.SetDisplacement(1.0);
-        return std::make_unique<noise::module::Voronoi>(voronoi_noise);
-    } else {
-        return std::make_unique<UniformNoise>();
+private:
+    // Below this number of points a batch is not worth splitting between threads.
+    static constexpr const size_t parallel_grain_size = 512;
+
+    template<typename NoiseModule>
+    static void evaluate(const NoiseModule& module, const std::vector<Vec2d>& points, double z, std::vector<double>& out)
+    {
+        auto evaluate_range = [&module, &points, z, &out](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++ i)
+                out[i] = module.NoiseModule::GetValue(points[i].x(), points[i].y(), z);
+        };
+        if (points.size() < 2 * parallel_grain_size)
+            evaluate_range(0, points.size());
+        else
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, points.size(), parallel_grain_size),
+                              [&evaluate_range](const tbb::blocked_range<size_t>& range) { evaluate_range(range.begin(), range.end()); });
     }
-}
 
-// Thanks Cura developers for this function.
-void fuzzy_polyline(Points& poly, bool closed, coordf_t slice_z, const FuzzySkinConfig& cfg)
+    NoiseType                   m_type;
+    noise::module::Perlin       m_perlin;
+    noise::module::Billow       m_billow;
+    noise::module::RidgedMulti  m_ridged_multi;
+    noise::module::Voronoi      m_voronoi;
+};
+
+// A new point of a fuzzy line, displaced along the normal of the source segment by the noise.
+struct FuzzySample
 {
-    std::unique_ptr<noise::module::Module> noise = get_noise_module(cfg);
+    Point  p;
+    // Unit normal of the source segment.
+    Vec2d  normal;
+    // Index of the end point of the source segment.
+    size_t end_idx;
+};
 
+// Sample the points of a polyline with the point distance of the fuzzy skin, then evaluate the noise of all the samples at once.
+template<typename PointFn>
+static void sample_fuzzy_line(size_t num_points, bool closed, PointFn&& point, coordf_t slice_z, const FuzzySkinConfig& cfg,
+                              std::vector<FuzzySample>& samples, std::vector<double>& noise)
+{
     const double min_dist_between_points = cfg.point_distance * 3. / 4.; // hardcoded: the point distance may vary between 3/4 and 5/4 the supplied value
     const double range_random_point_dist = cfg.point_distance / 2.;
     double dist_left_over = random_value() * (min_dist_between_points / 2.); // the distance to be traversed on the line before making the first new point
-    Point* p0 = &poly.back();
-    Points out;
-    out.reserve(poly.size());
-    for (Point &p1 : poly)
-    {
-        if (!closed) {
-            // Skip the first point for open path
-            closed = true;
-            p0 = &p1;
+
+    samples.clear();
+    // With closed loops, the first segment starts at the last point.
+    size_t p0_idx = closed ? num_points - 1 : 0;
+    for (size_t p1_idx = closed ? 0 : 1; p1_idx < num_points; ++ p1_idx) {
+        const Point& p0 = point(p0_idx);
+        const Point& p1 = point(p1_idx);
+        if (p0 == p1) {
+            // Zero length segment, mark the end point to be kept.
+            samples.push_back({ p1, Vec2d::Zero(), p1_idx });
             continue;
         }
         // 'a' is the (next) new point between p0 and p1
-        Vec2d  p0p1      = (p1 - *p0).cast<double>();
+        Vec2d  p0p1      = (p1 - p0).cast<double>();
         double p0p1_size = p0p1.norm();
         double p0pa_dist = dist_left_over;
-        for (; p0pa_dist < p0p1_size;
-            p0pa_dist += min_dist_between_points + random_value() * range_random_point_dist)
-        {
-            Point pa = *p0 + (p0p1 * (p0pa_dist / p0p1_size)).cast<coord_t>();
-            double r = noise->GetValue(unscale_(pa.x()), unscale_(pa.y()), slice_z) * cfg.thickness;
-            out.emplace_back(pa + (perp(p0p1).cast<double>().normalized() * r).cast<coord_t>());
-        }
+        const Vec2d normal = perp(p0p1).cast<double>().normalized();
+        for (; p0pa_dist < p0p1_size; p0pa_dist += min_dist_between_points + random_value() * range_random_point_dist)
+            samples.push_back({ p0 + (p0p1 * (p0pa_dist / p0p1_size)).cast<coord_t>(), normal, p1_idx });
         dist_left_over = p0pa_dist - p0p1_size;
-        p0 = &p1;
+        p0_idx = p1_idx;
+    }
+
+    std::vector<Vec2d> positions;
+    positions.reserve(samples.size());
+    for (const FuzzySample& sample : samples)
+        positions.emplace_back(unscale_(sample.p.x()), unscale_(sample.p.y()));
+    NoiseBatch(cfg).evaluate(positions, slice_z, noise);
+}
+
+// Thanks Cura developers for this function.
+void fuzzy_polyline(Points& poly, bool closed, coordf_t slice_z, const FuzzySkinConfig& cfg)
+{
+    std::vector<FuzzySample> samples;
+    std::vector<double>      noise;
+    sample_fuzzy_line(poly.size(), closed, [&poly](size_t idx) -> const Point& { return poly[idx]; }, slice_z, cfg, samples, noise);
+
+    Points out;
+    out.reserve(std::max(poly.size(), samples.size()));
+    for (size_t i = 0; i < samples.size(); ++ i) {
+        const FuzzySample& sample = samples[i];
+        if (sample.normal == Vec2d::Zero())
+            // Repeated points do not produce any new point.
+            continue;
+        out.emplace_back(sample.p + (sample.normal * (noise[i] * cfg.thickness)).cast<coord_t>());
     }
     while (out.size() < 3) {
         size_t point_idx = poly.size() - 2;
@@ -113,44 +184,37 @@ void fuzzy_polyline(Points& poly, bool closed, coordf_t slice_z, const FuzzySkin
 // Thanks Cura developers for this function.
 void fuzzy_extrusion_line(Arachne::ExtrusionJunctions& ext_lines, coordf_t slice_z, const FuzzySkinConfig& cfg)
 {
-    std::unique_ptr<noise::module::Module> noise = get_noise_module(cfg);
-
-    const double min_dist_between_points = cfg.point_distance * 3. / 4.; // hardcoded: the point distance may vary between 3/4 and 5/4 the supplied value
-    const double range_random_point_dist = cfg.point_distance / 2.;
     const double min_extrusion_width = 0.01; // workaround for many print options. Need overwrite formula with the layer height parameter. The width must more than >>> layer_height * (1 - 0.25 * PI) * 1.05 <<< (last num is the coeff of overlay error case)
-    double dist_left_over = random_value() * (min_dist_between_points / 2.); // the distance to be traversed on the line before making the first new point
 
-    auto* p0 = &ext_lines.front();
+    std::vector<FuzzySample> samples;
+    std::vector<double>      noise;
+    // The first segment of an extrusion line starts at its first junction, which is thus kept as a zero length segment.
+    sample_fuzzy_line(ext_lines.size(), false, [&ext_lines](size_t idx) -> const Point& { return ext_lines[idx].p; }, slice_z, cfg, samples, noise);
+
     Arachne::ExtrusionJunctions out;
-    out.reserve(ext_lines.size());
-    for (auto& p1 : ext_lines) {
-        if (p0->p == p1.p) { // Connect endpoints.
+    out.reserve(std::max(ext_lines.size(), samples.size() + 1));
+    // Connect endpoints.
+    out.emplace_back(ext_lines.front().p, ext_lines.front().w, ext_lines.front().perimeter_index);
+    for (size_t i = 0; i < samples.size(); ++ i) {
+        const FuzzySample&                sample = samples[i];
+        const Arachne::ExtrusionJunction& p1     = ext_lines[sample.end_idx];
+        if (sample.normal == Vec2d::Zero()) { // Connect endpoints.
             out.emplace_back(p1.p, p1.w, p1.perimeter_index);
             continue;
         }
-
-        // 'a' is the (next) new point between p0 and p1
-        Vec2d  p0p1 = (p1.p - p0->p).cast<double>();
-        double p0p1_size = p0p1.norm();
-        double p0pa_dist = dist_left_over;
-        for (; p0pa_dist < p0p1_size; p0pa_dist += min_dist_between_points + random_value() * range_random_point_dist) {
-            Point pa = p0->p + (p0p1 * (p0pa_dist / p0p1_size)).cast<coord_t>();
-            double r = noise->GetValue(unscale_(pa.x()), unscale_(pa.y()), slice_z) * cfg.thickness;
-            switch (cfg.mode) { //the curly code for testing
-                case FuzzySkinMode::Displacement :
-                    out.emplace_back(pa + (perp(p0p1).cast<double>().normalized() * r).cast<coord_t>(), p1.w, p1.perimeter_index);
-                    break;
-                case FuzzySkinMode::Extrusion :
-                    out.emplace_back(pa, std::max(p1.w + r + min_extrusion_width,  min_extrusion_width), p1.perimeter_index); 
-                    break;
-                case FuzzySkinMode::Combined :
-                    double rad = std::max(p1.w + r + min_extrusion_width,  min_extrusion_width);
-                    out.emplace_back(pa + (perp(p0p1).cast<double>().normalized() * ((rad  - p1.w) / 2)).cast<coord_t>(), rad, p1.perimeter_index); //0.05 - minimum width of extruded line
-                    break;
-            }
+        const double r = noise[i] * cfg.thickness;
+        switch (cfg.mode) { //the curly code for testing
+            case FuzzySkinMode::Displacement :
+                out.emplace_back(sample.p + (sample.normal * r).cast<coord_t>(), p1.w, p1.perimeter_index);
+                break;
+            case FuzzySkinMode::Extrusion :
+                out.emplace_back(sample.p, std::max(p1.w + r + min_extrusion_width,  min_extrusion_width), p1.perimeter_index);
+                break;
+            case FuzzySkinMode::Combined :
+                double rad = std::max(p1.w + r + min_extrusion_width,  min_extrusion_width);
+                out.emplace_back(sample.p + (sample.normal * ((rad  - p1.w) / 2)).cast<coord_t>(), rad, p1.perimeter_index); //0.05 - minimum width of extruded line
+                break;
         }
-        dist_left_over = p0pa_dist - p0p1_size;
-        p0 = &p1;
     }
 
     while (out.size() < 3) {
@@ -5,20 +5,8 @@
 #include "libslic3r/ClipperUtils.hpp"
 #include "Layer.hpp"
 
-namespace std {
-template<> struct hash<Slic3r::GridPoint3>
-{
-    size_t operator()(const Slic3r::GridPoint3& pp) const noexcept
-    {
-        static int prime  = 31;
-        int        result = 89;
-        result            = static_cast<int>(result * prime + pp.x());
-        result            = static_cast<int>(result * prime + pp.y());
-        result            = static_cast<int>(result * prime + pp.z());
-        return static_cast<size_t>(result);
-    }
-};
-} // namespace std
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 
 
 namespace Slic3r {
@@ -84,7 +72,7 @@ std::pair<ExPolygons, ExPolygons> InterlockingGenerator::growBorderAreasPerpendi
     return {from_border_a, from_border_b};
 }
 
-void InterlockingGenerator::handleThinAreas(const std::unordered_set<GridPoint3>& has_all_meshes) const
+void InterlockingGenerator::handleThinAreas(const VoxelGrid& has_all_meshes) const
 {
     const coord_t     number_of_beams_detect = boundary_avoidance;
     const coord_t     number_of_beams_expand = boundary_avoidance - 1;
@@ -100,56 +88,61 @@ void InterlockingGenerator::handleThinAreas(const std::unordered_set<GridPoint3>
     // Make an inclusionary polygon, to only actually handle thin areas near actual microstructures (so not in skin for example).
     std::vector<Polygons> near_interlock_per_layer;
     near_interlock_per_layer.assign(print_object.layer_count(), Polygons());
-    for (const auto& cell : has_all_meshes) {
+    has_all_meshes.for_each([this, &near_interlock_per_layer](const GridPoint3& cell) {
         const auto bottom_corner = vu.toLowerCorner(cell);
         for (coord_t layer_nr = bottom_corner.z();
              layer_nr < bottom_corner.z() + cell_size.z() && layer_nr < static_cast<coord_t>(near_interlock_per_layer.size()); ++layer_nr) {
             near_interlock_per_layer[static_cast<size_t>(layer_nr)].push_back(vu.toPolygon(cell));
         }
-    }
-    for (auto& near_interlock : near_interlock_per_layer) {
-        near_interlock = offset(union_(closing(near_interlock, rounding_errors)), detect);
-        polygons_rotate(near_interlock, rotation);
-    }
+    });
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, near_interlock_per_layer.size()), [this, &near_interlock_per_layer, detect](const tbb::blocked_range<size_t>& range) {
+        for (size_t layer_nr = range.begin(); layer_nr < range.end(); ++layer_nr) {
+            Polygons& near_interlock = near_interlock_per_layer[layer_nr];
+            near_interlock = offset(union_(closing(near_interlock, rounding_errors)), detect);
+            polygons_rotate(near_interlock, rotation);
+        }
+    });
 
     // Only alter layers when they are present in both meshes, zip should take care if that.
-    for (size_t layer_nr = 0; layer_nr < print_object.layer_count(); layer_nr++){
-        auto       layer   = print_object.get_layer(layer_nr);
-        ExPolygons polys_a = to_expolygons(layer->get_region(region_a_index)->slices.surfaces);
-        ExPolygons polys_b = to_expolygons(layer->get_region(region_b_index)->slices.surfaces);
-
-        const auto [from_border_a, from_border_b] = growBorderAreasPerpendicular(polys_a, polys_b, detect);
-
-        // Get the areas of each mesh that are _not_ thin (large), by performing a morphological open.
-        const ExPolygons large_a = opening_ex(polys_a, detect);
-        const ExPolygons large_b = opening_ex(polys_b, detect);
-
-        // Derive the area that the thin areas need to expand into (so the added areas to the thin strips) from the information we already have.
-        const ExPolygons thin_expansion_a =
-            offset_ex(intersection_ex(intersection_ex(intersection_ex(large_b, offset_ex(diff_ex(polys_a, large_a), expand)),
-                                                      near_interlock_per_layer[layer_nr]),
-                                      from_border_a),
-                      rounding_errors);
-        const ExPolygons thin_expansion_b =
-            offset_ex(intersection_ex(intersection_ex(intersection_ex(large_a, offset_ex(diff_ex(polys_b, large_b), expand)),
-                                                      near_interlock_per_layer[layer_nr]),
-                                      from_border_b),
-                      rounding_errors);
-
-        // Expanded thin areas of the opposing polygon should 'eat into' the larger areas of the polygon,
-        // and conversely, add the expansions to their own thin areas.
-        layer->get_region(region_a_index)->slices.set(closing_ex(diff_ex(union_ex(polys_a, thin_expansion_a), thin_expansion_b), close_gaps), stInternal);
-        layer->get_region(region_b_index)->slices.set(closing_ex(diff_ex(union_ex(polys_b, thin_expansion_b), thin_expansion_a), close_gaps), stInternal);
-    }
+    // Each layer only touches its own slices, thus the layers are processed in parallel.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, print_object.layer_count()), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t layer_nr = range.begin(); layer_nr < range.end(); layer_nr++){
+            auto       layer   = print_object.get_layer(layer_nr);
+            ExPolygons polys_a = to_expolygons(layer->get_region(region_a_index)->slices.surfaces);
+            ExPolygons polys_b = to_expolygons(layer->get_region(region_b_index)->slices.surfaces);
+
+            const auto [from_border_a, from_border_b] = growBorderAreasPerpendicular(polys_a, polys_b, detect);
+
+            // Get the areas of each mesh that are _not_ thin (large), by performing a morphological open.
+            const ExPolygons large_a = opening_ex(polys_a, detect);
+            const ExPolygons large_b = opening_ex(polys_b, detect);
+
+            // Derive the area that the thin areas need to expand into (so the added areas to the thin strips) from the information we already have.
+            const ExPolygons thin_expansion_a =
+                offset_ex(intersection_ex(intersection_ex(intersection_ex(large_b, offset_ex(diff_ex(polys_a, large_a), expand)),
+                                                          near_interlock_per_layer[layer_nr]),
+                                          from_border_a),
+                          rounding_errors);
+            const ExPolygons thin_expansion_b =
+                offset_ex(intersection_ex(intersection_ex(intersection_ex(large_a, offset_ex(diff_ex(polys_b, large_b), expand)),
+                                                          near_interlock_per_layer[layer_nr]),
+                                          from_border_b),
+                          rounding_errors);
+
+            // Expanded thin areas of the opposing polygon should 'eat into' the larger areas of the polygon,
+            // and conversely, add the expansions to their own thin areas.
+            layer->get_region(region_a_index)->slices.set(closing_ex(diff_ex(union_ex(polys_a, thin_expansion_a), thin_expansion_b), close_gaps), stInternal);
+            layer->get_region(region_b_index)->slices.set(closing_ex(diff_ex(union_ex(polys_b, thin_expansion_b), thin_expansion_a), close_gaps), stInternal);
+        }
+    });
 }
 
 void InterlockingGenerator::generateInterlockingStructure() const
 {
-    std::vector<std::unordered_set<GridPoint3>> voxels_per_mesh = getShellVoxels(interface_dilation);
+    std::vector<VoxelGrid> voxels_per_mesh = getShellVoxels(interface_dilation);
 
-    std::unordered_set<GridPoint3>& has_any_mesh   = voxels_per_mesh[0];
-    std::unordered_set<GridPoint3>& has_all_meshes = voxels_per_mesh[1];
-    has_any_mesh.merge(has_all_meshes); // perform union and intersection simultaneously. Cannibalizes voxels_per_mesh
+    VoxelGrid& has_all_meshes = voxels_per_mesh[0];
+    has_all_meshes &= voxels_per_mesh[1];
 
     if (has_all_meshes.empty()) {
         return;
@@ -158,12 +151,9 @@ void InterlockingGenerator::generateInterlockingStructure() const
     const std::vector<ExPolygons> layer_regions = computeUnionedVolumeRegions();
 
     if (air_filtering) {
-        std::unordered_set<GridPoint3> air_cells;
+        VoxelGrid air_cells;
         addBoundaryCells(layer_regions, air_dilation, air_cells);
-
-        for (const GridPoint3& p : air_cells) {
-            has_all_meshes.erase(p);
-        }
+        has_all_meshes -= air_cells;
 
         handleThinAreas(has_all_meshes);
     }
@@ -171,23 +161,25 @@ void InterlockingGenerator::generateInterlockingStructure() const
     applyMicrostructureToOutlines(has_all_meshes, layer_regions);
 }
 
-std::vector<std::unordered_set<GridPoint3>> InterlockingGenerator::getShellVoxels(const DilationKernel& kernel) const
+std::vector<VoxelGrid> InterlockingGenerator::getShellVoxels(const DilationKernel& kernel) const
 {
-    std::vector<std::unordered_set<GridPoint3>> voxels_per_mesh(2);
+    std::vector<VoxelGrid> voxels_per_mesh(2);
 
     // mark all cells which contain some boundary
     for (size_t region_idx = 0; region_idx < 2; region_idx++)
     {
         const size_t region = (region_idx == 0) ? region_a_index : region_b_index;
-        std::unordered_set<GridPoint3>& mesh_voxels = voxels_per_mesh[region_idx];
+        VoxelGrid& mesh_voxels = voxels_per_mesh[region_idx];
 
         std::vector<ExPolygons> rotated_polygons_per_layer(print_object.layer_count());
-        for (size_t layer_nr = 0; layer_nr < print_object.layer_count(); layer_nr++)
-        {
-            auto layer = print_object.get_layer(layer_nr);
-            rotated_polygons_per_layer[layer_nr] = to_expolygons(layer->get_region(region)->slices.surfaces);
-            expolygons_rotate(rotated_polygons_per_layer[layer_nr], rotation);
-        }
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, print_object.layer_count()), [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_nr = range.begin(); layer_nr < range.end(); layer_nr++)
+            {
+                auto layer = print_object.get_layer(layer_nr);
+                rotated_polygons_per_layer[layer_nr] = to_expolygons(layer->get_region(region)->slices.surfaces);
+                expolygons_rotate(rotated_polygons_per_layer[layer_nr], rotation);
+            }
+        });
 
         addBoundaryCells(rotated_polygons_per_layer, kernel, mesh_voxels);
     }
@@ -195,28 +187,41 @@ std::vector<std::unordered_set<GridPoint3>> InterlockingGenerator::getShellVoxel
     return voxels_per_mesh;
 }
 
-void InterlockingGenerator::addBoundaryCells(const std::vector<ExPolygons>&  layers,
-                                             const DilationKernel&           kernel,
-                                             std::unordered_set<GridPoint3>& cells) const
+void InterlockingGenerator::addBoundaryCells(const std::vector<ExPolygons>& layers,
+                                             const DilationKernel&          kernel,
+                                             VoxelGrid&                     cells) const
 {
-    auto voxel_emplacer = [&cells](GridPoint3 p) {
-        if (p.z() < 0) {
-            return true;
+    // Cells crossed by the outlines and the skins of each layer, before dilation.
+    std::vector<std::vector<GridPoint3>> cells_per_layer(layers.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t layer_nr = range.begin(); layer_nr < range.end(); layer_nr++) {
+            std::vector<GridPoint3>& layer_cells    = cells_per_layer[layer_nr];
+            auto                     voxel_emplacer = [&layer_cells](GridPoint3 p) {
+                layer_cells.emplace_back(p);
+                return true;
+            };
+            const coord_t z = static_cast<coord_t>(layer_nr);
+            vu.walkKernelAlignedPolygons(layers[layer_nr], z, kernel, voxel_emplacer);
+            ExPolygons skin = layers[layer_nr];
+            if (layer_nr > 0) {
+                skin = xor_ex(skin, layers[layer_nr - 1]);
+            }
+            skin = opening_ex(skin, cell_size.x() / 2.f); // remove superfluous small areas, which would anyway be included because of walkPolygons
+            vu.walkKernelAlignedAreas(skin, z, kernel, voxel_emplacer);
         }
-        cells.emplace(p);
-        return true;
-    };
-
-    for (size_t layer_nr = 0; layer_nr < layers.size(); layer_nr++) {
-        const coord_t z = static_cast<coord_t>(layer_nr);
-        vu.walkDilatedPolygons(layers[layer_nr], z, kernel, voxel_emplacer);
-        ExPolygons skin = layers[layer_nr];
-        if (layer_nr > 0) {
-            skin = xor_ex(skin, layers[layer_nr - 1]);
+    });
+
+    VoxelGrid raw_cells;
+    for (const std::vector<GridPoint3>& layer_cells : cells_per_layer) {
+        for (const GridPoint3& p : layer_cells) {
+            raw_cells.insert(p);
         }
-        skin = opening_ex(skin, cell_size.x() / 2.f); // remove superfluous small areas, which would anyway be included because of walkPolygons
-        vu.walkDilatedAreas(skin, z, kernel, voxel_emplacer);
     }
+
+    // The cells below the first layer are dropped after the dilation, they may still dilate into the first layer.
+    VoxelGrid dilated = raw_cells.dilated(kernel);
+    dilated.erase_below(0);
+    cells |= dilated;
 }
 
 std::vector<ExPolygons> InterlockingGenerator::computeUnionedVolumeRegions() const
@@ -225,15 +230,17 @@ std::vector<ExPolygons> InterlockingGenerator::computeUnionedVolumeRegions() con
                                    1; // introduce ghost layer on top for correct skin computation of topmost layer.
     std::vector<ExPolygons> layer_regions(max_layer_count);
 
-    for (size_t layer_nr = 0; layer_nr < max_layer_count - 1; layer_nr++) {
-        auto& layer_region = layer_regions[static_cast<size_t>(layer_nr)];
-        for (size_t region_idx : {region_a_index, region_b_index}) {
-            auto layer = print_object.get_layer(layer_nr);
-            expolygons_append(layer_region, to_expolygons(layer->get_region(region_idx)->slices.surfaces));
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, max_layer_count - 1), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t layer_nr = range.begin(); layer_nr < range.end(); layer_nr++) {
+            auto& layer_region = layer_regions[static_cast<size_t>(layer_nr)];
+            for (size_t region_idx : {region_a_index, region_b_index}) {
+                auto layer = print_object.get_layer(layer_nr);
+                expolygons_append(layer_region, to_expolygons(layer->get_region(region_idx)->slices.surfaces));
+            }
+            layer_region = closing_ex(layer_region, ignored_gap_); // Morphological close to merge meshes into single volume
+            expolygons_rotate(layer_region, rotation);
         }
-        layer_region = closing_ex(layer_region, ignored_gap_); // Morphological close to merge meshes into single volume
-        expolygons_rotate(layer_region, rotation);
-    }
+    });
     return layer_regions;
 }
 
@@ -267,8 +274,8 @@ std::vector<std::vector<ExPolygons>> InterlockingGenerator::generateMicrostructu
     return cell_area_per_mesh_per_layer;
 }
 
-void InterlockingGenerator::applyMicrostructureToOutlines(const std::unordered_set<GridPoint3>& cells,
-                                                          const std::vector<ExPolygons>&        layer_regions) const
+void InterlockingGenerator::applyMicrostructureToOutlines(const VoxelGrid&               cells,
+                                                          const std::vector<ExPolygons>& layer_regions) const
 {
     std::vector<std::vector<ExPolygons>> cell_area_per_mesh_per_layer = generateMicrostructure();
 
@@ -287,7 +294,7 @@ void InterlockingGenerator::applyMicrostructureToOutlines(const std::unordered_s
 
     // Only compute cell structure for half the layers, because since our beams are two layers high, every odd layer of the structure will
     // be the same as the layer below.
-    for (const GridPoint3& grid_loc : cells) {
+    cells.for_each([&](const GridPoint3& grid_loc) {
         Vec3crd bottom_corner = vu.toLowerCorner(grid_loc);
         for (size_t mesh_idx = 0; mesh_idx < 2; mesh_idx++) {
             for (size_t layer_nr = bottom_corner.z(); layer_nr < bottom_corner.z() + cell_size.z() && layer_nr < max_layer_count;
@@ -300,33 +307,37 @@ void InterlockingGenerator::applyMicrostructureToOutlines(const std::unordered_s
                 expolygons_append(structure_per_layer[mesh_idx][static_cast<size_t>(layer_nr / beam_layer_count)], areas_here);
             }
         }
-    }
+    });
 
     for (size_t mesh_idx = 0; mesh_idx < 2; mesh_idx++) {
-        for (size_t layer_nr = 0; layer_nr < structure_per_layer[mesh_idx].size(); layer_nr++) {
-            ExPolygons& layer_structure = structure_per_layer[mesh_idx][layer_nr];
-            layer_structure = union_ex(layer_structure);
-            expolygons_rotate(layer_structure, unapply_rotation);
-        }
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, structure_per_layer[mesh_idx].size()), [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_nr = range.begin(); layer_nr < range.end(); layer_nr++) {
+                ExPolygons& layer_structure = structure_per_layer[mesh_idx][layer_nr];
+                layer_structure = union_ex(layer_structure);
+                expolygons_rotate(layer_structure, unapply_rotation);
+            }
+        });
     }
 
-    for (size_t region_idx = 0; region_idx < 2; region_idx++) {
-        const size_t region = (region_idx == 0) ? region_a_index : region_b_index;
-        for (size_t layer_nr = 0; layer_nr < max_layer_count; layer_nr++) {
-            ExPolygons layer_outlines = layer_regions[layer_nr];
-            expolygons_rotate(layer_outlines, unapply_rotation);
-
-            const ExPolygons areas_here = intersection_ex(structure_per_layer[region_idx][layer_nr / static_cast<size_t>(beam_layer_count)], layer_outlines);
-            const ExPolygons& areas_other = structure_per_layer[!region_idx][layer_nr / static_cast<size_t>(beam_layer_count)];
-
-            auto       layer  = print_object.get_layer(layer_nr);
-            auto&      slices = layer->get_region(region)->slices;
-            ExPolygons polys  = to_expolygons(slices.surfaces);
-            slices.set(union_ex(diff_ex(polys, areas_other), // reduce layer areas inward with beams from other mesh
-                                areas_here)                  // extend layer areas outward with newly added beams
-                       , stInternal);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, max_layer_count), [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t region_idx = 0; region_idx < 2; region_idx++) {
+            const size_t region = (region_idx == 0) ? region_a_index : region_b_index;
+            for (size_t layer_nr = range.begin(); layer_nr < range.end(); layer_nr++) {
+                ExPolygons layer_outlines = layer_regions[layer_nr];
+                expolygons_rotate(layer_outlines, unapply_rotation);
+
+                const ExPolygons areas_here = intersection_ex(structure_per_layer[region_idx][layer_nr / static_cast<size_t>(beam_layer_count)], layer_outlines);
+                const ExPolygons& areas_other = structure_per_layer[!region_idx][layer_nr / static_cast<size_t>(beam_layer_count)];
+
+                auto       layer  = print_object.get_layer(layer_nr);
+                auto&      slices = layer->get_region(region)->slices;
+                ExPolygons polys  = to_expolygons(slices.surfaces);
+                slices.set(union_ex(diff_ex(polys, areas_other), // reduce layer areas inward with beams from other mesh
+                                    areas_here)                  // extend layer areas outward with newly added beams
+                           , stInternal);
+            }
         }
-    }
+    });
 }
 
 } // namespace Slic3r
@@ -0,0 +1,189 @@
+#include "VoxelGrid.hpp"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Slic3r {
+
+// Rows of a brick word with the x bits < n set.
+static uint64_t x_below_mask(int n)
+{
+    return 0x0101010101010101ull * ((uint64_t(1) << n) - 1);
+}
+
+static int popcount(uint64_t word)
+{
+    word = word - ((word >> 1) & 0x5555555555555555ull);
+    word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return int((word * 0x0101010101010101ull) >> 56);
+}
+
+static bool is_empty(const VoxelGrid::Brick &brick)
+{
+    return std::all_of(brick.begin(), brick.end(), [](uint64_t word) { return word == 0; });
+}
+
+int VoxelGrid::count_trailing_zeros(uint64_t word)
+{
+    assert(word != 0);
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward64(&idx, word);
+    return int(idx);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+bool VoxelGrid::insert(const GridPoint3 &p)
+{
+    const GridPoint3 key(p.x() >> brick_shift, p.y() >> brick_shift, p.z() >> brick_shift);
+    uint64_t        &word = m_bricks[key][p.z() & (brick_size - 1)];
+    const uint64_t   bit  = uint64_t(1) << (((p.y() & (brick_size - 1)) << brick_shift) | (p.x() & (brick_size - 1)));
+    const bool       inserted = (word & bit) == 0;
+    word |= bit;
+    return inserted;
+}
+
+bool VoxelGrid::contains(const GridPoint3 &p) const
+{
+    auto it = m_bricks.find(GridPoint3(p.x() >> brick_shift, p.y() >> brick_shift, p.z() >> brick_shift));
+    return it != m_bricks.end() &&
+           (it->second[p.z() & (brick_size - 1)] >> (((p.y() & (brick_size - 1)) << brick_shift) | (p.x() & (brick_size - 1)))) & 1;
+}
+
+size_t VoxelGrid::size() const
+{
+    size_t cnt = 0;
+    for (const auto &[key, brick] : m_bricks)
+        for (uint64_t word : brick)
+            cnt += popcount(word);
+    return cnt;
+}
+
+VoxelGrid &VoxelGrid::operator|=(const VoxelGrid &rhs)
+{
+    for (const auto &[key, brick] : rhs.m_bricks) {
+        Brick &dst = m_bricks[key];
+        for (size_t i = 0; i < brick.size(); ++ i)
+            dst[i] |= brick[i];
+    }
+    return *this;
+}
+
+VoxelGrid &VoxelGrid::operator&=(const VoxelGrid &rhs)
+{
+    for (auto it = m_bricks.begin(); it != m_bricks.end();) {
+        auto it_rhs = rhs.m_bricks.find(it->first);
+        if (it_rhs != rhs.m_bricks.end())
+            for (size_t i = 0; i < it->second.size(); ++ i)
+                it->second[i] &= it_rhs->second[i];
+        it = it_rhs == rhs.m_bricks.end() || is_empty(it->second) ? m_bricks.erase(it) : std::next(it);
+    }
+    return *this;
+}
+
+VoxelGrid &VoxelGrid::operator-=(const VoxelGrid &rhs)
+{
+    for (const auto &[key, brick] : rhs.m_bricks) {
+        auto it = m_bricks.find(key);
+        if (it == m_bricks.end())
+            continue;
+        for (size_t i = 0; i < brick.size(); ++ i)
+            it->second[i] &= ~brick[i];
+        if (is_empty(it->second))
+            m_bricks.erase(it);
+    }
+    return *this;
+}
+
+void VoxelGrid::or_shifted(const VoxelGrid &src, const GridPoint3 &offset)
+{
+    // Split the offset into whole bricks and a remainder in <0, brick_size).
+    const GridPoint3 brick_offset(offset.x() >> brick_shift, offset.y() >> brick_shift, offset.z() >> brick_shift);
+    const int        rx = int(offset.x() & (brick_size - 1));
+    const int        ry = int(offset.y() & (brick_size - 1));
+    const int        rz = int(offset.z() & (brick_size - 1));
+    // Bits staying in the brick after shifting by rx, bits moving into the next brick in x.
+    const uint64_t   x_stay_mask = x_below_mask(int(brick_size) - rx);
+
+    for (const auto &[key, brick] : src.m_bricks) {
+        // Up to 8 destination bricks, created on demand, indexed by the (x, y, z) spill bits.
+        std::array<Brick*, 8> dst{};
+        auto add = [this, &dst, &key, &brick_offset](int idx, int wz, uint64_t word) {
+            if (word == 0)
+                return;
+            if (dst[idx] == nullptr)
+                dst[idx] = &m_bricks[GridPoint3(key.x() + brick_offset.x() + (idx & 1), key.y() + brick_offset.y() + ((idx >> 1) & 1),
+                                                key.z() + brick_offset.z() + (idx >> 2))];
+            (*dst[idx])[wz] |= word;
+        };
+        for (int z = 0; z < int(brick_size); ++ z) {
+            const uint64_t word = brick[z];
+            if (word == 0)
+                continue;
+            const int tz   = z + rz;
+            const int dz   = (tz >> brick_shift) << 2;
+            const int wz   = tz & int(brick_size - 1);
+            // Shift in x.
+            const uint64_t parts_x[2] = { (word & x_stay_mask) << rx, rx == 0 ? 0 : (word & ~x_stay_mask) >> (int(brick_size) - rx) };
+            for (int dx = 0; dx < 2; ++ dx) {
+                // Shift in y by whole rows.
+                const uint64_t part = parts_x[dx];
+                add(dz | dx, wz, part << (ry << brick_shift));
+                if (ry != 0)
+                    add(dz | 2 | dx, wz, part >> ((int(brick_size) - ry) << brick_shift));
+            }
+        }
+    }
+}
+
+VoxelGrid VoxelGrid::dilated(const DilationKernel &kernel) const
+{
+    VoxelGrid out;
+    for (const GridPoint3 &rel : kernel.relative_cells_)
+        out.or_shifted(*this, rel);
+    return out;
+}
+
+void VoxelGrid::erase_below(coord_t min_z)
+{
+    for (auto it = m_bricks.begin(); it != m_bricks.end();) {
+        const coord_t z0 = it->first.z() * brick_size;
+        for (coord_t z = z0; z < std::min(min_z, z0 + brick_size); ++ z)
+            it->second[z - z0] = 0;
+        it = is_empty(it->second) ? m_bricks.erase(it) : std::next(it);
+    }
+}
+
+std::vector<const VoxelGrid::Bricks::value_type*> VoxelGrid::sorted_bricks() const
+{
+    std::vector<const Bricks::value_type*> out;
+    out.reserve(m_bricks.size());
+    for (const auto &brick : m_bricks)
+        out.emplace_back(&brick);
+    std::sort(out.begin(), out.end(), [](const Bricks::value_type *l, const Bricks::value_type *r) {
+        return std::lexicographical_compare(l->first.data(), l->first.data() + 3, r->first.data(), r->first.data() + 3);
+    });
+    return out;
+}
+
+std::vector<GridPoint3> VoxelGrid::cells() const
+{
+    std::vector<GridPoint3> out;
+    out.reserve(this->size());
+    this->for_each([&out](const GridPoint3 &p) { out.emplace_back(p); });
+    return out;
+}
+
+bool VoxelGrid::operator==(const VoxelGrid &rhs) const
+{
+    // Empty bricks are never stored, thus equal grids have equal bricks.
+    return m_bricks == rhs.m_bricks;
+}
+
+} // namespace Slic3r
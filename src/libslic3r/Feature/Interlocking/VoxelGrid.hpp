@@ -0,0 +1,90 @@
+#ifndef slic3r_Interlocking_VoxelGrid_hpp_
+#define slic3r_Interlocking_VoxelGrid_hpp_
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "VoxelUtils.hpp"
+
+namespace Slic3r {
+
+/*!
+ * Sparse set of voxel cells.
+ *
+ * The cells are stored in bricks of 8x8x8 cells, each brick being a bitset of eight 64 bit words, one word per z.
+ * Only the bricks containing some cell are stored, in a hash map indexed by the brick coordinates.
+ * The boolean operations and the dilation work on whole words, 64 cells at a time.
+ */
+class VoxelGrid
+{
+public:
+    static constexpr const int     brick_shift = 3;
+    static constexpr const coord_t brick_size  = 1 << brick_shift;
+
+    // Bit (y * 8 + x) of words[z] is the cell (x, y, z) of the brick.
+    using Brick = std::array<uint64_t, brick_size>;
+
+    bool   insert(const GridPoint3 &p);
+    bool   contains(const GridPoint3 &p) const;
+    bool   empty() const { return m_bricks.empty(); }
+    size_t size() const;
+    size_t bricks_count() const { return m_bricks.size(); }
+    void   clear() { m_bricks.clear(); }
+
+    VoxelGrid &operator|=(const VoxelGrid &rhs);
+    VoxelGrid &operator&=(const VoxelGrid &rhs);
+    VoxelGrid &operator-=(const VoxelGrid &rhs);
+
+    // The union of this grid shifted by all the relative cells of the kernel,
+    // the same cells as processed by VoxelUtils::dilate() for each cell of this grid.
+    VoxelGrid dilated(const DilationKernel &kernel) const;
+
+    // Remove the cells with z < min_z.
+    void erase_below(coord_t min_z);
+
+    // Call fn(GridPoint3) for all the cells, ordered by brick coordinates and by z, y, x inside a brick.
+    // The order does not depend on the order in which the cells were inserted.
+    template<typename Fn> void for_each(Fn &&fn) const
+    {
+        for (const auto *brick : this->sorted_bricks()) {
+            const GridPoint3 origin = brick->first * brick_size;
+            for (coord_t z = 0; z < brick_size; ++ z)
+                for (uint64_t word = brick->second[z]; word != 0; word &= word - 1) {
+                    const int bit = count_trailing_zeros(word);
+                    fn(GridPoint3(origin.x() + (bit & (brick_size - 1)), origin.y() + (bit >> brick_shift), origin.z() + z));
+                }
+        }
+    }
+
+    std::vector<GridPoint3> cells() const;
+
+    bool operator==(const VoxelGrid &rhs) const;
+    bool operator!=(const VoxelGrid &rhs) const { return !(*this == rhs); }
+
+private:
+    struct BrickHash
+    {
+        size_t operator()(const GridPoint3 &p) const noexcept
+        {
+            uint64_t h = uint64_t(p.x()) * 0x9E3779B97F4A7C15ull;
+            h ^= uint64_t(p.y()) * 0xC2B2AE3D27D4EB4Full + (h >> 29);
+            h ^= uint64_t(p.z()) * 0x165667B19E3779F9ull + (h >> 32);
+            return size_t(h);
+        }
+    };
+    using Bricks = std::unordered_map<GridPoint3, Brick, BrickHash>;
+
+    static int count_trailing_zeros(uint64_t word);
+
+    std::vector<const Bricks::value_type*> sorted_bricks() const;
+    // Set all the cells of src shifted by offset.
+    void or_shifted(const VoxelGrid &src, const GridPoint3 &offset);
+
+    Bricks m_bricks;
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_Interlocking_VoxelGrid_hpp_
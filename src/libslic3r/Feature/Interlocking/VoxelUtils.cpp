@@ -115,6 +115,11 @@ bool VoxelUtils::walkPolygons(const ExPolygon& polys, coord_t z, const std::func
 }
 
 bool VoxelUtils::walkDilatedPolygons(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
+{
+    return walkKernelAlignedPolygons(polys, z, kernel, dilate(kernel, process_cell_func));
+}
+
+bool VoxelUtils::walkKernelAlignedPolygons(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
 {
     ExPolygon translated = polys;
     GridPoint3 k = kernel.kernel_size_;
@@ -126,7 +131,7 @@ bool VoxelUtils::walkDilatedPolygons(const ExPolygon& polys, coord_t z, const Di
     {
         translated.translate(Point(translation.x(), translation.y()));
     }
-    return walkPolygons(translated, z + translation.z(), dilate(kernel, process_cell_func));
+    return walkPolygons(translated, z + translation.z(), process_cell_func);
 }
 
 bool VoxelUtils::walkAreas(const ExPolygon& polys, coord_t z, const std::function<bool(GridPoint3)>& process_cell_func) const
@@ -188,6 +193,11 @@ bool VoxelUtils::_walkAreas(const ExPolygon& polys, coord_t z, const std::functi
 }
 
 bool VoxelUtils::walkDilatedAreas(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
+{
+    return walkKernelAlignedAreas(polys, z, kernel, dilate(kernel, process_cell_func));
+}
+
+bool VoxelUtils::walkKernelAlignedAreas(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
 {
     ExPolygon translated = polys;
     GridPoint3 k = kernel.kernel_size_;
@@ -200,7 +210,7 @@ bool VoxelUtils::walkDilatedAreas(const ExPolygon& polys, coord_t z, const Dilat
     {
         translated.translate(Point(translation.x(), translation.y()));
     }
-    return _walkAreas(translated, z + translation.z(), dilate(kernel, process_cell_func));
+    return _walkAreas(translated, z + translation.z(), process_cell_func);
 }
 
 std::function<bool(GridPoint3)> VoxelUtils::dilate(const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
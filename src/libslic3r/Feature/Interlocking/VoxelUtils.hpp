@@ -116,6 +116,24 @@ public:
         return true;
     }
 
+    /*!
+     * Process voxels which the line segments of a polygon crosses, with the polygon aligned to the kernel the same way as in walkDilatedPolygons.
+     * Dilating the processed voxels by the kernel gives the voxels processed by walkDilatedPolygons.
+     *
+     * \warning Voxels may be processed multiple times!
+     */
+    bool walkKernelAlignedPolygons(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const;
+    bool walkKernelAlignedPolygons(const ExPolygons& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
+    {
+        for (const auto & poly : polys) {
+            if (!walkKernelAlignedPolygons(poly, z, kernel, process_cell_func)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
 private:
     /*!
      * \warning the \p polys is assumed to be translated by half the cell_size in xy already
@@ -158,6 +176,22 @@ public:
         return true;
     }
 
+    /*!
+     * Process all voxels inside the area of a polygons object, with the area aligned to the kernel the same way as in walkDilatedAreas.
+     * Dilating the processed voxels by the kernel gives the voxels processed by walkDilatedAreas.
+     */
+    bool walkKernelAlignedAreas(const ExPolygon& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const;
+    bool walkKernelAlignedAreas(const ExPolygons& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
+    {
+        for (const auto & poly : polys) {
+            if (!walkKernelAlignedAreas(poly, z, kernel, process_cell_func)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     /*!
      * Dilate with a kernel.
      *
@@ -5,6 +5,10 @@
 #include <random>
 #include <cassert>
 #include <sstream>
+#include <list>
+#include <mutex>
+
+#include <tbb/parallel_for.h>
 
 namespace Slic3r
 {
@@ -355,7 +359,7 @@ namespace Slic3r
         return labels;
     }
 
-    std::vector<int> KMediods2::assign_cluster_label(const std::vector<int>& center, const std::map<int, int>& unplaceable_limtis, const std::vector<int>& group_size, const FGStrategy& strategy)
+    std::vector<int> KMediods2::assign_cluster_label(const std::vector<int>& center, const std::map<int, int>& unplaceable_limtis, const std::vector<int>& group_size, const FGStrategy& strategy) const
     {
         struct Comp {
             bool operator()(const std::pair<int, int>& a, const std::pair<int, int>& b) {
@@ -419,7 +423,7 @@ namespace Slic3r
         return labels;
     }
 
-    int KMediods2::calc_cost(const std::vector<int>& labels, const std::vector<int>& medoids)
+    int KMediods2::calc_cost(const std::vector<int>& labels, const std::vector<int>& medoids) const
     {
         int total_cost = 0;
         for (int i = 0; i < m_elem_count; ++i)
@@ -427,11 +431,8 @@ namespace Slic3r
         return total_cost;
     }
 
-    void KMediods2::do_clustering(const FGStrategy& g_strategy, int timeout_ms)
+    void KMediods2::do_clustering(const FGStrategy& g_strategy, int max_evaluations)
     {
-        FlushTimeMachine T;
-        T.time_machine_start();
-
         if (m_elem_count < m_k) {
             m_cluster_labels = cluster_small_data(m_unplaceable_limits, m_max_cluster_size);
             {
@@ -446,9 +447,7 @@ namespace Slic3r
             return;
         }
 
-        std::vector<int>best_labels;
-        int best_cost = std::numeric_limits<int>::max();
-
+        std::vector<std::pair<int, int>> center_pairs;
         for (int center_0 = 0; center_0 < m_elem_count; ++center_0) {
             if (auto iter = m_unplaceable_limits.find(center_0); iter != m_unplaceable_limits.end() && iter->second == 0)
                 continue;
@@ -457,26 +456,39 @@ namespace Slic3r
                     continue;
                 if (auto iter = m_unplaceable_limits.find(center_1); iter != m_unplaceable_limits.end() && iter->second == 1)
                     continue;
+                center_pairs.emplace_back(center_0, center_1);
+            }
+        }
 
-                std::vector<int>new_centers = { center_0,center_1 };
-                std::vector<int>new_labels = assign_cluster_label(new_centers, m_unplaceable_limits, m_max_cluster_size, g_strategy);
+        // Evaluate the first max_evaluations center pairs concurrently, then
+        // collect the results in the order of the pairs.
+        if (center_pairs.size() > size_t(std::max(max_evaluations, 1)))
+            center_pairs.resize(size_t(std::max(max_evaluations, 1)));
+        std::vector<std::vector<int>> pair_labels(center_pairs.size());
+        std::vector<int> pair_costs(center_pairs.size(), 0);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, center_pairs.size()), [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t idx = range.begin(); idx < range.end(); ++idx) {
+                std::vector<int>new_centers = { center_pairs[idx].first, center_pairs[idx].second };
+                pair_labels[idx] = assign_cluster_label(new_centers, m_unplaceable_limits, m_max_cluster_size, g_strategy);
+                pair_costs[idx] = calc_cost(pair_labels[idx], new_centers);
+            }
+        });
 
-                int new_cost = calc_cost(new_labels, new_centers);
-                if (new_cost < best_cost) {
-                    best_cost = new_cost;
-                    best_labels = new_labels;
-                }
+        std::vector<int>best_labels;
+        int best_cost = std::numeric_limits<int>::max();
 
-                {
-                    MemoryedGroup g(new_labels,new_cost,1);
-                    update_memoryed_groups(g, memory_threshold, memoryed_groups);
-                }
+        for (size_t idx = 0; idx < center_pairs.size(); ++idx) {
+            if (pair_labels[idx].empty())
+                continue;
+            if (pair_costs[idx] < best_cost) {
+                best_cost = pair_costs[idx];
+                best_labels = pair_labels[idx];
+            }
 
-                if (T.time_machine_end() > timeout_ms)
-                    break;
+            {
+                MemoryedGroup g(pair_labels[idx], pair_costs[idx], 1);
+                update_memoryed_groups(g, memory_threshold, memoryed_groups);
             }
-            if (T.time_machine_end() > timeout_ms)
-                break;
         }
         this->m_cluster_labels = best_labels;
     }
@@ -489,7 +501,7 @@ namespace Slic3r
         if (used_filament_num < 10)
             return calc_min_flush_group_by_enum(used_filaments, cost);
         else
-            return calc_min_flush_group_by_pam2(used_filaments, cost, 500);
+            return calc_min_flush_group_by_pam2(used_filaments, cost);
     }
 
     std::unordered_map<int, std::vector<int>> FilamentGroup::try_merge_filaments()
@@ -575,7 +587,165 @@ namespace Slic3r
 
 
 
+    // Grouping results of recent slices. Slicing the same plate again (e.g. after
+    // changing a print setting) reuses the grouping instead of searching again.
+    struct FilamentGroupCache
+    {
+        struct Entry
+        {
+            std::vector<int> filament_map;
+            std::optional<int> cost;
+            std::vector<std::vector<int>> memoryed_groups;
+        };
+
+        static constexpr size_t max_entries = 8;
+
+        std::mutex mutex;
+        std::list<std::pair<std::string, Entry>> entries; // most recently used first
+        size_t hits = 0;
+        size_t misses = 0;
+    };
+
+    static FilamentGroupCache& filament_group_cache()
+    {
+        static FilamentGroupCache cache;
+        return cache;
+    }
+
+    std::string FilamentGroup::cache_key() const
+    {
+        std::string key;
+        auto put = [&key](const auto& value) {
+            key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+        auto put_str = [&key, &put](const std::string& str) {
+            put(str.size());
+            key += str;
+        };
+        auto put_filament = [&put, &put_str](const FilamentInfo& info) {
+            put(info.color.r); put(info.color.g); put(info.color.b); put(info.color.a);
+            put_str(info.type);
+            put(info.is_support);
+        };
+
+        const auto& model = ctx.model_info;
+        put(model.flush_matrix.size());
+        for (const FlushMatrix& matrix : model.flush_matrix) {
+            put(matrix.size());
+            for (const auto& row : matrix) {
+                put(row.size());
+                key.append(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(float));
+            }
+        }
+        put(model.layer_filaments.size());
+        for (size_t layer = 0; layer < model.layer_filaments.size(); ++layer) {
+            const auto& filaments = model.layer_filaments[layer];
+            put(filaments.size());
+            key.append(reinterpret_cast<const char*>(filaments.data()), filaments.size() * sizeof(unsigned int));
+            // The custom sequence only matters through what it returns per layer.
+            std::vector<int> custom_seq;
+            if (get_custom_seq && (*get_custom_seq)(int(layer), custom_seq)) {
+                put(custom_seq.size());
+                key.append(reinterpret_cast<const char*>(custom_seq.data()), custom_seq.size() * sizeof(int));
+            } else
+                put(size_t(-1));
+        }
+        put(model.filament_info.size());
+        for (const auto& info : model.filament_info)
+            put_filament(info);
+        put(model.filament_ids.size());
+        for (const auto& id : model.filament_ids)
+            put_str(id);
+        put(model.unprintable_filaments.size());
+        for (const auto& unprintables : model.unprintable_filaments) {
+            put(unprintables.size());
+            for (int f : unprintables)
+                put(f);
+        }
+
+        const auto& group = ctx.group_info;
+        put(group.total_filament_num); put(group.max_gap_threshold); put(group.mode); put(group.strategy);
+        put(group.ignore_ext_filament); put(group.max_cluster_evaluations); put(group.max_flush_evaluations);
+
+        const auto& machine = ctx.machine_info;
+        put(machine.max_group_size.size());
+        for (int size : machine.max_group_size)
+            put(size);
+        put(machine.machine_filament_info.size());
+        for (const auto& extruder_filaments : machine.machine_filament_info) {
+            put(extruder_filaments.size());
+            for (const auto& info : extruder_filaments) {
+                put_filament(info);
+                put(info.extruder_id);
+                put(info.is_extended);
+            }
+        }
+        put(machine.extruder_group_size.size());
+        for (const auto& [extruders, size] : machine.extruder_group_size) {
+            put(extruders.size());
+            for (int e : extruders)
+                put(e);
+            put(size);
+        }
+        put(machine.master_extruder_id);
+        return key;
+    }
+
     std::vector<int> FilamentGroup::calc_filament_group(int* cost)
+    {
+        FilamentGroupCache& cache = filament_group_cache();
+        const std::string key = cache_key();
+        {
+            std::lock_guard<std::mutex> lock(cache.mutex);
+            auto iter = std::find_if(cache.entries.begin(), cache.entries.end(), [&key](const auto& entry) { return entry.first == key; });
+            if (iter != cache.entries.end()) {
+                cache.entries.splice(cache.entries.begin(), cache.entries, iter);
+                ++cache.hits;
+                const FilamentGroupCache::Entry& entry = iter->second;
+                if (cost && entry.cost)
+                    *cost = *entry.cost;
+                m_memoryed_groups = entry.memoryed_groups;
+                return entry.filament_map;
+            }
+            ++cache.misses;
+        }
+
+        constexpr int cost_unset = std::numeric_limits<int>::min();
+        int new_cost = cost_unset;
+        std::vector<int> filament_map = calc_filament_group_uncached(&new_cost);
+
+        FilamentGroupCache::Entry entry;
+        entry.filament_map = filament_map;
+        if (new_cost != cost_unset) {
+            entry.cost = new_cost;
+            if (cost)
+                *cost = new_cost;
+        }
+        entry.memoryed_groups = m_memoryed_groups;
+        {
+            std::lock_guard<std::mutex> lock(cache.mutex);
+            cache.entries.emplace_front(key, std::move(entry));
+            if (cache.entries.size() > FilamentGroupCache::max_entries)
+                cache.entries.pop_back();
+        }
+        return filament_map;
+    }
+
+    size_t FilamentGroup::cache_hits()
+    {
+        FilamentGroupCache& cache = filament_group_cache();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        return cache.hits;
+    }
+
+    size_t FilamentGroup::cache_misses()
+    {
+        FilamentGroupCache& cache = filament_group_cache();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        return cache.misses;
+    }
+
+    std::vector<int> FilamentGroup::calc_filament_group_uncached(int* cost)
     {
         try {
             if (FGMode::MatchMode == ctx.group_info.mode)
@@ -774,25 +944,33 @@ namespace Slic3r
     }
 
 
-    // sorted used_filaments
-    std::vector<int> FilamentGroup::calc_min_flush_group_by_enum(const std::vector<unsigned int>& used_filaments, int* cost)
+    // labels are indexed like the sorted used filaments
+    int FilamentGroup::calc_prefer_level(const std::vector<int>& labels, const std::map<int, int>& unplaceable_limits) const
     {
         static constexpr int UNPLACEABLE_LIMIT_REWARD = 100;  // reward value if the group result follows the unprintable limit
         static constexpr int MAX_SIZE_LIMIT_REWARD = 10;    // reward value if the group result follows the max size per extruder
         static constexpr int BEST_FIT_LIMIT_REWARD = 1;     // reward value if the group result try to fill the max size per extruder
 
-        MemoryedGroupHeap memoryed_groups;
+        std::vector<std::set<int>>groups(2);
+        for (int j = 0; j < (int)labels.size(); ++j)
+            groups[labels[j]].insert(j);
 
-        auto bit_count_one = [](uint64_t n)
-            {
-                int count = 0;
-                while (n != 0)
-                {
-                    n &= n - 1;
-                    count++;
-                }
-                return count;
-            };
+        int prefer_level = 0;
+
+        if (check_printable(groups, unplaceable_limits))
+            prefer_level += UNPLACEABLE_LIMIT_REWARD;
+        if (groups[0].size() <= ctx.machine_info.max_group_size[0] && groups[1].size() <= ctx.machine_info.max_group_size[1])
+            prefer_level += MAX_SIZE_LIMIT_REWARD;
+        if (FGStrategy::BestFit == ctx.group_info.strategy && groups[0].size() >= ctx.machine_info.max_group_size[0] && groups[1].size() >= ctx.machine_info.max_group_size[1])
+            prefer_level += BEST_FIT_LIMIT_REWARD;
+
+        return prefer_level;
+    }
+
+    // sorted used_filaments
+    std::vector<int> FilamentGroup::calc_min_flush_group_by_enum(const std::vector<unsigned int>& used_filaments, int* cost)
+    {
+        MemoryedGroupHeap memoryed_groups;
 
         std::map<int, int>unplaceable_limit_indices;
         extract_unprintable_limit_indices(ctx.model_info.unprintable_filaments, used_filaments, unplaceable_limit_indices);
@@ -800,44 +978,39 @@ namespace Slic3r
         int used_filament_num = used_filaments.size();
         uint64_t max_group_num = (static_cast<uint64_t>(1) << used_filament_num);
 
+        auto mask_to_labels = [used_filament_num](uint64_t mask) {
+            std::vector<int>filament_maps(used_filament_num);
+            for (int j = 0; j < used_filament_num; ++j)
+                filament_maps[j] = (mask & (static_cast<uint64_t>(1) << j)) ? 1 : 0;
+            return filament_maps;
+        };
+
+        // Every grouping is evaluated over all layers, spread them over the cores.
+        std::vector<int> mask_costs(max_group_num, 0);
+        std::vector<int> mask_prefer_levels(max_group_num, 0);
+        tbb::parallel_for(tbb::blocked_range<uint64_t>(0, max_group_num), [&](const tbb::blocked_range<uint64_t>& range) {
+            for (uint64_t i = range.begin(); i < range.end(); ++i) {
+                std::vector<int>filament_maps = mask_to_labels(i);
+                mask_prefer_levels[i] = calc_prefer_level(filament_maps, unplaceable_limit_indices);
+                mask_costs[i] = reorder_filaments_for_minimum_flush_volume(
+                    used_filaments,
+                    filament_maps,
+                    ctx.model_info.layer_filaments,
+                    ctx.model_info.flush_matrix,
+                    get_custom_seq,
+                    nullptr
+                );
+            }
+        });
+
         int best_cost = std::numeric_limits<int>::max();
         std::vector<int>best_label;
         int best_prefer_level = 0;
 
         for (uint64_t i = 0; i < max_group_num; ++i) {
-            std::vector<std::set<int>>groups(2);
-            for (int j = 0; j < used_filament_num; ++j) {
-                if (i & (static_cast<uint64_t>(1) << j))
-                    groups[1].insert(j);
-                else
-                    groups[0].insert(j);
-            }
-
-            int prefer_level = 0;
-
-            if (check_printable(groups, unplaceable_limit_indices))
-                prefer_level += UNPLACEABLE_LIMIT_REWARD;
-            if (groups[0].size() <= ctx.machine_info.max_group_size[0] && groups[1].size() <= ctx.machine_info.max_group_size[1])
-                prefer_level += MAX_SIZE_LIMIT_REWARD;
-            if (FGStrategy::BestFit == ctx.group_info.strategy && groups[0].size() >= ctx.machine_info.max_group_size[0] && groups[1].size() >= ctx.machine_info.max_group_size[1])
-                prefer_level += BEST_FIT_LIMIT_REWARD;
-
-            std::vector<int>filament_maps(used_filament_num);
-            for (int i = 0; i < used_filament_num; ++i) {
-                if (groups[0].find(i) != groups[0].end())
-                    filament_maps[i] = 0;
-                if (groups[1].find(i) != groups[1].end())
-                    filament_maps[i] = 1;
-            }
-
-            int total_cost = reorder_filaments_for_minimum_flush_volume(
-                used_filaments,
-                filament_maps,
-                ctx.model_info.layer_filaments,
-                ctx.model_info.flush_matrix,
-                get_custom_seq,
-                nullptr
-            );
+            int prefer_level = mask_prefer_levels[i];
+            int total_cost = mask_costs[i];
+            std::vector<int>filament_maps = mask_to_labels(i);
 
             if (prefer_level > best_prefer_level || (prefer_level == best_prefer_level && total_cost < best_cost)) {
                 best_prefer_level = prefer_level;
@@ -865,7 +1038,7 @@ namespace Slic3r
     }
 
     // sorted used_filaments
-    std::vector<int> FilamentGroup::calc_min_flush_group_by_pam2(const std::vector<unsigned int>& used_filaments, int* cost, int timeout_ms)
+    std::vector<int> FilamentGroup::calc_min_flush_group_by_pam2(const std::vector<unsigned int>& used_filaments, int* cost)
     {
         std::vector<int>filament_labels_ret(ctx.group_info.total_filament_num, ctx.machine_info.master_extruder_id);
 
@@ -877,7 +1050,7 @@ namespace Slic3r
         PAM.set_max_cluster_size(ctx.machine_info.max_group_size);
         PAM.set_unplaceable_limits(unplaceable_limits);
         PAM.set_memory_threshold(ctx.group_info.max_gap_threshold);
-        PAM.do_clustering(ctx.group_info.strategy, timeout_ms);
+        PAM.do_clustering(ctx.group_info.strategy, ctx.group_info.max_cluster_evaluations);
 
         std::vector<int>filament_labels = PAM.get_cluster_labels();
 
@@ -886,14 +1059,86 @@ namespace Slic3r
             change_memoryed_heaps_to_arrays(memoryed_groups, ctx.group_info.total_filament_num, used_filaments, m_memoryed_groups);
         }
 
+        // Clustering works on an estimated distance, improve its result with the real flush volume.
+        int labels_cost = reorder_filaments_for_minimum_flush_volume(used_filaments, filament_labels, ctx.model_info.layer_filaments, ctx.model_info.flush_matrix, std::nullopt, nullptr);
+        filament_labels = improve_flush_group(used_filaments, filament_labels, labels_cost, ctx.group_info.max_flush_evaluations);
+
         if (cost)
-            *cost = reorder_filaments_for_minimum_flush_volume(used_filaments, filament_labels, ctx.model_info.layer_filaments, ctx.model_info.flush_matrix, std::nullopt, nullptr);
+            *cost = labels_cost;
 
         for (int i = 0; i < filament_labels.size(); ++i)
             filament_labels_ret[used_filaments[i]] = filament_labels[i];
         return filament_labels_ret;
     }
 
-}
+    // Local search from a given grouping: move a single filament to the other
+    // extruder or swap two filaments between them, and keep the best move as long
+    // as it lowers the flush volume without breaking more constraints. Stops at a
+    // local optimum or after max_evaluations flush volume evaluations, so the
+    // result is never worse than the input. The flush volume is evaluated without
+    // the custom sequences, as the cost reported by calc_min_flush_group_by_pam2().
+    std::vector<int> FilamentGroup::improve_flush_group(const std::vector<unsigned int>& used_filaments, const std::vector<int>& labels, int& cost, int max_evaluations)
+    {
+        std::map<int, int>unplaceable_limits;
+        extract_unprintable_limit_indices(ctx.model_info.unprintable_filaments, used_filaments, unplaceable_limits);
+
+        std::vector<int> best_labels = labels;
+        int best_prefer_level = calc_prefer_level(best_labels, unplaceable_limits);
+        const int n = (int)best_labels.size();
+
+        while (max_evaluations > 0) {
+            std::vector<std::vector<int>> candidates;
+            for (int i = 0; i < n; ++i) {
+                std::vector<int> moved = best_labels;
+                moved[i] = 1 - moved[i];
+                candidates.emplace_back(std::move(moved));
+            }
+            for (int i = 0; i < n; ++i)
+                for (int j = i + 1; j < n; ++j)
+                    if (best_labels[i] != best_labels[j]) {
+                        std::vector<int> swapped = best_labels;
+                        std::swap(swapped[i], swapped[j]);
+                        candidates.emplace_back(std::move(swapped));
+                    }
 
+            // Only the candidates keeping the constraints are evaluated, the first ones
+            // in the order of the moves once the budget is short.
+            constexpr int not_evaluated = std::numeric_limits<int>::max();
+            std::vector<int> candidate_costs(candidates.size(), not_evaluated);
+            std::vector<int> candidate_prefer_levels(candidates.size(), 0);
+            std::vector<size_t> evaluated;
+            for (size_t idx = 0; idx < candidates.size() && int(evaluated.size()) < max_evaluations; ++idx) {
+                candidate_prefer_levels[idx] = calc_prefer_level(candidates[idx], unplaceable_limits);
+                if (candidate_prefer_levels[idx] >= best_prefer_level)
+                    evaluated.emplace_back(idx);
+            }
+            max_evaluations -= int(evaluated.size());
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, evaluated.size()), [&](const tbb::blocked_range<size_t>& range) {
+                for (size_t i = range.begin(); i < range.end(); ++i)
+                    candidate_costs[evaluated[i]] = reorder_filaments_for_minimum_flush_volume(used_filaments, candidates[evaluated[i]], ctx.model_info.layer_filaments,
+                        ctx.model_info.flush_matrix, std::nullopt, nullptr);
+            });
 
+            int best_idx = -1;
+            int new_prefer_level = best_prefer_level;
+            int new_cost = cost;
+            for (size_t idx = 0; idx < candidates.size(); ++idx) {
+                if (candidate_costs[idx] == not_evaluated)
+                    continue;
+                if (candidate_prefer_levels[idx] > new_prefer_level || (candidate_prefer_levels[idx] == new_prefer_level && candidate_costs[idx] < new_cost)) {
+                    best_idx = (int)idx;
+                    new_prefer_level = candidate_prefer_levels[idx];
+                    new_cost = candidate_costs[idx];
+                }
+            }
+            if (best_idx < 0)
+                break;
+
+            best_labels = std::move(candidates[best_idx]);
+            best_prefer_level = new_prefer_level;
+            cost = new_cost;
+        }
+        return best_labels;
+    }
+
+}
@@ -8,6 +8,7 @@
 #include <map>
 #include <vector>
 #include <queue>
+#include <string>
 #include "GCode/ToolOrderUtils.hpp"
 #include "FilamentGroupUtils.hpp"
 
@@ -42,7 +43,7 @@ namespace Slic3r
                 start = std::chrono::high_resolution_clock::now();
             }
 
-            int time_machine_end()
+            int time_machine_end() const
             {
                 auto end = std::chrono::high_resolution_clock::now();
                 auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
@@ -83,6 +84,10 @@ namespace Slic3r
             FGMode mode;
             FGStrategy strategy;
             bool ignore_ext_filament;  //wai gua filament
+            // Groups are enumerated up to 9 filaments. Past that, the search is bounded by a number of evaluations instead of time,
+            // so that the same plate always gets the same groups.
+            int max_cluster_evaluations{ 1024 };  // center pairs tried by the clustering
+            int max_flush_evaluations{ 512 };     // flush volume evaluations of the local search refining the clustering result
         } group_info;
 
         struct MachineInfo {
@@ -126,14 +131,22 @@ namespace Slic3r
         std::vector<int> calc_filament_group(int * cost = nullptr);
         std::vector<std::vector<int>> get_memoryed_groups()const { return m_memoryed_groups; }
 
+        // Statistics of the grouping results reused from recent slices by calc_filament_group().
+        static size_t cache_hits();
+        static size_t cache_misses();
+
     public:
         std::vector<int> calc_filament_group_for_match(int* cost = nullptr);
         std::vector<int> calc_filament_group_for_flush(int* cost = nullptr);
 
     private:
+        std::vector<int> calc_filament_group_uncached(int* cost = nullptr);
         std::vector<int> calc_min_flush_group(int* cost = nullptr);
         std::vector<int> calc_min_flush_group_by_enum(const std::vector<unsigned int>& used_filaments, int* cost = nullptr);
-        std::vector<int> calc_min_flush_group_by_pam2(const std::vector<unsigned int>& used_filaments, int* cost = nullptr, int timeout_ms = 300);
+        std::vector<int> calc_min_flush_group_by_pam2(const std::vector<unsigned int>& used_filaments, int* cost = nullptr);
+        std::vector<int> improve_flush_group(const std::vector<unsigned int>& used_filaments, const std::vector<int>& labels, int& cost, int max_evaluations);
+        int calc_prefer_level(const std::vector<int>& labels, const std::map<int, int>& unplaceable_limits) const;
+        std::string cache_key() const;
 
         std::unordered_map<int, std::vector<int>> try_merge_filaments();
         void rebuild_context(const std::unordered_map<int, std::vector<int>>& merged_filaments);
@@ -173,7 +186,7 @@ namespace Slic3r
         // key stores elem idx, value stores the cluster id that elem cnanot be placed
         void set_unplaceable_limits(const std::map<int, int>& placeable_limits) { m_unplaceable_limits = placeable_limits; }
 
-        void do_clustering(const FGStrategy& g_strategy,int timeout_ms = 100);
+        void do_clustering(const FGStrategy& g_strategy, int max_evaluations = 1024);
 
         void set_memory_threshold(double threshold) { memory_threshold = threshold; }
         MemoryedGroupHeap get_memoryed_groups()const { return memoryed_groups; }
@@ -182,8 +195,8 @@ namespace Slic3r
 
     private:
         std::vector<int>cluster_small_data(const std::map<int, int>& unplaceable_limits, const std::vector<int>& group_size);
-        std::vector<int>assign_cluster_label(const std::vector<int>& center, const std::map<int, int>& unplaceable_limits, const std::vector<int>& group_size, const FGStrategy& strategy);
-        int calc_cost(const std::vector<int>& labels, const std::vector<int>& medoids);
+        std::vector<int>assign_cluster_label(const std::vector<int>& center, const std::map<int, int>& unplaceable_limits, const std::vector<int>& group_size, const FGStrategy& strategy) const;
+        int calc_cost(const std::vector<int>& labels, const std::vector<int>& medoids) const;
     protected:
         FilamentGroupUtils::MemoryedGroupHeap memoryed_groups;
         std::shared_ptr<FlushDistanceEvaluator> m_evaluator;
@@ -9,6 +9,7 @@
 #include "libslic3r/SLAPrint.hpp"
 
 #include <sstream>
+#include <chrono>
 
 #include "libslic3r/Exception.hpp"
 #include "libslic3r/SlicesToTriangleMesh.hpp"
@@ -500,14 +501,24 @@ void SL1Archive::export_print(Zipper& zipper,
         zipper.add_entry("prusaslicer.ini");
         zipper << to_ini(slicerconf);
         
-        size_t i = 0;
-        for (const sla::EncodedRaster &rst : m_layers) {
-
-            std::string imgname = project + string_printf("%.5d", i++) + "." +
+        // The layers are encoded as PNG already, they are stored without
+        // deflating them again, which was the bottleneck of the export.
+        // They are read back from the layers file one at a time.
+        auto   start = std::chrono::steady_clock::now();
+        size_t bytes = 0;
+        for (size_t i = 0; i < m_layers.size(); ++ i) {
+            sla::EncodedRaster rst = this->read_layer(i);
+
+            std::string imgname = project + string_printf("%.5d", i) + "." +
                                   rst.extension();
             
-            zipper.add_entry(imgname.c_str(), rst.data(), rst.size());
+            zipper.add_entry(imgname.c_str(), rst.data(), rst.size(), Zipper::NO_COMPRESSION);
+            bytes += rst.size();
         }
+
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        BOOST_LOG_TRIVIAL(info) << "SL1 export: " << m_layers.size() << " layers, " << bytes / (1024. * 1024.)
+                                << " MB written in " << secs << " s";
     } catch(std::exception& e) {
         BOOST_LOG_TRIVIAL(error) << e.what();
         // Rethrow the exception
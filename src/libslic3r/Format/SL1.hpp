@@ -33,7 +33,7 @@ public:
         auto diff = m_cfg.diff(cfg);
         if (!diff.empty()) {
             m_cfg.apply_only(cfg, diff);
-            m_layers = {};
+            this->clear_layers();
         }
     }
 };
@@ -6531,7 +6531,14 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
             }
             // BBS: use G1 if not enable arc fitting or has no arc fitting result or in spiral_mode mode or we are doing sloped extrusion
             // Attention: G2 and G3 is not supported in spiral_mode mode
-            if (!m_config.enable_arc_fitting || path.polyline.fitting_result.empty() || m_config.spiral_mode || sloped != nullptr) {
+            if ((!m_config.enable_arc_fitting || path.polyline.fitting_result.empty() || m_config.spiral_mode) && sloped == nullptr && !_needSAFC(path)) {
+                // Plain extrusion with the same E per mm over the whole path: calculate the segments in a batch
+                // and format the G1 lines directly into the G-code.
+                extrusion_segments(path.polyline.points, 0, path.polyline.points.size() - 1, m_origin, EXTRUDER_CONFIG(extruder_offset),
+                                   e_per_mm, m_extrusion_points, m_extrusion_dEs);
+                m_writer.extrude_polyline_to_xy(m_extrusion_points, m_extrusion_dEs, GCodeWriter::full_gcode_comment ? description : "",
+                                                path.is_force_no_extrusion(), gcode);
+            } else if (!m_config.enable_arc_fitting || path.polyline.fitting_result.empty() || m_config.spiral_mode || sloped != nullptr) {
                 double path_length = 0.;
                 double total_length = sloped == nullptr ? 0. : path.polyline.length() * SCALING_FACTOR;
                 for (const Line& line : path.polyline.lines()) {
@@ -6575,6 +6582,13 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
                     case EMovePathType::Linear_move: {
                         size_t start_index = fitting_result[fitting_index].start_point_index;
                         size_t end_index = fitting_result[fitting_index].end_point_index;
+                        if (!_needSAFC(path)) {
+                            extrusion_segments(path.polyline.points, start_index, end_index, m_origin, EXTRUDER_CONFIG(extruder_offset),
+                                               e_per_mm, m_extrusion_points, m_extrusion_dEs);
+                            m_writer.extrude_polyline_to_xy(m_extrusion_points, m_extrusion_dEs, GCodeWriter::full_gcode_comment ? description : "",
+                                                            path.is_force_no_extrusion(), gcode);
+                            break;
+                        }
                         for (size_t point_index = start_index + 1; point_index < end_index + 1; point_index++) {
                             tempDescription = description;
                             const Line line = Line(path.polyline.points[point_index - 1], path.polyline.points[point_index]);
@@ -7578,6 +7592,34 @@ Vec2d GCode::point_to_gcode_quantized(const Point& point) const
     return { GCodeFormatter::quantize_xyzf(p.x()), GCodeFormatter::quantize_xyzf(p.y()) };
 }
 
+void GCode::extrusion_segments(const Points &points, size_t first, size_t last, const Vec2d &origin, const Vec2d &extruder_offset,
+                               double e_per_mm, std::vector<Vec2d> &out_points, std::vector<double> &out_dEs)
+{
+    out_points.clear();
+    out_dEs.clear();
+    if (points.empty() || last <= first)
+        return;
+    assert(last < points.size());
+
+    // Lengths of all the segments first, the loop has no branches and it is vectorized.
+    const size_t num_segments = last - first;
+    out_dEs.resize(num_segments);
+    for (size_t i = 0; i < num_segments; ++ i)
+        out_dEs[i] = Line(points[first + i], points[first + i + 1]).length() * SCALING_FACTOR;
+
+    // Drop the short segments, calculate the end points and E of the others the same way as the per segment extrusion does.
+    out_points.reserve(num_segments);
+    size_t num_extruded = 0;
+    for (size_t i = 0; i < num_segments; ++ i) {
+        const double line_length = out_dEs[i];
+        if (line_length < EPSILON)
+            continue;
+        out_points.emplace_back(unscale(points[first + i + 1]) + origin - extruder_offset);
+        out_dEs[num_extruded ++] = e_per_mm * line_length;
+    }
+    out_dEs.resize(num_extruded);
+}
+
 
 // Goes through by_region std::vector and returns reference to a subvector of entities, that are to be printed
 // during infill/perimeter wiping, or normally (depends on wiping_entities parameter)
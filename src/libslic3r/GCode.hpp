@@ -224,6 +224,10 @@ public:
     Vec2d           point_to_gcode(const Point &point) const;
     Point           gcode_to_point(const Vec2d &point) const;
     Vec2d point_to_gcode_quantized(const Point& point) const;
+    // End points in G-code coordinates (see point_to_gcode()) and E deltas of the segments of points[first, last],
+    // skipping the segments shorter than EPSILON. The buffers are reused, thus they are not reallocated for each path.
+    static void     extrusion_segments(const Points &points, size_t first, size_t last, const Vec2d &origin, const Vec2d &extruder_offset,
+                                       double e_per_mm, std::vector<Vec2d> &out_points, std::vector<double> &out_dEs);
     const FullPrintConfig &config() const { return m_config; }
     const Layer*    layer() const { return m_layer; }
     GCodeWriter&    writer() { return m_writer; }
@@ -597,6 +601,9 @@ private:
     std::unique_ptr<WipeTowerIntegration> m_wipe_tower;
 
     std::unique_ptr<SmallAreaInfillFlowCompensator> m_small_area_infill_flow_compensator;
+    // Buffers of extrusion_segments() for the paths extruded by G1 lines.
+    std::vector<Vec2d>                  m_extrusion_points;
+    std::vector<double>                 m_extrusion_dEs;
     
     // Heights (print_z) at which the skirt has already been extruded.
     std::vector<coordf_t>               m_skirt_done;
@@ -0,0 +1,813 @@
+#include "BinaryGCode.hpp"
+#include "Thumbnails.hpp"
+
+#include "../Exception.hpp"
+#include "../Utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/beast/core/detail/base64.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/cstdio.hpp>
+
+#include <miniz.h>
+
+#include <tbb/parallel_for.h>
+
+namespace Slic3r::BinaryGCode {
+
+static constexpr const char     FileMagic[4]    = { 'O', 'B', 'G', 'C' };
+static constexpr const char     TrailerMagic[4] = { 'O', 'B', 'G', 'I' };
+static constexpr const uint32_t FormatVersion   = 1;
+// Deflate does not compress better than about 1032:1, a block header claiming more is corrupted.
+static constexpr const uint64_t MaxDeflateRatio = 1032;
+static constexpr const size_t   FileHeaderSize  = 16;
+static constexpr const size_t   BlockHeaderSize = 16;
+static constexpr const size_t   TrailerSize     = 12;
+
+// Little endian serialization.
+template<typename T> static void put(std::string &out, T value)
+{
+    for (size_t i = 0; i < sizeof(T); ++ i)
+        out.push_back(char((uint64_t(value) >> (8 * i)) & 0xFF));
+}
+
+static void put_float(std::string &out, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put(out, bits);
+}
+
+static void put_str(std::string &out, std::string_view str)
+{
+    put(out, uint32_t(str.size()));
+    out.append(str.data(), str.size());
+}
+
+class Cursor
+{
+public:
+    Cursor(const char *begin, const char *end) : m_ptr(begin), m_end(end) {}
+    Cursor(const std::string &data) : Cursor(data.data(), data.data() + data.size()) {}
+
+    template<typename T> T get()
+    {
+        this->require(sizeof(T));
+        uint64_t value = 0;
+        for (size_t i = 0; i < sizeof(T); ++ i)
+            value |= uint64_t((unsigned char)m_ptr[i]) << (8 * i);
+        m_ptr += sizeof(T);
+        return T(value);
+    }
+
+    float get_float()
+    {
+        uint32_t bits = this->get<uint32_t>();
+        float    value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::string get_str(size_t len)
+    {
+        this->require(len);
+        std::string out(m_ptr, len);
+        m_ptr += len;
+        return out;
+    }
+
+    std::string get_str() { return this->get_str(this->get<uint32_t>()); }
+    std::string get_rest() { return this->get_str(size_t(m_end - m_ptr)); }
+    size_t      remaining() const { return size_t(m_end - m_ptr); }
+
+private:
+    void require(size_t len) const
+    {
+        if (size_t(m_end - m_ptr) < len)
+            throw Slic3r::RuntimeError("Binary G-code is corrupted: a block is shorter than expected.");
+    }
+
+    const char *m_ptr;
+    const char *m_end;
+};
+
+static bool seek(FILE *f, uint64_t pos)
+{
+#ifdef _WIN32
+    return _fseeki64(f, int64_t(pos), SEEK_SET) == 0;
+#else
+    return fseeko(f, off_t(pos), SEEK_SET) == 0;
+#endif
+}
+
+static std::string compress_block(const std::string &src, int level)
+{
+    mz_ulong    len = mz_compressBound(mz_ulong(src.size()));
+    std::string out(len, '\0');
+    if (mz_compress2((unsigned char*)out.data(), &len, (const unsigned char*)src.data(), mz_ulong(src.size()), level) != MZ_OK)
+        throw Slic3r::RuntimeError("Binary G-code export failed: compression error.");
+    out.resize(len);
+    return out;
+}
+
+static void decompress_block(const std::string &src, size_t size, std::string &out)
+{
+    out.resize(size);
+    mz_ulong len = mz_ulong(size);
+    if (mz_uncompress((unsigned char*)out.data(), &len, (const unsigned char*)src.data(), mz_ulong(src.size())) != MZ_OK || len != size)
+        throw Slic3r::RuntimeError("Binary G-code is corrupted: a block cannot be decompressed.");
+}
+
+static uint32_t block_crc(const std::string &data)
+{
+    return uint32_t(mz_crc32(MZ_CRC32_INIT, (const unsigned char*)data.data(), data.size()));
+}
+
+static std::string serialize_metadata(const Metadata &metadata)
+{
+    std::string out;
+    put(out, uint32_t(metadata.size()));
+    for (const auto &[key, value] : metadata) {
+        put_str(out, key);
+        put_str(out, value);
+    }
+    return out;
+}
+
+static Metadata deserialize_metadata(const std::string &data)
+{
+    Cursor   cursor(data);
+    Metadata out(cursor.get<uint32_t>());
+    for (auto &[key, value] : out) {
+        key   = cursor.get_str();
+        value = cursor.get_str();
+    }
+    return out;
+}
+
+static bool starts_with(std::string_view str, std::string_view prefix)
+{
+    return str.size() >= prefix.size() && str.compare(0, prefix.size(), prefix) == 0;
+}
+
+// The line without its end of line.
+static std::string_view line_content(std::string_view line)
+{
+    while (! line.empty() && (line.back() == '\n' || line.back() == '\r'))
+        line.remove_suffix(1);
+    return line;
+}
+
+Writer::Writer(const std::string &path, const WriterParams &params) : m_path(path), m_params(params)
+{
+    m_file = boost::nowide::fopen(path.c_str(), "wb");
+    if (m_file == nullptr)
+        throw Slic3r::RuntimeError(std::string("Binary G-code export to ") + path + " failed.\nCannot open the file for writing.\n");
+
+    std::string header(FileMagic, sizeof(FileMagic));
+    put(header, FormatVersion);
+    put(header, uint32_t(m_params.block_size));
+    put(header, uint32_t(0));
+    assert(header.size() == FileHeaderSize);
+    this->write_raw(header.data(), header.size());
+}
+
+Writer::~Writer()
+{
+    if (m_file != nullptr) {
+        // Not finished, the file is not valid.
+        ::fclose(m_file);
+        boost::nowide::remove(m_path.c_str());
+    }
+}
+
+void Writer::write(const char *data, size_t len)
+{
+    m_text.append(data, len);
+    // Scan the lines completed by the new data.
+    for (;;) {
+        const char *begin = m_text.data() + m_scan_pos;
+        const char *eol   = (const char*)memchr(begin, '\n', m_text.size() - m_scan_pos);
+        if (eol == nullptr)
+            break;
+        this->scan_line(begin, eol + 1);
+        m_scan_pos = eol + 1 - m_text.data();
+        ++ m_lines_count;
+    }
+    m_text_offset += len;
+    // Close the blocks at the first end of line past the block size.
+    while (m_scan_pos > m_params.block_size) {
+        const char *eol = (const char*)memchr(m_text.data() + m_params.block_size - 1, '\n', m_scan_pos - m_params.block_size + 1);
+        assert(eol != nullptr);
+        this->queue_block(eol + 1 - m_text.data());
+    }
+}
+
+void Writer::scan_line(const char *begin, const char *end)
+{
+    const std::string_view line(begin, end - begin);
+    if (line[0] != ';')
+        return;
+    if (starts_with(line, ";LAYER_CHANGE") || starts_with(line, "; CHANGE_LAYER")) {
+        m_layers.push_back({ m_lines_count, 0.f });
+        m_layer_z_pending = true;
+    } else if (m_layer_z_pending) {
+        const size_t tag_len = starts_with(line, ";Z:") ? 3 : starts_with(line, "; Z_HEIGHT: ") ? 12 : 0;
+        if (tag_len > 0) {
+            m_layers.back().z = float(atof(std::string(line.substr(tag_len)).c_str()));
+            m_layer_z_pending = false;
+        }
+    }
+}
+
+void Writer::queue_block(size_t len)
+{
+    PendingBlock &block = m_pending.emplace_back();
+    block.text          = m_text.substr(0, len);
+    block.first_line    = m_block_first_line;
+    block.text_offset   = m_block_text_offset;
+    m_block_first_line  += std::count(block.text.begin(), block.text.end(), '\n');
+    m_block_text_offset += len;
+    m_text.erase(0, len);
+    m_scan_pos -= std::min(m_scan_pos, len);
+    if (m_pending.size() >= m_params.parallel_blocks)
+        this->flush_blocks();
+}
+
+void Writer::flush_blocks()
+{
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_pending.size()), [this](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            PendingBlock &block = m_pending[i];
+            if (m_params.compression_level > 0)
+                block.stored = compress_block(block.text, m_params.compression_level);
+            if (m_params.compression_level > 0 && block.stored.size() < block.text.size())
+                block.compression = Compression::Deflate;
+            else {
+                block.stored      = std::move(block.text);
+                block.compression = Compression::None;
+            }
+        }
+    });
+    for (PendingBlock &block : m_pending) {
+        const size_t text_size = block.compression == Compression::None ? block.stored.size() : block.text.size();
+        this->write_block(BlockType::GCode, block.compression, uint32_t(text_size), block.stored, block.first_line, block.text_offset);
+    }
+    m_pending.clear();
+}
+
+void Writer::add_metadata(BlockType type, const Metadata &metadata)
+{
+    assert(type == BlockType::FileMetadata || type == BlockType::PrintMetadata);
+    const std::string payload = serialize_metadata(metadata);
+    if (m_params.compression_level > 0)
+        this->write_block(type, Compression::Deflate, uint32_t(payload.size()), compress_block(payload, m_params.compression_level));
+    else
+        this->write_block(type, Compression::None, uint32_t(payload.size()), payload);
+}
+
+void Writer::add_thumbnail(const Thumbnail &thumbnail)
+{
+    std::string payload;
+    put(payload, uint64_t(thumbnail.line));
+    put(payload, thumbnail.width);
+    put(payload, thumbnail.height);
+    put(payload, uint16_t(thumbnail.tag.size()));
+    payload += thumbnail.tag;
+    // The images are compressed already.
+    payload += thumbnail.data;
+    this->write_block(BlockType::Thumbnail, Compression::None, uint32_t(payload.size()), payload);
+}
+
+void Writer::finish()
+{
+    // A last line without an end of line is a line as well.
+    const bool last_line_open = ! m_text.empty() && m_text.back() != '\n';
+    if (! m_text.empty())
+        this->queue_block(m_text.size());
+    this->flush_blocks();
+
+    std::string index;
+    put(index, uint64_t(m_lines_count + (last_line_open ? 1 : 0)));
+    put(index, uint64_t(m_text_offset));
+    put(index, uint32_t(m_index.size()));
+    for (const IndexEntry &entry : m_index) {
+        put(index, uint16_t(entry.type));
+        put(index, entry.file_offset);
+        put(index, entry.first_line);
+        put(index, entry.text_offset);
+    }
+    put(index, uint32_t(m_layers.size()));
+    for (const Layer &layer : m_layers) {
+        put(index, uint64_t(layer.first_line));
+        put_float(index, layer.z);
+    }
+    const uint64_t index_offset = m_file_pos;
+    this->write_block(BlockType::Index, Compression::Deflate, uint32_t(index.size()), compress_block(index, 6));
+
+    std::string trailer;
+    put(trailer, index_offset);
+    trailer.append(TrailerMagic, sizeof(TrailerMagic));
+    assert(trailer.size() == TrailerSize);
+    this->write_raw(trailer.data(), trailer.size());
+
+    const bool failed = ::fclose(m_file) != 0;
+    m_file = nullptr;
+    if (failed) {
+        boost::nowide::remove(m_path.c_str());
+        throw Slic3r::RuntimeError(std::string("Binary G-code export to ") + m_path + " failed.\nIs the disk full?\n");
+    }
+}
+
+void Writer::write_block(BlockType type, Compression compression, uint32_t uncompressed_size, const std::string &stored,
+                         uint64_t first_line, uint64_t text_offset)
+{
+    if (type != BlockType::Index)
+        m_index.push_back({ type, m_file_pos, first_line, text_offset });
+    std::string header;
+    put(header, uint16_t(type));
+    put(header, uint16_t(compression));
+    put(header, uncompressed_size);
+    put(header, uint32_t(stored.size()));
+    put(header, block_crc(stored));
+    assert(header.size() == BlockHeaderSize);
+    this->write_raw(header.data(), header.size());
+    this->write_raw(stored.data(), stored.size());
+}
+
+void Writer::write_raw(const void *data, size_t len)
+{
+    if (len > 0 && ::fwrite(data, 1, len, m_file) != len) {
+        ::fclose(m_file);
+        m_file = nullptr;
+        boost::nowide::remove(m_path.c_str());
+        throw Slic3r::RuntimeError(std::string("Binary G-code export to ") + m_path + " failed.\nIs the disk full?\n");
+    }
+    m_file_pos += len;
+}
+
+Reader::Reader(const std::string &path) : m_path(path)
+{
+    m_file = boost::nowide::fopen(path.c_str(), "rb");
+    if (m_file == nullptr)
+        throw Slic3r::RuntimeError(std::string("Cannot open binary G-code ") + path + " for reading.");
+
+    char header[FileHeaderSize];
+    if (::fread(header, 1, FileHeaderSize, m_file) != FileHeaderSize || memcmp(header, FileMagic, sizeof(FileMagic)) != 0)
+        throw Slic3r::RuntimeError(path + " is not a binary G-code.");
+    if (Cursor(header + 4, header + 8).get<uint32_t>() > FormatVersion)
+        throw Slic3r::RuntimeError(path + " was written by a newer version of the binary G-code format.");
+
+    char trailer[TrailerSize];
+#ifdef _WIN32
+    const bool trailer_found = _fseeki64(m_file, -int64_t(TrailerSize), SEEK_END) == 0;
+#else
+    const bool trailer_found = fseeko(m_file, -off_t(TrailerSize), SEEK_END) == 0;
+#endif
+    if (! trailer_found || ::fread(trailer, 1, TrailerSize, m_file) != TrailerSize || memcmp(trailer + 8, TrailerMagic, sizeof(TrailerMagic)) != 0)
+        throw Slic3r::RuntimeError(std::string("Binary G-code ") + path + " has no index, the file is probably truncated.");
+#ifdef _WIN32
+    m_file_size = uint64_t(_ftelli64(m_file));
+#else
+    m_file_size = uint64_t(ftello(m_file));
+#endif
+
+    const std::string index_payload = this->read_payload(Cursor(trailer, trailer + 8).get<uint64_t>(), BlockType::Index);
+    Cursor            index(index_payload);
+    m_lines_count = size_t(index.get<uint64_t>());
+    m_text_size   = size_t(index.get<uint64_t>());
+    for (uint32_t i = index.get<uint32_t>(); i > 0; -- i) {
+        const auto     type        = BlockType(index.get<uint16_t>());
+        const uint64_t file_offset = index.get<uint64_t>();
+        const uint64_t first_line  = index.get<uint64_t>();
+        const uint64_t text_offset = index.get<uint64_t>();
+        switch (type) {
+        case BlockType::GCode:
+            if (! m_blocks.empty())
+                m_blocks.back().text_size = text_offset - m_blocks.back().text_offset;
+            m_blocks.push_back({ file_offset, first_line, text_offset, 0 });
+            break;
+        case BlockType::FileMetadata:
+            m_file_metadata = deserialize_metadata(this->read_payload(file_offset, type));
+            break;
+        case BlockType::PrintMetadata:
+            m_print_metadata = deserialize_metadata(this->read_payload(file_offset, type));
+            break;
+        case BlockType::Thumbnail: {
+            const std::string payload = this->read_payload(file_offset, type);
+            Cursor            cursor(payload);
+            Thumbnail        &thumbnail = m_thumbnails.emplace_back();
+            thumbnail.line   = size_t(cursor.get<uint64_t>());
+            thumbnail.width  = cursor.get<uint16_t>();
+            thumbnail.height = cursor.get<uint16_t>();
+            thumbnail.tag    = cursor.get_str(cursor.get<uint16_t>());
+            thumbnail.data   = cursor.get_rest();
+            break;
+        }
+        default:
+            // Unknown blocks of a newer version are skipped.
+            break;
+        }
+    }
+    if (! m_blocks.empty())
+        m_blocks.back().text_size = m_text_size - m_blocks.back().text_offset;
+    const uint32_t layers_count = index.get<uint32_t>();
+    // Each layer is stored in 12 bytes, don't trust a corrupted count.
+    if (index.remaining() < uint64_t(layers_count) * 12)
+        throw Slic3r::RuntimeError(std::string("Binary G-code ") + path + " is corrupted: the layer index is shorter than expected.");
+    m_layers.resize(layers_count);
+    for (Layer &layer : m_layers) {
+        layer.first_line = size_t(index.get<uint64_t>());
+        layer.z          = index.get_float();
+    }
+    std::stable_sort(m_thumbnails.begin(), m_thumbnails.end(), [](const Thumbnail &l, const Thumbnail &r) { return l.line < r.line; });
+}
+
+Reader::~Reader()
+{
+    if (m_file != nullptr)
+        ::fclose(m_file);
+}
+
+std::string Reader::read_payload(uint64_t file_offset, BlockType expected_type) const
+{
+    char header[BlockHeaderSize];
+    if (! seek(m_file, file_offset) || ::fread(header, 1, BlockHeaderSize, m_file) != BlockHeaderSize)
+        throw Slic3r::RuntimeError(std::string("Binary G-code ") + m_path + " is truncated.");
+    Cursor         cursor(header, header + BlockHeaderSize);
+    const auto     type              = BlockType(cursor.get<uint16_t>());
+    const auto     compression       = Compression(cursor.get<uint16_t>());
+    const uint32_t uncompressed_size = cursor.get<uint32_t>();
+    const uint32_t stored_size       = cursor.get<uint32_t>();
+    const uint32_t crc               = cursor.get<uint32_t>();
+    if (type != expected_type)
+        throw Slic3r::RuntimeError(std::string("Binary G-code ") + m_path + " is corrupted: unexpected block type.");
+    // The sizes are bounded by the file size before anything is allocated.
+    if (uint64_t(stored_size) > m_file_size - std::min(m_file_size, file_offset + BlockHeaderSize))
+        throw Slic3r::RuntimeError(std::string("Binary G-code ") + m_path + " is truncated.");
+    if (compression == Compression::None ? uncompressed_size != stored_size : uint64_t(uncompressed_size) > MaxDeflateRatio * stored_size + 64)
+        throw Slic3r::RuntimeError(std::string("Binary G-code ") + m_path + " is corrupted: invalid block size.");
+
+    std::string stored(stored_size, '\0');
+    if (::fread(stored.data(), 1, stored_size, m_file) != stored_size)
+        throw Slic3r::RuntimeError(std::string("Binary G-code ") + m_path + " is truncated.");
+    if (block_crc(stored) != crc)
+        throw Slic3r::RuntimeError(std::string("Binary G-code ") + m_path + " is corrupted: checksum mismatch.");
+
+    switch (compression) {
+    case Compression::None:
+        return stored;
+    case Compression::Deflate: {
+        std::string out;
+        decompress_block(stored, uncompressed_size, out);
+        return out;
+    }
+    default:
+        throw Slic3r::RuntimeError(std::string("Binary G-code ") + m_path + " uses an unknown compression.");
+    }
+}
+
+void Reader::read_block(size_t block_idx, std::string &out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (block_idx == m_cached_block)
+        out = m_cached_text;
+    else
+        out = this->read_payload(m_blocks[block_idx].file_offset, BlockType::GCode);
+}
+
+const std::string &Reader::cached_block(size_t block_idx) const
+{
+    if (block_idx != m_cached_block) {
+        m_cached_text  = this->read_payload(m_blocks[block_idx].file_offset, BlockType::GCode);
+        m_cached_block = block_idx;
+    }
+    return m_cached_text;
+}
+
+size_t Reader::block_by_text_offset(size_t offset) const
+{
+    auto it = std::upper_bound(m_blocks.begin(), m_blocks.end(), offset, [](size_t offset, const BlockInfo &block) { return offset < block.text_offset; });
+    return it == m_blocks.begin() ? 0 : size_t(it - m_blocks.begin()) - 1;
+}
+
+size_t Reader::block_by_line(size_t line) const
+{
+    auto it = std::upper_bound(m_blocks.begin(), m_blocks.end(), line, [](size_t line, const BlockInfo &block) { return line < block.first_line; });
+    return it == m_blocks.begin() ? 0 : size_t(it - m_blocks.begin()) - 1;
+}
+
+std::string Reader::read_text(size_t offset, size_t len) const
+{
+    std::string out;
+    len = std::min(len, m_text_size - std::min(offset, m_text_size));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (len > 0) {
+        const size_t       block_idx = this->block_by_text_offset(offset);
+        const std::string &text      = this->cached_block(block_idx);
+        const size_t       begin     = offset - m_blocks[block_idx].text_offset;
+        const size_t       n         = std::min(len, text.size() - begin);
+        out.append(text, begin, n);
+        offset += n;
+        len    -= n;
+    }
+    return out;
+}
+
+std::string Reader::read_lines(size_t first_line, size_t last_line) const
+{
+    std::string out;
+    last_line = std::min(last_line, m_lines_count);
+    if (first_line >= last_line)
+        return out;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t block_idx = this->block_by_line(first_line); block_idx < m_blocks.size() && first_line < last_line; ++ block_idx) {
+        const std::string &text = this->cached_block(block_idx);
+        size_t             line = m_blocks[block_idx].first_line;
+        size_t             pos  = 0;
+        // Skip the lines in front of first_line.
+        for (; line < first_line && pos < text.size(); ++ line)
+            pos = text.find('\n', pos) + 1;
+        size_t end = pos;
+        for (; line < last_line && end < text.size(); ++ line) {
+            const size_t eol = text.find('\n', end);
+            end = eol == std::string::npos ? text.size() : eol + 1;
+        }
+        out.append(text, pos, end - pos);
+        first_line = line;
+    }
+    return out;
+}
+
+std::string Reader::read_layer(size_t layer_idx) const
+{
+    return this->read_lines(m_layers[layer_idx].first_line, layer_idx + 1 < m_layers.size() ? m_layers[layer_idx + 1].first_line : m_lines_count);
+}
+
+void Reader::export_ascii(FILE *out) const
+{
+    auto write = [out, this](const char *data, size_t len) {
+        if (len > 0 && ::fwrite(data, 1, len, out) != len)
+            throw Slic3r::RuntimeError(std::string("Conversion of ") + m_path + " to ASCII G-code failed.\nIs the disk full?\n");
+    };
+    auto write_thumbnail = [&write](const Thumbnail &thumbnail) {
+        const std::string text = GCodeThumbnails::thumbnail_block_to_gcode(thumbnail.tag, thumbnail.width, thumbnail.height, thumbnail.data.data(), thumbnail.data.size());
+        write(text.data(), text.size());
+    };
+
+    auto        it_thumbnail = m_thumbnails.begin();
+    std::string text;
+    for (size_t block_idx = 0; block_idx < m_blocks.size(); ++ block_idx) {
+        this->read_block(block_idx, text);
+        const size_t next_first_line = block_idx + 1 < m_blocks.size() ? m_blocks[block_idx + 1].first_line : size_t(-1);
+        size_t       line            = m_blocks[block_idx].first_line;
+        size_t       pos             = 0;
+        for (; it_thumbnail != m_thumbnails.end() && it_thumbnail->line < next_first_line; ++ it_thumbnail) {
+            size_t end = pos;
+            for (; line < it_thumbnail->line && end < text.size(); ++ line)
+                end = text.find('\n', end) + 1;
+            write(text.data() + pos, end - pos);
+            pos = end;
+            write_thumbnail(*it_thumbnail);
+        }
+        write(text.data() + pos, text.size() - pos);
+    }
+    for (; it_thumbnail != m_thumbnails.end(); ++ it_thumbnail)
+        write_thumbnail(*it_thumbnail);
+}
+
+bool is_binary_gcode_file(const std::string &path)
+{
+    FilePtr f{ boost::nowide::fopen(path.c_str(), "rb") };
+    char    magic[sizeof(FileMagic)];
+    return f.f != nullptr && ::fread(magic, 1, sizeof(magic), f.f) == sizeof(magic) && memcmp(magic, FileMagic, sizeof(magic)) == 0;
+}
+
+// Splits the ASCII G-code into lines, moves the thumbnails into thumbnail blocks and collects the metadata.
+class AsciiConverter
+{
+public:
+    explicit AsciiConverter(Writer &writer) : m_writer(writer) {}
+
+    // line including its end of line.
+    void process_line(std::string_view line)
+    {
+        const std::string_view content = line_content(line);
+        if (m_in_thumbnail) {
+            if (m_thumbnail_end_found) {
+                // The block is followed by an empty line.
+                const bool empty = content.empty();
+                if (empty)
+                    m_thumbnail_text += line;
+                this->finish_thumbnail();
+                if (empty)
+                    return;
+            } else if (m_thumbnail_text.size() > MaxThumbnailText || (! content.empty() && content.front() != ';')) {
+                // Not a thumbnail written by us, keep it as G-code.
+                this->abandon_thumbnail();
+            } else {
+                m_thumbnail_text += line;
+                m_thumbnail_end_found = content == "; THUMBNAIL_BLOCK_END";
+                return;
+            }
+        }
+        if (content == "; THUMBNAIL_BLOCK_START") {
+            m_in_thumbnail        = true;
+            m_thumbnail_end_found = false;
+            m_thumbnail_line      = m_writer.lines_count();
+            m_thumbnail_text      = line;
+            return;
+        }
+        this->collect_metadata(content);
+        m_writer.write(line);
+    }
+
+    void finish()
+    {
+        if (m_in_thumbnail) {
+            if (m_thumbnail_end_found)
+                this->finish_thumbnail();
+            else
+                this->abandon_thumbnail();
+        }
+        if (! m_file_metadata.empty())
+            m_writer.add_metadata(BlockType::FileMetadata, m_file_metadata);
+        if (! m_print_metadata.empty())
+            m_writer.add_metadata(BlockType::PrintMetadata, m_print_metadata);
+    }
+
+private:
+    static constexpr const size_t MaxThumbnailText = 16 * 1024 * 1024;
+
+    enum class Section { None, Header, Config };
+
+    void collect_metadata(std::string_view content)
+    {
+        if (content == "; HEADER_BLOCK_START")
+            m_section = Section::Header;
+        else if (content == "; CONFIG_BLOCK_START")
+            // Only the first config block is collected.
+            m_section = m_print_metadata.empty() ? Section::Config : Section::None;
+        else if (content == "; HEADER_BLOCK_END" || content == "; CONFIG_BLOCK_END")
+            m_section = Section::None;
+        else if (m_section != Section::None && starts_with(content, "; ")) {
+            content.remove_prefix(2);
+            // "; key = value" in the config block, "; key: value" in the header block.
+            const size_t sep = m_section == Section::Config ? content.find(" = ") : content.find(": ");
+            std::string  key, value;
+            if (sep != std::string_view::npos) {
+                key   = std::string(content.substr(0, sep));
+                value = std::string(content.substr(sep + (m_section == Section::Config ? 3 : 2)));
+            } else if (m_section == Section::Header && starts_with(content, "generated by ")) {
+                key   = "generated by";
+                value = std::string(content.substr(13));
+            }
+            boost::trim(key);
+            boost::trim(value);
+            if (! key.empty())
+                (m_section == Section::Config ? m_print_metadata : m_file_metadata).emplace_back(std::move(key), std::move(value));
+        }
+    }
+
+    void finish_thumbnail()
+    {
+        m_in_thumbnail = false;
+        Thumbnail thumbnail;
+        if (this->parse_thumbnail(thumbnail) &&
+            // Only a thumbnail restored byte for byte is moved into a thumbnail block.
+            GCodeThumbnails::thumbnail_block_to_gcode(thumbnail.tag, thumbnail.width, thumbnail.height, thumbnail.data.data(), thumbnail.data.size()) ==
+                m_thumbnail_text) {
+            thumbnail.line = m_thumbnail_line;
+            m_writer.add_thumbnail(thumbnail);
+        } else
+            this->write_thumbnail_text();
+    }
+
+    void abandon_thumbnail()
+    {
+        m_in_thumbnail = false;
+        this->write_thumbnail_text();
+    }
+
+    void write_thumbnail_text()
+    {
+        for (size_t pos = 0; pos < m_thumbnail_text.size();) {
+            const size_t           eol  = m_thumbnail_text.find('\n', pos);
+            const size_t           end  = eol == std::string::npos ? m_thumbnail_text.size() : eol + 1;
+            const std::string_view line = std::string_view(m_thumbnail_text).substr(pos, end - pos);
+            this->collect_metadata(line_content(line));
+            m_writer.write(line);
+            pos = end;
+        }
+        m_thumbnail_text.clear();
+    }
+
+    bool parse_thumbnail(Thumbnail &thumbnail) const
+    {
+        std::vector<std::string_view> lines;
+        for (size_t pos = 0; pos < m_thumbnail_text.size();) {
+            const size_t eol = m_thumbnail_text.find('\n', pos);
+            const size_t end = eol == std::string::npos ? m_thumbnail_text.size() : eol + 1;
+            lines.emplace_back(line_content(std::string_view(m_thumbnail_text).substr(pos, end - pos)));
+            pos = end;
+        }
+        // START, empty, ";", begin, data..., end, END, empty
+        if (lines.size() < 7 || lines[2] != ";" || ! starts_with(lines[3], "; "))
+            return false;
+        const std::string begin_line(lines[3].substr(2));
+        const size_t      begin_pos = begin_line.find(" begin ");
+        unsigned int      width = 0, height = 0;
+        size_t            encoded_size = 0;
+        if (begin_pos == std::string::npos || sscanf(begin_line.c_str() + begin_pos + 7, "%ux%u %zu", &width, &height, &encoded_size) != 3 ||
+            width > 0xFFFF || height > 0xFFFF)
+            return false;
+        thumbnail.tag    = begin_line.substr(0, begin_pos);
+        thumbnail.width  = uint16_t(width);
+        thumbnail.height = uint16_t(height);
+        std::string encoded;
+        for (size_t i = 4; i < lines.size() && starts_with(lines[i], "; ") && lines[i] != "; " + thumbnail.tag + " end"; ++ i)
+            encoded += lines[i].substr(2);
+        if (encoded.size() != encoded_size)
+            return false;
+        thumbnail.data.resize(boost::beast::detail::base64::decoded_size(encoded.size()));
+        thumbnail.data.resize(boost::beast::detail::base64::decode(thumbnail.data.data(), encoded.data(), encoded.size()).first);
+        return true;
+    }
+
+    Writer     &m_writer;
+    Section     m_section{ Section::None };
+    Metadata    m_file_metadata;
+    Metadata    m_print_metadata;
+    bool        m_in_thumbnail{ false };
+    bool        m_thumbnail_end_found{ false };
+    size_t      m_thumbnail_line{ 0 };
+    std::string m_thumbnail_text;
+};
+
+void convert_ascii_to_binary(const std::string &src_path, const std::string &dst_path, const WriterParams &params)
+{
+    FilePtr in{ boost::nowide::fopen(src_path.c_str(), "rb") };
+    if (in.f == nullptr)
+        throw Slic3r::RuntimeError(std::string("Cannot open G-code ") + src_path + " for reading.");
+
+    Writer         writer(dst_path, params);
+    AsciiConverter converter(writer);
+    // Read the input 1MB at a time, pass the complete lines to the converter.
+    std::vector<char> buffer(1024 * 1024);
+    std::string       line;
+    for (;;) {
+        const size_t cnt_read = ::fread(buffer.data(), 1, buffer.size(), in.f);
+        if (::ferror(in.f))
+            throw Slic3r::RuntimeError(std::string("Error reading G-code ") + src_path + ".");
+        if (cnt_read == 0)
+            break;
+        const char *begin = buffer.data();
+        const char *end   = begin + cnt_read;
+        while (begin != end) {
+            const char *eol = (const char*)memchr(begin, '\n', end - begin);
+            if (eol == nullptr) {
+                line.append(begin, end);
+                break;
+            }
+            if (line.empty())
+                converter.process_line(std::string_view(begin, eol + 1 - begin));
+            else {
+                line.append(begin, eol + 1);
+                converter.process_line(line);
+                line.clear();
+            }
+            begin = eol + 1;
+        }
+    }
+    if (! line.empty())
+        converter.process_line(line);
+    converter.finish();
+    writer.finish();
+    BOOST_LOG_TRIVIAL(info) << "Converted G-code " << src_path << " to binary G-code " << dst_path;
+}
+
+void convert_binary_to_ascii(const std::string &src_path, const std::string &dst_path)
+{
+    Reader  reader(src_path);
+    FilePtr out{ boost::nowide::fopen(dst_path.c_str(), "wb") };
+    if (out.f == nullptr)
+        throw Slic3r::RuntimeError(std::string("Cannot open G-code ") + dst_path + " for writing.");
+    try {
+        reader.export_ascii(out.f);
+        if (::fclose(out.f) != 0) {
+            out.f = nullptr;
+            throw Slic3r::RuntimeError(std::string("Conversion of ") + src_path + " to ASCII G-code failed.\nIs the disk full?\n");
+        }
+        out.f = nullptr;
+    } catch (...) {
+        out.close();
+        boost::nowide::remove(dst_path.c_str());
+        throw;
+    }
+    BOOST_LOG_TRIVIAL(info) << "Converted binary G-code " << src_path << " to G-code " << dst_path;
+}
+
+} // namespace Slic3r::BinaryGCode
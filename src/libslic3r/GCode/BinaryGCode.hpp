@@ -0,0 +1,225 @@
+#ifndef slic3r_GCode_BinaryGCode_hpp_
+#define slic3r_GCode_BinaryGCode_hpp_
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Slic3r::BinaryGCode {
+
+// Block based binary container of a G-code.
+//
+// The file starts with a 16 bytes header (magic "OBGC", version, G-code block size), followed by blocks and ends
+// with a trailer pointing to the index block. Each block has a 16 bytes header (type, compression, uncompressed size,
+// stored size, CRC32 of the stored payload). All numbers are little endian.
+//
+// G-code blocks hold whole lines of the ASCII G-code compressed by deflate, thus each of them may be decompressed
+// on its own. The index block stores the position of all the blocks, the first line and the text offset of each
+// G-code block and the first line of each layer, thus any line or layer is reached by decompressing a single block.
+// Metadata blocks hold key / value pairs, thumbnail blocks the compressed images.
+//
+// Line numbers and text offsets refer to the G-code text of the G-code blocks, which is the ASCII G-code without
+// the thumbnails. GCodeReader reads the same text from a binary G-code, so the lines of a GCodeProcessorResult
+// of a binary G-code are found by Reader::read_text() and Reader::read_lines().
+
+// Extension of the binary G-code files. The container is specific to this application, printers and print hosts
+// don't read it, thus it does not use the .bgcode extension of the libbgcode format.
+static constexpr const char *FileExtension = ".obgcode";
+
+enum class BlockType : uint16_t {
+    FileMetadata  = 0,
+    // Key / value pairs of the print configuration, as stored in the CONFIG_BLOCK of the ASCII G-code.
+    PrintMetadata = 1,
+    Thumbnail     = 2,
+    GCode         = 3,
+    Index         = 4,
+};
+
+enum class Compression : uint16_t {
+    None    = 0,
+    Deflate = 1,
+};
+
+using Metadata = std::vector<std::pair<std::string, std::string>>;
+
+struct Thumbnail
+{
+    // Tag of the thumbnail in the ASCII G-code: "thumbnail" for PNG, "thumbnail_JPG", "thumbnail_QOI"...
+    std::string tag;
+    uint16_t    width{ 0 };
+    uint16_t    height{ 0 };
+    // Compressed image.
+    std::string data;
+    // Line of the G-code text in front of which the thumbnail is stored.
+    size_t      line{ 0 };
+};
+
+struct Layer
+{
+    // Line of the layer change tag.
+    size_t first_line{ 0 };
+    // Z of the layer if known, 0 otherwise.
+    float  z{ 0.f };
+};
+
+struct WriterParams
+{
+    // Size of the uncompressed G-code of a block, blocks are closed at the first end of line past it.
+    size_t block_size{ 65536 };
+    // Deflate level, 0 stores the G-code uncompressed.
+    int    compression_level{ 6 };
+    // Number of G-code blocks compressed in parallel before being written.
+    size_t parallel_blocks{ 32 };
+};
+
+// Sequential writer. The G-code may be passed in chunks of any size, metadata and thumbnails may be added at any time
+// before finish(). Throws Slic3r::RuntimeError on IO errors.
+class Writer
+{
+public:
+    explicit Writer(const std::string &path, const WriterParams &params = WriterParams());
+    // Closes the file, removing it if finish() was not called.
+    ~Writer();
+
+    Writer(const Writer &) = delete;
+    Writer &operator=(const Writer &) = delete;
+
+    void   write(const char *data, size_t len);
+    void   write(std::string_view data) { this->write(data.data(), data.size()); }
+    void   add_metadata(BlockType type, const Metadata &metadata);
+    void   add_thumbnail(const Thumbnail &thumbnail);
+
+    // Number of complete lines passed to write().
+    size_t lines_count() const { return m_lines_count; }
+
+    // Write the pending G-code, the index and the trailer and close the file.
+    void   finish();
+
+private:
+    struct PendingBlock
+    {
+        std::string text;
+        size_t      first_line;
+        size_t      text_offset;
+        std::string stored;
+        Compression compression;
+    };
+    struct IndexEntry
+    {
+        BlockType type;
+        uint64_t  file_offset;
+        uint64_t  first_line;
+        uint64_t  text_offset;
+    };
+
+    void scan_line(const char *begin, const char *end);
+    void queue_block(size_t len);
+    void flush_blocks();
+    void write_block(BlockType type, Compression compression, uint32_t uncompressed_size, const std::string &stored,
+                     uint64_t first_line = 0, uint64_t text_offset = 0);
+    void write_raw(const void *data, size_t len);
+
+    std::string               m_path;
+    WriterParams              m_params;
+    FILE                     *m_file{ nullptr };
+    uint64_t                  m_file_pos{ 0 };
+    // G-code not yet closed into a block.
+    std::string               m_text;
+    // Lines and text up to the end of m_text.
+    size_t                    m_lines_count{ 0 };
+    size_t                    m_text_offset{ 0 };
+    // Lines and text up to the start of m_text.
+    size_t                    m_block_first_line{ 0 };
+    size_t                    m_block_text_offset{ 0 };
+    // Position in m_text of the first line not scanned yet for the layer tags.
+    size_t                    m_scan_pos{ 0 };
+    // A layer change tag was found, its Z tag not yet.
+    bool                      m_layer_z_pending{ false };
+    std::vector<PendingBlock> m_pending;
+    std::vector<IndexEntry>   m_index;
+    std::vector<Layer>        m_layers;
+};
+
+// Random access reader. Throws Slic3r::RuntimeError on IO errors and on corrupted files. Thread safe.
+class Reader
+{
+public:
+    explicit Reader(const std::string &path);
+    ~Reader();
+
+    Reader(const Reader &) = delete;
+    Reader &operator=(const Reader &) = delete;
+
+    const Metadata               &file_metadata() const { return m_file_metadata; }
+    const Metadata               &print_metadata() const { return m_print_metadata; }
+    const std::vector<Thumbnail> &thumbnails() const { return m_thumbnails; }
+    const std::vector<Layer>     &layers() const { return m_layers; }
+
+    // Lines and size of the G-code text, thumbnails excluded.
+    size_t lines_count() const { return m_lines_count; }
+    size_t text_size() const { return m_text_size; }
+
+    size_t blocks_count() const { return m_blocks.size(); }
+    size_t block_first_line(size_t block_idx) const { return m_blocks[block_idx].first_line; }
+    size_t block_text_offset(size_t block_idx) const { return m_blocks[block_idx].text_offset; }
+    // Uncompressed G-code of a block, made of whole lines.
+    void   read_block(size_t block_idx, std::string &out) const;
+
+    // Text <offset, offset + len) of the G-code, clamped to text_size().
+    std::string read_text(size_t offset, size_t len) const;
+    // Lines <first_line, last_line) of the G-code, including their end of lines.
+    std::string read_lines(size_t first_line, size_t last_line) const;
+    // Lines of a layer, up to the next layer.
+    std::string read_layer(size_t layer_idx) const;
+
+    // Write the ASCII G-code, with the thumbnails restored at their lines.
+    void        export_ascii(FILE *out) const;
+
+private:
+    struct BlockInfo
+    {
+        uint64_t file_offset;
+        uint64_t first_line;
+        uint64_t text_offset;
+        uint64_t text_size;
+    };
+
+    std::string read_payload(uint64_t file_offset, BlockType expected_type) const;
+    size_t      block_by_text_offset(size_t offset) const;
+    size_t      block_by_line(size_t line) const;
+    // The text of a block, from the cache of the last block read. m_mutex shall be locked.
+    const std::string &cached_block(size_t block_idx) const;
+
+    std::string            m_path;
+    FILE                  *m_file{ nullptr };
+    Metadata               m_file_metadata;
+    Metadata               m_print_metadata;
+    std::vector<Thumbnail> m_thumbnails;
+    std::vector<Layer>     m_layers;
+    std::vector<BlockInfo> m_blocks;
+    uint64_t               m_file_size{ 0 };
+    size_t                 m_lines_count{ 0 };
+    size_t                 m_text_size{ 0 };
+
+    mutable std::mutex     m_mutex;
+    mutable size_t         m_cached_block{ size_t(-1) };
+    mutable std::string    m_cached_text;
+};
+
+// Check the magic of the file header.
+bool is_binary_gcode_file(const std::string &path);
+
+// Convert an ASCII G-code into the binary container. The thumbnails are moved into thumbnail blocks, the key / value
+// pairs of the HEADER_BLOCK and of the CONFIG_BLOCK are copied into metadata blocks.
+// Converting back to ASCII restores the original G-code byte for byte. Throws Slic3r::RuntimeError.
+void convert_ascii_to_binary(const std::string &src_path, const std::string &dst_path, const WriterParams &params = WriterParams());
+void convert_binary_to_ascii(const std::string &src_path, const std::string &dst_path);
+
+} // namespace Slic3r::BinaryGCode
+
+#endif // slic3r_GCode_BinaryGCode_hpp_
@@ -217,57 +217,240 @@ ConflictComputeOpt ConflictChecker::find_inter_of_lines(const LineWithIDs &lines
     return {};
 }
 
+namespace ConflictLinesImpl {
+static void append_paths(const ExtrusionPaths &paths, ConflictLinesPile &pile)
+{
+    for (const ExtrusionPath &path : paths)
+        if (path.is_force_no_extrusion() == false) {
+            Lines lines = path.polyline.lines();
+            pile.lines.insert(pile.lines.end(), lines.begin(), lines.end());
+            pile.roles.insert(pile.roles.end(), lines.size(), path.role());
+        }
+}
+
+// Merge piles of equal bottom_z, as the extrusion layers of equal bottom_z were taken together by LinesBucket, and compute their bounding boxes.
+static ConflictLinesPiles finalize_piles(ConflictLinesPiles &&piles)
+{
+    ConflictLinesPiles out;
+    out.reserve(piles.size());
+    for (ConflictLinesPile &pile : piles)
+        if (out.empty() || out.back().bottom_z != pile.bottom_z)
+            out.emplace_back(std::move(pile));
+        else {
+            out.back().lines.insert(out.back().lines.end(), pile.lines.begin(), pile.lines.end());
+            out.back().roles.insert(out.back().roles.end(), pile.roles.begin(), pile.roles.end());
+        }
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, out.size()), [&out](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++i)
+            for (const Line &line : out[i].lines) {
+                out[i].bbox.merge(line.a);
+                out[i].bbox.merge(line.b);
+            }
+    });
+    return out;
+}
+
+static ConflictLinesPiles piles_from_extrusion_layers(const ExtrusionLayers &els)
+{
+    ConflictLinesPiles piles(els.size());
+    for (size_t i = 0; i < els.size(); ++i) {
+        piles[i].bottom_z = els[i].bottom_z;
+        append_paths(els[i].paths, piles[i]);
+    }
+    return finalize_piles(std::move(piles));
+}
+
+// Mirrors LinesBucket: walks the piles of a single object from bottom to top, the piles are shared with the cache.
+struct PilesBucket
+{
+    const ConflictLinesPiles *piles;
+    const void               *id;
+    Point                     offset;
+    size_t                    cur_pile_idx  = 0;
+    float                     cur_bottom_z  = 0.f;
+
+    bool valid() const { return cur_pile_idx < piles->size(); }
+    void raise()
+    {
+        if (!valid()) { return; }
+        ++cur_pile_idx;
+        cur_bottom_z = cur_pile_idx == piles->size() ? piles->back().bottom_z : (*piles)[cur_pile_idx].bottom_z;
+    }
+};
+
+struct PilesBucketPtrComp
+{
+    bool operator()(const PilesBucket *left, const PilesBucket *right) { return left->cur_bottom_z > right->cur_bottom_z; }
+};
+
+struct LayerPiles
+{
+    float bottom_z;
+    // Pairs of bucket index and pile index.
+    std::vector<std::pair<int, int>> piles;
+};
+
+// Same sequence of layers as produced by LinesBucketQueue, though only indices of piles are collected, not the lines.
+static std::vector<LayerPiles> sweep_layers(std::vector<PilesBucket> &buckets)
+{
+    std::priority_queue<PilesBucket *, std::vector<PilesBucket *>, PilesBucketPtrComp> queue;
+    for (PilesBucket &bucket : buckets)
+        queue.push(&bucket);
+
+    std::vector<LayerPiles> layers;
+    std::vector<PilesBucket *> lowests;
+    while (!queue.empty()) {
+        LayerPiles layer;
+        for (size_t i = 0; i < buckets.size(); ++i)
+            if (buckets[i].valid())
+                layer.piles.emplace_back(int(i), int(buckets[i].cur_pile_idx));
+
+        PilesBucket *lowest = queue.top();
+        queue.pop();
+        layer.bottom_z = lowest->cur_bottom_z;
+        lowests.assign(1, lowest);
+        while (!queue.empty() && std::abs(queue.top()->cur_bottom_z - lowest->cur_bottom_z) < EPSILON) {
+            lowests.push_back(queue.top());
+            queue.pop();
+        }
+        for (PilesBucket *bp : lowests) {
+            float prevZ = bp->cur_bottom_z;
+            bp->raise();
+            if (bp->cur_bottom_z == prevZ) continue;
+            if (bp->valid()) { queue.push(bp); }
+        }
+        layers.emplace_back(std::move(layer));
+    }
+    return layers;
+}
+
+// Collect lines of the layer, which may intersect lines of another object: Only objects with overlapping bounding boxes
+// are considered, and only their lines touching the bounding box of another object.
+static LineWithIDs collect_candidate_lines(const LayerPiles &layer, const std::vector<PilesBucket> &buckets)
+{
+    struct ObjectBox
+    {
+        const void *id;
+        BoundingBox bbox;
+    };
+    std::vector<ObjectBox> boxes;
+    for (auto [bucket_idx, pile_idx] : layer.piles) {
+        const PilesBucket       &bucket = buckets[bucket_idx];
+        const ConflictLinesPile &pile   = (*bucket.piles)[pile_idx];
+        if (!pile.bbox.defined) continue;
+        BoundingBox bbox = pile.bbox;
+        bbox.translate(bucket.offset);
+        auto it = std::find_if(boxes.begin(), boxes.end(), [&bucket](const ObjectBox &b) { return b.id == bucket.id; });
+        if (it == boxes.end())
+            boxes.push_back({bucket.id, bbox});
+        else
+            it->bbox.merge(bbox);
+    }
+
+    auto overlaps_other = [&boxes](const void *id, const BoundingBox &bbox) {
+        return std::any_of(boxes.begin(), boxes.end(), [id, &bbox](const ObjectBox &b) { return b.id != id && b.bbox.overlap(bbox); });
+    };
+
+    LineWithIDs lines;
+    for (auto [bucket_idx, pile_idx] : layer.piles) {
+        const PilesBucket       &bucket = buckets[bucket_idx];
+        const ConflictLinesPile &pile   = (*bucket.piles)[pile_idx];
+        if (!pile.bbox.defined) continue;
+        BoundingBox pile_bbox = pile.bbox;
+        pile_bbox.translate(bucket.offset);
+        if (!overlaps_other(bucket.id, pile_bbox)) continue;
+        for (size_t i = 0; i < pile.lines.size(); ++i) {
+            Line line = pile.lines[i];
+            line.translate(bucket.offset);
+            BoundingBox line_bbox(Points{line.a, line.b});
+            if (overlaps_other(bucket.id, line_bbox))
+                lines.emplace_back(line, bucket.id, pile.roles[i]);
+        }
+    }
+    return lines;
+}
+} // namespace ConflictLinesImpl
+
+void ConflictChecker::update_lines_cache(PrintObject &obj, ConflictLinesCache &cache)
+{
+    using namespace ConflictLinesImpl;
+    if (cache.valid) { return; }
+
+    const LayerPtrs &layers = obj.layers();
+    ConflictLinesPiles perimeters(layers.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()), [&layers, &perimeters](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            perimeters[i].bottom_z = layers[i]->bottom_z();
+            for (const ExtrusionLayer &el : getExtrusionPathsFromLayer(layers[i]->regions()))
+                append_paths(el.paths, perimeters[i]);
+        }
+    });
+    // Layers without regions were not collected by getAllLayersExtrusionPathsFromObject().
+    for (size_t i = 0, j = 0; i < layers.size(); ++i)
+        if (layers[i]->regions().empty())
+            perimeters.erase(perimeters.begin() + j);
+        else
+            ++j;
+
+    const SupportLayerPtrs &support_layers = obj.support_layers();
+    ConflictLinesPiles support(support_layers.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, support_layers.size()), [&support_layers, &support](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            support[i].bottom_z = support_layers[i]->bottom_z();
+            append_paths(getExtrusionPathsFromSupportLayer(support_layers[i]).paths, support[i]);
+        }
+    });
+
+    cache.perimeters = finalize_piles(std::move(perimeters));
+    cache.support    = finalize_piles(std::move(support));
+    cache.valid      = true;
+}
+
 ConflictResultOpt ConflictChecker::find_inter_of_lines_in_diff_objs(PrintObjectPtrs                      objs,
                                                                     std::optional<const FakeWipeTower *> wtdptr) // find the first intersection point of lines in different objects
 {
+    using namespace ConflictLinesImpl;
     if (objs.size() <= 1 && !wtdptr) { return {}; }
-    LinesBucketQueue conflictQueue;
 
+    // Lines of objects are taken from their caches, only the objects invalidated since the last check are collected again.
+    // The wipe tower changes with any object, it is collected every time.
+    std::vector<std::shared_ptr<ConflictLinesCache>> caches;
+    ConflictLinesPiles                               wipe_tower_piles;
+    std::vector<PilesBucket>                         buckets;
     if (wtdptr.has_value()) { // wipe tower at 0 by default
-        //auto            wtpaths = wtdptr.value()->getFakeExtrusionPathsFromWipeTower();
-        ExtrusionLayers wtels = wtdptr.value()->getTrueExtrusionLayersFromWipeTower();
-        //wtels.type = ExtrusionLayersType::WIPE_TOWER;
-        //for (int i = 0; i < wtpaths.size(); ++i) { // assume that wipe tower always has same height
-        //    ExtrusionLayer el;
-        //    el.paths    = wtpaths[i];
-        //    el.bottom_z = wtpaths[i].front().height * (float) i;
-        //    el.layer    = nullptr;
-        //    wtels.push_back(el);
-        //}
-        conflictQueue.emplace_back_bucket(std::move(wtels), wtdptr.value(), {wtdptr.value()->plate_origin.x(), wtdptr.value()->plate_origin.y()});
+        wipe_tower_piles = piles_from_extrusion_layers(wtdptr.value()->getTrueExtrusionLayersFromWipeTower());
+        buckets.push_back({&wipe_tower_piles, wtdptr.value(), Point(wtdptr.value()->plate_origin.x(), wtdptr.value()->plate_origin.y())});
     }
     for (PrintObject *obj : objs) {
-        auto layers = getAllLayersExtrusionPathsFromObject(obj);
-        conflictQueue.emplace_back_bucket(std::move(layers.perimeters), obj, obj->instances().front().shift);
-        conflictQueue.emplace_back_bucket(std::move(layers.support), obj, obj->instances().front().shift);
+        std::shared_ptr<ConflictLinesCache> cache = obj->alloc_conflict_lines_cache();
+        update_lines_cache(*obj, *cache);
+        buckets.push_back({&cache->perimeters, obj, obj->instances().front().shift});
+        buckets.push_back({&cache->support, obj, obj->instances().front().shift});
+        caches.emplace_back(std::move(cache));
     }
 
-    std::vector<LineWithIDs> layersLines;
-    std::vector<float>       bottomZs;
-    while (conflictQueue.valid()) {
-        LineWithIDs lines = conflictQueue.getCurLines();
-        float curBottomZ = conflictQueue.getCurrBottomZ();
-        bottomZs.push_back(curBottomZ);
-        layersLines.push_back(std::move(lines));
-    }
+    std::vector<LayerPiles> layers = sweep_layers(buckets);
 
-    bool                                                          find = false;
-    tbb::concurrent_vector<std::pair<ConflictComputeResult, float>> conflict;
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, layersLines.size()), [&](tbb::blocked_range<size_t> range) {
+    // Index of the lowest layer with a conflict found so far, layers above it are not checked anymore.
+    std::atomic<size_t>             first_conflict_layer { layers.size() };
+    std::vector<ConflictComputeOpt> conflicts(layers.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()), [&](tbb::blocked_range<size_t> range) {
         for (size_t i = range.begin(); i < range.end(); i++) {
-            auto interRes = find_inter_of_lines(layersLines[i]);
-            if (interRes.has_value()) {
-                find = true;
-                conflict.emplace_back(interRes.value(), bottomZs[i]);
+            if (i > first_conflict_layer.load(std::memory_order_relaxed)) { break; }
+            LineWithIDs lines = collect_candidate_lines(layers[i], buckets);
+            if (lines.empty()) { continue; }
+            if (conflicts[i] = find_inter_of_lines(lines); conflicts[i].has_value()) {
+                size_t prev = first_conflict_layer.load();
+                while (i < prev && !first_conflict_layer.compare_exchange_weak(prev, i));
                 break;
             }
         }
     });
 
-    if (find) {
-        const void *ptr1           = conflict[0].first._obj1;
-        const void *ptr2           = conflict[0].first._obj2;
-        float       conflictPrintZ = conflict[0].second;
+    if (first_conflict_layer < layers.size()) {
+        const void *ptr1           = conflicts[first_conflict_layer]->_obj1;
+        const void *ptr2           = conflicts[first_conflict_layer]->_obj2;
+        float       conflictPrintZ = layers[first_conflict_layer].bottom_z;
         if (wtdptr.has_value()) {
             const FakeWipeTower *wtdp = wtdptr.value();
             if (ptr1 == wtdp || ptr2 == wtdp) {
@@ -139,11 +139,34 @@ struct ConflictComputeResult
 
 using ConflictComputeOpt = std::optional<ConflictComputeResult>;
 
+// Extrusion lines of all extrusions starting at the same bottom_z, in object coordinates.
+struct ConflictLinesPile
+{
+    float                      bottom_z { 0.f };
+    Lines                      lines;
+    std::vector<ExtrusionRole> roles;
+    BoundingBox                bbox;
+};
+
+using ConflictLinesPiles = std::vector<ConflictLinesPile>;
+
+// Extrusion lines of a PrintObject indexed per layer, in object coordinates, thus independent of the position
+// of the object on the plate. Kept by PrintObject across re-slicing and dropped when any step of the object is invalidated,
+// so that only the changed objects are collected again by the conflict checker.
+struct ConflictLinesCache
+{
+    ConflictLinesPiles perimeters;
+    ConflictLinesPiles support;
+    bool               valid { false };
+};
+
 using ConflictObjName = std::optional<std::pair<std::string, std::string>>;
 
 struct ConflictChecker
 {
     static ConflictResultOpt  find_inter_of_lines_in_diff_objs(PrintObjectPtrs objs, std::optional<const FakeWipeTower *> wtdptr);
+    // Fill the cache with the extrusion lines of the object if it is not valid.
+    static void               update_lines_cache(PrintObject &obj, ConflictLinesCache &cache);
     static ConflictComputeOpt find_inter_of_lines(const LineWithIDs &lines);
     static ConflictComputeOpt line_intersect(const LineWithID &l1, const LineWithID &l2);
 };
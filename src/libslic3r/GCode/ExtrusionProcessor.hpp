@@ -20,11 +20,16 @@
 #include <cmath>
 #include <cstddef>
 #include <limits>
+#include <map>
+#include <memory>
 #include <numeric>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 namespace Slic3r {
 
 struct ExtendedPoint
@@ -34,7 +39,8 @@ struct ExtendedPoint
     float curvature;
 };
 
-template<bool SCALED_INPUT, bool ADD_INTERSECTIONS, bool PREV_LAYER_BOUNDARY_OFFSET, bool SIGNED_DISTANCE, typename POINTS, typename L>
+// CALCULATE_CURVATURE: the curvature of the points is left zero if false, for the callers using the distances only.
+template<bool SCALED_INPUT, bool ADD_INTERSECTIONS, bool PREV_LAYER_BOUNDARY_OFFSET, bool SIGNED_DISTANCE, bool CALCULATE_CURVATURE = true, typename POINTS, typename L>
 std::vector<ExtendedPoint> estimate_points_properties(const POINTS                           &input_points,
                                                       const AABBTreeLines::LinesDistancer<L> &unscaled_prev_layer,
                                                       float                                   flow_width,
@@ -215,6 +221,9 @@ std::vector<ExtendedPoint> estimate_points_properties(const POINTS
         points = std::move(new_points);
     }
 
+    if (! CALCULATE_CURVATURE)
+        return points;
+
     // Curvature calculation
     float accumulated_distance = 0;
     std::vector<float> distances_for_curvature(points.size());
@@ -290,11 +299,66 @@ struct ProcessedPoint
 
 class ExtrusionQualityEstimator
 {
-    std::unordered_map<const PrintObject *, AABBTreeLines::LinesDistancer<Linef>> prev_layer_boundaries;
-    std::unordered_map<const PrintObject *, AABBTreeLines::LinesDistancer<Linef>> next_layer_boundaries;
-    std::unordered_map<const PrintObject *, AABBTreeLines::LinesDistancer<CurledLine>> prev_curled_extrusions;
-    std::unordered_map<const PrintObject *, AABBTreeLines::LinesDistancer<CurledLine>> next_curled_extrusions;
-    const PrintObject                                                            *current_object;
+    // Distancers of the outlines and of the curled extrusions of a layer.
+    struct LayerDistancers
+    {
+        AABBTreeLines::LinesDistancer<Linef>      boundaries;
+        AABBTreeLines::LinesDistancer<CurledLine> curled_extrusions;
+    };
+    using LayerDistancersPtr = std::shared_ptr<const LayerDistancers>;
+
+    // Number of layers, whose distancers are built in parallel ahead of the G-code export.
+    static constexpr const size_t layers_batch_size = 16;
+
+    std::unordered_map<const PrintObject *, LayerDistancersPtr> prev_layer_distancers;
+    std::unordered_map<const PrintObject *, LayerDistancersPtr> next_layer_distancers;
+    // Distancers built ahead for the layers not yet passed to prepare_for_new_layer(), by the requesting object and layer.
+    // Objects sharing the layers of another object request the same layers, thus the key holds the object.
+    std::map<std::pair<const PrintObject *, const Layer *>, LayerDistancersPtr> layers_ahead;
+    const PrintObject                                          *current_object;
+
+    const LayerDistancers &prev_layer() const
+    {
+        static const LayerDistancers empty;
+        auto it = prev_layer_distancers.find(current_object);
+        return it == prev_layer_distancers.end() || ! it->second ? empty : *it->second;
+    }
+
+    // The distancers of a layer are taken from the layers built ahead. If missing, the distancers of the layer
+    // and of the layers above it are built in parallel.
+    LayerDistancersPtr layer_distancers(const PrintObject *object, const Layer *layer)
+    {
+        auto it = layers_ahead.find({ object, layer });
+        if (it == layers_ahead.end()) {
+            // The layers built ahead for this object and not used were skipped.
+            for (auto it_ahead = layers_ahead.begin(); it_ahead != layers_ahead.end();)
+                it_ahead = it_ahead->first.first == object ? layers_ahead.erase(it_ahead) : std::next(it_ahead);
+            std::vector<const Layer *> batch;
+            for (const Layer *l = layer; l != nullptr && batch.size() < layers_batch_size; l = l->upper_layer)
+                batch.emplace_back(l);
+            // Distancers of the same layers built ahead for another object are shared.
+            std::vector<LayerDistancersPtr> built(batch.size());
+            for (size_t i = 0; i < batch.size(); ++ i)
+                for (const auto &[key, distancers] : layers_ahead)
+                    if (key.second == batch[i]) {
+                        built[i] = distancers;
+                        break;
+                    }
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, batch.size()), [&batch, &built](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i)
+                    if (! built[i])
+                        built[i] = std::make_shared<const LayerDistancers>(
+                            LayerDistancers{ AABBTreeLines::LinesDistancer<Linef>{ to_unscaled_linesf(batch[i]->lslices) },
+                                             AABBTreeLines::LinesDistancer<CurledLine>{ batch[i]->curled_lines } });
+            });
+            for (size_t i = 0; i < batch.size(); ++ i)
+                layers_ahead.emplace(std::make_pair(object, batch[i]), std::move(built[i]));
+            it = layers_ahead.find({ object, layer });
+        }
+        LayerDistancersPtr out = std::move(it->second);
+        layers_ahead.erase(it);
+        return out;
+    }
 
 public:
     void set_current_object(const PrintObject *object) { current_object = object; }
@@ -303,10 +367,8 @@ public:
     {
         if (layer == nullptr) return;
         const PrintObject *object = obj;
-        prev_layer_boundaries[object] = next_layer_boundaries[object];
-        next_layer_boundaries[object] = AABBTreeLines::LinesDistancer<Linef>{to_unscaled_linesf(layer->lslices)};
-        prev_curled_extrusions[object] = next_curled_extrusions[object];
-        next_curled_extrusions[object] = AABBTreeLines::LinesDistancer<CurledLine>{layer->curled_lines};
+        prev_layer_distancers[object] = std::move(next_layer_distancers[object]);
+        next_layer_distancers[object] = this->layer_distancers(object, layer);
     }
 
     std::vector<ProcessedPoint> estimate_extrusion_quality(const ExtrusionPath                &path,
@@ -359,9 +421,10 @@ public:
             smallest_distance_with_lower_speed=-1.f;
 
         // Orca: Pass to the point properties estimator the smallest ovehang distance that triggers a slowdown (smallest_distance_with_lower_speed)
-        std::vector<ExtendedPoint> extended_points = estimate_points_properties<true, true, true, true>
+        const LayerDistancers     &prev_layer      = this->prev_layer();
+        std::vector<ExtendedPoint> extended_points = estimate_points_properties<true, true, true, true, false>
                                                                 (path.polyline.points,
-                                                                 prev_layer_boundaries[current_object],
+                                                                 prev_layer.boundaries,
                                                                  path.width,
                                                                  -1,
                                                                  smallest_distance_with_lower_speed);
@@ -378,7 +441,7 @@ public:
             	const double dist_limit = 10.0 * path.width;
 				{
 				Vec2d middle = 0.5 * (curr.position + next.position);
-				auto line_indices = prev_curled_extrusions[current_object].all_lines_in_radius(Point::new_scale(middle), scale_(dist_limit));
+				auto line_indices = prev_layer.curled_extrusions.all_lines_in_radius(Point::new_scale(middle), scale_(dist_limit));
 					if (!line_indices.empty()) {
 						double len   = (next.position - curr.position).norm();
 						// For long lines, there is a problem with the additional slowdown. If by accident, there is small curled line near the middle of this long line
@@ -398,7 +461,7 @@ public:
 
                         	double projected_lengths_sum = 0;
                         	for (size_t idx : line_indices) {
-                            	const CurledLine &line   = prev_curled_extrusions[current_object].get_line(idx);
+                            	const CurledLine &line   = prev_layer.curled_extrusions.get_line(idx);
                             	Lines             inside = intersection_ln({{line.a, line.b}}, {box_of_influence});
                             	if (inside.empty())
                                 	continue;
@@ -411,7 +474,7 @@ public:
                     	}
                     
                     	for (size_t idx : line_indices) {
-                        	const CurledLine &line                 = prev_curled_extrusions[current_object].get_line(idx);
+                        	const CurledLine &line                 = prev_layer.curled_extrusions.get_line(idx);
                         	float             distance_from_curled = unscaled(line_alg::distance_to(line, Point::new_scale(middle)));
                         	float             dist                 = path.width * (1.0 - (distance_from_curled / dist_limit)) *
                                      (1.0 - (distance_from_curled / dist_limit)) *
@@ -0,0 +1,257 @@
+#include "ThumbnailRenderer.hpp"
+#include "../BuildVolume.hpp"
+#include "../Geometry.hpp"
+
+#include <admesh/stl.h>
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace Slic3r::GCodeThumbnails {
+
+// Light setup of resources/shaders/*/thumbnail.vs, directions in eye space.
+static constexpr float INTENSITY_CORRECTION = 0.6f;
+static const Vec3f     LIGHT_TOP_DIR(-0.4574957f, 0.4574957f, 0.7624929f);
+static constexpr float LIGHT_TOP_DIFFUSE    = 0.8f * INTENSITY_CORRECTION;
+static constexpr float LIGHT_TOP_SPECULAR   = 0.125f * INTENSITY_CORRECTION;
+static constexpr float LIGHT_TOP_SHININESS  = 20.0f;
+static const Vec3f     LIGHT_FRONT_DIR(0.6985074f, 0.1397015f, 0.6985074f);
+static constexpr float LIGHT_FRONT_DIFFUSE  = 0.3f * INTENSITY_CORRECTION;
+static constexpr float INTENSITY_AMBIENT    = 0.3f;
+static constexpr float EMISSION_FACTOR      = 0.1f;
+
+// Tile edge in (supersampled) pixels. Each tile owns its depth buffer and is rasterized by a single task.
+static constexpr int TILE_SIZE = 32;
+
+struct ScreenTriangle
+{
+    std::array<Vec2f, 3> pt;
+    // Eye space depth, larger is closer to the camera.
+    Vec3f                depth;
+    // World Z for clipping below the bed.
+    Vec3f                world_z;
+    std::array<unsigned char, 4> color;
+};
+
+static Matrix3d view_rotation(RenderView view)
+{
+    if (view == RenderView::Top)
+        return Matrix3d::Identity();
+    // Camera::set_default_orientation(): zenit 45 degrees, azimuth 45 degrees.
+    return (Eigen::AngleAxisd(Geometry::deg2rad(-45.0), Vec3d::UnitX()) * Eigen::AngleAxisd(Geometry::deg2rad(45.0), Vec3d::UnitZ())).toRotationMatrix();
+}
+
+static unsigned char to_uchar(float v) { return static_cast<unsigned char>(std::clamp(v, 0.f, 1.f) * 255.f + 0.5f); }
+
+static std::array<unsigned char, 4> shade(const ColorRGBA &color, const Vec3f &eye_normal, bool ban_light)
+{
+    if (ban_light)
+        return { to_uchar(color.r()), to_uchar(color.g()), to_uchar(color.b()), to_uchar(color.a()) };
+
+    float intensity = INTENSITY_AMBIENT + std::max(eye_normal.dot(LIGHT_TOP_DIR), 0.f) * LIGHT_TOP_DIFFUSE;
+    // Orthographic camera, the view vector is constant.
+    const Vec3f reflected = -LIGHT_TOP_DIR + 2.f * eye_normal.dot(LIGHT_TOP_DIR) * eye_normal;
+    const float specular  = LIGHT_TOP_SPECULAR * std::pow(std::max(reflected.z(), 0.f), LIGHT_TOP_SHININESS);
+    intensity += std::max(eye_normal.dot(LIGHT_FRONT_DIR), 0.f) * LIGHT_FRONT_DIFFUSE;
+    intensity += EMISSION_FACTOR;
+    return { to_uchar(specular + color.r() * intensity), to_uchar(specular + color.g() * intensity),
+             to_uchar(specular + color.b() * intensity), to_uchar(color.a()) };
+}
+
+BoundingBoxf3 render_items_bounding_box(const std::vector<RenderItem> &items)
+{
+    BoundingBoxf3 bbox;
+    for (const RenderItem &item : items)
+        if (item.its != nullptr && !item.its->vertices.empty())
+            for (const stl_vertex &v : item.its->vertices)
+                bbox.merge(item.trafo * v.cast<double>());
+    if (!bbox.defined)
+        return bbox;
+    bbox.min.z() = -BuildVolume::SceneEpsilon;
+    const Vec3d size = bbox.size();
+    bbox.min -= Vec3d(size.x() * 0.01, size.y() * 0.01, size.z() * 0.02);
+    bbox.max += Vec3d(size.x() * 0.01, size.y() * 0.01, size.z() * 0.02);
+    return bbox;
+}
+
+void render_thumbnail(ThumbnailData &thumbnail, unsigned int width, unsigned int height,
+                      const std::vector<RenderItem> &items, const RenderParams &params)
+{
+    thumbnail.set(width, height);
+    if (!thumbnail.is_valid())
+        return;
+    const std::array<unsigned char, 4> background { to_uchar(params.background.r()), to_uchar(params.background.g()),
+                                                    to_uchar(params.background.b()), to_uchar(params.background.a()) };
+    auto fill_background = [&background](std::vector<unsigned char> &pixels) {
+        for (size_t i = 0; i < pixels.size(); i += 4)
+            std::copy(background.begin(), background.end(), pixels.begin() + i);
+    };
+    fill_background(thumbnail.pixels);
+    if (!params.view_box.defined)
+        return;
+
+    const int ss = int(std::max(1u, params.supersampling));
+    const int w  = int(width) * ss;
+    const int h  = int(height) * ss;
+
+    // Fit the projected view box into the image.
+    const Matrix3d rotation = view_rotation(params.view);
+    BoundingBoxf   view_rect;
+    for (int i = 0; i < 8; ++ i) {
+        const Vec3d corner((i & 1) ? params.view_box.max.x() : params.view_box.min.x(),
+                           (i & 2) ? params.view_box.max.y() : params.view_box.min.y(),
+                           (i & 4) ? params.view_box.max.z() : params.view_box.min.z());
+        view_rect.merge(Vec2d((rotation * corner).head<2>()));
+    }
+    const Vec2d rect_size = view_rect.size();
+    if (rect_size.x() <= 0. || rect_size.y() <= 0.)
+        return;
+    const double scale  = std::min(double(w) / rect_size.x(), double(h) / rect_size.y());
+    const Vec2d  center = view_rect.center();
+
+    // Transform and shade all triangles in parallel.
+    std::vector<size_t> item_offsets(items.size() + 1, 0);
+    for (size_t i = 0; i < items.size(); ++ i)
+        item_offsets[i + 1] = item_offsets[i] + (items[i].its ? items[i].its->indices.size() : 0);
+    std::vector<ScreenTriangle> triangles(item_offsets.back());
+    std::vector<char>           triangle_valid(triangles.size(), 0);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, items.size()), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t item_idx = range.begin(); item_idx < range.end(); ++ item_idx) {
+            const RenderItem &item = items[item_idx];
+            if (item.its == nullptr)
+                continue;
+            const bool   mirrored = item.trafo.linear().determinant() < 0.;
+            const size_t offset   = item_offsets[item_idx];
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, item.its->indices.size()), [&](const tbb::blocked_range<size_t> &faces) {
+                for (size_t face_idx = faces.begin(); face_idx < faces.end(); ++ face_idx) {
+                    const stl_triangle_vertex_indices &face = item.its->indices[face_idx];
+                    std::array<Vec3d, 3> world;
+                    for (int j = 0; j < 3; ++ j)
+                        world[j] = item.trafo * item.its->vertices[face[j]].cast<double>();
+                    Vec3d normal = (world[1] - world[0]).cross(world[2] - world[0]);
+                    if (normal.squaredNorm() == 0.)
+                        continue;
+                    if (mirrored)
+                        normal = -normal;
+                    ScreenTriangle &tri = triangles[offset + face_idx];
+                    for (int j = 0; j < 3; ++ j) {
+                        const Vec3d eye = rotation * world[j];
+                        tri.pt[j]      = Vec2f(float((eye.x() - center.x()) * scale + 0.5 * w), float((eye.y() - center.y()) * scale + 0.5 * h));
+                        tri.depth[j]   = float(eye.z());
+                        tri.world_z[j] = float(world[j].z());
+                    }
+                    tri.color = shade(item.color, (rotation * normal.normalized()).cast<float>(), params.ban_light || !item.lit);
+                    triangle_valid[offset + face_idx] = 1;
+                }
+            });
+        }
+    });
+
+    // Bin the triangles into screen tiles.
+    const int tiles_x = (w + TILE_SIZE - 1) / TILE_SIZE;
+    const int tiles_y = (h + TILE_SIZE - 1) / TILE_SIZE;
+    std::vector<std::vector<uint32_t>> bins(size_t(tiles_x) * size_t(tiles_y));
+    for (size_t tri_idx = 0; tri_idx < triangles.size(); ++ tri_idx) {
+        if (!triangle_valid[tri_idx])
+            continue;
+        const ScreenTriangle &tri = triangles[tri_idx];
+        const float min_x = std::min({ tri.pt[0].x(), tri.pt[1].x(), tri.pt[2].x() });
+        const float max_x = std::max({ tri.pt[0].x(), tri.pt[1].x(), tri.pt[2].x() });
+        const float min_y = std::min({ tri.pt[0].y(), tri.pt[1].y(), tri.pt[2].y() });
+        const float max_y = std::max({ tri.pt[0].y(), tri.pt[1].y(), tri.pt[2].y() });
+        if (max_x < 0.f || max_y < 0.f || min_x >= float(w) || min_y >= float(h))
+            continue;
+        const int tx0 = std::max(0, int(min_x) / TILE_SIZE);
+        const int tx1 = std::min(tiles_x - 1, int(max_x) / TILE_SIZE);
+        const int ty0 = std::max(0, int(min_y) / TILE_SIZE);
+        const int ty1 = std::min(tiles_y - 1, int(max_y) / TILE_SIZE);
+        for (int ty = ty0; ty <= ty1; ++ ty)
+            for (int tx = tx0; tx <= tx1; ++ tx)
+                bins[size_t(ty) * tiles_x + tx].emplace_back(uint32_t(tri_idx));
+    }
+
+    // Rasterize the tiles in parallel, each tile with its own depth buffer.
+    std::vector<unsigned char> samples(size_t(w) * size_t(h) * 4);
+    fill_background(samples);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, bins.size()), [&](const tbb::blocked_range<size_t> &range) {
+        std::array<float, TILE_SIZE * TILE_SIZE> depth_buffer;
+        for (size_t tile_idx = range.begin(); tile_idx < range.end(); ++ tile_idx) {
+            if (bins[tile_idx].empty())
+                continue;
+            const int x0 = int(tile_idx % tiles_x) * TILE_SIZE;
+            const int y0 = int(tile_idx / tiles_x) * TILE_SIZE;
+            const int x1 = std::min(x0 + TILE_SIZE, w);
+            const int y1 = std::min(y0 + TILE_SIZE, h);
+            depth_buffer.fill(-std::numeric_limits<float>::max());
+            for (uint32_t tri_idx : bins[tile_idx]) {
+                const ScreenTriangle &tri  = triangles[tri_idx];
+                const Vec2f          &a    = tri.pt[0];
+                const Vec2f          &b    = tri.pt[1];
+                const Vec2f          &c    = tri.pt[2];
+                const float           area = (b - a).x() * (c - a).y() - (b - a).y() * (c - a).x();
+                if (std::abs(area) < 1e-12f)
+                    continue;
+                const float inv_area = 1.f / area;
+                const int   px0 = std::max(x0, int(std::floor(std::min({ a.x(), b.x(), c.x() }))));
+                const int   px1 = std::min(x1 - 1, int(std::ceil(std::max({ a.x(), b.x(), c.x() }))));
+                const int   py0 = std::max(y0, int(std::floor(std::min({ a.y(), b.y(), c.y() }))));
+                const int   py1 = std::min(y1 - 1, int(std::ceil(std::max({ a.y(), b.y(), c.y() }))));
+                // Barycentric coordinates as edge functions normalized by the signed area, linear in x and y.
+                auto edge = [inv_area](const Vec2f &p, const Vec2f &q, float x, float y) {
+                    return ((q.x() - p.x()) * (y - p.y()) - (q.y() - p.y()) * (x - p.x())) * inv_area;
+                };
+                const float dw0_dx = -(c.y() - b.y()) * inv_area, dw0_dy = (c.x() - b.x()) * inv_area;
+                const float dw1_dx = -(a.y() - c.y()) * inv_area, dw1_dy = (a.x() - c.x()) * inv_area;
+                const float dw2_dx = -(b.y() - a.y()) * inv_area, dw2_dy = (b.x() - a.x()) * inv_area;
+                float w0_row = edge(b, c, float(px0) + 0.5f, float(py0) + 0.5f);
+                float w1_row = edge(c, a, float(px0) + 0.5f, float(py0) + 0.5f);
+                float w2_row = edge(a, b, float(px0) + 0.5f, float(py0) + 0.5f);
+                for (int y = py0; y <= py1; ++ y) {
+                    float w0 = w0_row, w1 = w1_row, w2 = w2_row;
+                    for (int x = px0; x <= px1; ++ x) {
+                        if (w0 >= 0.f && w1 >= 0.f && w2 >= 0.f) {
+                            const float depth = w0 * tri.depth[0] + w1 * tri.depth[1] + w2 * tri.depth[2];
+                            float      &dst   = depth_buffer[(y - y0) * TILE_SIZE + (x - x0)];
+                            if (depth > dst && (!params.clip_below_bed || w0 * tri.world_z[0] + w1 * tri.world_z[1] + w2 * tri.world_z[2] >= 0.f)) {
+                                dst = depth;
+                                std::copy(tri.color.begin(), tri.color.end(), samples.begin() + (size_t(y) * w + x) * 4);
+                            }
+                        }
+                        w0 += dw0_dx;
+                        w1 += dw1_dx;
+                        w2 += dw2_dx;
+                    }
+                    w0_row += dw0_dy;
+                    w1_row += dw1_dy;
+                    w2_row += dw2_dy;
+                }
+            }
+        }
+    });
+
+    // Resolve the supersampled image.
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, height), [&](const tbb::blocked_range<unsigned int> &rows) {
+        const unsigned int num_samples = unsigned(ss * ss);
+        for (unsigned int y = rows.begin(); y < rows.end(); ++ y)
+            for (unsigned int x = 0; x < width; ++ x) {
+                std::array<unsigned int, 4> sum { 0, 0, 0, 0 };
+                for (int sy = 0; sy < ss; ++ sy)
+                    for (int sx = 0; sx < ss; ++ sx) {
+                        const unsigned char *src = &samples[(size_t(y * ss + sy) * w + x * ss + sx) * 4];
+                        for (int i = 0; i < 4; ++ i)
+                            sum[i] += src[i];
+                    }
+                unsigned char *dst = &thumbnail.pixels[(size_t(y) * width + x) * 4];
+                for (int i = 0; i < 4; ++ i)
+                    dst[i] = static_cast<unsigned char>((sum[i] + num_samples / 2) / num_samples);
+            }
+    });
+}
+
+} // namespace Slic3r::GCodeThumbnails
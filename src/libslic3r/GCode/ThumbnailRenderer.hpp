@@ -0,0 +1,61 @@
+#ifndef slic3r_GCodeThumbnailRenderer_hpp_
+#define slic3r_GCodeThumbnailRenderer_hpp_
+
+#include "../Point.hpp"
+#include "../BoundingBox.hpp"
+#include "../Color.hpp"
+#include "ThumbnailData.hpp"
+
+#include <vector>
+
+struct indexed_triangle_set;
+
+namespace Slic3r::GCodeThumbnails {
+
+// CPU rasterizer producing the same thumbnails as GLCanvas3D::render_thumbnail_internal(),
+// without requiring an OpenGL context. Used by the CLI on headless machines.
+
+// One mesh to be rasterized, resolved to its world transformation and final color.
+struct RenderItem
+{
+    const indexed_triangle_set *its { nullptr };
+    Transform3d                 trafo { Transform3d::Identity() };
+    ColorRGBA                   color;
+    // Shade by the lights unless RenderParams::ban_light. The bed is rendered with its flat color.
+    bool                        lit { true };
+};
+
+enum class RenderView : unsigned char
+{
+    // Same orientation as Camera::set_default_orientation().
+    Iso,
+    // Looking down the Z axis with Y up, as Camera::ViewAngleType::Top_Plate.
+    Top,
+};
+
+struct RenderParams
+{
+    RenderView    view { RenderView::Iso };
+    // Part of the scene fitted into the image (plate build volume or the bounding box of the items).
+    BoundingBoxf3 view_box;
+    // Output the item colors as they are, no lighting. Used for the no_light and picking thumbnails.
+    bool          ban_light { false };
+    // Drop the fragments below the print bed, as the thumbnail shader does.
+    bool          clip_below_bed { true };
+    // Supersampling factor per axis, 1 disables antialiasing.
+    unsigned int  supersampling { 2 };
+    // Color of the pixels not covered by any item, fully transparent by default.
+    ColorRGBA     background { 0.f, 0.f, 0.f, 0.f };
+};
+
+// Rasterize the items into thumbnail (RGBA, rows bottom-up as returned by glReadPixels()).
+// Tiles of the image are rasterized in parallel.
+void render_thumbnail(ThumbnailData &thumbnail, unsigned int width, unsigned int height,
+                      const std::vector<RenderItem> &items, const RenderParams &params);
+
+// Bounding box of the transformed items, slightly inflated the same way the GL renderer does for zoom_to_box().
+BoundingBoxf3 render_items_bounding_box(const std::vector<RenderItem> &items);
+
+} // namespace Slic3r::GCodeThumbnails
+
+#endif // slic3r_GCodeThumbnailRenderer_hpp_
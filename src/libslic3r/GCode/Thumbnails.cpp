@@ -242,6 +242,26 @@ std::string rjust(std::string input, unsigned int width, char fill_char) {
     return stream.str();
 }
 
+std::string thumbnail_block_to_gcode(std::string_view tag, unsigned int width, unsigned int height, const void *data, size_t size)
+{
+    static constexpr const size_t max_row_length = 78;
+
+    std::string encoded;
+    encoded.resize(boost::beast::detail::base64::encoded_size(size));
+    encoded.resize(boost::beast::detail::base64::encode((void *) encoded.data(), data, size));
+
+    std::string out = "; THUMBNAIL_BLOCK_START\n";
+    out += (boost::format("\n;\n; %s begin %dx%d %d\n") % tag % width % height % encoded.size()).str();
+    for (size_t i = 0; i < encoded.size(); i += max_row_length) {
+        out += "; ";
+        out.append(encoded, i, max_row_length);
+        out += '\n';
+    }
+    out += (boost::format("; %s end\n") % tag).str();
+    out += "; THUMBNAIL_BLOCK_END\n\n";
+    return out;
+}
+
 std::unique_ptr<CompressedImageBuffer> compress_thumbnail(const ThumbnailData &data, GCodeThumbnailsFormat format)
 {
     switch (format) {
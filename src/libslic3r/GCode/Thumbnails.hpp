@@ -33,6 +33,8 @@ std::string get_hex(const unsigned int input);
 std::string rjust(std::string input, unsigned int width, char fill_char);
 std::unique_ptr<CompressedImageBuffer> compress_thumbnail(const ThumbnailData &data, GCodeThumbnailsFormat format);
 std::string get_error_string(const ThumbnailErrors& errors);
+// Base64 encoded thumbnail delimited by THUMBNAIL_BLOCK_START / THUMBNAIL_BLOCK_END, as written into the G-code.
+std::string thumbnail_block_to_gcode(std::string_view tag, unsigned int width, unsigned int height, const void *data, size_t size);
 
 
 typedef std::vector<std::pair<GCodeThumbnailsFormat, Vec2d>> GCodeThumbnailDefinitionsList;
@@ -54,7 +56,6 @@ inline void export_thumbnails_to_file(ThumbnailsGeneratorCallback&
     short i = 0;
     bool first_ColPic = true;
     for (const auto& [format, size] : thumbnails_list) {
-        static constexpr const size_t max_row_length = 78;
         ThumbnailsList                thumbnails     = thumbnail_cb(ThumbnailsParams{{size}, true, true, true, true, plate_id});
         for (const ThumbnailData &data : thumbnails) {
             if (data.is_valid()) {
@@ -76,25 +77,7 @@ inline void export_thumbnails_to_file(ThumbnailsGeneratorCallback&
                         first_ColPic = false;
                     } 
                     else {
-                        output("; THUMBNAIL_BLOCK_START\n");
-                        std::string encoded;
-                        encoded.resize(boost::beast::detail::base64::encoded_size(compressed->size));
-                        encoded.resize(boost::beast::detail::base64::encode((void *) encoded.data(), (const void *) compressed->data,
-                                                                            compressed->size));                        
-                        output((boost::format("\n;\n; %s begin %dx%d %d\n") % compressed->tag() % data.width % data.height % encoded.size())
-                                   .str()
-                                   .c_str());                        
-                        while (encoded.size() > max_row_length) {
-                            output((boost::format("; %s\n") % encoded.substr(0, max_row_length)).str().c_str());
-                            encoded = encoded.substr(max_row_length);
-                        }
-
-                        // Orca write remaining ecoded data
-                        if (encoded.size() > 0)
-                            output((boost::format("; %s\n") % encoded).str().c_str());
-
-                        output((boost::format("; %s end\n") % compressed->tag()).str().c_str());
-                        output("; THUMBNAIL_BLOCK_END\n\n");
+                        output(thumbnail_block_to_gcode(compressed->tag(), data.width, data.height, compressed->data, compressed->size).c_str());
                     }
                     throw_if_canceled();
                 }
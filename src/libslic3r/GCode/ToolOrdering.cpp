@@ -1142,6 +1142,7 @@ std::vector<int> ToolOrdering::get_recommended_filament_maps(const std::vector<s
             context.group_info.strategy = FGStrategy::BestCost;
             context.group_info.mode = fg_mode;
             context.group_info.ignore_ext_filament = ignore_ext_filament;
+            context.group_info.max_flush_evaluations = print_config.filament_group_search_budget.value;
         }
 
 
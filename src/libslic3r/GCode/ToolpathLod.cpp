@@ -0,0 +1,65 @@
+#include "ToolpathLod.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <tuple>
+
+namespace Slic3r {
+
+static float distance_to_segment(const Vec3f &pt, const Vec3f &a, const Vec3f &b)
+{
+    const Vec3f v  = b - a;
+    const float l2 = v.squaredNorm();
+    if (l2 == 0.f)
+        return (pt - a).norm();
+    const float t = std::clamp((pt - a).dot(v) / l2, 0.f, 1.f);
+    return (pt - (a + t * v)).norm();
+}
+
+std::vector<float> toolpath_lod_errors(const std::vector<Vec3f> &polyline, float min_tolerance)
+{
+    std::vector<float> error(polyline.size(), 0.f);
+    if (polyline.empty())
+        return error;
+    error.front() = error.back() = std::numeric_limits<float>::max();
+
+    // Douglas-Peucker keeps a point for a tolerance if the point and all the points splitting the polyline before it
+    // deviate more than the tolerance. The smallest of these deviations is the error of removing the point,
+    // thus the polyline is split just once for all the tolerances.
+    std::vector<std::tuple<size_t, size_t, float>> stack;
+    if (polyline.size() > 2)
+        stack.emplace_back(0, polyline.size() - 1, std::numeric_limits<float>::max());
+    while (! stack.empty()) {
+        auto [begin, end, parent_error] = stack.back();
+        stack.pop_back();
+        float  max_dist = 0.f;
+        size_t max_idx  = begin;
+        for (size_t i = begin + 1; i < end; ++ i)
+            if (float d = distance_to_segment(polyline[i], polyline[begin], polyline[end]); d > max_dist) {
+                max_dist = d;
+                max_idx  = i;
+            }
+        // Points deviating less than the smallest tolerance are removed at all levels.
+        if (max_dist > min_tolerance) {
+            error[max_idx] = std::min(max_dist, parent_error);
+            if (max_idx - begin > 1)
+                stack.emplace_back(begin, max_idx, error[max_idx]);
+            if (end - max_idx > 1)
+                stack.emplace_back(max_idx, end, error[max_idx]);
+        }
+    }
+    return error;
+}
+
+size_t select_toolpath_lod(const std::vector<float> &tolerances, float mm_per_pixel, float max_error_px)
+{
+    assert(std::is_sorted(tolerances.begin(), tolerances.end()));
+    const float max_error = mm_per_pixel * max_error_px;
+    for (size_t level = tolerances.size(); level > 0; -- level)
+        if (tolerances[level - 1] <= max_error)
+            return level - 1;
+    return tolerances.size();
+}
+
+} // namespace Slic3r
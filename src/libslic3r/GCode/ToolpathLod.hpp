@@ -0,0 +1,23 @@
+// Simplified levels of detail of the toolpaths shown by the G-code preview when zoomed out.
+
+#ifndef slic3r_ToolpathLod_hpp_
+#define slic3r_ToolpathLod_hpp_
+
+#include "../Point.hpp"
+
+#include <vector>
+
+namespace Slic3r {
+
+// Douglas-Peucker simplification of the polyline with all the tolerances at once.
+// Returns the error of removing each point: a point is kept by the simplification with tolerance t if its error is larger than t.
+// The end points are always kept, the points deviating less than min_tolerance get a zero error.
+std::vector<float> toolpath_lod_errors(const std::vector<Vec3f> &polyline, float min_tolerance);
+
+// Index of the coarsest level whose tolerance, in mm, does not exceed max_error_px pixels on the screen.
+// tolerances shall be sorted ascending. Returns tolerances.size() if no level is fine enough and the full detail shall be shown.
+size_t select_toolpath_lod(const std::vector<float> &tolerances, float mm_per_pixel, float max_error_px = 1.f);
+
+} // namespace Slic3r
+
+#endif // slic3r_ToolpathLod_hpp_
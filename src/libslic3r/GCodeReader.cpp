@@ -1,4 +1,5 @@
 #include "GCodeReader.hpp"
+#include "GCode/BinaryGCode.hpp"
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/log/trivial.hpp>
@@ -125,18 +126,45 @@ void GCodeReader::update_coordinates(GCodeLine &gline, std::pair<const char*, co
 template<typename ParseLineCallback, typename LineEndCallback>
 bool GCodeReader::parse_file_raw_internal(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback)
 {
-    FilePtr in{ boost::nowide::fopen(filename.c_str(), "rb") };
+    // A binary G-code is read block by block, each block holds whole lines of the G-code text.
+    // The positions passed to line_end_callback are then the offsets in the G-code text.
+    std::unique_ptr<BinaryGCode::Reader> binary;
+    if (BinaryGCode::is_binary_gcode_file(filename)) {
+        try {
+            binary = std::make_unique<BinaryGCode::Reader>(filename);
+        } catch (const std::exception &ex) {
+            BOOST_LOG_TRIVIAL(error) << ex.what();
+            return false;
+        }
+    }
+    FilePtr in{ binary ? nullptr : boost::nowide::fopen(filename.c_str(), "rb") };
 
     // Read the input stream 64kB at a time, extract lines and process them.
     std::vector<char> buffer(65536 * 10, 0);
+    std::string       block;
+    size_t            next_block = 0;
     // Line buffer.
     std::string gcode_line;
     size_t file_pos = 0;
     m_parsing = true;
     for (;;) {
-        size_t cnt_read = ::fread(buffer.data(), 1, buffer.size(), in.f);
-        if (::ferror(in.f))
-            return false;
+        size_t cnt_read = 0;
+        if (binary) {
+            if (next_block < binary->blocks_count()) {
+                try {
+                    binary->read_block(next_block ++, block);
+                } catch (const std::exception &ex) {
+                    BOOST_LOG_TRIVIAL(error) << ex.what();
+                    return false;
+                }
+                buffer.assign(block.begin(), block.end());
+                cnt_read = buffer.size();
+            }
+        } else {
+            cnt_read = ::fread(buffer.data(), 1, buffer.size(), in.f);
+            if (::ferror(in.f))
+                return false;
+        }
         bool eof       = cnt_read == 0;
         auto it        = buffer.begin();
         auto it_bufend = buffer.begin() + cnt_read;
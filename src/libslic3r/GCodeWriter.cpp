@@ -882,6 +882,34 @@ std::string GCodeWriter::extrude_to_xy(const Vec2d &point, double dE, const std:
     return w.string();
 }
 
+void GCodeWriter::extrude_polyline_to_xy(const std::vector<Vec2d> &points, const std::vector<double> &dEs, const std::string &comment, bool force_no_extrusion, std::string &gcode)
+{
+    assert(points.size() == dEs.size());
+    if (points.empty())
+        return;
+
+    m_pos(0) = points.back()(0);
+    m_pos(1) = points.back()(1);
+
+    Extruder   *extruder     = filament();
+    const bool  with_comment = GCodeWriter::full_gcode_comment && ! comment.empty();
+    // "G1 X-123.456 Y-123.456 E-1234.56789\n" is 37 characters long.
+    gcode.reserve(gcode.size() + points.size() * (40 + (with_comment ? comment.size() + 3 : 0)));
+    for (size_t i = 0; i < points.size(); ++ i) {
+        const bool no_extrusion = force_no_extrusion || std::abs(dEs[i]) <= std::numeric_limits<double>::epsilon();
+        if (! no_extrusion)
+            extruder->extrude(dEs[i]);
+
+        //BBS: take plate offset into consider
+        GCodeG1Formatter w;
+        w.emit_xy({ points[i](0) - m_x_offset, points[i](1) - m_y_offset });
+        if (! no_extrusion)
+            w.emit_e(extruder->E());
+        w.emit_comment(GCodeWriter::full_gcode_comment, comment);
+        w.append_to(gcode);
+    }
+}
+
 //BBS: generate G2 or G3 extrude which moves by arc
 //point is end point which means X and Y axis
 //center_offset is I and J axis
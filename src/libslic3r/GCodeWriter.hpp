@@ -78,6 +78,9 @@ public:
     std::string travel_to_z(double z, const std::string &comment = std::string(), bool force = false);
     bool        will_move_z(double z) const;
     std::string extrude_to_xy(const Vec2d &point, double dE, const std::string &comment = std::string(), bool force_no_extrusion = false);
+    // Extrude through the points, appending one G1 line per point to gcode. Produces the same output as extrude_to_xy()
+    // called for each point with the matching dE, without formatting each line into a temporary string.
+    void        extrude_polyline_to_xy(const std::vector<Vec2d> &points, const std::vector<double> &dEs, const std::string &comment, bool force_no_extrusion, std::string &gcode);
     //BBS: generate G2 or G3 extrude which moves by arc
     std::string extrude_arc_to_xy(const Vec2d &point, const Vec2d &center_offset, double dE, const bool is_ccw, const std::string &comment = std::string(), bool force_no_extrusion = false);
     std::string extrude_to_xyz(const Vec3d &point, double dE, const std::string &comment = std::string(), bool force_no_extrusion = false);
@@ -273,6 +276,11 @@ public:
         return std::string(this->buf, ptr_err.ptr - buf);
     }
 
+    void append_to(std::string &out) {
+        *ptr_err.ptr ++ = '\n';
+        out.append(this->buf, ptr_err.ptr - buf);
+    }
+
 protected:
     static constexpr const size_t   buflen = 256;
     char                            buf[buflen];
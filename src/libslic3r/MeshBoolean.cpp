@@ -475,6 +475,16 @@ bool empty(const CGALMesh &mesh)
     return mesh.m.is_empty();
 }
 
+size_t memory_size(const CGALMesh &mesh)
+{
+    using Index = _EpicMesh::Vertex_index;
+    // A vertex stores its point and a halfedge, a halfedge its vertex, face, next and previous halfedge, a face a halfedge.
+    return sizeof(CGALMesh) +
+           mesh.m.number_of_vertices() * (sizeof(EpicKernel::Point_3) + sizeof(Index)) +
+           mesh.m.number_of_halfedges() * 4 * sizeof(Index) +
+           mesh.m.number_of_faces() * sizeof(Index);
+}
+
 CGALMeshPtr clone(const CGALMesh &m)
 {
     return CGALMeshPtr{new CGALMesh{m}};
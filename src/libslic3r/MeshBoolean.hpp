@@ -70,6 +70,8 @@ TriangleMesh merge(std::vector<TriangleMesh> meshes);
 
 bool does_bound_a_volume(const CGALMesh &mesh);
 bool empty(const CGALMesh &mesh);
+// Estimate of the memory occupied by the mesh, in bytes.
+size_t memory_size(const CGALMesh &mesh);
 }
 
 namespace mcut {
@@ -0,0 +1,133 @@
+#include "MeshSlicesCache.hpp"
+#include "TriangleMesh.hpp"
+
+#include <algorithm>
+
+namespace Slic3r {
+
+static bool same_slicing_params(const MeshSlicingParamsEx &l, const MeshSlicingParamsEx &r)
+{
+    return l.mode == r.mode && l.slicing_mode_normal_below_layer == r.slicing_mode_normal_below_layer && l.mode_below == r.mode_below &&
+           l.closing_radius == r.closing_radius && l.extra_offset == r.extra_offset && l.resolution == r.resolution;
+}
+
+static size_t slices_bytes(const std::vector<ExPolygons> &slices)
+{
+    size_t bytes = sizeof(ExPolygons) * slices.size();
+    for (const ExPolygons &expolygons : slices)
+        for (const ExPolygon &expolygon : expolygons) {
+            bytes += sizeof(ExPolygon) + sizeof(Point) * expolygon.contour.size();
+            for (const Polygon &hole : expolygon.holes)
+                bytes += sizeof(Polygon) + sizeof(Point) * hole.size();
+        }
+    return bytes;
+}
+
+MeshSlicesCache::SlicesPtr MeshSlicesCache::slice(const std::shared_ptr<const TriangleMesh> &mesh,
+                                                  const std::vector<float>                  &zs,
+                                                  const MeshSlicingParamsEx                 &params,
+                                                  const std::function<Slices()>             &slice_fn)
+{
+    if (! mesh)
+        return std::make_shared<const Slices>(slice_fn());
+
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        auto range = m_entries.equal_range(mesh.get());
+        for (auto it = range.first; it != range.second; ++ it) {
+            Entry &entry = it->second;
+            if (entry.params.trafo.matrix() == params.trafo.matrix() && same_slicing_params(entry.params, params) &&
+                entry.zs == zs && entry.scaling_factor == SCALING_FACTOR) {
+                ++ m_hits;
+                entry.last_used = ++ m_time;
+                return entry.slices;
+            }
+        }
+        ++ m_misses;
+    }
+
+    // Slice outside of the lock, other meshes may be sliced in parallel.
+    auto         slices = std::make_shared<const Slices>(slice_fn());
+    const size_t bytes  = slices_bytes(*slices);
+
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    auto range = m_entries.equal_range(mesh.get());
+    auto it    = std::find_if(range.first, range.second, [&params](const auto &kvp) { return kvp.second.params.trafo.matrix() == params.trafo.matrix(); });
+    if (it == range.second)
+        it = m_entries.emplace(mesh.get(), Entry{ mesh });
+    Entry &entry         = it->second;
+    m_bytes             -= entry.bytes;
+    entry.params         = params;
+    entry.zs             = zs;
+    entry.scaling_factor = SCALING_FACTOR;
+    entry.slices         = slices;
+    entry.bytes          = bytes;
+    entry.last_used      = ++ m_time;
+    m_bytes             += bytes;
+    this->evict(&entry);
+    return slices;
+}
+
+void MeshSlicesCache::evict(const Entry *keep)
+{
+    while (m_bytes > m_max_bytes) {
+        auto lru = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++ it)
+            if (&it->second != keep && (lru == m_entries.end() || it->second.last_used < lru->second.last_used))
+                lru = it;
+        if (lru == m_entries.end())
+            break;
+        m_bytes -= lru->second.bytes;
+        m_entries.erase(lru);
+    }
+}
+
+void MeshSlicesCache::prune()
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        // Entries of the same mesh are adjacent, each of them holds a reference to the mesh.
+        auto range = m_entries.equal_range(it->first);
+        if (it->second.mesh.use_count() <= long(std::distance(range.first, range.second))) {
+            for (auto it2 = range.first; it2 != range.second; ++ it2)
+                m_bytes -= it2->second.bytes;
+            it = m_entries.erase(range.first, range.second);
+        } else
+            it = range.second;
+    }
+}
+
+void MeshSlicesCache::clear()
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_bytes  = 0;
+    m_hits   = 0;
+    m_misses = 0;
+}
+
+size_t MeshSlicesCache::size() const
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+size_t MeshSlicesCache::bytes() const
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_bytes;
+}
+
+size_t MeshSlicesCache::hits() const
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_hits;
+}
+
+size_t MeshSlicesCache::misses() const
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_misses;
+}
+
+} // namespace Slic3r
@@ -0,0 +1,87 @@
+#ifndef slic3r_MeshSlicesCache_hpp_
+#define slic3r_MeshSlicesCache_hpp_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <admesh/stl.h>
+
+#include "ExPolygon.hpp"
+#include "TriangleMeshSlicer.hpp"
+
+namespace Slic3r {
+
+class TriangleMesh;
+
+// Slices of the meshes of model volumes, shared by the objects of a Print and kept between slicing runs.
+//
+// The slices depend on the mesh, on its transformation, on the Z of the layers (thus on the layer height profile)
+// and on the mesh slicing parameters only. Objects made of the same meshes, which differ in their placement or in
+// settings not affecting the slicing (walls, infill, supports...), and objects sliced again after such settings
+// were changed reuse the slices instead of slicing their meshes again.
+//
+// A single set of slices is kept for a mesh and transformation, slicing with different layers replaces it.
+// The size of the cache is bounded, the least recently used slices are released first, thus the slices of the poses
+// an object was rotated or scaled through don't pile up. The cache holds a reference to the meshes, prune() releases
+// the meshes no more referenced by the model.
+// Thread safe.
+class MeshSlicesCache
+{
+public:
+    using Slices    = std::vector<ExPolygons>;
+    using SlicesPtr = std::shared_ptr<const Slices>;
+
+    // Approximate size of the slices kept by default.
+    static constexpr size_t DefaultMaxBytes = size_t(256) << 20;
+
+    explicit MeshSlicesCache(size_t max_bytes = DefaultMaxBytes) : m_max_bytes(max_bytes) {}
+
+    // Slices of the mesh transformed by params.trafo at zs, either cached or produced by slice_fn().
+    // The slices are shared with the cache, they are never modified.
+    SlicesPtr slice(const std::shared_ptr<const TriangleMesh> &mesh,
+                    const std::vector<float>                  &zs,
+                    const MeshSlicingParamsEx                 &params,
+                    const std::function<Slices()>             &slice_fn);
+
+    // Release the slices of the meshes referenced by the cache only.
+    void   prune();
+    void   clear();
+
+    // Number of the sets of slices cached and their approximate size.
+    size_t size() const;
+    size_t bytes() const;
+    size_t hits() const;
+    size_t misses() const;
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<const TriangleMesh> mesh;
+        MeshSlicingParamsEx                 params;
+        std::vector<float>                  zs;
+        // Slices are scaled, thus they depend on the scaling factor of the printer.
+        double                              scaling_factor;
+        SlicesPtr                           slices;
+        size_t                              bytes { 0 };
+        // Value of m_time at the last access.
+        size_t                              last_used { 0 };
+    };
+
+    // Release the least recently used slices until the cache fits into m_max_bytes, except for keep. m_mutex shall be locked.
+    void evict(const Entry *keep);
+
+    mutable std::mutex                                       m_mutex;
+    std::unordered_multimap<const TriangleMesh*, Entry>      m_entries;
+    size_t                                                   m_max_bytes;
+    size_t                                                   m_bytes { 0 };
+    size_t                                                   m_time { 0 };
+    size_t                                                   m_hits { 0 };
+    size_t                                                   m_misses { 0 };
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_MeshSlicesCache_hpp_
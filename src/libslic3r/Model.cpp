@@ -3452,8 +3452,7 @@ bool FacetsAnnotation::set(const TriangleSelector& selector)
 
 void FacetsAnnotation::reset()
 {
-    m_data.triangles_to_split.clear();
-    m_data.bitstream.clear();
+    m_data.clear();
     this->touch();
 }
 
@@ -3493,6 +3492,8 @@ void FacetsAnnotation::set_triangle_from_string(int triangle_id, const std::stri
     m_data.triangles_to_split.emplace_back(triangle_id, int(m_data.bitstream.size()));
 
     const size_t bitstream_start_idx = m_data.bitstream.size();
+    std::vector<uint8_t> codes;
+    codes.reserve(str.size());
     for (auto it = str.crbegin(); it != str.crend(); ++it) {
         const char ch = *it;
         int dec = 0;
@@ -3502,17 +3503,23 @@ void FacetsAnnotation::set_triangle_from_string(int triangle_id, const std::stri
             dec = 10 + int(ch - 'A');
         else
             assert(false);
+        codes.emplace_back(uint8_t(dec));
+    }
 
-        // Convert to binary and append into code.
+    // Convert to binary and append into code.
+    m_data.bitstream.resize(bitstream_start_idx + 4 * codes.size());
+    auto bit_it = m_data.bitstream.begin() + bitstream_start_idx;
+    for (uint8_t code : codes)
         for (int i = 0; i < 4; ++i)
-            m_data.bitstream.insert(m_data.bitstream.end(), bool(dec & (1 << i)));
-    }
+            *bit_it ++ = bool(code & (1 << i));
 
+    m_data.append_root_hash(TriangleSelector::TriangleSplittingData::root_hash(triangle_id, codes.data(), codes.size()));
     m_data.update_used_states(bitstream_start_idx);
 }
 
 bool FacetsAnnotation::equals(const FacetsAnnotation &other) const
 {
+    // The hashes of the paintings reject quickly, the bitstreams are compared only if the hashes match.
     const auto& data = other.get_data();
     return (m_data == data);
 }
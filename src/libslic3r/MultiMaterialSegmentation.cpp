@@ -12,6 +12,7 @@
 #include <unordered_set>
 
 #include <boost/log/trivial.hpp>
+#include <boost/functional/hash.hpp>
 #include <tbb/parallel_for.h>
 #include <mutex>
 #include <boost/thread/lock_guard.hpp>
@@ -1952,6 +1953,231 @@ static bool has_layer_only_one_color(const std::vector<ColoredLines> &colored_po
     return true;
 }
 
+// Painted facets of all model volumes transformed into the coordinates of the print object, bucketed into Z bands,
+// so that the painted facets intersecting a layer can be looked up without iterating over all painted facets.
+struct PaintedFacetsIndex
+{
+    struct Facet
+    {
+        // Vertices sorted by Z.
+        std::array<Vec3f, 3> vertices;
+        // Facet is projected into layers with slice_z in (min_slice_z, max_slice_z].
+        float                min_slice_z;
+        float                max_slice_z;
+        int                  state;
+    };
+
+    std::vector<Facet>                 facets;
+    double                             min_z       { 0. };
+    double                             band_height { 1. };
+    // Indices of facets overlapping each of the Z bands.
+    std::vector<std::vector<uint32_t>> bands;
+
+    size_t band_idx(double z) const { return size_t(std::clamp(std::floor((z - min_z) / band_height), 0., double(bands.size() - 1))); }
+
+    // Facets, which may be projected into a layer at slice_z.
+    const std::vector<uint32_t> *band(double slice_z) const
+    {
+        return bands.empty() || slice_z < min_z ? nullptr : &bands[band_idx(slice_z)];
+    }
+};
+
+static std::shared_ptr<const PaintedFacetsIndex> build_painted_facets_index(const PrintObject                                               &print_object,
+                                                                            const std::function<ModelVolumeFacetsInfo(const ModelVolume &)> &extract_facets_info,
+                                                                            const size_t                                                     num_facets_states,
+                                                                            const std::function<void()>                                     &throw_on_cancel_callback)
+{
+    auto index = std::make_shared<PaintedFacetsIndex>();
+    for (const ModelVolume *mv : print_object.model_object()->volumes) {
+        if (!mv->is_model_part())
+            continue;
+
+        const ModelVolumeFacetsInfo                      facets_info = extract_facets_info(*mv);
+        const Transform3f                                tr          = print_object.trafo().cast<float>() * mv->get_matrix().cast<float>();
+        std::vector<std::vector<PaintedFacetsIndex::Facet>> facets_per_state(num_facets_states);
+        tbb::parallel_for(tbb::blocked_range<size_t>(1, num_facets_states), [&mv, &facets_info, &tr, &facets_per_state, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+            for (size_t state_idx = range.begin(); state_idx < range.end(); ++state_idx) {
+                throw_on_cancel_callback();
+                const indexed_triangle_set custom_facets = facets_info.facets_annotation.get_facets(*mv, EnforcerBlockerType(state_idx));
+                std::vector<PaintedFacetsIndex::Facet> &facets = facets_per_state[state_idx];
+                facets.reserve(custom_facets.indices.size());
+                for (const stl_triangle_vertex_indices &indices : custom_facets.indices) {
+                    PaintedFacetsIndex::Facet facet;
+                    float min_z = std::numeric_limits<float>::max();
+                    float max_z = std::numeric_limits<float>::lowest();
+                    for (int p_idx = 0; p_idx < 3; ++p_idx) {
+                        facet.vertices[p_idx] = tr * custom_facets.vertices[indices(p_idx)];
+                        max_z                 = std::max(max_z, facet.vertices[p_idx].z());
+                        min_z                 = std::min(min_z, facet.vertices[p_idx].z());
+                    }
+
+                    if (is_equal(min_z, max_z))
+                        continue;
+
+                    // Sort the vertices by z-axis for simplification of projected_facet on slices
+                    std::sort(facet.vertices.begin(), facet.vertices.end(), [](const Vec3f &p1, const Vec3f &p2) { return p1.z() < p2.z(); });
+                    facet.min_slice_z = float(min_z - EPSILON);
+                    facet.max_slice_z = float(max_z + EPSILON);
+                    facet.state       = int(state_idx);
+                    facets.emplace_back(facet);
+                }
+            }
+        }); // end of parallel_for
+
+        for (std::vector<PaintedFacetsIndex::Facet> &facets : facets_per_state)
+            Slic3r::append(index->facets, std::move(facets));
+    }
+
+    if (index->facets.empty())
+        return index;
+
+    float min_z = std::numeric_limits<float>::max();
+    float max_z = std::numeric_limits<float>::lowest();
+    for (const PaintedFacetsIndex::Facet &facet : index->facets) {
+        min_z = std::min(min_z, facet.min_slice_z);
+        max_z = std::max(max_z, facet.max_slice_z);
+    }
+
+    // About sqrt(N) bands, so that both the number of bands and the number of facets in a band stay reasonable.
+    const size_t num_bands = std::clamp<size_t>(size_t(std::sqrt(double(index->facets.size()))), 1, 4096);
+    index->min_z           = double(min_z);
+    index->band_height     = std::max(double(max_z - min_z) / double(num_bands), EPSILON);
+    index->bands.assign(num_bands, {});
+    for (uint32_t facet_idx = 0; facet_idx < uint32_t(index->facets.size()); ++facet_idx) {
+        const PaintedFacetsIndex::Facet &facet = index->facets[facet_idx];
+        for (size_t band_idx = index->band_idx(facet.min_slice_z); band_idx <= index->band_idx(facet.max_slice_z); ++band_idx)
+            index->bands[band_idx].emplace_back(facet_idx);
+    }
+
+    return index;
+}
+
+// Identifies the painting of all model volumes of the print object together with their meshes and placement.
+// The meshes are identified by their content, a mesh released and another allocated at the same address must not match.
+static size_t painted_facets_hash(const PrintObject &print_object, const std::function<ModelVolumeFacetsInfo(const ModelVolume &)> &extract_facets_info, const size_t num_facets_states)
+{
+    size_t seed = 0;
+    boost::hash_combine(seed, std::hash<size_t>{}(num_facets_states));
+    const auto hash_matrix = [&seed](const Transform3d &trafo) {
+        for (int i = 0; i < 16; ++i)
+            boost::hash_combine(seed, std::hash<double>{}(trafo.matrix().data()[i]));
+    };
+
+    hash_matrix(print_object.trafo());
+    boost::hash_combine(seed, std::hash<coord_t>{}(print_object.center_offset().x()));
+    boost::hash_combine(seed, std::hash<coord_t>{}(print_object.center_offset().y()));
+    for (const ModelVolume *mv : print_object.model_object()->volumes) {
+        const ModelVolumeFacetsInfo facets_info = extract_facets_info(*mv);
+        boost::hash_combine(seed, std::hash<size_t>{}(mv->id().id));
+        boost::hash_combine(seed, std::hash<bool>{}(mv->is_model_part()));
+        boost::hash_combine(seed, std::hash<bool>{}(facets_info.is_painted));
+        boost::hash_combine(seed, std::hash<size_t>{}(facets_info.facets_annotation.timestamp()));
+        const indexed_triangle_set &its = mv->mesh().its;
+        boost::hash_combine(seed, std::hash<size_t>{}(its.vertices.size()));
+        boost::hash_combine(seed, std::hash<size_t>{}(its.indices.size()));
+        for (const stl_vertex &vertex : its.vertices)
+            for (int i = 0; i < 3; ++i)
+                boost::hash_combine(seed, std::hash<float>{}(vertex(i)));
+        for (const stl_triangle_vertex_indices &indices : its.indices)
+            for (int i = 0; i < 3; ++i)
+                boost::hash_combine(seed, std::hash<int>{}(indices(i)));
+        hash_matrix(mv->get_matrix());
+    }
+    return seed;
+}
+
+// Identifies the processed slices of a layer and the area they are projected into.
+static size_t layer_slices_hash(const ExPolygons &expolygons, const BoundingBox &edge_grid_bbox)
+{
+    size_t seed = 0;
+    const auto hash_points = [&seed](const Points &pts) {
+        boost::hash_combine(seed, std::hash<size_t>{}(pts.size()));
+        for (const Point &pt : pts) {
+            boost::hash_combine(seed, std::hash<coord_t>{}(pt.x()));
+            boost::hash_combine(seed, std::hash<coord_t>{}(pt.y()));
+        }
+    };
+
+    for (const ExPolygon &expolygon : expolygons) {
+        hash_points(expolygon.contour.points);
+        boost::hash_combine(seed, std::hash<size_t>{}(expolygon.holes.size()));
+        for (const Polygon &hole : expolygon.holes)
+            hash_points(hole.points);
+    }
+    hash_points({edge_grid_bbox.min, edge_grid_bbox.max});
+    return seed;
+}
+
+size_t PaintedSegmentationCache::LayerKeyHash::operator()(const LayerKey &key) const
+{
+    size_t seed = key.paint_hash;
+    boost::hash_combine(seed, std::hash<size_t>{}(key.num_facets_states));
+    boost::hash_combine(seed, std::hash<double>{}(key.slice_z));
+    boost::hash_combine(seed, std::hash<size_t>{}(key.slice_hash));
+    return seed;
+}
+
+std::shared_ptr<const PaintedFacetsIndex> PaintedSegmentationCache::facets_index(size_t paint_hash, size_t num_facets_states) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_facets_index && m_paint_hash == paint_hash && m_num_facets_states == num_facets_states ? m_facets_index : nullptr;
+}
+
+void PaintedSegmentationCache::set_facets_index(size_t paint_hash, size_t num_facets_states, std::shared_ptr<const PaintedFacetsIndex> index)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_paint_hash        = paint_hash;
+    m_num_facets_states = num_facets_states;
+    m_facets_index      = std::move(index);
+}
+
+bool PaintedSegmentationCache::find_layer(const LayerKey &key, std::vector<ExPolygons> &segmented_layer)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (auto it = m_layers.find(key); it != m_layers.end()) {
+        segmented_layer = it->second;
+    } else if (auto it_previous = m_layers_previous.find(key); it_previous != m_layers_previous.end()) {
+        segmented_layer = it_previous->second;
+        m_layers.emplace(key, std::move(it_previous->second));
+        m_layers_previous.erase(it_previous);
+    } else
+        return false;
+
+    ++m_num_hits;
+    return true;
+}
+
+void PaintedSegmentationCache::insert_layer(const LayerKey &key, const std::vector<ExPolygons> &segmented_layer)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_layers.emplace(key, segmented_layer);
+}
+
+void PaintedSegmentationCache::begin_run()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_layers_previous.merge(m_layers);
+    m_layers.clear();
+    m_num_hits = 0;
+}
+
+void PaintedSegmentationCache::end_run()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_layers_previous.clear();
+}
+
+void PaintedSegmentationCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_paint_hash        = 0;
+    m_num_facets_states = 0;
+    m_facets_index.reset();
+    m_layers.clear();
+    m_layers_previous.clear();
+    m_num_hits = 0;
+}
+
 std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject                                               &print_object,
                                                               const std::function<ModelVolumeFacetsInfo(const ModelVolume &)> &extract_facets_info,
                                                               const size_t                                                     num_facets_states,
@@ -1959,13 +2185,13 @@ std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject
                                                               const float                                                      segmentation_interlocking_depth,
                                                               const bool                                                       segmentation_interlocking_beam,
                                                               const IncludeTopAndBottomLayers                                  include_top_and_bottom_layers,
-                                                              const std::function<void()>                                     &throw_on_cancel_callback)
+                                                              const std::function<void()>                                     &throw_on_cancel_callback,
+                                                              PaintedSegmentationCache                                        *cache)
 {
     const size_t                          num_layers    = print_object.layers().size();
     std::vector<std::vector<ExPolygons>>  segmented_regions(num_layers);
     segmented_regions.assign(num_layers, std::vector<ExPolygons>(num_facets_states));
     std::vector<std::vector<PaintedLine>> painted_lines(num_layers);
-    std::array<std::mutex, 64>            painted_lines_mutex;
     std::vector<EdgeGrid::Grid>           edge_grids(num_layers);
     const ConstLayerPtrsAdaptor           layers = print_object.layers();
     std::vector<ExPolygons>               input_expolygons(num_layers);
@@ -2027,106 +2253,109 @@ std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject
         edge_grids[layer_idx].create(input_expolygons[layer_idx], coord_t(scale_(10.)));
     }
 
+    const size_t                              paint_hash    = painted_facets_hash(print_object, extract_facets_info, num_facets_states);
+    std::shared_ptr<const PaintedFacetsIndex> facets_index  = cache ? cache->facets_index(paint_hash, num_facets_states) : nullptr;
+    if (!facets_index) {
+        BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - Indexing of painted triangles - Begin";
+        facets_index = build_painted_facets_index(print_object, extract_facets_info, num_facets_states, throw_on_cancel_callback);
+        if (cache)
+            cache->set_facets_index(paint_hash, num_facets_states, facets_index);
+        BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - Indexing of painted triangles - End";
+    }
+
+    // Layers with the same painting, slice_z and processed slices as in the previous segmentation are taken from the cache.
+    std::vector<PaintedSegmentationCache::LayerKey> layer_keys(num_layers);
+    std::vector<char>                               layer_cached(num_layers, false);
+    if (cache)
+        cache->begin_run();
+
     BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - Projection of painted triangles - Begin";
-    for (const ModelVolume *mv : print_object.model_object()->volumes) {
-        const ModelVolumeFacetsInfo facets_info = extract_facets_info(*mv);
-        tbb::parallel_for(tbb::blocked_range<size_t>(1, num_facets_states), [&mv, &print_object, &facets_info, &layers, &edge_grids, &painted_lines, &painted_lines_mutex, &input_expolygons, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
-            for (size_t extruder_idx = range.begin(); extruder_idx < range.end(); ++extruder_idx) {
-                throw_on_cancel_callback();
-                const indexed_triangle_set custom_facets = facets_info.facets_annotation.get_facets(*mv, EnforcerBlockerType(extruder_idx));
-                if (!mv->is_model_part() || custom_facets.indices.empty())
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&print_object, &facets_index, &layers, &edge_grids, &input_expolygons, &painted_lines, &segmented_regions, &layer_keys, &layer_cached, &cache, paint_hash, num_facets_states, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+            throw_on_cancel_callback();
+            const Layer *layer = layers[layer_idx];
+            if (cache) {
+                layer_keys[layer_idx] = { paint_hash, num_facets_states, layer->slice_z, layer_slices_hash(input_expolygons[layer_idx], edge_grids[layer_idx].bbox()) };
+                if (cache->find_layer(layer_keys[layer_idx], segmented_regions[layer_idx])) {
+                    layer_cached[layer_idx] = true;
                     continue;
+                }
+            }
 
-                const Transform3f tr = print_object.trafo().cast<float>() * mv->get_matrix().cast<float>();
-                tbb::parallel_for(tbb::blocked_range<size_t>(0, custom_facets.indices.size()), [&tr, &custom_facets, &print_object, &layers, &edge_grids, &input_expolygons, &painted_lines, &painted_lines_mutex, &extruder_idx](const tbb::blocked_range<size_t> &range) {
-                    for (size_t facet_idx = range.begin(); facet_idx < range.end(); ++facet_idx) {
-                        float min_z = std::numeric_limits<float>::max();
-                        float max_z = std::numeric_limits<float>::lowest();
-
-                        std::array<Vec3f, 3> facet;
-                        for (int p_idx = 0; p_idx < 3; ++p_idx) {
-                            facet[p_idx] = tr * custom_facets.vertices[custom_facets.indices[facet_idx](p_idx)];
-                            max_z        = std::max(max_z, facet[p_idx].z());
-                            min_z        = std::min(min_z, facet[p_idx].z());
-                        }
+            const std::vector<uint32_t> *band = facets_index->band(layer->slice_z);
+            if (input_expolygons[layer_idx].empty() || band == nullptr)
+                continue;
 
-                        if (is_equal(min_z, max_z))
-                            continue;
-
-                        // Sort the vertices by z-axis for simplification of projected_facet on slices
-                        std::sort(facet.begin(), facet.end(), [](const Vec3f &p1, const Vec3f &p2) { return p1.z() < p2.z(); });
-
-                        // Find lowest slice not below the triangle.
-                        auto first_layer = std::upper_bound(layers.begin(), layers.end(), float(min_z - EPSILON),
-                                                            [](float z, const Layer *l1) { return z < l1->slice_z; });
-                        auto last_layer  = std::upper_bound(layers.begin(), layers.end(), float(max_z + EPSILON),
-                                                           [](float z, const Layer *l1) { return z < l1->slice_z; });
-                        --last_layer;
-
-                        for (auto layer_it = first_layer; layer_it != (last_layer + 1); ++layer_it) {
-                            const Layer *layer     = *layer_it;
-                            size_t       layer_idx = layer_it - layers.begin();
-                            if (input_expolygons[layer_idx].empty() || is_less(layer->slice_z, facet[0].z()) || is_less(facet[2].z(), layer->slice_z))
-                                continue;
-
-                            // https://kandepet.com/3d-printing-slicing-3d-objects/
-                            float t            = (float(layer->slice_z) - facet[0].z()) / (facet[2].z() - facet[0].z());
-                            Vec3f line_start_f = facet[0] + t * (facet[2] - facet[0]);
-                            Vec3f line_end_f;
-
-                            // BBS: When one side of a triangle coincides with the slice_z.
-                            if ((is_equal(facet[0].z(), facet[1].z()) && is_equal(facet[1].z(), layer->slice_z))
-                                || (is_equal(facet[1].z(), facet[2].z()) && is_equal(facet[1].z(), layer->slice_z))) {
-                                line_end_f = facet[1];
-                            }
-                            else if (facet[1].z() > layer->slice_z) {
-                                // [P0, P2] and [P0, P1]
-                                float t1   = (float(layer->slice_z) - facet[0].z()) / (facet[1].z() - facet[0].z());
-                                line_end_f = facet[0] + t1 * (facet[1] - facet[0]);
-                            } else {
-                                // [P0, P2] and [P1, P2]
-                                float t2   = (float(layer->slice_z) - facet[1].z()) / (facet[2].z() - facet[1].z());
-                                line_end_f = facet[1] + t2 * (facet[2] - facet[1]);
-                            }
+            // Only this thread writes into painted_lines of this layer.
+            std::mutex  painted_lines_mutex;
+            BoundingBox edge_grid_bbox = edge_grids[layer_idx].bbox();
+            edge_grid_bbox.offset(10 * scale_(EPSILON));
+            for (const uint32_t facet_idx : *band) {
+                const PaintedFacetsIndex::Facet &painted_facet = facets_index->facets[facet_idx];
+                const std::array<Vec3f, 3>      &facet         = painted_facet.vertices;
+                assert(painted_facet.state >= 0 && size_t(painted_facet.state) < num_facets_states);
+                // Only layers with the lowest slice not below the triangle up to the highest slice not above the triangle.
+                if (!(painted_facet.min_slice_z < layer->slice_z && layer->slice_z <= painted_facet.max_slice_z))
+                    continue;
 
-                            Line line_to_test(Point(scale_(line_start_f.x()), scale_(line_start_f.y())),
-                                              Point(scale_(line_end_f.x()), scale_(line_end_f.y())));
-                            line_to_test.translate(-print_object.center_offset());
-
-                            // BoundingBoxes for EdgeGrids are computed from printable regions. It is possible that the painted line (line_to_test) could
-                            // be outside EdgeGrid's BoundingBox, for example, when the negative volume is used on the painted area (GH #7618).
-                            // To ensure that the painted line is always inside EdgeGrid's BoundingBox, it is clipped by EdgeGrid's BoundingBox in cases
-                            // when any of the endpoints of the line are outside the EdgeGrid's BoundingBox.
-                            BoundingBox edge_grid_bbox = edge_grids[layer_idx].bbox();
-                            edge_grid_bbox.offset(10 * scale_(EPSILON));
-                            if (!edge_grid_bbox.contains(line_to_test.a) || !edge_grid_bbox.contains(line_to_test.b)) {
-                                // If the painted line (line_to_test) is entirely outside EdgeGrid's BoundingBox, skip this painted line.
-                                if (!edge_grid_bbox.overlap(BoundingBox(Points{line_to_test.a, line_to_test.b})) ||
-                                    !line_to_test.clip_with_bbox(edge_grid_bbox))
-                                    continue;
-                            }
+                if (is_less(layer->slice_z, facet[0].z()) || is_less(facet[2].z(), layer->slice_z))
+                    continue;
 
-                            size_t mutex_idx = layer_idx & 0x3F;
-                            assert(mutex_idx < painted_lines_mutex.size());
+                // https://kandepet.com/3d-printing-slicing-3d-objects/
+                float t            = (float(layer->slice_z) - facet[0].z()) / (facet[2].z() - facet[0].z());
+                Vec3f line_start_f = facet[0] + t * (facet[2] - facet[0]);
+                Vec3f line_end_f;
 
-                            PaintedLineVisitor visitor(edge_grids[layer_idx], painted_lines[layer_idx], painted_lines_mutex[mutex_idx], 16);
-                            visitor.line_to_test = line_to_test;
-                            visitor.color        = int(extruder_idx);
-                            edge_grids[layer_idx].visit_cells_intersecting_line(line_to_test.a, line_to_test.b, visitor);
-                        }
-                    }
-                }); // end of parallel_for
+                // BBS: When one side of a triangle coincides with the slice_z.
+                if ((is_equal(facet[0].z(), facet[1].z()) && is_equal(facet[1].z(), layer->slice_z))
+                    || (is_equal(facet[1].z(), facet[2].z()) && is_equal(facet[1].z(), layer->slice_z))) {
+                    line_end_f = facet[1];
+                }
+                else if (facet[1].z() > layer->slice_z) {
+                    // [P0, P2] and [P0, P1]
+                    float t1   = (float(layer->slice_z) - facet[0].z()) / (facet[1].z() - facet[0].z());
+                    line_end_f = facet[0] + t1 * (facet[1] - facet[0]);
+                } else {
+                    // [P0, P2] and [P1, P2]
+                    float t2   = (float(layer->slice_z) - facet[1].z()) / (facet[2].z() - facet[1].z());
+                    line_end_f = facet[1] + t2 * (facet[2] - facet[1]);
+                }
+
+                Line line_to_test(Point(scale_(line_start_f.x()), scale_(line_start_f.y())),
+                                  Point(scale_(line_end_f.x()), scale_(line_end_f.y())));
+                line_to_test.translate(-print_object.center_offset());
+
+                // BoundingBoxes for EdgeGrids are computed from printable regions. It is possible that the painted line (line_to_test) could
+                // be outside EdgeGrid's BoundingBox, for example, when the negative volume is used on the painted area (GH #7618).
+                // To ensure that the painted line is always inside EdgeGrid's BoundingBox, it is clipped by EdgeGrid's BoundingBox in cases
+                // when any of the endpoints of the line are outside the EdgeGrid's BoundingBox.
+                if (!edge_grid_bbox.contains(line_to_test.a) || !edge_grid_bbox.contains(line_to_test.b)) {
+                    // If the painted line (line_to_test) is entirely outside EdgeGrid's BoundingBox, skip this painted line.
+                    if (!edge_grid_bbox.overlap(BoundingBox(Points{line_to_test.a, line_to_test.b})) ||
+                        !line_to_test.clip_with_bbox(edge_grid_bbox))
+                        continue;
+                }
+
+                PaintedLineVisitor visitor(edge_grids[layer_idx], painted_lines[layer_idx], painted_lines_mutex, 16);
+                visitor.line_to_test = line_to_test;
+                visitor.color        = painted_facet.state;
+                edge_grids[layer_idx].visit_cells_intersecting_line(line_to_test.a, line_to_test.b, visitor);
             }
-        }); // end of parallel_for
-    }
+        }
+    }); // end of parallel_for
     BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - projection of painted triangles - end";
     BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - painted layers count: "
                              << std::count_if(painted_lines.begin(), painted_lines.end(), [](const std::vector<PaintedLine> &pl) { return !pl.empty(); });
+    if (cache)
+        BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - layers reused from cache: " << std::count(layer_cached.begin(), layer_cached.end(), char(true));
 
     BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - layers segmentation in parallel - begin";
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&edge_grids, &input_expolygons, &painted_lines, &segmented_regions, &num_facets_states, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&edge_grids, &input_expolygons, &painted_lines, &segmented_regions, &num_facets_states, &layer_keys, &layer_cached, &cache, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
         for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
             throw_on_cancel_callback();
+            if (layer_cached[layer_idx])
+                continue;
+
             if (!painted_lines[layer_idx].empty()) {
 #ifdef MM_SEGMENTATION_DEBUG_PAINTED_LINES
                 export_painted_lines_to_svg(debug_out_path("0-mm-painted-lines-%d-%d.svg", layer_idx, iRun), {painted_lines[layer_idx]}, input_expolygons[layer_idx]);
@@ -2161,11 +2390,17 @@ std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject
                 export_regions_to_svg(debug_out_path("3-mm-regions-sides-%d-%d.svg", layer_idx, iRun), segmented_regions[layer_idx], input_expolygons[layer_idx]);
 #endif // MM_SEGMENTATION_DEBUG_REGIONS
             }
+
+            if (cache)
+                cache->insert_layer(layer_keys[layer_idx], segmented_regions[layer_idx]);
         }
     }); // end of parallel_for
     BOOST_LOG_TRIVIAL(debug) << "Print object segmentation - layers segmentation in parallel - end";
     throw_on_cancel_callback();
 
+    if (cache)
+        cache->end_run();
+
     if ((segmentation_max_width > 0.f || segmentation_interlocking_depth > 0.f) && !segmentation_interlocking_beam) {
         cut_segmented_layers(input_expolygons, segmented_regions, float(scale_(segmentation_max_width)), float(scale_(segmentation_interlocking_depth)), throw_on_cancel_callback);
         throw_on_cancel_callback();
@@ -2194,7 +2429,7 @@ std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject
 }
 
 // Returns multi-material segmentation based on painting in multi-material segmentation gizmo
-std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback) {
+std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback, PaintedSegmentationCache *cache) {
     const size_t num_facets_states  = print_object.print()->config().filament_colour.size() + 1;
     const float  max_width          = float(print_object.config().mmu_segmented_region_max_width.value);
     const float  interlocking_depth = float(print_object.config().mmu_segmented_region_interlocking_depth.value);
@@ -2204,11 +2439,11 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
         return {mv.mmu_segmentation_facets, mv.is_mm_painted(), false};
     };
 
-    return segmentation_by_painting(print_object, extract_facets_info, num_facets_states, max_width, interlocking_depth, interlocking_beam, IncludeTopAndBottomLayers::Yes, throw_on_cancel_callback);
+    return segmentation_by_painting(print_object, extract_facets_info, num_facets_states, max_width, interlocking_depth, interlocking_beam, IncludeTopAndBottomLayers::Yes, throw_on_cancel_callback, cache);
 }
 
 // Returns fuzzy skin segmentation based on painting in fuzzy skin segmentation gizmo
-std::vector<std::vector<ExPolygons>> fuzzy_skin_segmentation_by_painting(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback) {
+std::vector<std::vector<ExPolygons>> fuzzy_skin_segmentation_by_painting(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback, PaintedSegmentationCache *cache) {
     const size_t num_facets_states = 2; // Unpainted facets and facets painted with fuzzy skin.
 
     const auto extract_facets_info = [](const ModelVolume &mv) -> ModelVolumeFacetsInfo {
@@ -2223,7 +2458,7 @@ std::vector<std::vector<ExPolygons>> fuzzy_skin_segmentation_by_painting(const P
         max_external_perimeter_width = std::max<float>(max_external_perimeter_width, region.flow(print_object, frExternalPerimeter, print_object.config().layer_height).width());
     }
 
-    return segmentation_by_painting(print_object, extract_facets_info, num_facets_states, max_external_perimeter_width, 0.f, false, IncludeTopAndBottomLayers::No, throw_on_cancel_callback);
+    return segmentation_by_painting(print_object, extract_facets_info, num_facets_states, max_external_perimeter_width, 0.f, false, IncludeTopAndBottomLayers::No, throw_on_cancel_callback, cache);
 }
 
 } // namespace Slic3r
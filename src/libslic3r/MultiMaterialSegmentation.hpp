@@ -3,16 +3,18 @@
 
 #include <utility>
 #include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "ExPolygon.hpp"
 
 namespace Slic3r {
 
-class ExPolygon;
 class ModelVolume;
 class PrintObject;
 class FacetsAnnotation;
 
-using ExPolygons = std::vector<ExPolygon>;
-
 struct ColoredLine
 {
     Line line;
@@ -36,6 +38,58 @@ struct ModelVolumeFacetsInfo {
     const bool              replace_default_extruder;
 };
 
+struct PaintedFacetsIndex;
+
+// Results of segmentation_by_painting() kept by a PrintObject across re-slicing.
+// The painted facets are projected once per painting, the segmentation of a layer is reused as long as
+// the painting, the layer Z and the processed slices of that layer do not change, so that only
+// the layers affected by a change are segmented again.
+class PaintedSegmentationCache
+{
+public:
+    struct LayerKey
+    {
+        // Hash of the painting, of the meshes and of the transformation of all model volumes.
+        size_t paint_hash { 0 };
+        size_t num_facets_states { 0 };
+        double slice_z { 0. };
+        // Hash of the processed slices of the layer and of the area they are projected into.
+        size_t slice_hash { 0 };
+
+        bool operator==(const LayerKey &rhs) const {
+            return paint_hash == rhs.paint_hash && num_facets_states == rhs.num_facets_states && slice_z == rhs.slice_z && slice_hash == rhs.slice_hash;
+        }
+    };
+
+    // Painted facets indexed by Z, built for the painting identified by paint_hash and for num_facets_states states.
+    std::shared_ptr<const PaintedFacetsIndex> facets_index(size_t paint_hash, size_t num_facets_states) const;
+    void                                      set_facets_index(size_t paint_hash, size_t num_facets_states, std::shared_ptr<const PaintedFacetsIndex> index);
+
+    // Thread safe lookup and insertion of segmented layers.
+    bool find_layer(const LayerKey &key, std::vector<ExPolygons> &segmented_layer);
+    void insert_layer(const LayerKey &key, const std::vector<ExPolygons> &segmented_layer);
+
+    // Layers not queried nor inserted between begin_run() and end_run() are released by end_run().
+    void begin_run();
+    void end_run();
+    void clear();
+
+    size_t num_hits() const { return m_num_hits; }
+
+private:
+    struct LayerKeyHash { size_t operator()(const LayerKey &key) const; };
+    using LayerMap = std::unordered_map<LayerKey, std::vector<ExPolygons>, LayerKeyHash>;
+
+    mutable std::mutex                        m_mutex;
+    size_t                                    m_paint_hash { 0 };
+    size_t                                    m_num_facets_states { 0 };
+    std::shared_ptr<const PaintedFacetsIndex> m_facets_index;
+    // Layers used by the current run and layers of the previous runs, which were not requested yet.
+    LayerMap                                  m_layers;
+    LayerMap                                  m_layers_previous;
+    size_t                                    m_num_hits { 0 };
+};
+
 // Returns segmentation based on painting in segmentation gizmos.
 std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject                                               &print_object,
                                                               const std::function<ModelVolumeFacetsInfo(const ModelVolume &)> &extract_facets_info,
@@ -44,13 +98,14 @@ std::vector<std::vector<ExPolygons>> segmentation_by_painting(const PrintObject
                                                               float                                                            segmentation_interlocking_depth,
                                                               bool                                                             segmentation_interlocking_beam,
                                                               IncludeTopAndBottomLayers                                        include_top_and_bottom_layers,
-                                                              const std::function<void()>                                     &throw_on_cancel_callback);
+                                                              const std::function<void()>                                     &throw_on_cancel_callback,
+                                                              PaintedSegmentationCache                                        *cache = nullptr);
 
 // Returns multi-material segmentation based on painting in multi-material segmentation gizmo
-std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback);
+std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback, PaintedSegmentationCache *cache = nullptr);
 
 // Returns fuzzy skin segmentation based on painting in fuzzy skin segmentation gizmo
-std::vector<std::vector<ExPolygons>> fuzzy_skin_segmentation_by_painting(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback);
+std::vector<std::vector<ExPolygons>> fuzzy_skin_segmentation_by_painting(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback, PaintedSegmentationCache *cache = nullptr);
 
 } // namespace Slic3r
 
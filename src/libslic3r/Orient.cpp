@@ -1,5 +1,6 @@
 #include "Orient.hpp"
 #include "Geometry.hpp"
+#include <array>
 #include <numeric>
 #include <ClipperUtils.hpp>
 #include <boost/geometry/index/rtree.hpp>
@@ -64,10 +65,10 @@ public:
     Eigen::MatrixXf normals, normals_quantize, normals_hull, normals_hull_quantize;
     Eigen::VectorXf areas, areas_hull;
     Eigen::VectorXf is_apperance; // whether a facet is outer apperance
-    Eigen::MatrixXf z_projected;
-    Eigen::VectorXf z_max, z_max_hull;  // max of projected z
-    Eigen::VectorXf z_median;  // median of projected z
-    Eigen::VectorXf z_mean;  // mean of projected z
+    // Facet corners stacked per corner index, so that projecting all facets
+    // onto a direction is a single matrix-vector product.
+    std::array<Eigen::Matrix<float, Eigen::Dynamic, 3>, 3> facet_vertices, facet_vertices_hull;
+    float bbox_area = 0.f, bbox_radius = 0.f, volume = 0.f;
     std::vector<Vec3f> face_normals;
     std::vector<Vec3f> face_normals_hull;
     OrientParams params;
@@ -100,6 +101,13 @@ public:
         preprocess();
     }
 
+    // Facet heights along one candidate orientation.
+    struct Projection {
+        Eigen::VectorXf z_max, z_max_hull;  // max of projected z
+        Eigen::VectorXf z_mean;  // mean of projected z
+        float min_z = 0.f;
+    };
+
     struct VecHash {
         size_t operator()(const Vec3f& n1) const {
             return std::hash<coord_t>()(int(n1(0)*100+100)) + std::hash<coord_t>()(int(n1(1)*100+100)) * 101 + std::hash<coord_t>()(int(n1(2)*100+100)) * 10221;
@@ -128,22 +136,28 @@ public:
         if (progressind)
             progressind(30);
 
+        // Candidates only read the preprocessed data, score them concurrently.
+        std::vector<CostItems> candidate_costs(orientations.size());
+        auto score_candidates = [this, &candidate_costs](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); ++i) {
+                Vec3f orientation = -orientations[i];
+                Projection projection = project_vertices(orientation);
+                CostItems cost_items = get_features(orientation, projection, params.min_volume);
+                target_function(cost_items, params.min_volume);
+                candidate_costs[i] = cost_items;
+            }
+        };
+        if (params.parallel)
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, orientations.size()), score_candidates);
+        else
+            score_candidates(tbb::blocked_range<size_t>(0, orientations.size()));
+
         std::unordered_map<Vec3f, CostItems, VecHash> results;
-        BOOST_LOG_TRIVIAL(info) << CostItems::field_names();
-        std::cout << CostItems::field_names() << std::endl;
+        BOOST_LOG_TRIVIAL(debug) << CostItems::field_names();
         for (int i = 0; i < orientations.size();i++) {
             Vec3f orientation = -orientations[i];
-
-            project_vertices(orientation);
-
-            auto cost_items = get_features(orientation, params.min_volume);
-
-            float unprintability = target_function(cost_items, params.min_volume);
-
-            results[orientation] = cost_items;
-
-            BOOST_LOG_TRIVIAL(info) << std::fixed << std::setprecision(4) << "orientation:" << orientation.transpose() << ", cost:" << std::fixed << std::setprecision(4) << cost_items.field_values();
-            std::cout << std::fixed << std::setprecision(4) << "orientation:" << orientation.transpose() << ", cost:" << std::fixed << std::setprecision(4) << cost_items.field_values() << std::endl;
+            results[orientation] = candidate_costs[i];
+            BOOST_LOG_TRIVIAL(debug) << std::fixed << std::setprecision(4) << "orientation:" << orientation.transpose() << ", cost:" << std::fixed << std::setprecision(4) << candidate_costs[i].field_values();
         }
         if (progressind)
             progressind(60);
@@ -173,7 +187,6 @@ public:
         }
 
         BOOST_LOG_TRIVIAL(info) << std::fixed << std::setprecision(6) << "best:" << best_orientation.transpose() << ", costs:" << results_vector[0].second.field_values();
-        std::cout << std::fixed << std::setprecision(6) << "best:" << best_orientation.transpose() << ", costs:" << results_vector[0].second.field_values() << std::endl;
 
         return best_orientation.cast<double>();
     }
@@ -183,8 +196,10 @@ public:
         int count_apperance = 0;
         {
             int face_count = mesh->facets_count();
-            auto its = mesh->its;
+            const indexed_triangle_set &its = mesh->its;
             face_normals = its_face_normals(its);
+            // Facet types are missing unless a face detection ran on the mesh.
+            const bool has_properties = its.properties.size() == its.indices.size();
             areas = Eigen::VectorXf::Zero(face_count);
             is_apperance = Eigen::VectorXf::Zero(face_count);
             normals = Eigen::MatrixXf::Zero(face_count, 3);
@@ -195,9 +210,15 @@ public:
                 normals.row(i) = face_normals[i];
                 normals_quantize.row(i) = quantize_vec3f(face_normals[i]);
                 areas(i) = area;
-                is_apperance(i) = (its.get_property(i).type == EnumFaceTypes::eExteriorAppearance);
+                is_apperance(i) = has_properties && its.properties[i].type == EnumFaceTypes::eExteriorAppearance;
                 count_apperance += (is_apperance(i)==1);
             }
+            stack_facet_vertices(its, facet_vertices);
+
+            BoundingBoxf3 bbox = mesh->bounding_box();
+            bbox_area = bbox.area();
+            bbox_radius = bbox.radius();
+            volume = mesh->stats().volume > 0 ? mesh->stats().volume : its_volume(its);
         }
 
         if (orient_mesh)
@@ -209,7 +230,7 @@ public:
             //mesh_convex_hull.write_binary("convex_hull_debug.stl");
 
             int face_count = mesh_convex_hull.facets_count();
-            auto its = mesh_convex_hull.its;
+            const indexed_triangle_set &its = mesh_convex_hull.its;
             face_count_hull = mesh_convex_hull.facets_count();
             face_normals_hull = its_face_normals(its);
             areas_hull = Eigen::VectorXf::Zero(face_count);
@@ -223,9 +244,19 @@ public:
                 normals_hull_quantize.row(i) = quantize_vec3f(face_normals_hull[i]);
                 areas_hull(i) = area;
             }
+            stack_facet_vertices(its, facet_vertices_hull);
         }
     }
 
+    static void stack_facet_vertices(const indexed_triangle_set &its, std::array<Eigen::Matrix<float, Eigen::Dynamic, 3>, 3> &out)
+    {
+        for (auto &corners : out)
+            corners.resize(its.indices.size(), 3);
+        for (size_t i = 0; i < its.indices.size(); ++i)
+            for (int j = 0; j < 3; ++j)
+                out[j].row(i) = its.vertices[its.indices[i](j)];
+    }
+
     void area_cumulation(const Eigen::MatrixXf& normals_, const Eigen::VectorXf& areas_, int num_directions = 10)
     {
         std::unordered_map<stl_normal, float, VecHash> alignments;
@@ -316,36 +347,20 @@ public:
         }
     }
 
-    void project_vertices(Vec3f orientation)
+    Projection project_vertices(const Vec3f &orientation) const
     {
-        int face_count = mesh->facets_count();
-        auto its = mesh->its;
-        z_projected.resize(face_count, 3);
-        z_max.resize(face_count, 1);
-        z_median.resize(face_count, 1);
-        z_mean.resize(face_count, 1);
-        for (size_t i = 0; i < face_count; i++)
-        {
-            float z0 = its.get_vertex(i,0).dot(orientation);
-            float z1 = its.get_vertex(i,1).dot(orientation);
-            float z2 = its.get_vertex(i,2).dot(orientation);
-            z_projected(i, 0) = z0;
-            z_projected(i, 1) = z1;
-            z_projected(i, 2) = z2;
-            z_max(i) = MAX3(z0,z1,z2);
-            z_median(i) = MEDIAN3(z0,z1,z2);
-            z_mean(i) = (z0 + z1 + z2) / 3;
-        }
-
-        z_max_hull.resize(mesh_convex_hull.facets_count(), 1);
-        its = mesh_convex_hull.its;
-        for (size_t i = 0; i < z_max_hull.rows(); i++)
-        {
-            float z0 = its.get_vertex(i,0).dot(orientation);
-            float z1 = its.get_vertex(i,1).dot(orientation);
-            float z2 = its.get_vertex(i,2).dot(orientation);
-            z_max_hull(i) = MAX3(z0, z1, z2);
-        }
+        Projection projection;
+        Eigen::VectorXf z0 = facet_vertices[0] * orientation;
+        Eigen::VectorXf z1 = facet_vertices[1] * orientation;
+        Eigen::VectorXf z2 = facet_vertices[2] * orientation;
+        projection.z_max = z0.cwiseMax(z1).cwiseMax(z2);
+        projection.z_mean = (z0 + z1 + z2) / 3;
+        projection.min_z = z0.size() > 0 ? z0.cwiseMin(z1).cwiseMin(z2).minCoeff() : 0.f;
+
+        projection.z_max_hull = (facet_vertices_hull[0] * orientation)
+            .cwiseMax(facet_vertices_hull[1] * orientation)
+            .cwiseMax(facet_vertices_hull[2] * orientation);
+        return projection;
     }
 
     static Eigen::VectorXi argsort(const Eigen::VectorXf& vec, std::string order="ascend")
@@ -372,15 +387,17 @@ public:
     }
 
     // previously calc_overhang
-    CostItems get_features(Vec3f orientation, bool min_volume = true)
+    CostItems get_features(const Vec3f &orientation, const Projection &projection, bool min_volume = true) const
     {
         CostItems costs;
-        costs.area_total = mesh->bounding_box().area();
-        costs.radius = mesh->bounding_box().radius();
-        // volume
-        costs.volume = mesh->stats().volume > 0 ? mesh->stats().volume : its_volume(mesh->its);
-
-        float total_min_z = z_projected.minCoeff();
+        costs.area_total = bbox_area;
+        costs.radius = bbox_radius;
+        costs.volume = volume;
+
+        const Eigen::VectorXf &z_max = projection.z_max;
+        const Eigen::VectorXf &z_max_hull = projection.z_max_hull;
+        const Eigen::VectorXf &z_mean = projection.z_mean;
+        float total_min_z = projection.min_z;
         // filter bottom area
         auto bottom_condition = (z_max.array() < total_min_z + this->params.FIRST_LAY_H - EPSILON).eval();
         auto bottom_condition_hull = (z_max_hull.array() < total_min_z + this->params.FIRST_LAY_H - EPSILON).eval();
@@ -392,11 +409,7 @@ public:
         costs.bottom = bottom_condition.select(areas, 0).sum()*0.5 + bottom_condition_2nd.select(areas, 0).sum();
 
         // filter overhang
-        Eigen::VectorXf normal_projection(normals.rows(), 1);// = this->normals.dot(orientation);
-        for (size_t i = 0; i < normals.rows(); i++)
-        {
-            normal_projection(i) = normals.row(i).dot(orientation);
-        }
+        Eigen::VectorXf normal_projection = normals * orientation;
         auto areas_appearance = areas.cwiseProduct((is_apperance * params.APPERANCE_FACE_SUPP + Eigen::VectorXf::Ones(is_apperance.rows(), is_apperance.cols()))).eval();
         auto overhang_areas = ((normal_projection.array() < params.ASCENT) * (!bottom_condition_2nd)).select(areas_appearance, 0).eval();
         Eigen::MatrixXf inner = normal_projection.array() - params.ASCENT;
@@ -412,25 +425,8 @@ public:
 
         {
             // contour perimeter
-#if 1
             // the simple way for contour is even better for faces of small bridges
             costs.contour = 4 * sqrt(costs.bottom);
-#else
-            float contour = 0;
-            int face_count = mesh->facets_count();
-            auto its = mesh->its;
-            int contour_amout = 0;
-            for (size_t i = 0; i < face_count; i++)
-            {
-                if (bottom_condition(i)) {
-                    Eigen::VectorXi index = argsort(z_projected.row(i));
-                    stl_vertex line = its.get_vertex(i, index(0)) - its.get_vertex(i, index(1));
-                    contour += line.norm();
-                    contour_amout++;
-                }
-            }
-            costs.contour += contour + params.CONTOUR_AMOUNT * contour_amout;
-#endif
         }
 
         // bottom of convex hull
@@ -442,13 +438,13 @@ public:
         costs.area_laf = laf_areas.sum();
 
         // height to bottom_hull_area ratio
-        //float total_max_z = z_projected.maxCoeff();
+        //float total_max_z = z_max.maxCoeff();
         //costs.height_to_bottom_hull_ratio = SQ(total_max_z) / (costs.bottom_hull + 1e-7);
 
         return costs;
     }
 
-    float target_function(CostItems& costs, bool min_volume)
+    float target_function(CostItems& costs, bool min_volume) const
     {
         float cost=0;
         float bottom = costs.bottom;//std::min(costs.bottom, params.BOTTOM_MAX);
@@ -514,11 +510,8 @@ void orient(OrientMeshs &      arrangables,
 
 }
 
-void orient(ModelObject* obj)
+static void apply_orientation(ModelObject* obj, const Vec3d& orientation)
 {
-    auto m = obj->mesh();
-    AutoOrienter orienter(&m);
-    Vec3d orientation = orienter.process();
     Vec3d axis;
     double angle;
     Geometry::rotation_from_two_vectors(orientation, { 0,0,1 }, axis, angle);
@@ -527,6 +520,30 @@ void orient(ModelObject* obj)
     obj->ensure_on_bed();
 }
 
+void orient(ModelObject* obj)
+{
+    auto m = obj->mesh();
+    AutoOrienter orienter(&m);
+    apply_orientation(obj, orienter.process());
+}
+
+void orient(const ModelObjectPtrs& objs)
+{
+    // Searching the orientation only reads the meshes, so all the objects
+    // are processed at once. Rotating them touches the model and stays serial.
+    std::vector<Vec3d> orientations(objs.size(), Vec3d(0, 0, 1));
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, objs.size()), [&objs, &orientations](const tbb::blocked_range<size_t>& range) {
+        for (size_t i = range.begin(); i != range.end(); ++i) {
+            TriangleMesh m = objs[i]->mesh();
+            AutoOrienter orienter(&m);
+            orientations[i] = orienter.process();
+        }
+    });
+
+    for (size_t i = 0; i < objs.size(); ++i)
+        apply_orientation(objs[i], orientations[i]);
+}
+
 void orient(ModelInstance* instance)
 {
     auto m = instance->get_object()->mesh();
@@ -126,7 +126,7 @@ struct OrientParams {
 
 
     /// Allow parallel execution.
-    bool parallel = false;
+    bool parallel = true;
 
     /// Progress indicator callback called when an object gets packed.
     /// The unsigned argument is the number of items remaining to pack.
@@ -152,6 +152,9 @@ void orient(OrientMeshs &items, const OrientMeshs &excludes, const OrientParams
 // this function should be deleted, since rotating objects are so complicated that its inherited transformation may be a trouble
 void orient(ModelObject* obj);
 
+// Same as orient(ModelObject*) for many objects, their orientations are searched concurrently.
+void orient(const ModelObjectPtrs& objs);
+
 void orient(ModelInstance* instance);
 
 }} // namespace Slic3r::orientment
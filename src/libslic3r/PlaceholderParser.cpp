@@ -7,6 +7,8 @@
 #include <iomanip>
 #include <sstream>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 #ifdef _MSC_VER
     #include <stdlib.h>  // provides **_environ
 #else
@@ -67,7 +69,45 @@
 
 namespace Slic3r {
 
-PlaceholderParser::PlaceholderParser(const DynamicConfig *external_config) : m_external_config(external_config)
+struct PlaceholderParser::CompiledTemplate
+{
+    struct Node;
+    // Branch of an {if}{elsif}{else}{endif} block.
+    struct Branch {
+        // Position of the condition in the template, empty for the {else} branch.
+        size_t            condition_begin;
+        size_t            condition_end;
+        std::vector<Node> nodes;
+    };
+    struct Node {
+        enum class Type {
+            // Literal text to be copied to the output.
+            Text,
+            // Top level {} or [] macro, parsed on its own.
+            Macro,
+            // {if}{elsif}{else}{endif} block spanning literal text and further macros.
+            If,
+        };
+        Type                type;
+        // Position of the text or of the macro including its braces in the template.
+        size_t              begin;
+        size_t              end;
+        std::vector<Branch> branches;
+    };
+    // Literal text, top level macros and conditional blocks in the order of the template.
+    std::vector<Node> nodes;
+    // False if the template could not be split safely, for example if it contains regular expressions.
+    // Such a template is parsed as a whole.
+    bool              split { false };
+};
+
+struct PlaceholderParser::TemplateCache
+{
+    std::mutex                                                               mutex;
+    std::unordered_map<std::string, std::shared_ptr<const CompiledTemplate>> templates;
+};
+
+PlaceholderParser::PlaceholderParser(const DynamicConfig *external_config) : m_external_config(external_config), m_template_cache(std::make_shared<TemplateCache>())
 {
     this->set("version", std::string(SoftFever_VERSION));
     this->apply_env_variables();
@@ -831,6 +871,8 @@ namespace client
         // If true, the macro processor will evaluate just a boolean condition using the full expressive power of the macro processor.
         bool                     just_boolean_expression = false;
         std::string              error_message;
+        // If a part of a template is parsed, the whole template, so that the errors are reported at their line of the template.
+        IteratorRange            whole_template;
 
         // Table to translate symbol tag to a human readable error message.
         static std::map<std::string, std::string> tag_to_error_message;
@@ -870,6 +912,8 @@ namespace client
         }
         // Inside a block, which is conditionally suppressed?
         bool skipping() const { return m_depth_suppressed > 0; }
+        // Parse without evaluating anything, to check the syntax only.
+        void skip_all() const { ++ m_depth_suppressed; }
 
         const ConfigOption* 	optptr(const t_config_option_key &opt_key) const override
         {
@@ -1639,8 +1683,9 @@ namespace client
         static void process_error_message(const MyContext *context, const boost::spirit::info &info, const Iterator &it_begin, const Iterator &it_end, const Iterator &it_error)
         {
             std::string &msg = const_cast<MyContext*>(context)->error_message;
-            std::string  first(it_begin, it_error);
-            std::string  last(it_error, it_end);
+            const bool   whole = ! context->whole_template.empty();
+            std::string  first(whole ? context->whole_template.begin() : it_begin, it_error);
+            std::string  last(it_error, whole ? context->whole_template.end() : it_end);
             auto         first_pos  = first.rfind('\n');
             auto         last_pos   = last.find('\n');
             int          line_nr    = 1;
@@ -1655,7 +1700,7 @@ namespace client
             }
             auto error_line = std::string(first, first_pos) + std::string(last, 0, last_pos);
             // Position of the it_error from the start of its line.
-            auto error_pos  = (it_error - it_begin) - first_pos;
+            auto error_pos  = first.size() - first_pos;
             msg += "Parsing error at line " + std::to_string(line_nr);
             if (! info.tag.empty() && info.tag.front() == '*') {
                 // The gat contains an explanatory string.
@@ -2414,10 +2459,10 @@ namespace client
 
 static const client::macro_processor g_macro_processor_instance;
 
-static std::string process_macro(const std::string &templ, client::MyContext &context)
+static std::string process_macro(client::Iterator begin, client::Iterator end, client::MyContext &context)
 {
     std::string output;
-    phrase_parse(templ.begin(), templ.end(), g_macro_processor_instance(&context), client::skipper{}, output);
+    phrase_parse(begin, end, g_macro_processor_instance(&context), client::skipper{}, output);
 	if (! context.error_message.empty()) {
         if (context.error_message.back() != '\n' && context.error_message.back() != '\r')
             context.error_message += '\n';
@@ -2426,6 +2471,219 @@ static std::string process_macro(const std::string &templ, client::MyContext &co
     return output;
 }
 
+static std::string process_macro(const std::string &templ, client::MyContext &context)
+{
+    return process_macro(templ.begin(), templ.end(), context);
+}
+
+// Accepts the same UTF-8 sequences as utf8_char_parser, which throws on the others.
+static bool utf8_valid(const std::string &text, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end;) {
+        unsigned char c = static_cast<unsigned char>(text[i ++]);
+        if ((c & 0xC0) == 0x80)
+            return false;
+        unsigned int result = 0;
+        for (unsigned char mask = 0x80u; c & mask; mask >>= 1)
+            ++ result;
+        for (unsigned int cnt = (result == 0) ? 0 : ((result > 4) ? 3 : result - 1); cnt > 0; -- cnt) {
+            if (i == end)
+                return false;
+            c = static_cast<unsigned char>(text[i ++]);
+            if (cnt > 1 && (c & 0xC0) != 0x80)
+                return false;
+        }
+    }
+    return true;
+}
+
+static bool is_identifier_char(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// Keywords of the conditional blocks in the macro, skipping string literals.
+static std::vector<std::string> if_keywords(const std::string &templ, size_t begin, size_t end)
+{
+    std::vector<std::string> out;
+    for (size_t i = begin; i < end;) {
+        if (templ[i] == '"') {
+            for (++ i; i < end && templ[i] != '"'; ++ i)
+                if (templ[i] == '\\')
+                    ++ i;
+            ++ i;
+        } else if (is_identifier_char(templ[i])) {
+            size_t kw_end = i;
+            for (; kw_end < end && is_identifier_char(templ[kw_end]); ++ kw_end) ;
+            std::string kw = templ.substr(i, kw_end - i);
+            if (kw == "if" || kw == "elsif" || kw == "else" || kw == "endif" || kw == "then")
+                out.emplace_back(std::move(kw));
+            i = kw_end;
+        } else
+            ++ i;
+    }
+    return out;
+}
+
+// Split the template into literal text, top level {} or [] macros and the {if}{elsif}{else}{endif} blocks
+// spanning them. The literal text is copied without running it through the parser, each macro and each condition
+// is parsed on its own and only the branch taken is processed. The split is only done if it is guaranteed
+// to produce the same output as parsing the whole template, otherwise CompiledTemplate::split is false.
+std::shared_ptr<const PlaceholderParser::CompiledTemplate> PlaceholderParser::compile(const std::string &templ) const
+{
+    {
+        std::lock_guard<std::mutex> lock(m_template_cache->mutex);
+        if (auto it = m_template_cache->templates.find(templ); it != m_template_cache->templates.end())
+            return it->second;
+    }
+
+    using Node   = CompiledTemplate::Node;
+    using Branch = CompiledTemplate::Branch;
+    auto out = std::make_shared<CompiledTemplate>();
+    out->split = [&templ, &nodes = out->nodes]() {
+        // Open {if} blocks, the nodes are added to the last branch of the innermost one.
+        std::vector<Node*> open_blocks;
+        auto current_nodes = [&nodes, &open_blocks]() -> std::vector<Node>& {
+            return open_blocks.empty() ? nodes : open_blocks.back()->branches.back().nodes;
+        };
+        size_t i = 0;
+        while (i < templ.size()) {
+            const char open = templ[i];
+            if (open != '{' && open != '[') {
+                size_t end = templ.find_first_of("{[", i);
+                if (end == std::string::npos)
+                    end = templ.size();
+                if (! utf8_valid(templ, i, end))
+                    return false;
+                current_nodes().push_back({ Node::Type::Text, i, end });
+                i = end;
+                continue;
+            }
+            // Find the matching closing brace, skipping string literals.
+            const char close = open == '{' ? '}' : ']';
+            size_t     depth     = 0;
+            size_t     max_depth = 0;
+            size_t     end       = i;
+            for (; end < templ.size(); ++ end) {
+                const char c = templ[end];
+                if (c == '"') {
+                    // String literal with backslash escapes.
+                    for (++ end; end < templ.size() && templ[end] != '"'; ++ end)
+                        if (templ[end] == '\\')
+                            ++ end;
+                    if (end >= templ.size())
+                        return false;
+                } else if (c == open)
+                    max_depth = std::max(max_depth, ++ depth);
+                else if (c == close && -- depth == 0)
+                    break;
+            }
+            if (end == templ.size())
+                return false;
+            if (open == '{') {
+                // Regular expressions may contain unbalanced braces.
+                if (max_depth > 1 || templ.find("=~", i) < end || templ.find("!~", i) < end)
+                    return false;
+                const std::vector<std::string> keywords = if_keywords(templ, i + 1, end);
+                const auto num_ifs    = std::count(keywords.begin(), keywords.end(), "if");
+                const bool inline_ifs = num_ifs > 0 && num_ifs == std::count(keywords.begin(), keywords.end(), "endif");
+                if (! keywords.empty() && ! inline_ifs) {
+                    // Not an {if ... then ... endif} macro, but a part of a conditional block spanning literal text:
+                    // a single {if cond}, {elsif cond}, {else} or {endif}.
+                    size_t body_begin = templ.find_first_not_of(" \t\r\n", i + 1);
+                    size_t body_end   = templ.find_last_not_of(" \t\r\n", end - 1) + 1;
+                    size_t kw_end     = body_begin;
+                    for (; kw_end < body_end && is_identifier_char(templ[kw_end]); ++ kw_end) ;
+                    const std::string kw = templ.substr(body_begin, kw_end - body_begin);
+                    if (keywords.size() != 1 || kw != keywords.front() || templ.find(';', i) < end)
+                        return false;
+                    if (kw == "if") {
+                        current_nodes().push_back({ Node::Type::If, i, end + 1 });
+                        open_blocks.emplace_back(&current_nodes().back());
+                        open_blocks.back()->branches.push_back({ kw_end, body_end });
+                    } else if (open_blocks.empty() || (kw != "endif" &&
+                               open_blocks.back()->branches.back().condition_begin == open_blocks.back()->branches.back().condition_end)) {
+                        // {elsif}, {else} or {endif} without an {if}, {elsif} or {else} following an {else}.
+                        return false;
+                    } else if (kw == "elsif") {
+                        open_blocks.back()->branches.push_back({ kw_end, body_end });
+                    } else if (kw == "else") {
+                        if (body_end != kw_end)
+                            return false;
+                        open_blocks.back()->branches.push_back({ kw_end, kw_end });
+                    } else {
+                        if (body_end != kw_end)
+                            return false;
+                        open_blocks.back()->end = end + 1;
+                        open_blocks.pop_back();
+                    }
+                    i = end + 1;
+                    continue;
+                }
+            }
+            current_nodes().push_back({ Node::Type::Macro, i, end + 1 });
+            i = end + 1;
+        }
+        return open_blocks.empty();
+    }();
+    if (out->split) {
+        // The branches not taken are not parsed by process(), while parsing the whole template checks their syntax.
+        // Check the syntax of the whole template once, without evaluating anything.
+        client::MyContext context;
+        context.external_config = this->external_config();
+        context.config          = &this->config();
+        context.skip_all();
+        std::string output;
+        try {
+            phrase_parse(templ.begin(), templ.end(), g_macro_processor_instance(&context), client::skipper{}, output);
+            out->split = context.error_message.empty();
+        } catch (...) {
+            out->split = false;
+        }
+    }
+    if (! out->split)
+        out->nodes.clear();
+
+    std::lock_guard<std::mutex> lock(m_template_cache->mutex);
+    // Templates are mostly taken from the config, a limited set. Don't let templates composed at runtime grow the cache forever.
+    if (m_template_cache->templates.size() >= 1024)
+        m_template_cache->templates.clear();
+    m_template_cache->templates.emplace(templ, out);
+    return out;
+}
+
+static void process_nodes(const std::string &templ, const std::vector<PlaceholderParser::CompiledTemplate::Node> &nodes, client::MyContext &context, std::string &output)
+{
+    using Node = PlaceholderParser::CompiledTemplate::Node;
+    for (const Node &node : nodes)
+        switch (node.type) {
+        case Node::Type::Text:
+            output.append(templ, node.begin, node.end - node.begin);
+            break;
+        case Node::Type::Macro:
+            output += process_macro(templ.begin() + node.begin, templ.begin() + node.end, context);
+            break;
+        case Node::Type::If: {
+            // As if parsed as a whole: all the conditions are evaluated in order, the first branch whose condition holds is processed
+            // right after its condition.
+            bool taken = false;
+            for (const PlaceholderParser::CompiledTemplate::Branch &branch : node.branches) {
+                bool condition = true;
+                if (branch.condition_begin != branch.condition_end) {
+                    context.just_boolean_expression = true;
+                    condition = process_macro(templ.begin() + branch.condition_begin, templ.begin() + branch.condition_end, context) == "true";
+                    context.just_boolean_expression = false;
+                }
+                if (condition && ! taken) {
+                    taken = true;
+                    process_nodes(templ, branch.nodes, context, output);
+                }
+            }
+            break;
+        }
+        }
+}
+
 std::string PlaceholderParser::process(const std::string &templ, unsigned int current_extruder_id, const DynamicConfig *config_override, DynamicConfig *config_outputs, ContextData *context_data) const
 {
     client::MyContext context;
@@ -2435,7 +2693,16 @@ std::string PlaceholderParser::process(const std::string &templ, unsigned int cu
     context.config_outputs      = config_outputs;
     context.current_extruder_id = current_extruder_id;
     context.context_data        = context_data;
-    return process_macro(templ, context);
+    std::shared_ptr<const CompiledTemplate> compiled = this->compile(templ);
+    if (! compiled->split)
+        return process_macro(templ, context);
+
+    // The macros share a single context, thus local variables are visible to the following macros as if the template was parsed as a whole.
+    // Errors are reported at their line of the whole template.
+    context.whole_template = client::IteratorRange(templ.begin(), templ.end());
+    std::string output;
+    process_nodes(templ, compiled->nodes, context, output);
+    return output;
 }
 
 // Evaluate a boolean expression using the full expressive power of the PlaceholderParser boolean expression syntax.
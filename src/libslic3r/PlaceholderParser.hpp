@@ -3,6 +3,7 @@
 
 #include "libslic3r.h"
 #include <map>
+#include <memory>
 #include <random>
 #include <string>
 #include <string_view>
@@ -56,8 +57,13 @@ public:
     // External config is not owned by PlaceholderParser. It has a lowest priority when looking up an option.
 	const DynamicConfig*	external_config() const  			{ return m_external_config; }
 
+    // Template split into literal text, top level macros and the conditional blocks spanning them. Compiled once by process() and cached.
+    struct CompiledTemplate;
+
     // Fill in the template using a macro processing language.
     // Throws Slic3r::PlaceholderParserError on syntax or runtime error.
+    // The template is compiled on the first call and cached, so that the literal text between the macros is not parsed again
+    // and only the branches taken of the conditional blocks are parsed.
     std::string process(const std::string &templ, unsigned int current_extruder_id, const DynamicConfig *config_override, DynamicConfig *config_outputs, ContextData *context) const;
     std::string process(const std::string &templ, unsigned int current_extruder_id = 0, const DynamicConfig *config_override = nullptr, ContextData *context = nullptr) const
         { return this->process(templ, current_extruder_id, config_override, nullptr /* config_outputs */, context); }
@@ -75,9 +81,15 @@ public:
     void update_user_name() { update_user_name(m_config); }
 
 private:
+    std::shared_ptr<const CompiledTemplate> compile(const std::string &templ) const;
+
 	// config has a higher priority than external_config when looking up a symbol.
     DynamicConfig 			 m_config;
     const DynamicConfig 	*m_external_config;
+
+    // Compiled templates do not depend on the config, thus the cache is shared by copies of this PlaceholderParser.
+    struct TemplateCache;
+    std::shared_ptr<TemplateCache> m_template_cache;
 };
 
 }
@@ -48,6 +48,7 @@ static std::vector<std::string> s_project_options {
     "flush_multiplier",
     "nozzle_volume_type",
     "filament_map_mode",
+    "filament_group_search_budget",
     "filament_map"
 };
 
@@ -12,6 +12,7 @@
 #include "Thread.hpp"
 #include "Time.hpp"
 #include "GCode.hpp"
+#include "GCode/BinaryGCode.hpp"
 #include "GCode/WipeTower.hpp"
 #include "GCode/WipeTower2.hpp"
 #include "Utils.hpp"
@@ -23,6 +24,8 @@
 
 #include <algorithm>
 #include <limits>
+#include <list>
+#include <mutex>
 #include <unordered_set>
 #include <boost/filesystem/path.hpp>
 #include <boost/format.hpp>
@@ -76,6 +79,7 @@ void Print::clear()
     m_print_regions.clear();
     m_model.clear_objects();
     m_statistics_by_extruder_count.clear();
+    m_mesh_slices_cache.clear();
 }
 
 bool Print::has_tpu_filament() const
@@ -89,15 +93,10 @@ bool Print::has_tpu_filament() const
     return false;
 }
 
-// Called by Print::apply().
-// This method only accepts PrintConfig option keys.
-bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* new_config */, const std::vector<t_config_option_key> &opt_keys)
+// Cache the plenty of parameters, which influence the G-code generator only,
+// or they are only notes not influencing the generated G-code.
+static const std::unordered_set<std::string>& print_config_gcode_export_options()
 {
-    if (opt_keys.empty())
-        return false;
-
-    // Cache the plenty of parameters, which influence the G-code generator only,
-    // or they are only notes not influencing the generated G-code.
     static std::unordered_set<std::string> steps_gcode = {
         //BBS
         "additional_cooling_fan_speed",
@@ -236,8 +235,32 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
         "process_notes",
         "printer_notes"
     };
+    return steps_gcode;
+}
+
+static const std::unordered_set<std::string>& print_config_ignored_options()
+{
+    static std::unordered_set<std::string> steps_ignore = {
+        // Applied when copying the exported G-code to its destination.
+        "binary_gcode",
+    };
+    return steps_ignore;
+}
+
+bool Print::is_gcode_export_option(const t_config_option_key &opt_key)
+{
+    return print_config_gcode_export_options().count(opt_key) > 0 || print_config_ignored_options().count(opt_key) > 0;
+}
+
+// Called by Print::apply().
+// This method only accepts PrintConfig option keys.
+bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* new_config */, const std::vector<t_config_option_key> &opt_keys)
+{
+    if (opt_keys.empty())
+        return false;
 
-    static std::unordered_set<std::string> steps_ignore;
+    const std::unordered_set<std::string> &steps_gcode  = print_config_gcode_export_options();
+    const std::unordered_set<std::string> &steps_ignore = print_config_ignored_options();
 
     std::vector<PrintStep> steps;
     std::vector<PrintObjectStep> osteps;
@@ -322,6 +345,7 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
             || opt_key == "other_layers_print_sequence_nums" 
             || opt_key == "extruder_ams_count"
             || opt_key == "filament_map_mode"
+            || opt_key == "filament_group_search_budget"
             || opt_key == "filament_map"
             || opt_key == "filament_adhesiveness_category"
             || opt_key == "wipe_tower_bridging"
@@ -2004,6 +2028,8 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
 
     for (PrintObject *obj : m_objects)
         obj->clear_shared_object();
+    // Release the slices of the meshes deleted from the model since the last slicing.
+    m_mesh_slices_cache.prune();
 
     //add the print_object share check logic
     auto is_print_object_the_same = [this](const PrintObject* object1, const PrintObject* object2) -> bool{
@@ -2465,33 +2491,43 @@ void Print::_make_skirt()
         skirt_height_z = std::max(skirt_height_z, object->m_layers[skirt_layers-1]->print_z);
     }
 
-    // Collect points from all layers contained in skirt height.
+    // Collect points from all layers contained in skirt height, the objects in parallel.
+    std::vector<Points>  objects_points(m_objects.size());
+    std::vector<Polygon> objects_convex_hulls(m_objects.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_objects.size()),
+        [this, skirt_height_z, &objects_points, &objects_convex_hulls](const tbb::blocked_range<size_t>& range) {
+        for (size_t object_idx = range.begin(); object_idx < range.end(); ++ object_idx) {
+            const PrintObject *object        = m_objects[object_idx];
+            Points            &object_points = objects_points[object_idx];
+            // Get object layers up to skirt_height_z.
+            for (const Layer *layer : object->m_layers) {
+                if (layer->print_z > skirt_height_z)
+                    break;
+                for (const ExPolygon &expoly : layer->lslices)
+                    // Collect the outer contour points only, ignore holes for the calculation of the convex hull.
+                    append(object_points, expoly.contour.points);
+            }
+            // Get support layers up to skirt_height_z.
+            for (const SupportLayer *layer : object->support_layers()) {
+                if (layer->print_z > skirt_height_z)
+                    break;
+                layer->support_fills.collect_points(object_points);
+            }
+            objects_convex_hulls[object_idx] = Slic3r::Geometry::convex_hull(object_points);
+        }
+    });
+
     Points points;
 
     // BBS
     std::map<PrintObject*, Polygon> object_convex_hulls;
-    for (PrintObject *object : m_objects) {
-        Points object_points;
-        // Get object layers up to skirt_height_z.
-        for (const Layer *layer : object->m_layers) {
-            if (layer->print_z > skirt_height_z)
-                break;
-            for (const ExPolygon &expoly : layer->lslices)
-                // Collect the outer contour points only, ignore holes for the calculation of the convex hull.
-                append(object_points, expoly.contour.points);
-        }
-        // Get support layers up to skirt_height_z.
-        for (const SupportLayer *layer : object->support_layers()) {
-            if (layer->print_z > skirt_height_z)
-                break;
-            layer->support_fills.collect_points(object_points);
-        }
-
-        object_convex_hulls.insert({ object, Slic3r::Geometry::convex_hull(object_points) });
+    for (size_t object_idx = 0; object_idx < m_objects.size(); ++ object_idx) {
+        PrintObject *object = m_objects[object_idx];
+        object_convex_hulls.insert({ object, std::move(objects_convex_hulls[object_idx]) });
 
         // Repeat points for each object copy.
         for (const PrintInstance &instance : object->instances()) {
-            Points copy_points = object_points;
+            Points copy_points = objects_points[object_idx];
             for (Point &pt : copy_points)
                 pt += instance.shift;
             append(points, copy_points);
@@ -3072,6 +3108,65 @@ bool Print::enable_timelapse_print() const
     return m_config.timelapse_type.value == TimelapseType::tlSmooth;
 }
 
+// Generated wipe towers of recent slices. Plates sharing the wipe tower inputs, and reslicing a plate after a change
+// not touching them (e.g. moving an object on a single color print), reuse the generated tool changes.
+// The tower is generated in its own coordinates, thus the entries are not specific to a plate: the position of the tower
+// on the current plate and the plate origin are applied to the entry found. The tool ordering and the planning of the
+// tool changes are not cached, they run on every slice.
+struct WipeTowerCache
+{
+    // Outputs of WipeTower / WipeTower2 after the generation.
+    struct Entry
+    {
+        std::vector<std::vector<WipeTower::ToolChangeResult>> tool_changes;
+        WipeTower::ToolChangeResult                           final_purge;
+        std::vector<float>                                    used_filament;
+        int                                                   number_of_toolchanges { -1 };
+        float                                                 depth { 0.f };
+        std::vector<std::pair<float, float>>                  z_and_depth_pairs;
+        float                                                 brim_width { 0.f };
+        BoundingBoxf                                          bbx;
+        Vec2f                                                 rib_offset { 0.f, 0.f };
+        std::optional<WipeTowerData::WipeTowerMeshData>       wipe_tower_mesh_data;
+        // Geometry of the fake wipe tower, placed at the position of the tower on the current plate.
+        float                                                 width { 0.f };
+        float                                                 height { 0.f };
+        float                                                 layer_height { 0.f };
+        std::map<float, Polylines>                            outer_wall;
+    };
+
+    // The tool changes hold the wipe tower G-code, keep just a few of them.
+    static constexpr size_t max_entries = 4;
+
+    std::mutex                               mutex;
+    std::list<std::pair<std::string, Entry>> entries; // most recently used first
+
+    bool find(const std::string &key, Entry &out)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::find_if(entries.begin(), entries.end(), [&key](const auto &entry) { return entry.first == key; });
+        if (it == entries.end())
+            return false;
+        entries.splice(entries.begin(), entries, it);
+        out = it->second;
+        return true;
+    }
+
+    void store(std::string key, const Entry &entry)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.emplace_front(std::move(key), entry);
+        if (entries.size() > max_entries)
+            entries.pop_back();
+    }
+};
+
+static WipeTowerCache& wipe_tower_cache()
+{
+    static WipeTowerCache cache;
+    return cache;
+}
+
 void Print::_make_wipe_tower()
 {
     m_wipe_tower_data.clear();
@@ -3125,6 +3220,43 @@ void Print::_make_wipe_tower()
     }
     this->throw_if_canceled();
 
+    // Everything the wipe tower generation depends on: the print config, the tool ordering summary and, appended
+    // by the planning below, the planned tool changes. The planning has to run anyway, as it marks the extrusions
+    // used for wiping, only the generation of the wipe tower is looked up in the cache.
+    std::string cache_key;
+    auto put = [&cache_key](const auto &value) {
+        cache_key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    auto put_str = [&cache_key, &put](const std::string &str) {
+        put(str.size());
+        cache_key += str;
+    };
+    auto put_config = [&put_str](const ConfigBase &config) {
+        for (const std::string &opt_key : config.keys()) {
+            // Position of the tower per plate, applied to the cached tower.
+            if (opt_key == "wipe_tower_x" || opt_key == "wipe_tower_y")
+                continue;
+            put_str(opt_key);
+            put_str(config.opt_serialize(opt_key));
+        }
+    };
+    put(bUseWipeTower2);
+    put_config(m_config);
+    if (bUseWipeTower2)
+        put_config(m_default_region_config);
+    put(m_wipe_tower_data.tool_ordering.first_extruder());
+    for (unsigned int extruder_id : m_wipe_tower_data.tool_ordering.all_extruders())
+        put(extruder_id);
+    put(m_wipe_tower_data.tool_ordering.back().print_z);
+    put(m_wipe_tower_data.tool_ordering.back().wipe_tower_partitions);
+    put(m_objects.front()->config().layer_height.value);
+    put(this->skirt_first_layer_height());
+    put(this->has_tpu_filament());
+    for (int filament_map : this->get_filament_maps())
+        put(filament_map);
+
+    WipeTowerCache::Entry result;
+
     if (!bUseWipeTower2) {
         // in BBL machine, wipe tower is only use to prime extruder. So just use a global wipe volume.
         WipeTower wipe_tower(m_config, m_plate_index, m_origin, m_wipe_tower_data.tool_ordering.first_extruder(),
@@ -3160,6 +3292,11 @@ void Print::_make_wipe_tower()
 
         std::vector<int>filament_maps = get_filament_maps();
 
+        auto plan_toolchange = [&wipe_tower, &put](float z, float layer_height, unsigned int old_tool, unsigned int new_tool, float wipe_volume, float prime_volume) {
+            wipe_tower.plan_toolchange(z, layer_height, old_tool, new_tool, wipe_volume, prime_volume);
+            put(z); put(layer_height); put(old_tool); put(new_tool); put(wipe_volume); put(prime_volume);
+        };
+
         std::vector<unsigned int> nozzle_cur_filament_ids(nozzle_nums, -1);
         unsigned int current_filament_id = m_wipe_tower_data.tool_ordering.first_extruder();
         size_t cur_nozzle_id = filament_maps[current_filament_id] - 1;
@@ -3168,7 +3305,7 @@ void Print::_make_wipe_tower()
         for (auto& layer_tools : m_wipe_tower_data.tool_ordering.layer_tools()) { // for all layers
             if (!layer_tools.has_wipe_tower) continue;
             bool first_layer = &layer_tools == &m_wipe_tower_data.tool_ordering.front();
-            wipe_tower.plan_toolchange((float)layer_tools.print_z, (float)layer_tools.wipe_tower_layer_height, current_filament_id, current_filament_id);
+            plan_toolchange((float)layer_tools.print_z, (float)layer_tools.wipe_tower_layer_height, current_filament_id, current_filament_id, 0.f, 0.f);
 
             used_filament_ids.insert(layer_tools.extruders.begin(), layer_tools.extruders.end());
 
@@ -3191,7 +3328,7 @@ void Print::_make_wipe_tower()
                 float grab_purge_volume = m_config.grab_length.get_at(nozzle_id) * 2.4; //(diameter/2)^2*PI=2.4
                 volume_to_purge = std::max(0.f, volume_to_purge - grab_purge_volume);
 
-                wipe_tower.plan_toolchange((float)layer_tools.print_z, (float)layer_tools.wipe_tower_layer_height, current_filament_id, filament_id,
+                plan_toolchange((float)layer_tools.print_z, (float)layer_tools.wipe_tower_layer_height, current_filament_id, filament_id,
                     m_config.prime_volume, volume_to_purge);
                 current_filament_id = filament_id;
                 nozzle_cur_filament_ids[nozzle_id] = filament_id;
@@ -3200,7 +3337,10 @@ void Print::_make_wipe_tower()
 
             // if enable timelapse, slice all layer
             if (m_config.enable_wrapping_detection || enable_timelapse_print()) {
-                if (layer_tools.wipe_tower_partitions == 0) wipe_tower.set_last_layer_extruder_fill(false);
+                if (layer_tools.wipe_tower_partitions == 0) {
+                    wipe_tower.set_last_layer_extruder_fill(false);
+                    put(layer_tools.print_z);
+                }
                 continue;
             }
 
@@ -3216,44 +3356,61 @@ void Print::_make_wipe_tower()
             categories.push_back(m_config.filament_adhesiveness_category.get_at(i));
         }
         wipe_tower.set_filament_categories(categories);
-
-        // Generate the wipe tower layers.
-        m_wipe_tower_data.tool_changes.reserve(m_wipe_tower_data.tool_ordering.layer_tools().size());
-        wipe_tower.generate_new(m_wipe_tower_data.tool_changes);
-        m_wipe_tower_data.depth      = wipe_tower.get_depth();
-        m_wipe_tower_data.brim_width = wipe_tower.get_brim_width();
-        m_wipe_tower_data.bbx = wipe_tower.get_bbx();
-        m_wipe_tower_data.rib_offset = wipe_tower.get_rib_offset();
-
-        // Unload the current filament over the purge tower.
-        coordf_t layer_height = m_objects.front()->config().layer_height.value;
-        if (m_wipe_tower_data.tool_ordering.back().wipe_tower_partitions > 0) {
-            // The wipe tower goes up to the last layer of the print.
-            if (wipe_tower.layer_finished()) {
-                // The wipe tower is printed to the top of the print and it has no space left for the final extruder purge.
-                // Lift Z to the next layer.
-                wipe_tower.set_layer(float(m_wipe_tower_data.tool_ordering.back().print_z + layer_height), float(layer_height), 0, false,
-                                     true);
+        for (int id : used_filament_ids)
+            put(id);
+        for (int category : categories)
+            put(category);
+
+        if (! wipe_tower_cache().find(cache_key, result)) {
+            // Generate the wipe tower layers.
+            result.tool_changes.reserve(m_wipe_tower_data.tool_ordering.layer_tools().size());
+            wipe_tower.generate_new(result.tool_changes);
+            result.depth      = wipe_tower.get_depth();
+            result.brim_width = wipe_tower.get_brim_width();
+            result.bbx        = wipe_tower.get_bbx();
+            result.rib_offset = wipe_tower.get_rib_offset();
+
+            // Unload the current filament over the purge tower.
+            coordf_t layer_height = m_objects.front()->config().layer_height.value;
+            if (m_wipe_tower_data.tool_ordering.back().wipe_tower_partitions > 0) {
+                // The wipe tower goes up to the last layer of the print.
+                if (wipe_tower.layer_finished()) {
+                    // The wipe tower is printed to the top of the print and it has no space left for the final extruder purge.
+                    // Lift Z to the next layer.
+                    wipe_tower.set_layer(float(m_wipe_tower_data.tool_ordering.back().print_z + layer_height), float(layer_height), 0, false,
+                                         true);
+                } else {
+                    // There is yet enough space at this layer of the wipe tower for the final purge.
+                }
             } else {
-                // There is yet enough space at this layer of the wipe tower for the final purge.
+                // The wipe tower does not reach the last print layer, perform the pruge at the last print layer.
+                assert(m_wipe_tower_data.tool_ordering.back().wipe_tower_partitions == 0);
+                wipe_tower.set_layer(float(m_wipe_tower_data.tool_ordering.back().print_z), float(layer_height), 0, false, true);
             }
-        } else {
-            // The wipe tower does not reach the last print layer, perform the pruge at the last print layer.
-            assert(m_wipe_tower_data.tool_ordering.back().wipe_tower_partitions == 0);
-            wipe_tower.set_layer(float(m_wipe_tower_data.tool_ordering.back().print_z), float(layer_height), 0, false, true);
-        }
-        m_wipe_tower_data.final_purge = Slic3r::make_unique<WipeTower::ToolChangeResult>(wipe_tower.tool_change((unsigned int) (-1)));
-
-        m_wipe_tower_data.used_filament         = wipe_tower.get_used_filament();
-        m_wipe_tower_data.number_of_toolchanges = wipe_tower.get_number_of_toolchanges();
-        m_wipe_tower_data.construct_mesh(wipe_tower.width(), wipe_tower.get_depth(), wipe_tower.get_height(), wipe_tower.get_brim_width(), config().wipe_tower_wall_type.value == WipeTowerWallType::wtwRib,
-                                         wipe_tower.get_rib_width(), wipe_tower.get_rib_length(), config().wipe_tower_fillet_wall.value);
+            result.final_purge = wipe_tower.tool_change((unsigned int) (-1));
+
+            result.used_filament         = wipe_tower.get_used_filament();
+            result.number_of_toolchanges = wipe_tower.get_number_of_toolchanges();
+            m_wipe_tower_data.construct_mesh(wipe_tower.width(), wipe_tower.get_depth(), wipe_tower.get_height(), wipe_tower.get_brim_width(), config().wipe_tower_wall_type.value == WipeTowerWallType::wtwRib,
+                                             wipe_tower.get_rib_width(), wipe_tower.get_rib_length(), config().wipe_tower_fillet_wall.value);
+            result.wipe_tower_mesh_data = m_wipe_tower_data.wipe_tower_mesh_data;
+            result.width                = wipe_tower.width();
+            result.height               = wipe_tower.get_height();
+            result.layer_height         = wipe_tower.get_layer_height();
+            result.outer_wall           = wipe_tower.get_outer_wall();
+            wipe_tower_cache().store(cache_key, result);
+        }
+        const Vec2f position = wipe_tower.position();
+
+        m_wipe_tower_data.bbx                  = result.bbx;
+        m_wipe_tower_data.rib_offset           = result.rib_offset;
+        m_wipe_tower_data.wipe_tower_mesh_data = std::move(result.wipe_tower_mesh_data);
         const Vec3d origin                      = this->get_plate_origin();
-        m_fake_wipe_tower.rib_offset = wipe_tower.get_rib_offset();
-        m_fake_wipe_tower.set_fake_extrusion_data(wipe_tower.position() + m_fake_wipe_tower.rib_offset, wipe_tower.width(), wipe_tower.get_height(), wipe_tower.get_layer_height(),
-                                                  m_wipe_tower_data.depth,
-                                                  m_wipe_tower_data.brim_width, {scale_(origin.x()), scale_(origin.y())});
-        m_fake_wipe_tower.outer_wall = wipe_tower.get_outer_wall();
+        m_fake_wipe_tower.rib_offset = result.rib_offset;
+        m_fake_wipe_tower.set_fake_extrusion_data(position + m_fake_wipe_tower.rib_offset, result.width, result.height, result.layer_height,
+                                                  result.depth,
+                                                  result.brim_width, {scale_(origin.x()), scale_(origin.y())});
+        m_fake_wipe_tower.outer_wall = std::move(result.outer_wall);
     } else {
         // Get wiping matrix to get number of extruders and convert vector<double> to vector<float>:
         std::vector<float> flush_matrix(cast<float>(m_config.flush_volumes_matrix.values));
@@ -3289,13 +3446,17 @@ void Print::_make_wipe_tower()
         // Lets go through the wipe tower layers and determine pairs of extruder changes for each
         // to pass to wipe_tower (so that it can use it for planning the layout of the tower)
         {
+            auto plan_toolchange = [&wipe_tower, &put](float z, float layer_height, unsigned int old_tool, unsigned int new_tool, float wipe_volume) {
+                wipe_tower.plan_toolchange(z, layer_height, old_tool, new_tool, wipe_volume);
+                put(z); put(layer_height); put(old_tool); put(new_tool); put(wipe_volume);
+            };
             unsigned int current_extruder_id = m_wipe_tower_data.tool_ordering.all_extruders().back();
             for (auto &layer_tools : m_wipe_tower_data.tool_ordering.layer_tools()) { // for all layers
                 if (!layer_tools.has_wipe_tower)
                     continue;
                 bool first_layer = &layer_tools == &m_wipe_tower_data.tool_ordering.front();
-                wipe_tower.plan_toolchange((float) layer_tools.print_z, (float) layer_tools.wipe_tower_layer_height, current_extruder_id,
-                                           current_extruder_id, false);
+                plan_toolchange((float) layer_tools.print_z, (float) layer_tools.wipe_tower_layer_height, current_extruder_id,
+                                current_extruder_id, 0.f);
                 for (const auto extruder_id : layer_tools.extruders) {
                     if ((first_layer && extruder_id == m_wipe_tower_data.tool_ordering.all_extruders().back()) || extruder_id !=
                         current_extruder_id) {
@@ -3315,8 +3476,8 @@ void Print::_make_wipe_tower()
                         }
 
                         // request a toolchange at the wipe tower with at least volume_to_wipe purging amount
-                        wipe_tower.plan_toolchange((float) layer_tools.print_z, (float) layer_tools.wipe_tower_layer_height,
-                                                   current_extruder_id, extruder_id, volume_to_wipe);
+                        plan_toolchange((float) layer_tools.print_z, (float) layer_tools.wipe_tower_layer_height,
+                                        current_extruder_id, extruder_id, volume_to_wipe);
                         current_extruder_id = extruder_id;
                     }
                 }
@@ -3326,42 +3487,57 @@ void Print::_make_wipe_tower()
             }
         }
 
-        // Generate the wipe tower layers.
-        m_wipe_tower_data.tool_changes.reserve(m_wipe_tower_data.tool_ordering.layer_tools().size());
-        wipe_tower.generate(m_wipe_tower_data.tool_changes);
-        m_wipe_tower_data.depth             = wipe_tower.get_depth();
-        m_wipe_tower_data.z_and_depth_pairs = wipe_tower.get_z_and_depth_pairs();
-        m_wipe_tower_data.brim_width        = wipe_tower.get_brim_width();
-        m_wipe_tower_data.height            = wipe_tower.get_wipe_tower_height();
-
-        // Unload the current filament over the purge tower.
-        coordf_t layer_height = m_objects.front()->config().layer_height.value;
-        if (m_wipe_tower_data.tool_ordering.back().wipe_tower_partitions > 0) {
-            // The wipe tower goes up to the last layer of the print.
-            if (wipe_tower.layer_finished()) {
-                // The wipe tower is printed to the top of the print and it has no space left for the final extruder purge.
-                // Lift Z to the next layer.
-                wipe_tower.set_layer(float(m_wipe_tower_data.tool_ordering.back().print_z + layer_height), float(layer_height), 0, false,
-                                     true);
+        if (! wipe_tower_cache().find(cache_key, result)) {
+            // Generate the wipe tower layers.
+            result.tool_changes.reserve(m_wipe_tower_data.tool_ordering.layer_tools().size());
+            wipe_tower.generate(result.tool_changes);
+            result.depth             = wipe_tower.get_depth();
+            result.z_and_depth_pairs = wipe_tower.get_z_and_depth_pairs();
+            result.brim_width        = wipe_tower.get_brim_width();
+            result.height            = wipe_tower.get_wipe_tower_height();
+
+            // Unload the current filament over the purge tower.
+            coordf_t layer_height = m_objects.front()->config().layer_height.value;
+            if (m_wipe_tower_data.tool_ordering.back().wipe_tower_partitions > 0) {
+                // The wipe tower goes up to the last layer of the print.
+                if (wipe_tower.layer_finished()) {
+                    // The wipe tower is printed to the top of the print and it has no space left for the final extruder purge.
+                    // Lift Z to the next layer.
+                    wipe_tower.set_layer(float(m_wipe_tower_data.tool_ordering.back().print_z + layer_height), float(layer_height), 0, false,
+                                         true);
+                } else {
+                    // There is yet enough space at this layer of the wipe tower for the final purge.
+                }
             } else {
-                // There is yet enough space at this layer of the wipe tower for the final purge.
+                // The wipe tower does not reach the last print layer, perform the pruge at the last print layer.
+                assert(m_wipe_tower_data.tool_ordering.back().wipe_tower_partitions == 0);
+                wipe_tower.set_layer(float(m_wipe_tower_data.tool_ordering.back().print_z), float(layer_height), 0, false, true);
             }
-        } else {
-            // The wipe tower does not reach the last print layer, perform the pruge at the last print layer.
-            assert(m_wipe_tower_data.tool_ordering.back().wipe_tower_partitions == 0);
-            wipe_tower.set_layer(float(m_wipe_tower_data.tool_ordering.back().print_z), float(layer_height), 0, false, true);
+            result.final_purge = wipe_tower.tool_change((unsigned int) (-1));
+
+            result.used_filament         = wipe_tower.get_used_filament();
+            result.number_of_toolchanges = wipe_tower.get_number_of_toolchanges();
+            result.width                 = wipe_tower.width();
+            wipe_tower_cache().store(cache_key, result);
         }
-        m_wipe_tower_data.final_purge = Slic3r::make_unique<WipeTower::ToolChangeResult>(wipe_tower.tool_change((unsigned int) (-1)));
+        const Vec2f position = wipe_tower.position();
 
-        m_wipe_tower_data.used_filament         = wipe_tower.get_used_filament();
-        m_wipe_tower_data.number_of_toolchanges = wipe_tower.get_number_of_toolchanges();
+        m_wipe_tower_data.z_and_depth_pairs = result.z_and_depth_pairs;
+        m_wipe_tower_data.height            = result.height;
         const Vec3d origin                      = Vec3d::Zero();
-        m_fake_wipe_tower.set_fake_extrusion_data(wipe_tower.position(), wipe_tower.width(), wipe_tower.get_wipe_tower_height(),
-                                                  config().initial_layer_print_height, m_wipe_tower_data.depth,
-                                                  m_wipe_tower_data.z_and_depth_pairs, m_wipe_tower_data.brim_width,
+        m_fake_wipe_tower.set_fake_extrusion_data(position, result.width, result.height,
+                                                  config().initial_layer_print_height, result.depth,
+                                                  result.z_and_depth_pairs, result.brim_width,
                                                   config().wipe_tower_rotation_angle, config().wipe_tower_cone_angle,
                                                   {scale_(origin.x()), scale_(origin.y())});
     }
+
+    m_wipe_tower_data.tool_changes          = std::move(result.tool_changes);
+    m_wipe_tower_data.final_purge           = Slic3r::make_unique<WipeTower::ToolChangeResult>(std::move(result.final_purge));
+    m_wipe_tower_data.used_filament         = std::move(result.used_filament);
+    m_wipe_tower_data.number_of_toolchanges = result.number_of_toolchanges;
+    m_wipe_tower_data.depth                 = result.depth;
+    m_wipe_tower_data.brim_width            = result.brim_width;
 }
 
 // Generate a recommended G-code output file name based on the format template, default extension, and template parameters
@@ -3378,7 +3554,11 @@ std::string Print::output_filename(const std::string &filename_base) const
     config.set_key_value("plate_number", new ConfigOptionString(get_plate_number_formatted()));
     config.set_key_value("model_name", new ConfigOptionString(get_model_name()));
 
-    return this->PrintBase::output_filename(m_config.filename_format.value, ".gcode", filename_base, &config);
+    std::string filename = this->PrintBase::output_filename(m_config.filename_format.value, ".gcode", filename_base, &config);
+    // The binary G-code is exported under its own extension.
+    if (m_config.binary_gcode.value && boost::iends_with(filename, ".gcode"))
+        filename.replace(filename.size() - 6, 6, BinaryGCode::FileExtension);
+    return filename;
 }
 
 std::string Print::get_model_name() const
@@ -4305,11 +4485,41 @@ static void from_json(const json& j, groupedVolumeSlices& firstlayer_group)
     }
 }
 
+static size_t cached_data_identify_id(const PrintObject *obj)
+{
+    const ModelInstance *model_instance = obj->instances()[0].model_instance;
+    return (model_instance->loaded_id > 0) ? model_instance->loaded_id : model_instance->id().id;
+}
+
 int Print::export_cached_data(const std::string& directory, bool with_space)
 {
-    int ret = 0;
     boost::filesystem::path directory_path(directory);
 
+    //firstly clear this directory
+    if (fs::exists(directory_path)) {
+        fs::remove_all(directory_path);
+    }
+    try {
+        if (!fs::create_directory(directory_path)) {
+            BOOST_LOG_TRIVIAL(error) << boost::format("create directory %1% failed")%directory;
+            return CLI_EXPORT_CACHE_DIRECTORY_CREATE_FAILED;
+        }
+    }
+    catch (...)
+    {
+        BOOST_LOG_TRIVIAL(error) << boost::format("create directory %1% failed")%directory;
+        return CLI_EXPORT_CACHE_DIRECTORY_CREATE_FAILED;
+    }
+
+    return this->export_cached_data([&directory](const PrintObject &obj) {
+        return directory + "/obj_" + std::to_string(cached_data_identify_id(&obj)) + ".json";
+    }, with_space);
+}
+
+int Print::export_cached_data(const CachedDataFileName &object_file_name, bool with_space)
+{
+    int ret = 0;
+
     auto convert_layer_to_json = [](json& layer_json, const Layer* layer) {
         json slice_polygons_json = json::array(), slice_bboxs_json = json::array(), overhang_polygons_json = json::array(), layer_regions_json = json::array();
         layer_json[JSON_LAYER_PRINT_Z] = layer->print_z;
@@ -4354,22 +4564,6 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
         return;
     };
 
-    //firstly clear this directory
-    if (fs::exists(directory_path)) {
-        fs::remove_all(directory_path);
-    }
-    try {
-        if (!fs::create_directory(directory_path)) {
-            BOOST_LOG_TRIVIAL(error) << boost::format("create directory %1% failed")%directory;
-            return CLI_EXPORT_CACHE_DIRECTORY_CREATE_FAILED;
-        }
-    }
-    catch (...)
-    {
-        BOOST_LOG_TRIVIAL(error) << boost::format("create directory %1% failed")%directory;
-        return CLI_EXPORT_CACHE_DIRECTORY_CREATE_FAILED;
-    }
-
     int count = 0;
     std::vector<std::string> filename_vector;
     std::vector<json> json_vector;
@@ -4380,10 +4574,12 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
             continue;
         }
 
-        const PrintInstance &print_instance = obj->instances()[0];
-        const ModelInstance *model_instance = print_instance.model_instance;
-        size_t identify_id = (model_instance->loaded_id > 0)?model_instance->loaded_id: model_instance->id().id;
-        std::string file_name = directory +"/obj_"+std::to_string(identify_id)+".json";
+        size_t identify_id = cached_data_identify_id(obj);
+        std::string file_name = object_file_name(*obj);
+        if (file_name.empty()) {
+            BOOST_LOG_TRIVIAL(info) << boost::format("object %1% needs no export, skip it")%model_obj->name;
+            continue;
+        }
 
         BOOST_LOG_TRIVIAL(info) << boost::format("begin to dump object %1%, identify_id %2% to %3%")%model_obj->name %identify_id %file_name;
 
@@ -4575,7 +4771,6 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
 
 int Print::load_cached_data(const std::string& directory)
 {
-    int ret = 0;
     boost::filesystem::path directory_path(directory);
 
     if (!fs::exists(directory_path)) {
@@ -4583,6 +4778,20 @@ int Print::load_cached_data(const std::string& directory)
         return CLI_IMPORT_CACHE_NOT_FOUND;
     }
 
+    return this->load_cached_data([&directory](const PrintObject &obj) {
+        size_t identify_id = cached_data_identify_id(&obj);
+        if (obj.instances()[0].model_instance->loaded_id <= 0) {
+            //for old 3mf
+            BOOST_LOG_TRIVIAL(info) << "load_cached_data" << boost::format(": object %1%'s loaded_id is 0, need to use the instance_id %2%")%obj.model_object()->name %identify_id;
+        }
+        return directory + "/obj_" + std::to_string(identify_id) + ".json";
+    });
+}
+
+int Print::load_cached_data(const CachedDataFileName &object_file_name)
+{
+    int ret = 0;
+
     auto find_region = [this](PrintObject* object, size_t config_hash) -> const PrintRegion* {
         int regions_count = object->num_printing_regions();
         for (int index = 0; index < regions_count; index++ )
@@ -4598,23 +4807,12 @@ int Print::load_cached_data(const std::string& directory)
     int count = 0;
     std::vector<std::pair<std::string, PrintObject*>> object_filenames;
     for (PrintObject *obj : m_objects) {
-        const ModelObject* model_obj = obj->model_object();
-        const PrintInstance &print_instance = obj->instances()[0];
-        const ModelInstance *model_instance = print_instance.model_instance;
-
         obj->clear_layers();
         obj->clear_support_layers();
 
-        int identify_id = model_instance->loaded_id;
-        if (identify_id <= 0) {
-            //for old 3mf
-            identify_id = model_instance->id().id;
-            BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(": object %1%'s loaded_id is 0, need to use the instance_id %2%")%model_obj->name %identify_id;
-            //continue;
-        }
-        std::string file_name = directory +"/obj_"+std::to_string(identify_id)+".json";
+        std::string file_name = object_file_name(*obj);
 
-        if (!fs::exists(file_name)) {
+        if (file_name.empty() || !fs::exists(file_name)) {
             BOOST_LOG_TRIVIAL(info) << __FUNCTION__<<boost::format(": file %1% not exist, maybe a shared object, skip it")%file_name;
             continue;
         }
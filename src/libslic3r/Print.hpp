@@ -8,6 +8,7 @@
 #include "BoundingBox.hpp"
 #include "ExtrusionEntityCollection.hpp"
 #include "Flow.hpp"
+#include "MeshSlicesCache.hpp"
 #include "Point.hpp"
 #include "Slicing.hpp"
 #include "TriangleMeshSlicer.hpp"
@@ -38,6 +39,8 @@ class SupportLayer;
 class TreeSupportData;
 class TreeSupport;
 class ExtrusionLayers;
+struct ConflictLinesCache;
+struct PrintObjectBrimAreas;
 
 #define MAX_OUTER_NOZZLE_DIAMETER   4
 // BBS: move from PrintObjectSlice.cpp
@@ -399,6 +402,11 @@ public:
     SupportLayer* add_tree_support_layer(int id, coordf_t height, coordf_t print_z, coordf_t slice_z);
     std::shared_ptr<TreeSupportData> alloc_tree_support_preview_cache();
     void clear_tree_support_preview_cache() { m_tree_support_preview_cache.reset(); }
+    // Orca: Segmentation of painted layers kept across re-slicing, so that only the changed layers are segmented again.
+    std::shared_ptr<PaintedSegmentationCache> alloc_mm_segmentation_cache();
+    std::shared_ptr<PaintedSegmentationCache> alloc_fuzzy_skin_segmentation_cache();
+    // Orca: Extrusion lines indexed for the G-code conflict check, kept until any step of this object is invalidated.
+    std::shared_ptr<ConflictLinesCache> alloc_conflict_lines_cache();
 
     size_t          support_layer_count() const { return m_support_layers.size(); }
     void            clear_support_layers();
@@ -460,6 +468,8 @@ public:
 
     // BBS: Boundingbox of the first layer
     BoundingBox                 firstLayerObjectBrimBoundingBox;
+    // Brim areas of this object produced by make_brim(), reused until the first layer or the brim settings change.
+    std::shared_ptr<const PrintObjectBrimAreas> brim_areas_cache;
 
     // BBS: returns 1-based indices of extruders used to print the first layer wall of objects
     std::vector<int>            object_first_layer_wall_extruders;
@@ -557,6 +567,10 @@ private:
     SupportLayerPtrs                        m_support_layers;
     // BBS
     std::shared_ptr<TreeSupportData>        m_tree_support_preview_cache;
+    // Orca
+    std::shared_ptr<PaintedSegmentationCache> m_mm_segmentation_cache;
+    std::shared_ptr<PaintedSegmentationCache> m_fuzzy_skin_segmentation_cache;
+    std::shared_ptr<ConflictLinesCache>       m_conflict_lines_cache;
 
     // this is set to true when LayerRegion->slices is split in top/internal/bottom
     // so that next call to make_perimeters() performs a union() before computing loops
@@ -911,6 +925,12 @@ public:
     //return 0 means successful
     int                 export_cached_data(const std::string& dir_path, bool with_space=false);
     int                 load_cached_data(const std::string& directory);
+    // Returns the file of the cached data of a PrintObject, or an empty string to skip the object.
+    using CachedDataFileName = std::function<std::string(const PrintObject&)>;
+    int                 export_cached_data(const CachedDataFileName &object_file_name, bool with_space=false);
+    int                 load_cached_data(const CachedDataFileName &object_file_name);
+    // Returns true if the PrintConfig option influences the G-code export only, not the PrintObject steps.
+    static bool         is_gcode_export_option(const t_config_option_key &opt_key);
 
     // methods for handling state
     bool                is_step_done(PrintStep step) const { return Inherited::is_step_done(step); }
@@ -980,6 +1000,9 @@ public:
     const StatisticsByExtruderCount statistics_by_extruder() const { return m_statistics_by_extruder_count; }
     StatisticsByExtruderCount& statistics_by_extruder() { return m_statistics_by_extruder_count; }
 
+    // Slices of the model volume meshes, reused by the objects sharing the same meshes and slicing parameters.
+    MeshSlicesCache&            mesh_slices_cache() const { return m_mesh_slices_cache; }
+
     // Wipe tower support.
     bool                        has_wipe_tower() const;
     const WipeTowerData&        wipe_tower_data(size_t filaments_cnt = 0) const;
@@ -1159,6 +1182,8 @@ private:
     PrintStatistics                         m_print_statistics;
     bool                                    m_support_used {false};
     StatisticsByExtruderCount               m_statistics_by_extruder_count;
+    // Thread safe, filled by the PrintObjects while slicing.
+    mutable MeshSlicesCache                 m_mesh_slices_cache;
 
     std::vector<unsigned int> m_slice_used_filaments;
     std::vector<unsigned int> m_slice_used_filaments_first_layer;
@@ -229,14 +229,9 @@ static t_config_option_keys print_config_diffs(
     const std::vector<std::string> &extruder_retract_keys = print_config_def.extruder_retract_keys();
     const std::string               filament_prefix       = "filament_";
     t_config_option_keys            print_diff;
-    for (const t_config_option_key &opt_key : current_config.keys()) {
-        const ConfigOption *opt_old = current_config.option(opt_key);
-        assert(opt_old != nullptr);
-        const ConfigOption *opt_new = new_full_config.option(opt_key);
-        // assert(opt_new != nullptr);
-        if (opt_new == nullptr)
-            //FIXME This may happen when executing some test cases.
-            continue;
+    // Options missing in new_full_config are skipped.
+    //FIXME This may happen when executing some test cases.
+    current_config.iterate_common_options(new_full_config, [&](const t_config_option_key &opt_key, const ConfigOption *opt_old, const ConfigOption *opt_new) {
         const ConfigOption *opt_new_filament = std::binary_search(extruder_retract_keys.begin(), extruder_retract_keys.end(), opt_key) ? new_full_config.option(filament_prefix + opt_key) : nullptr;
 
         if (opt_new_filament != nullptr) {
@@ -259,19 +254,19 @@ static t_config_option_keys print_config_diffs(
             else
                 print_diff.emplace_back(opt_key);
         }
-    }
+    });
 
     return print_diff;
 }
 
 // Prepare for storing of the full print config into new_full_config to be exported into the G-code and to be used by the PlaceholderParser.
+// Only the groups of options modified since one config was composed of the other are compared, their keys are returned by compared_keys.
 //BBS: add plate index
-static t_config_option_keys full_print_config_diffs(const DynamicPrintConfig &current_full_config, const DynamicPrintConfig &new_full_config, int plate_index)
+static t_config_option_keys full_print_config_diffs(const DynamicPrintConfig &current_full_config, const DynamicPrintConfig &new_full_config, int plate_index, t_config_option_keys &compared_keys)
 {
     t_config_option_keys full_config_diff;
-    for (const t_config_option_key &opt_key : new_full_config.keys()) {
-        const ConfigOption *opt_old = current_full_config.option(opt_key);
-        const ConfigOption *opt_new = new_full_config.option(opt_key);
+    new_full_config.iterate_changed_groups(current_full_config, [&](const t_config_option_key &opt_key, const ConfigOption *opt_new, const ConfigOption *opt_old) {
+        compared_keys.emplace_back(opt_key);
         if (opt_old == nullptr || *opt_new != *opt_old) {
             //BBS: add plate_index logic for wipe_tower_x/wipe_tower_y
             if (opt_old && (!opt_key.compare("wipe_tower_x") || !opt_key.compare("wipe_tower_y"))) {
@@ -290,7 +285,7 @@ static t_config_option_keys full_print_config_diffs(const DynamicPrintConfig &cu
             else
                 full_config_diff.emplace_back(opt_key);
         }
-    }
+    });
     return full_config_diff;
 }
 
@@ -1169,10 +1164,12 @@ Print::ApplyStatus Print::apply(const Model &model, DynamicPrintConfig new_full_
     DynamicPrintConfig   filament_overrides;
     //BBS: add plate index
     t_config_option_keys print_diff       = print_config_diffs(m_config, new_full_config, filament_overrides, this->m_plate_index, filament_maps);
-    t_config_option_keys full_config_diff = full_print_config_diffs(m_full_print_config, new_full_config, this->m_plate_index);
-    // Collect changes to object and region configs.
-    t_config_option_keys object_diff      = m_default_object_config.diff(new_full_config);
-    t_config_option_keys region_diff      = m_default_region_config.diff(new_full_config);
+    t_config_option_keys compared_keys;
+    t_config_option_keys full_config_diff = full_print_config_diffs(m_full_print_config, new_full_config, this->m_plate_index, compared_keys);
+    // Collect changes to object and region configs. Their defaults are applied together with m_full_print_config,
+    // thus they may only differ from new_full_config in the options of the groups changed in the full config.
+    t_config_option_keys object_diff      = m_default_object_config.diff(new_full_config, compared_keys);
+    t_config_option_keys region_diff      = m_default_region_config.diff(new_full_config, compared_keys);
 
     //BBS: process the filament_map related logic
     std::unordered_set<std::string> print_diff_set(print_diff.begin(), print_diff.end());
@@ -2313,6 +2313,15 @@ void PrintConfigDef::init_fff_params()
     def->mode = comAdvanced;
     def->set_default_value(new ConfigOptionEnum<FilamentMapMode>(fmmAutoForFlush));
 
+    def = this->add("filament_group_search_budget", coInt);
+    // internal use only, don't need translation
+    def->label = "Filament grouping search budget";
+    def->tooltip = "Number of flush volume evaluations spent on refining the automatic filament grouping when there are too many "
+                   "filaments to try all the groups. Larger values may lower the flush volume at the cost of a longer slicing.";
+    def->min = 0;
+    def->mode = comDevelop;
+    def->set_default_value(new ConfigOptionInt(512));
+
     def = this->add("filament_flush_temp", coInts);
     def->label = L("Flush temperature");
     def->tooltip = L("Temperature when flushing filament. 0 indicates the upper bound of the recommended nozzle temperature range.");
@@ -4925,6 +4934,15 @@ void PrintConfigDef::init_fff_params()
     def->mode = comAdvanced;
     def->set_default_value(new ConfigOptionBool(false));
 
+    def = this->add("binary_gcode", coBool);
+    def->label = L("Binary G-code");
+    def->tooltip = L("Export the G-code to a .obgcode file, a compact binary container with compressed blocks, metadata, thumbnails and a layer index. "
+                     "The container is specific to this application and it is not the .bgcode format, printers and print hosts don't read it. "
+                     "It is opened by the G-code viewer and it may be converted back to plain G-code from the command line. "
+                     "G-codes uploaded to a print host are always plain G-code.");
+    def->mode = comAdvanced;
+    def->set_default_value(new ConfigOptionBool(false));
+
     def = this->add("seam_position", coEnum);
     def->label = L("Seam position");
     def->category = L("Quality");
@@ -9735,6 +9753,12 @@ CLIActionsConfigDef::CLIActionsConfigDef()
     def->tooltip = L("Send progress to pipe.");
     def->cli_params = "pipename";
     def->set_default_value(new ConfigOptionString());
+
+    def = this->add("convert_gcode", coStrings);
+    def->label = L("Convert G-code");
+    def->tooltip = L("Convert an ASCII G-code into a binary G-code or a binary G-code back into an ASCII G-code.");
+    def->cli_params = "\"input;output\"";
+    def->set_default_value(new ConfigOptionStrings());
 }
 
 //BBS: remove unused command currently
@@ -9932,6 +9956,21 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->cli_params = "\"machine1.json;machine2.json;...\"";
     def->set_default_value(new ConfigOptionStrings());
 
+    def = this->add("slice_cache_dir", coString);
+    def->label = L("Slicing cache directory");
+    def->tooltip = L("Restore the objects sliced before with the same geometry and settings from this directory, "
+                     "and store the newly sliced objects into it. The directory may be shared by several slicing processes.");
+    def->cli_params = "dir";
+    def->set_default_value(new ConfigOptionString());
+
+    def = this->add("slice_cache_size_limit", coInt);
+    def->label = L("Slicing cache size limit");
+    def->tooltip = L("Maximum size of the slicing cache directory in MB. The least recently used objects are removed "
+                     "when the directory grows over this size. 0 means no limit.");
+    def->min = 0;
+    def->cli_params = "size";
+    def->set_default_value(new ConfigOptionInt(10240));
+
     def = this->add("load_assemble_list", coString);
     def->label = L("Load assemble list");
     def->tooltip = L("Load assemble object list from config file.");
@@ -9978,6 +10017,13 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->tooltip = L("If enabled, this slicing will be considered using timelapse.");
     def->set_default_value(new ConfigOptionBool(false));
 
+    def = this->add("software_thumbnails", coBool);
+    def->label = L("Render thumbnails without OpenGL");
+    def->tooltip = L("Render the plate and G-code thumbnails with the built-in CPU rasterizer instead of an OpenGL context. "
+                     "Useful on headless machines without a GPU.");
+    def->cli_params = "option";
+    def->set_default_value(new ConfigOptionBool(false));
+
 #if (defined(_MSC_VER) || defined(__MINGW32__)) && defined(SLIC3R_GUI)
     /*def = this->add("sw_renderer", coBool);
     def->label = L("Render with a software renderer");
@@ -709,6 +709,49 @@ protected:
         const std::vector<std::string>& keys()      const { return m_keys; }
         const T&                        defaults()  const { return *m_defaults; }
 
+        // Keys of the options of lhs differing from the same options of rhs.
+        // The options are addressed by their index into keys(), no key is looked up.
+        t_config_option_keys diff(const T *lhs, const T *rhs) const
+        {
+            t_config_option_keys out;
+            for (size_t i = 0; i < m_keys.size(); ++ i)
+                if (*this->option_at(i, lhs) != *this->option_at(i, rhs))
+                    out.emplace_back(m_keys[i]);
+            return out;
+        }
+
+        // Keys among keys of the options of owner differing from the same options of other, options missing in other are skipped.
+        t_config_option_keys diff(const T *owner, const DynamicConfig &other, const t_config_option_keys &keys) const
+        {
+            t_config_option_keys out;
+            for (const t_config_option_key &opt_key : keys)
+                if (auto it = std::lower_bound(m_keys.begin(), m_keys.end(), opt_key); it != m_keys.end() && *it == opt_key)
+                    if (const ConfigOption *opt_other = other.option(opt_key); opt_other != nullptr && *this->option_at(it - m_keys.begin(), owner) != *opt_other)
+                        out.emplace_back(opt_key);
+            return out;
+        }
+
+        // Call fn(key, owner_option, other_option) for the options present in both owner and other.
+        // Both keys() and the options of a DynamicConfig are sorted, thus they are walked at once instead of looking up
+        // the keys one by one.
+        template<typename Fn>
+        void                iterate_common(const T *owner, const DynamicConfig &other, Fn &&fn) const
+        {
+            auto it = other.cbegin();
+            for (size_t i = 0; i < m_keys.size() && it != other.cend();) {
+                const int cmp = m_keys[i].compare(it->first);
+                if (cmp < 0)
+                    ++ i;
+                else if (cmp > 0)
+                    ++ it;
+                else {
+                    fn(m_keys[i], this->option_at(i, owner), it->second.get());
+                    ++ i;
+                    ++ it;
+                }
+            }
+        }
+
         // To be called during the StaticCache setup.
         // Collect option keys from m_map_name_to_offset,
         // assign default values to m_defaults.
@@ -718,6 +761,8 @@ protected:
             m_defaults = defaults;
             m_keys.clear();
             m_keys.reserve(m_map_name_to_offset.size());
+            m_offsets.clear();
+            m_offsets.reserve(m_map_name_to_offset.size());
             for (const auto &kvp : defs->options) {
                 // Find the option given the option name kvp.first by an offset from (char*)m_defaults.
                 ConfigOption *opt = this->optptr(kvp.first, m_defaults);
@@ -725,16 +770,24 @@ protected:
                     // This option is not defined by the ConfigBase of type T.
                     continue;
                 m_keys.emplace_back(kvp.first);
+                m_offsets.emplace_back((char*)opt - (char*)m_defaults);
                 const ConfigOptionDef *def = defs->get(kvp.first);
                 assert(def != nullptr);
                 if (def->default_value)
                     opt->set(def->default_value.get());
             }
+            assert(std::is_sorted(m_keys.begin(), m_keys.end()));
         }
 
     private:
+        const ConfigOption* option_at(size_t idx, const T *owner) const
+            { return reinterpret_cast<const ConfigOption*>((const char*)owner + m_offsets[idx]); }
+
         T                                  *m_defaults;
+        // Sorted, as the options of ConfigDef.
         std::vector<std::string>            m_keys;
+        // Offsets of the options in the order of m_keys.
+        std::vector<ptrdiff_t>              m_offsets;
     };
 };
 
@@ -749,6 +802,24 @@ public: \
     /* Overrides ConfigBase::keys(). Collect names of all configuration values maintained by this configuration store. */ \
     t_config_option_keys     keys() const override { return s_cache_##CLASS_NAME.keys(); } \
     const t_config_option_keys& keys_ref() const override { return s_cache_##CLASS_NAME.keys(); } \
+    /* Counterparts of ConfigBase::diff() walking the options by index instead of looking up their keys. */ \
+    using ConfigBase::diff; \
+    t_config_option_keys     diff(const CLASS_NAME &other) const \
+        { return *this == other ? t_config_option_keys() : s_cache_##CLASS_NAME.diff(this, &other); } \
+    t_config_option_keys     diff(const DynamicConfig &other) const \
+    { \
+        t_config_option_keys out; \
+        this->iterate_common_options(other, [&out](const t_config_option_key &opt_key, const ConfigOption *lhs, const ConfigOption *rhs) \
+            { if (*lhs != *rhs) out.emplace_back(opt_key); }); \
+        return out; \
+    } \
+    /* Counterpart of diff() comparing only the options of keys, the other options being known to be equal. */ \
+    t_config_option_keys     diff(const DynamicConfig &other, const t_config_option_keys &keys) const \
+        { return s_cache_##CLASS_NAME.diff(this, other, keys); } \
+    /* Call fn(key, this_option, other_option) for the options present in both this and other. */ \
+    template<typename Fn> \
+    void                     iterate_common_options(const DynamicConfig &other, Fn &&fn) const \
+        { s_cache_##CLASS_NAME.iterate_common(this, other, std::forward<Fn>(fn)); } \
     static const CLASS_NAME& defaults() { assert(s_cache_##CLASS_NAME.initialized()); return s_cache_##CLASS_NAME.defaults(); } \
 private: \
     friend int print_config_static_initializer(); \
@@ -1260,6 +1331,7 @@ PRINT_CONFIG_CLASS_DEFINE(
     ((ConfigOptionFloats,              filament_max_volumetric_speed))
     ((ConfigOptionInts,                required_nozzle_HRC))
     ((ConfigOptionEnum<FilamentMapMode>, filament_map_mode))
+    ((ConfigOptionInt,                 filament_group_search_budget))
     ((ConfigOptionInts,                filament_map))
     //((ConfigOptionInts,                filament_extruder_id))
     ((ConfigOptionStrings,             filament_extruder_variant))
@@ -1345,6 +1417,7 @@ PRINT_CONFIG_CLASS_DEFINE(
     ((ConfigOptionFloatOrPercent,      initial_layer_travel_speed))
     ((ConfigOptionBool,                bbl_calib_mark_logo))
     ((ConfigOptionBool,                disable_m73))
+    ((ConfigOptionBool,                binary_gcode))
 
     // Orca: mmu
     ((ConfigOptionFloat,               cooling_tube_retraction))
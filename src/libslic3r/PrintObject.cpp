@@ -21,6 +21,7 @@
 #include "Format/STL.hpp"
 #include "format.hpp"
 #include "AABBTreeLines.hpp"
+#include "GCode/ConflictChecker.hpp"
 
 #include <float.h>
 #include <oneapi/tbb/blocked_range.h>
@@ -975,6 +976,30 @@ std::shared_ptr<TreeSupportData> PrintObject::alloc_tree_support_preview_cache()
     return m_tree_support_preview_cache;
 }
 
+std::shared_ptr<PaintedSegmentationCache> PrintObject::alloc_mm_segmentation_cache()
+{
+    if (!m_mm_segmentation_cache)
+        m_mm_segmentation_cache = std::make_shared<PaintedSegmentationCache>();
+
+    return m_mm_segmentation_cache;
+}
+
+std::shared_ptr<PaintedSegmentationCache> PrintObject::alloc_fuzzy_skin_segmentation_cache()
+{
+    if (!m_fuzzy_skin_segmentation_cache)
+        m_fuzzy_skin_segmentation_cache = std::make_shared<PaintedSegmentationCache>();
+
+    return m_fuzzy_skin_segmentation_cache;
+}
+
+std::shared_ptr<ConflictLinesCache> PrintObject::alloc_conflict_lines_cache()
+{
+    if (!m_conflict_lines_cache)
+        m_conflict_lines_cache = std::make_shared<ConflictLinesCache>();
+
+    return m_conflict_lines_cache;
+}
+
 SupportLayer* PrintObject::add_tree_support_layer(int id, coordf_t height, coordf_t print_z, coordf_t slice_z)
 {
     m_support_layers.emplace_back(new SupportLayer(id, 0, this, height, print_z, slice_z));
@@ -990,6 +1015,8 @@ SupportLayer* PrintObject::add_support_layer(int id, int interface_id, coordf_t
 
 SupportLayerPtrs::iterator PrintObject::insert_support_layer(SupportLayerPtrs::iterator pos, size_t id, size_t interface_id, coordf_t height, coordf_t print_z, coordf_t slice_z)
 {
+    // The cached support lines no longer match the support layers, collect them again for the conflict check.
+    m_conflict_lines_cache.reset();
     return m_support_layers.insert(pos, new SupportLayer(id, interface_id, this, height, print_z, slice_z));
 }
 
@@ -1347,6 +1374,8 @@ bool PrintObject::invalidate_state_by_config_options(
 bool PrintObject::invalidate_step(PrintObjectStep step)
 {
 	bool invalidated = Inherited::invalidate_step(step);
+    // Any step of this object may change its extrusions, collect them again for the conflict check.
+    m_conflict_lines_cache.reset();
 
     // propagate to dependent steps
     if (step == posPerimeters) {
@@ -1382,6 +1411,7 @@ bool PrintObject::invalidate_all_steps()
     bool result = Inherited::invalidate_all_steps() | m_print->invalidate_all_steps();
 	// Then reset some of the depending values.
 	m_slicing_params.valid = false;
+	m_conflict_lines_cache.reset();
 	return result;
 }
 
@@ -10,8 +10,20 @@
 #include <numeric>
 
 #include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
+#include <atomic>
+#include <chrono>
+#include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
 #include <boost/log/trivial.hpp>
+#include <boost/nowide/cstdio.hpp>
 
 // #define SLAPRINT_DO_BENCHMARK
 
@@ -668,6 +680,131 @@ StringObjectException SLAPrint::validate(StringObjectException *exception, Polyg
     return {};
 }
 
+void SLAArchive::draw_layers(size_t                                         layer_num,
+                             std::function<void(sla::RasterBase &, size_t)> drawfn,
+                             std::function<bool()>                          cancelfn,
+                             size_t                                         max_in_flight)
+{
+    using Clock = std::chrono::steady_clock;
+    auto micros = [](Clock::time_point since) {
+        return int64_t(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - since).count());
+    };
+
+    if (max_in_flight == 0)
+        max_in_flight = size_t(tbb::this_task_arena::max_concurrency());
+
+    this->clear_layers();
+    m_layers.resize(layer_num);
+    m_layers_path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("sla_layers_%%%%-%%%%-%%%%.tmp")).string();
+    m_layers_file = boost::nowide::fopen(m_layers_path.c_str(), "w+b");
+    if (m_layers_file == nullptr)
+        throw Slic3r::RuntimeError(std::string("Cannot create the temporary file ") + m_layers_path);
+    uint64_t file_pos = 0;
+
+    // Time spent in the parallel stages, summed over threads.
+    std::atomic<int64_t> draw_us { 0 };
+    std::atomic<int64_t> encode_us { 0 };
+    const auto           start = Clock::now();
+
+    struct DrawnLayer {
+        size_t                                   idx = 0;
+        // Shared pointer, as older TBB requires the items passed between the filters to be copyable.
+        std::shared_ptr<sla::RasterBase>         raster;
+    };
+    struct EncodedItem {
+        size_t                                   idx = 0;
+        std::shared_ptr<sla::EncodedRaster>      encoded;
+    };
+
+    size_t next_idx = 0;
+    const auto source = tbb::make_filter<void, size_t>(slic3r_tbb_filtermode::serial_in_order,
+        [&next_idx, layer_num, &cancelfn](tbb::flow_control &fc) -> size_t {
+            if (next_idx >= layer_num || cancelfn()) {
+                fc.stop();
+                return 0;
+            }
+            return next_idx ++;
+        });
+    const auto draw = tbb::make_filter<size_t, DrawnLayer>(slic3r_tbb_filtermode::parallel,
+        [this, &drawfn, &cancelfn, &draw_us, &micros](size_t idx) -> DrawnLayer {
+            if (cancelfn())
+                return { idx, nullptr };
+            const auto t = Clock::now();
+            std::shared_ptr<sla::RasterBase> raster = create_raster();
+            drawfn(*raster, idx);
+            draw_us += micros(t);
+            return { idx, std::move(raster) };
+        });
+    const auto encode = tbb::make_filter<DrawnLayer, EncodedItem>(slic3r_tbb_filtermode::parallel,
+        [this, &encode_us, &micros](DrawnLayer in) -> EncodedItem {
+            if (! in.raster)
+                return { in.idx, nullptr };
+            const auto t = Clock::now();
+            auto encoded = std::make_shared<sla::EncodedRaster>(in.raster->encode(get_encoder()));
+            // Release the uncompressed raster before the layer is passed on.
+            in.raster.reset();
+            encode_us += micros(t);
+            return { in.idx, std::move(encoded) };
+        });
+    // Written in order, thus the layers file is filled sequentially. The encoded layer is released right after.
+    const auto output = tbb::make_filter<EncodedItem, void>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &file_pos](EncodedItem in) {
+            if (! in.encoded)
+                return;
+            EncodedLayer &layer = m_layers[in.idx];
+            if (::fwrite(in.encoded->data(), 1, in.encoded->size(), m_layers_file) != in.encoded->size())
+                throw Slic3r::RuntimeError(std::string("Cannot write the temporary file ") + m_layers_path);
+            layer.offset    = file_pos;
+            layer.size      = in.encoded->size();
+            layer.extension = in.encoded->extension();
+            file_pos       += layer.size;
+        });
+
+    tbb::parallel_pipeline(max_in_flight, source & draw & encode & output);
+    if (::fflush(m_layers_file) != 0)
+        throw Slic3r::RuntimeError(std::string("Cannot write the temporary file ") + m_layers_path);
+
+    const double wall_s = micros(start) * 1e-6;
+    BOOST_LOG_TRIVIAL(info) << "SLA rasterization: " << layer_num << " layers in " << wall_s << " s ("
+                            << (wall_s > 0. ? double(layer_num) / wall_s : 0.) << " layers/s), draw " << draw_us * 1e-6
+                            << " s, encode " << encode_us * 1e-6 << " s of thread time, at most " << max_in_flight << " layers in flight";
+}
+
+SLAArchive::~SLAArchive()
+{
+    this->clear_layers();
+}
+
+void SLAArchive::clear_layers()
+{
+    std::lock_guard<std::mutex> lock(m_layers_mutex);
+    m_layers.clear();
+    if (m_layers_file != nullptr) {
+        ::fclose(m_layers_file);
+        m_layers_file = nullptr;
+        boost::system::error_code ec;
+        boost::filesystem::remove(m_layers_path, ec);
+        m_layers_path.clear();
+    }
+}
+
+sla::EncodedRaster SLAArchive::read_layer(size_t idx) const
+{
+    const EncodedLayer  &layer = m_layers[idx];
+    std::vector<uint8_t> buffer(layer.size);
+    if (layer.size > 0) {
+        std::lock_guard<std::mutex> lock(m_layers_mutex);
+#ifdef _WIN32
+        const bool seek_ok = _fseeki64(m_layers_file, int64_t(layer.offset), SEEK_SET) == 0;
+#else
+        const bool seek_ok = fseeko(m_layers_file, off_t(layer.offset), SEEK_SET) == 0;
+#endif
+        if (! seek_ok || ::fread(buffer.data(), 1, layer.size, m_layers_file) != layer.size)
+            throw Slic3r::RuntimeError(std::string("Cannot read the temporary file ") + m_layers_path);
+    }
+    return sla::EncodedRaster(std::move(buffer), layer.extension);
+}
+
 void SLAPrint::set_printer(SLAArchive *arch)
 {
     invalidate_step(slapsRasterize);
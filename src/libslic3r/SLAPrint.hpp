@@ -2,6 +2,7 @@
 #define slic3r_SLAPrint_hpp_
 
 #include <cstdint>
+#include <cstdio>
 #include <mutex>
 #include "PrintBase.hpp"
 #include "SLA/RasterBase.hpp"
@@ -390,37 +391,46 @@ struct SLAPrintStatistics
 
 class SLAArchive {
 protected:
-    std::vector<sla::EncodedRaster> m_layers;
+    // Layer encoded by draw_layers(), stored in the layers file.
+    struct EncodedLayer {
+        uint64_t    offset = 0;
+        size_t      size   = 0;
+        std::string extension;
+    };
+    std::vector<EncodedLayer> m_layers;
 
     virtual std::unique_ptr<sla::RasterBase> create_raster() const = 0;
     virtual sla::RasterEncoder get_encoder() const = 0;
 
+    // Read back an encoded layer. Thread safe. Throws Slic3r::RuntimeError on IO errors.
+    sla::EncodedRaster read_layer(size_t idx) const;
+    // Release the encoded layers and their file.
+    void               clear_layers();
+
 public:
-    virtual ~SLAArchive() = default;
+    SLAArchive() = default;
+    SLAArchive(const SLAArchive &) = delete;
+    SLAArchive &operator=(const SLAArchive &) = delete;
+    virtual ~SLAArchive();
 
     virtual void apply(const SLAPrinterConfig &cfg) = 0;
 
     // Fn have to be thread safe: void(sla::RasterBase& raster, size_t lyrid);
-    template<class Fn, class CancelFn, class EP = ExecutionTBB>
+    // The layers are drawn and encoded in parallel by a pipeline, which keeps at most max_in_flight
+    // layers alive at a time. The encoded layers are written in order into a temporary file as soon
+    // as they are ready and released, thus neither the rasters nor the encoded layers of high resolution
+    // printers pile up in memory. The export reads them back one by one.
+    // Zero max_in_flight stands for the number of worker threads.
     void draw_layers(
-        size_t     layer_num,
-        Fn &&      drawfn,
-        CancelFn cancelfn = []() { return false; },
-        const EP & ep       = {})
-    {
-        m_layers.resize(layer_num);
-        execution::for_each(
-            ep, size_t(0), m_layers.size(),
-            [this, &drawfn, &cancelfn](size_t idx) {
-                if (cancelfn()) return;
-
-                sla::EncodedRaster &enc = m_layers[idx];
-                auto                rst = create_raster();
-                drawfn(*rst, idx);
-                enc = rst->encode(get_encoder());
-            },
-            execution::max_concurrency(ep));
-    }
+        size_t                                           layer_num,
+        std::function<void(sla::RasterBase &, size_t)>   drawfn,
+        std::function<bool()>                            cancelfn      = []() { return false; },
+        size_t                                           max_in_flight = 0);
+
+private:
+    std::string        m_layers_path;
+    FILE              *m_layers_file = nullptr;
+    mutable std::mutex m_layers_mutex;
 };
 
 /**
@@ -1092,9 +1092,9 @@ void SLAPrint::Steps::rasterize()
     // last minute escape
     if(canceled()) return;
 
-    // Print all the layers in parallel
+    // Print all the layers in parallel, the number of uncompressed rasters in memory is bounded by the pipeline.
     m_print->m_printer->draw_layers(m_print->m_printer_input.size(), lvlfn,
-                                    [this]() { return canceled(); }, ex_tbb);
+                                    [this]() { return canceled(); });
 }
 
 std::string SLAPrint::Steps::label(SLAPrintObjectStep step)
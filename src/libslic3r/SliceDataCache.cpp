@@ -0,0 +1,250 @@
+#include "SliceDataCache.hpp"
+#include "Model.hpp"
+#include "Print.hpp"
+#include "Utils.hpp"
+#include "libslic3r_version.h"
+
+#include <algorithm>
+#include <ctime>
+#include <tuple>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/log/trivial.hpp>
+
+#include <openssl/md5.h>
+
+namespace fs = boost::filesystem;
+
+namespace Slic3r {
+
+// Increase when the content of the entries changes.
+static constexpr const int slice_data_cache_format = 1;
+
+// Temporary files of the processes, which did not finish writing their entries, are removed after this time.
+static constexpr const std::time_t stale_temporary_file_age = 3600;
+
+namespace {
+
+class ContentHash
+{
+public:
+    ContentHash() { MD5_Init(&m_ctx); }
+
+    void add(const void *data, size_t size) { MD5_Update(&m_ctx, data, size); }
+    // Plain values and vectors of plain values, including the fixed size Eigen vectors.
+    template<typename T> void add_value(const T &value) { this->add(&value, sizeof(T)); }
+    template<typename T> void add_values(const std::vector<T> &values)
+    {
+        this->add_value(values.size());
+        this->add(values.data(), values.size() * sizeof(T));
+    }
+    void add_string(const std::string &str)
+    {
+        this->add_value(str.size());
+        this->add(str.data(), str.size());
+    }
+    template<typename Filter> void add_config(const ConfigBase &config, Filter &&filter)
+    {
+        for (const std::string &key : config.keys())
+            if (filter(key)) {
+                this->add_string(key);
+                this->add_string(config.opt_serialize(key));
+            }
+    }
+    void add_config(const ConfigBase &config) { this->add_config(config, [](const std::string&) { return true; }); }
+    void add_facets(const FacetsAnnotation &facets)
+    {
+        const TriangleSelector::TriangleSplittingData &data = facets.get_data();
+        this->add_value(data.triangles_to_split.size());
+        this->add_value(data.bitstream.size());
+        this->add_value(data.hash);
+    }
+
+    std::string hex()
+    {
+        unsigned char digest[MD5_DIGEST_LENGTH];
+        MD5_Final(digest, &m_ctx);
+        char out[MD5_DIGEST_LENGTH * 2 + 1];
+        for (int i = 0; i < MD5_DIGEST_LENGTH; ++ i)
+            sprintf(&out[i * 2], "%02x", (unsigned int) digest[i]);
+        return std::string(out, MD5_DIGEST_LENGTH * 2);
+    }
+
+private:
+    MD5_CTX m_ctx;
+};
+
+} // namespace
+
+SliceDataCache::SliceDataCache(const std::string &directory, uint64_t size_limit) : m_directory(directory), m_size_limit(size_limit) {}
+
+std::string SliceDataCache::object_key(const PrintObject &object)
+{
+    ContentHash hash;
+    hash.add_string(SoftFever_VERSION);
+    hash.add_value(slice_data_cache_format);
+    hash.add_value(SCALING_FACTOR);
+
+    // Options of the print, of the object and of its regions.
+    hash.add_config(object.print()->config(), [](const std::string &key) { return ! Print::is_gcode_export_option(key); });
+    hash.add_config(object.config());
+    hash.add_value(object.num_printing_regions());
+    for (size_t region_id = 0; region_id < object.num_printing_regions(); ++ region_id)
+        hash.add_config(object.printing_region(region_id).config());
+
+    // Placement of the object, without the XY position of its instances.
+    hash.add(object.trafo().matrix().data(), sizeof(double) * 16);
+    hash.add_value(object.center_offset().x());
+    hash.add_value(object.center_offset().y());
+
+    const ModelObject &model_object = *object.model_object();
+    hash.add_config(model_object.config.get());
+    hash.add_values(model_object.layer_height_profile.get());
+    hash.add_value(model_object.layer_config_ranges.size());
+    for (const auto &[range, config] : model_object.layer_config_ranges) {
+        hash.add_value(range.first);
+        hash.add_value(range.second);
+        hash.add_config(config.get());
+    }
+    hash.add_value(model_object.volumes.size());
+    for (const ModelVolume *volume : model_object.volumes) {
+        hash.add_value(volume->type());
+        hash.add_values(volume->mesh().its.vertices);
+        hash.add_values(volume->mesh().its.indices);
+        hash.add(volume->get_matrix().matrix().data(), sizeof(double) * 16);
+        hash.add_config(volume->config.get());
+        hash.add_facets(volume->supported_facets);
+        hash.add_facets(volume->seam_facets);
+        hash.add_facets(volume->mmu_segmentation_facets);
+        hash.add_facets(volume->fuzzy_skin_facets);
+    }
+    return hash.hex();
+}
+
+std::string SliceDataCache::entry_path(const std::string &key) const
+{
+    return (fs::path(m_directory) / (key + ".json")).string();
+}
+
+int SliceDataCache::load(Print &print)
+{
+    m_stats = Stats();
+    m_keys.clear();
+    m_loaded.clear();
+
+    std::set<std::string> missing;
+    int ret = print.load_cached_data([this, &missing](const PrintObject &object) -> std::string {
+        const std::string &key = m_keys[&object] = object_key(object);
+        // Objects made of the same data are shared by Print::process().
+        if (m_loaded.count(key) || missing.count(key))
+            return {};
+        const std::string path = this->entry_path(key);
+        boost::system::error_code ec;
+        if (! fs::exists(path, ec)) {
+            missing.insert(key);
+            return {};
+        }
+        // Recently used entries are evicted last.
+        fs::last_write_time(path, std::time(nullptr), ec);
+        m_loaded.insert(key);
+        return path;
+    });
+
+    if (ret) {
+        BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << boost::format(": loading from %1% failed, ret=%2%, the objects will be stored again") % m_directory % ret;
+        // The entries failed to load are overwritten by store().
+        m_stats.misses = m_loaded.size() + missing.size();
+        m_loaded.clear();
+        return ret;
+    }
+    m_stats.hits   = m_loaded.size();
+    m_stats.misses = missing.size();
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": %1% objects restored from %2%, %3% objects not cached") % m_stats.hits % m_directory % m_stats.misses;
+    return 0;
+}
+
+int SliceDataCache::store(Print &print, bool with_space)
+{
+    boost::system::error_code ec;
+    fs::create_directories(m_directory, ec);
+    if (! fs::is_directory(m_directory, ec)) {
+        BOOST_LOG_TRIVIAL(error) << boost::format("create directory %1% failed") % m_directory;
+        return CLI_EXPORT_CACHE_DIRECTORY_CREATE_FAILED;
+    }
+
+    // Temporary and final paths of the entries.
+    std::vector<std::pair<std::string, std::string>> written;
+    std::set<std::string>                            written_keys;
+    int ret = print.export_cached_data([this, &written, &written_keys](const PrintObject &object) -> std::string {
+        auto it = m_keys.find(&object);
+        const std::string key = it == m_keys.end() ? object_key(object) : it->second;
+        if (m_loaded.count(key) || ! written_keys.insert(key).second)
+            return {};
+        const std::string path = this->entry_path(key);
+        written.emplace_back(path + "." + fs::unique_path("%%%%-%%%%-%%%%").string() + ".tmp", path);
+        return written.back().first;
+    }, with_space);
+
+    for (const auto &[tmp_path, path] : written) {
+        if (ret == 0) {
+            fs::rename(tmp_path, path, ec);
+            if (! ec) {
+                ++ m_stats.stored;
+                continue;
+            }
+            BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << boost::format(": renaming %1% to %2% failed, reason = %3%") % tmp_path % path % ec.message();
+        }
+        fs::remove(tmp_path, ec);
+    }
+    if (ret) {
+        BOOST_LOG_TRIVIAL(error) << __FUNCTION__ << boost::format(": storing to %1% failed, ret=%2%") % m_directory % ret;
+        return ret;
+    }
+
+    this->evict();
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": %1% objects stored to %2%, %3% entries evicted") % m_stats.stored % m_directory % m_stats.evicted;
+    return 0;
+}
+
+void SliceDataCache::evict()
+{
+    boost::system::error_code ec;
+    const std::time_t         now = std::time(nullptr);
+    // Last write time, size and path of the entries.
+    std::vector<std::tuple<std::time_t, uint64_t, fs::path>> entries;
+    uint64_t                                                 total_size = 0;
+    for (fs::directory_iterator it(m_directory, ec), end; ! ec && it != end; it.increment(ec)) {
+        const fs::path &path = it->path();
+        if (! fs::is_regular_file(path, ec))
+            continue;
+        const std::time_t time = fs::last_write_time(path, ec);
+        if (ec)
+            continue;
+        if (path.extension() == ".tmp") {
+            if (now - time > stale_temporary_file_age)
+                fs::remove(path, ec);
+        } else if (path.extension() == ".json") {
+            const uint64_t size = fs::file_size(path, ec);
+            if (ec)
+                continue;
+            entries.emplace_back(time, size, path);
+            total_size += size;
+        }
+    }
+    if (m_size_limit == 0 || total_size <= m_size_limit)
+        return;
+
+    std::sort(entries.begin(), entries.end(), [](const auto &l, const auto &r) { return std::get<0>(l) < std::get<0>(r); });
+    for (const auto &[time, size, path] : entries) {
+        if (total_size <= m_size_limit)
+            break;
+        // Another process may have removed the entry in the meantime.
+        fs::remove(path, ec);
+        total_size -= size;
+        ++ m_stats.evicted;
+    }
+}
+
+} // namespace Slic3r
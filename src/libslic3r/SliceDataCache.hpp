@@ -0,0 +1,66 @@
+#ifndef slic3r_SliceDataCache_hpp_
+#define slic3r_SliceDataCache_hpp_
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+
+namespace Slic3r {
+
+class Print;
+class PrintObject;
+
+// Directory of sliced PrintObjects shared by the command line invocations, addressed by the content of their inputs.
+//
+// An entry holds the layers of a single object as exported by Print::export_cached_data(), named by a hash of the meshes
+// of the object, of their transformations and of the object, region and print options the PrintObject steps depend on.
+// The options influencing the G-code export only are not hashed, thus the objects are reused when slicing with another
+// start G-code, other fan or retraction settings. Objects sliced before are restored by Print::process(nullptr, true),
+// the other objects are sliced and stored after the print is processed.
+//
+// The least recently used entries are removed once the directory exceeds its size limit.
+// The directory may be shared by several processes: the entries are written to temporary files, which are then renamed.
+class SliceDataCache
+{
+public:
+    // Counts of the distinct objects of a print.
+    struct Stats
+    {
+        size_t hits    { 0 };
+        size_t misses  { 0 };
+        size_t stored  { 0 };
+        size_t evicted { 0 };
+    };
+
+    // size_limit in bytes, 0 for no limit.
+    SliceDataCache(const std::string &directory, uint64_t size_limit);
+
+    // Hash of all the inputs of the PrintObject steps of the object.
+    static std::string object_key(const PrintObject &object);
+
+    // Restore the objects of the print found in the cache and start the statistics of the print.
+    // Returns 0 or one of the CLI_IMPORT_CACHE_* errors, after which the print shall be processed without the cache.
+    int                load(Print &print);
+    // Store the objects of a processed print, which were not restored by load(), then evict the entries over the size limit.
+    // Returns 0 or one of the CLI_EXPORT_CACHE_* errors.
+    int                store(Print &print, bool with_space = false);
+
+    const Stats&       stats() const { return m_stats; }
+    const std::string& directory() const { return m_directory; }
+
+private:
+    std::string        entry_path(const std::string &key) const;
+    void               evict();
+
+    std::string                              m_directory;
+    uint64_t                                 m_size_limit;
+    Stats                                    m_stats;
+    // Keys of the objects of the current print, keys of the objects restored from the cache.
+    std::map<const PrintObject*, std::string> m_keys;
+    std::set<std::string>                    m_loaded;
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_SliceDataCache_hpp_
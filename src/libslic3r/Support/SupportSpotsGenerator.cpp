@@ -18,6 +18,14 @@
 #include "tbb/blocked_range.h"
 #include "tbb/blocked_range2d.h"
 #include "tbb/parallel_reduce.h"
+#include "tbb/task_arena.h"
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
 #include <algorithm>
 #include <boost/log/trivial.hpp>
 #include <cmath>
@@ -138,6 +146,35 @@ float estimate_curled_up_height(
     return curled_up_height;
 }
 
+// Walks the layers bottom-up with sweep(layer_idx, prepared) on one thread at a time, while prepare(layer_idx)
+// builds the per layer inputs of the layers above on the worker threads. Only a limited number of layers is
+// prepared ahead, so the memory stays bounded on tall objects.
+template<class Prepared, class PrepareFn, class SweepFn>
+static void sweep_layers_pipelined(size_t layer_count, PrepareFn &&prepare, SweepFn &&sweep)
+{
+    struct PreparedLayer {
+        size_t                    idx = 0;
+        // Shared pointer, as older TBB requires the items passed between the filters to be copyable.
+        std::shared_ptr<Prepared> data;
+    };
+
+    size_t     next_idx = 0;
+    const auto source   = tbb::make_filter<void, size_t>(slic3r_tbb_filtermode::serial_in_order,
+        [&next_idx, layer_count](tbb::flow_control &fc) -> size_t {
+            if (next_idx >= layer_count) {
+                fc.stop();
+                return 0;
+            }
+            return next_idx++;
+        });
+    const auto prepare_filter = tbb::make_filter<size_t, PreparedLayer>(slic3r_tbb_filtermode::parallel,
+        [&prepare](size_t idx) -> PreparedLayer { return PreparedLayer{idx, std::make_shared<Prepared>(prepare(idx))}; });
+    const auto sweep_filter = tbb::make_filter<PreparedLayer, void>(slic3r_tbb_filtermode::serial_in_order,
+        [&sweep](PreparedLayer layer) { sweep(layer.idx, *layer.data); });
+
+    tbb::parallel_pipeline(2 * size_t(tbb::this_task_arena::max_concurrency()), source & prepare_filter & sweep_filter);
+}
+
 void estimate_malformations(LayerPtrs &layers, const Params &params)
 {
 #ifdef DEBUG_FILES
@@ -145,45 +182,73 @@ void estimate_malformations(LayerPtrs &layers, const Params &params)
     FILE *full_file  = boost::nowide::fopen(debug_out_path("object_full.obj").c_str(), "w");
 #endif
 
-    LD prev_layer_lines{};
+    // Everything that does not depend on the curling of the layer below.
+    struct MalformationLayerInput
+    {
+        struct Perimeter
+        {
+            const ExtrusionEntity *extrusion;
+            float                  flow_width;
+            Points                 points;
+        };
+
+        AABBTreeLines::LinesDistancer<Linef>   prev_layer_boundary;
+        // Owns the flattened copies of the perimeters, the entities above point into them.
+        std::vector<ExtrusionEntityCollection> flattened_perimeters;
+        std::vector<Perimeter>                 external_perimeters;
+    };
 
-    for (Layer *l : layers) {
-        l->curled_lines.clear();
+    auto prepare_layer = [&layers](size_t layer_idx) {
+        const Layer           *l = layers[layer_idx];
+        MalformationLayerInput input;
         std::vector<Linef> boundary_lines = l->lower_layer != nullptr ? to_unscaled_linesf(l->lower_layer->lslices) : std::vector<Linef>();
-        AABBTreeLines::LinesDistancer<Linef> prev_layer_boundary{std::move(boundary_lines)};
-        std::vector<ExtrusionLine>           current_layer_lines;
+        input.prev_layer_boundary = AABBTreeLines::LinesDistancer<Linef>{std::move(boundary_lines)};
+        input.flattened_perimeters.reserve(l->regions().size());
         for (const LayerRegion *layer_region : l->regions()) {
-            for (const ExtrusionEntity *extrusion : layer_region->perimeters.flatten().entities) {
+            input.flattened_perimeters.emplace_back(layer_region->perimeters.flatten());
+            for (const ExtrusionEntity *extrusion : input.flattened_perimeters.back().entities) {
                 if (extrusion->role() != Slic3r::erExternalPerimeter)
                     continue;
 
-                Points extrusion_pts;
-                extrusion->collect_points(extrusion_pts);
-                float flow_width       = get_flow_width(layer_region, extrusion->role());
-                auto  annotated_points = estimate_points_properties<true, true, false, false>(extrusion_pts,
-                                                                                                                 prev_layer_lines,
-                                                                                                                 flow_width,
-                                                                                                                 params.bridge_distance);
-                for (size_t i = 0; i < annotated_points.size(); ++i) {
-                    const ExtendedPoint &a = i > 0 ? annotated_points[i - 1] : annotated_points[i];
-                    const ExtendedPoint &b = annotated_points[i];
-                    ExtrusionLine line_out{a.position.cast<float>(), b.position.cast<float>(), float((a.position - b.position).norm()),
-                                           extrusion};
-
-                    Vec2f middle                               = 0.5 * (line_out.a + line_out.b);
-                    auto [middle_distance, bottom_line_idx, x] = prev_layer_lines.distance_from_lines_extra<false>(middle);
-                    ExtrusionLine bottom_line                  = prev_layer_lines.get_lines().empty() ? ExtrusionLine{} :
-                                                                                                        prev_layer_lines.get_line(bottom_line_idx);
-
-                    // correctify the distance sign using slice polygons
-                    float sign = (prev_layer_boundary.distance_from_lines<true>(middle.cast<double>()) + 0.5f * flow_width) < 0.0f ? -1.0f :
-                                                                                                                                     1.0f;
-
-                    line_out.curled_up_height = estimate_curled_up_height(middle_distance * sign * params.curled_distance_expansion, 0.5 * (a.curvature + b.curvature),
-                                                                          l->height, flow_width, bottom_line.curled_up_height, params);
-
-                    current_layer_lines.push_back(line_out);
-                }
+                MalformationLayerInput::Perimeter perimeter{extrusion, get_flow_width(layer_region, extrusion->role()), {}};
+                extrusion->collect_points(perimeter.points);
+                input.external_perimeters.emplace_back(std::move(perimeter));
+            }
+        }
+        return input;
+    };
+
+    LD prev_layer_lines{};
+
+    auto sweep_layer = [&](size_t layer_idx, const MalformationLayerInput &input) {
+        Layer *l = layers[layer_idx];
+        l->curled_lines.clear();
+        const AABBTreeLines::LinesDistancer<Linef> &prev_layer_boundary = input.prev_layer_boundary;
+        std::vector<ExtrusionLine>                  current_layer_lines;
+        for (const MalformationLayerInput::Perimeter &perimeter : input.external_perimeters) {
+            const ExtrusionEntity *extrusion  = perimeter.extrusion;
+            float                  flow_width = perimeter.flow_width;
+            auto annotated_points = estimate_points_properties<true, true, false, false>(perimeter.points, prev_layer_lines, flow_width,
+                                                                                         params.bridge_distance);
+            for (size_t i = 0; i < annotated_points.size(); ++i) {
+                const ExtendedPoint &a = i > 0 ? annotated_points[i - 1] : annotated_points[i];
+                const ExtendedPoint &b = annotated_points[i];
+                ExtrusionLine line_out{a.position.cast<float>(), b.position.cast<float>(), float((a.position - b.position).norm()),
+                                       extrusion};
+
+                Vec2f middle                               = 0.5 * (line_out.a + line_out.b);
+                auto [middle_distance, bottom_line_idx, x] = prev_layer_lines.distance_from_lines_extra<false>(middle);
+                ExtrusionLine bottom_line                  = prev_layer_lines.get_lines().empty() ? ExtrusionLine{} :
+                                                                                                    prev_layer_lines.get_line(bottom_line_idx);
+
+                // correctify the distance sign using slice polygons
+                float sign = (prev_layer_boundary.distance_from_lines<true>(middle.cast<double>()) + 0.5f * flow_width) < 0.0f ? -1.0f :
+                                                                                                                                 1.0f;
+
+                line_out.curled_up_height = estimate_curled_up_height(middle_distance * sign * params.curled_distance_expansion, 0.5 * (a.curvature + b.curvature),
+                                                                      l->height, flow_width, bottom_line.curled_up_height, params);
+
+                current_layer_lines.push_back(line_out);
             }
         }
 
@@ -207,7 +272,9 @@ void estimate_malformations(LayerPtrs &layers, const Params &params)
 #endif
 
         prev_layer_lines = LD{current_layer_lines};
-    }
+    };
+
+    sweep_layers_pipelined<MalformationLayerInput>(layers.size(), prepare_layer, sweep_layer);
 
 #ifdef DEBUG_FILES
     fclose(debug_file);
@@ -863,7 +930,33 @@ std::tuple<SupportPoints, PartialObjects> check_stability(const PrintObject *po,
         }
     };
 
-    for (size_t layer_idx = 0; layer_idx < po->layer_count(); ++layer_idx) {
+    // Per slice data, which depends on the layer and the layer below only.
+    struct StabilitySliceInput
+    {
+        ObjectPart                           new_part;
+        SliceConnection                      connection_to_below;
+        AABBTreeLines::LinesDistancer<Linef> prev_layer_boundary;
+    };
+
+    auto prepare_layer = [po, &params](size_t layer_idx) {
+        const Layer                     *layer = po->get_layer(layer_idx);
+        std::vector<StabilitySliceInput> slices;
+        slices.reserve(layer->lslices_ex.size());
+        for (size_t slice_idx = 0; slice_idx < layer->lslices_ex.size(); ++slice_idx) {
+            const LayerSlice &slice = layer->lslices_ex[slice_idx];
+            std::vector<Linef> boundary_lines;
+            for (const auto &link : slice.overlaps_below) {
+                auto ls = to_unscaled_linesf({layer->lower_layer->lslices[link.slice_idx]});
+                boundary_lines.insert(boundary_lines.end(), ls.begin(), ls.end());
+            }
+            slices.push_back({std::get<0>(build_object_part_from_slice(slice_idx, layer, params)),
+                              estimate_slice_connection(slice_idx, layer),
+                              AABBTreeLines::LinesDistancer<Linef>{std::move(boundary_lines)}});
+        }
+        return slices;
+    };
+
+    auto sweep_layer = [&](size_t layer_idx, const std::vector<StabilitySliceInput> &slices_input) {
         cancel_func();
         const Layer *layer                 = po->get_layer(layer_idx);
         float        bottom_z              = layer->bottom_z();
@@ -871,8 +964,8 @@ std::tuple<SupportPoints, PartialObjects> check_stability(const PrintObject *po,
 
         for (size_t slice_idx = 0; slice_idx < layer->lslices_ex.size(); ++slice_idx) {
             const LayerSlice &slice             = layer->lslices_ex.at(slice_idx);
-            auto [new_part, covered_area]       = build_object_part_from_slice(slice_idx, layer, params);
-            SliceConnection connection_to_below = estimate_slice_connection(slice_idx, layer);
+            const ObjectPart &new_part          = slices_input[slice_idx].new_part;
+            SliceConnection connection_to_below = slices_input[slice_idx].connection_to_below;
 
 #ifdef DETAILED_DEBUG_LOGS
             std::cout << "SLICE IDX: " << slice_idx << std::endl;
@@ -947,13 +1040,7 @@ std::tuple<SupportPoints, PartialObjects> check_stability(const PrintObject *po,
             const LayerSlice          &slice        = layer->lslices_ex.at(slice_idx);
             ObjectPart                &part         = active_object_parts.access(prev_slice_idx_to_object_part_mapping[slice_idx]);
             SliceConnection           &weakest_conn = prev_slice_idx_to_weakest_connection[slice_idx];
-
-            std::vector<Linef> boundary_lines;
-            for (const auto &link : slice.overlaps_below) { 
-                auto ls = to_unscaled_linesf({layer->lower_layer->lslices[link.slice_idx]});
-                boundary_lines.insert(boundary_lines.end(), ls.begin(), ls.end());
-            }
-            AABBTreeLines::LinesDistancer<Linef> prev_layer_boundary{std::move(boundary_lines)};
+            const AABBTreeLines::LinesDistancer<Linef> &prev_layer_boundary = slices_input[slice_idx].prev_layer_boundary;
 
 
             std::vector<ExtrusionLine> current_slice_ext_perims_lines{};
@@ -1078,7 +1165,9 @@ std::tuple<SupportPoints, PartialObjects> check_stability(const PrintObject *po,
                                                   current_slice_ext_perims_lines.end());
         } // slice iterations
         prev_layer_ext_perim_lines = LD(current_layer_ext_perims_lines);
-    } // layer iterations
+    }; // layer iterations
+
+    sweep_layers_pipelined<std::vector<StabilitySliceInput>>(po->layer_count(), prepare_layer, sweep_layer);
 
     for (const auto& active_obj_pair : prev_slice_idx_to_object_part_mapping) {
         remember_partial_object(active_obj_pair.second);
@@ -1422,52 +1422,73 @@ int TriangleSelector::num_facets(EnforcerBlockerType state) const
     return cnt;
 }
 
-indexed_triangle_set TriangleSelector::get_facets(EnforcerBlockerType state) const
+std::vector<std::vector<int>> TriangleSelector::collect_leaf_triangles(int only_state) const
+{
+    // Fixed blocks, so that concatenating the blocks keeps the order of m_triangles.
+    constexpr size_t block_size = 16384;
+    const size_t     num_lists  = only_state < 0 ? size_t(EnforcerBlockerType::ExtruderMax) + 1 : 1;
+    std::vector<std::vector<std::vector<int>>> blocks((m_triangles.size() + block_size - 1) / block_size, std::vector<std::vector<int>>(num_lists));
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, blocks.size()), [this, &blocks, only_state](const tbb::blocked_range<size_t> &range) {
+        for (size_t block_idx = range.begin(); block_idx < range.end(); ++ block_idx)
+            for (size_t tr_idx = block_idx * block_size; tr_idx < std::min(m_triangles.size(), (block_idx + 1) * block_size); ++ tr_idx)
+                if (const Triangle &tr = m_triangles[tr_idx]; tr.valid() && ! tr.is_split()) {
+                    if (only_state < 0) {
+                        if (size_t(tr.get_state()) < blocks[block_idx].size())
+                            blocks[block_idx][size_t(tr.get_state())].emplace_back(int(tr_idx));
+                    } else if (int(tr.get_state()) == only_state)
+                        blocks[block_idx].front().emplace_back(int(tr_idx));
+                }
+    });
+
+    std::vector<std::vector<int>> out(num_lists);
+    for (size_t list_idx = 0; list_idx < num_lists; ++ list_idx) {
+        size_t cnt = 0;
+        for (const std::vector<std::vector<int>> &block : blocks)
+            cnt += block[list_idx].size();
+        out[list_idx].reserve(cnt);
+        for (const std::vector<std::vector<int>> &block : blocks)
+            out[list_idx].insert(out[list_idx].end(), block[list_idx].begin(), block[list_idx].end());
+    }
+    return out;
+}
+
+indexed_triangle_set TriangleSelector::facets_from_triangles(const std::vector<int> &triangles) const
 {
     indexed_triangle_set out;
+    out.indices.reserve(triangles.size());
     std::vector<int> vertex_map(m_vertices.size(), -1);
-    for (const Triangle& tr : m_triangles) {
-        if (tr.valid() && ! tr.is_split() && tr.get_state() == state) {
-            stl_triangle_vertex_indices indices;
-            for (int i=0; i<3; ++i) {
-                int j = tr.verts_idxs[i];
-                if (vertex_map[j] == -1) {
-                    vertex_map[j] = int(out.vertices.size());
-                    out.vertices.emplace_back(m_vertices[j].v);
-                }
-                indices[i] = vertex_map[j];
+    for (int tr_idx : triangles) {
+        const Triangle &tr = m_triangles[tr_idx];
+        stl_triangle_vertex_indices indices;
+        for (int i = 0; i < 3; ++i) {
+            int j = tr.verts_idxs[i];
+            if (vertex_map[j] == -1) {
+                vertex_map[j] = int(out.vertices.size());
+                out.vertices.emplace_back(m_vertices[j].v);
             }
-            out.indices.emplace_back(indices);
+            indices[i] = vertex_map[j];
         }
+        out.indices.emplace_back(indices);
     }
     return out;
 }
 
+indexed_triangle_set TriangleSelector::get_facets(EnforcerBlockerType state) const
+{
+    return this->facets_from_triangles(this->collect_leaf_triangles(int(state)).front());
+}
+
 // BBS
 void TriangleSelector::get_facets(std::vector<indexed_triangle_set>& facets_per_type) const
 {
-    facets_per_type.clear();
-
-    for (int type = (int)EnforcerBlockerType::NONE; type <= (int)EnforcerBlockerType::ExtruderMax; type++) {
-        facets_per_type.emplace_back();
-        indexed_triangle_set& its = facets_per_type.back();
-        std::vector<int> vertex_map(m_vertices.size(), -1);
-
-        for (const Triangle& tr : m_triangles) {
-            if (tr.valid() && !tr.is_split() && tr.get_state() == (EnforcerBlockerType)type) {
-                stl_triangle_vertex_indices indices;
-                for (int i = 0; i < 3; ++i) {
-                    int j = tr.verts_idxs[i];
-                    if (vertex_map[j] == -1) {
-                        vertex_map[j] = int(its.vertices.size());
-                        its.vertices.emplace_back(m_vertices[j].v);
-                    }
-                    indices[i] = vertex_map[j];
-                }
-                its.indices.emplace_back(indices);
-            }
-        }
-    }
+    // Single pass over the triangles for all the types, then the types are assembled in parallel.
+    const std::vector<std::vector<int>> triangles_per_type = this->collect_leaf_triangles(-1);
+    facets_per_type.assign(triangles_per_type.size(), indexed_triangle_set());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, triangles_per_type.size()), [this, &triangles_per_type, &facets_per_type](const tbb::blocked_range<size_t> &range) {
+        for (size_t type = range.begin(); type < range.end(); ++ type)
+            if (! triangles_per_type[type].empty())
+                facets_per_type[type] = this->facets_from_triangles(triangles_per_type[type]);
+    });
 }
 
 indexed_triangle_set TriangleSelector::get_facets_strict(EnforcerBlockerType state) const
@@ -1640,6 +1661,62 @@ void TriangleSelector::get_seed_fill_contour_recursive(const int facet_idx, cons
     }
 }
 
+// The bitstream of TriangleSplittingData is a sequence of 4 bit codes, each root triangle starts at a code boundary.
+// Codes are converted from / to the bitstream in parallel over blocks of codes, which span whole words of std::vector<bool>,
+// thus no two threads write into the same word.
+static constexpr size_t bitstream_block_codes = 4096;
+
+static void codes_to_bitstream(const std::vector<uint8_t> &codes, std::vector<bool> &bitstream)
+{
+    bitstream.assign(codes.size() * 4, false);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, (codes.size() + bitstream_block_codes - 1) / bitstream_block_codes), [&codes, &bitstream](const tbb::blocked_range<size_t> &range) {
+        for (size_t block_idx = range.begin(); block_idx < range.end(); ++ block_idx) {
+            const size_t code_end = std::min(codes.size(), (block_idx + 1) * bitstream_block_codes);
+            auto         bit_it   = bitstream.begin() + block_idx * bitstream_block_codes * 4;
+            for (size_t code_idx = block_idx * bitstream_block_codes; code_idx < code_end; ++ code_idx)
+                for (int i = 0; i < 4; ++ i)
+                    *bit_it ++ = (codes[code_idx] >> i) & 1;
+        }
+    });
+}
+
+static std::vector<uint8_t> bitstream_to_codes(const std::vector<bool> &bitstream)
+{
+    std::vector<uint8_t> codes(bitstream.size() / 4, 0);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, (codes.size() + bitstream_block_codes - 1) / bitstream_block_codes), [&codes, &bitstream](const tbb::blocked_range<size_t> &range) {
+        for (size_t block_idx = range.begin(); block_idx < range.end(); ++ block_idx) {
+            const size_t code_end = std::min(codes.size(), (block_idx + 1) * bitstream_block_codes);
+            auto         bit_it   = bitstream.begin() + block_idx * bitstream_block_codes * 4;
+            for (size_t code_idx = block_idx * bitstream_block_codes; code_idx < code_end; ++ code_idx) {
+                uint8_t code = 0;
+                for (int i = 0; i < 4; ++ i)
+                    code |= uint8_t(*bit_it ++) << i;
+                codes[code_idx] = code;
+            }
+        }
+    });
+    return codes;
+}
+
+uint64_t TriangleSelector::TriangleSplittingData::root_hash(int triangle_idx, const uint8_t *codes, size_t num_codes)
+{
+    // FNV-1a over the triangle index and its codes. It does not depend on the platform nor on std::hash,
+    // thus data loaded from 3MF hashes the same as data serialized from a TriangleSelector.
+    uint64_t h   = hash_seed;
+    auto     add = [&h](uint8_t byte) { h ^= byte; h *= 0x100000001b3ull; };
+    for (int i = 0; i < 4; ++ i)
+        add(uint8_t(uint32_t(triangle_idx) >> (8 * i)));
+    for (size_t i = 0; i < num_codes; ++ i)
+        add(codes[i]);
+    return h;
+}
+
+void TriangleSelector::TriangleSplittingData::append_root_hash(uint64_t root_hash)
+{
+    hash  = (hash ^ root_hash) * 0x9e3779b97f4a7c15ull;
+    hash ^= hash >> 32;
+}
+
 TriangleSelector::TriangleSplittingData TriangleSelector::serialize() const {
     // Each original triangle of the mesh is assigned a number encoding its state
     // or how it is split. Each triangle is encoded by 4 bits (xxyy) or 8 bits (zzzzxxyy):
@@ -1654,9 +1731,12 @@ TriangleSelector::TriangleSplittingData TriangleSelector::serialize() const {
     // Using an explicit function object to support recursive call of Serializer::serialize().
     // This is cheaper than the previous implementation using a recursive call of type erased std::function.
     // (std::function calls using a pointer, while this implementation calls directly).
+    // The tree of each root triangle is written as 4 bit codes into a buffer of the block of root triangles
+    // being processed, the blocks are serialized in parallel and then concatenated.
     struct Serializer {
-        const TriangleSelector* triangle_selector;
-        TriangleSplittingData data;
+        const TriangleSelector *triangle_selector;
+        std::vector<uint8_t>   &codes;
+        uint32_t               &used_states;
 
         void serialize(int facet_idx) {
             const Triangle& tr = triangle_selector->m_triangles[facet_idx];
@@ -1665,17 +1745,13 @@ TriangleSelector::TriangleSplittingData TriangleSelector::serialize() const {
             int split_sides = tr.number_of_split_sides();
             assert(split_sides >= 0 && split_sides <= 3);
 
-            data.bitstream.push_back(split_sides & 0b01);
-            data.bitstream.push_back(split_sides & 0b10);
-
             if (split_sides) {
                 // If this triangle is split, save which side is split (in case
                 // of one split) or kept (in case of two splits). The value will
                 // be ignored for 3-side split.
                 assert(tr.is_split() && split_sides > 0);
                 assert(tr.special_side() >= 0 && tr.special_side() <= 3);
-                data.bitstream.push_back(tr.special_side() & 0b01);
-                data.bitstream.push_back(tr.special_side() & 0b10);
+                codes.push_back(uint8_t(split_sides | (tr.special_side() << 2)));
                 // Now save all children.
                 // Serialized in reverse order for compatibility with PrusaSlicer 2.3.1.
                 for (int child_idx = split_sides; child_idx >= 0; -- child_idx)
@@ -1683,41 +1759,81 @@ TriangleSelector::TriangleSplittingData TriangleSelector::serialize() const {
             } else {
                 // In case this is leaf, we better save information about its state.
                 int n = int(tr.get_state());
-                if (n <= static_cast<size_t>(EnforcerBlockerType::ExtruderMax))
-                    data.used_states[n] = true;
+                if (n <= static_cast<int>(EnforcerBlockerType::ExtruderMax))
+                    used_states |= uint32_t(1) << n;
 
                 if (n >= 3) {
                     assert(n <= 16);
                     if (n <= 16) {
                         // Store "11" plus 4 bits of (n-3).
-                        data.bitstream.insert(data.bitstream.end(), { true, true });
-                        n -= 3;
-                        for (size_t bit_idx = 0; bit_idx < 4; ++bit_idx)
-                            data.bitstream.push_back(n & (uint64_t(0b0001) << bit_idx));
+                        codes.push_back(0b1100);
+                        codes.push_back(uint8_t(n - 3));
                     }
                 } else {
                     // Simple case, compatible with PrusaSlicer 2.3.1 and older for storing paint on supports and seams.
                     // Store 2 bits of n.
-                    data.bitstream.push_back(n & 0b01);
-                    data.bitstream.push_back(n & 0b10);
+                    codes.push_back(uint8_t(n << 2));
                 }
             }
         }
-    } out { this };
+    };
 
-    out.data.triangles_to_split.reserve(m_orig_size_indices);
-    for (int i=0; i<m_orig_size_indices; ++i)
-        if (const Triangle& tr = m_triangles[i]; tr.is_split() || tr.get_state() != EnforcerBlockerType::NONE) {
-            // Store index of the first bit assigned to ith triangle.
-            out.data.triangles_to_split.emplace_back(i, int(out.data.bitstream.size()));
-            // out the triangle bits.
-            out.serialize(i);
+    struct Block {
+        std::vector<int>      roots;
+        // Index of the first code of each root in codes, with one extra item at the end.
+        std::vector<size_t>   root_code_start;
+        std::vector<uint64_t> root_hashes;
+        std::vector<uint8_t>  codes;
+        uint32_t              used_states { 0 };
+    };
+
+    constexpr int      block_size = 4096;
+    std::vector<Block> blocks((m_orig_size_indices + block_size - 1) / block_size);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, blocks.size()), [this, &blocks](const tbb::blocked_range<size_t> &range) {
+        for (size_t block_idx = range.begin(); block_idx < range.end(); ++ block_idx) {
+            Block     &block = blocks[block_idx];
+            Serializer out { this, block.codes, block.used_states };
+            for (int i = int(block_idx) * block_size; i < std::min(m_orig_size_indices, int(block_idx + 1) * block_size); ++ i)
+                if (const Triangle &tr = m_triangles[i]; tr.is_split() || tr.get_state() != EnforcerBlockerType::NONE) {
+                    block.roots.emplace_back(i);
+                    block.root_code_start.emplace_back(block.codes.size());
+                    out.serialize(i);
+                }
+            block.root_code_start.emplace_back(block.codes.size());
+            block.root_hashes.reserve(block.roots.size());
+            for (size_t root_idx = 0; root_idx < block.roots.size(); ++ root_idx)
+                block.root_hashes.emplace_back(TriangleSplittingData::root_hash(block.roots[root_idx], block.codes.data() + block.root_code_start[root_idx],
+                                                                                block.root_code_start[root_idx + 1] - block.root_code_start[root_idx]));
         }
+    });
+
+    TriangleSplittingData data;
+    size_t                num_roots = 0;
+    size_t                num_codes = 0;
+    for (const Block &block : blocks) {
+        num_roots += block.roots.size();
+        num_codes += block.codes.size();
+    }
 
     // May be stored onto Undo / Redo stack, thus conserve memory.
-    out.data.triangles_to_split.shrink_to_fit();
-    out.data.bitstream.shrink_to_fit();
-    return out.data;
+    data.triangles_to_split.reserve(num_roots);
+    std::vector<uint8_t> codes;
+    codes.reserve(num_codes);
+    uint32_t used_states = 0;
+    for (const Block &block : blocks) {
+        for (size_t root_idx = 0; root_idx < block.roots.size(); ++ root_idx) {
+            // Store index of the first bit assigned to ith triangle.
+            data.triangles_to_split.emplace_back(block.roots[root_idx], int(4 * (codes.size() + block.root_code_start[root_idx])));
+            data.append_root_hash(block.root_hashes[root_idx]);
+        }
+        codes.insert(codes.end(), block.codes.begin(), block.codes.end());
+        used_states |= block.used_states;
+    }
+
+    codes_to_bitstream(codes, data.bitstream);
+    for (size_t state_idx = 0; state_idx < data.used_states.size(); ++ state_idx)
+        data.used_states[state_idx] = (used_states >> state_idx) & 1;
+    return data;
 }
 
 void TriangleSelector::deserialize(const TriangleSplittingData &data,
@@ -1741,6 +1857,9 @@ void TriangleSelector::deserialize(const TriangleSplittingData &data,
     // Here the triangles count account for both the nodes and leaves, thus the following line may overestimate.
     m_vertices.reserve(std::max(m_mesh.its.vertices.size(), m_triangles.size() / 2));
 
+    // Unpack the bitstream into 4 bit codes in parallel, the trees are then rebuilt reading bytes instead of single bits.
+    const std::vector<uint8_t> codes = bitstream_to_codes(data.bitstream);
+
     // Vector to store all parents that have offsprings.
     struct ProcessingInfo {
         int facet_id = 0;
@@ -1754,12 +1873,9 @@ void TriangleSelector::deserialize(const TriangleSplittingData &data,
 
     for (auto [triangle_id, ibit] : data.triangles_to_split) {
         assert(triangle_id < int(m_triangles.size()));
-        assert(ibit < int(data.bitstream.size()));
-        auto next_nibble = [&data, &ibit = ibit]() {
-            int n = 0;
-            for (int i = 0; i < 4; ++ i)
-                n |= data.bitstream[ibit ++] << i;
-            return n;
+        assert(ibit < int(data.bitstream.size()) && ibit % 4 == 0);
+        auto next_nibble = [&codes, icode = size_t(ibit) / 4]() mutable {
+            return icode < codes.size() ? int(codes[icode ++]) : 0;
         };
 
         parents.clear();
@@ -262,13 +262,22 @@ public:
         std::vector<bool>                     bitstream;
         // Array indicating which triangle state types are used (encoded inside bitstream).
         std::vector<bool>                     used_states { std::vector<bool>(static_cast<size_t>(EnforcerBlockerType::ExtruderMax) + 1, false) };
+        // Stable hash of triangles_to_split and bitstream, folded root triangle by root triangle in the order of triangles_to_split.
+        // Kept up to date by whoever appends to the bitstream, so that equality tests do not need to compare the bitstreams.
+        uint64_t                              hash { hash_seed };
+
+        static constexpr uint64_t hash_seed = 0xcbf29ce484222325ull;
 
         TriangleSplittingData() = default;
 
+        // Differing hashes reject quickly, matching hashes are confirmed by comparing the data, as hashes may collide.
         friend bool operator==(const TriangleSplittingData &lhs, const TriangleSplittingData &rhs) {
-            return lhs.triangles_to_split == rhs.triangles_to_split
-                && lhs.bitstream          == rhs.bitstream
-                && lhs.used_states        == rhs.used_states;
+            return lhs.hash                      == rhs.hash
+                && lhs.triangles_to_split.size() == rhs.triangles_to_split.size()
+                && lhs.bitstream.size()          == rhs.bitstream.size()
+                && lhs.used_states               == rhs.used_states
+                && lhs.triangles_to_split        == rhs.triangles_to_split
+                && lhs.bitstream                 == rhs.bitstream;
         }
 
         friend bool operator!=(const TriangleSplittingData &lhs, const TriangleSplittingData &rhs) { return !(lhs == rhs); }
@@ -282,9 +291,17 @@ public:
         // Update used states based on the bitstream. It just iterated over the bitstream from the bitstream_start_idx till the end.
         void update_used_states(size_t bitstream_start_idx);
 
+        // Hash of a single root triangle, its bitstream passed as a sequence of 4 bit codes.
+        static uint64_t root_hash(int triangle_idx, const uint8_t *codes, size_t num_codes);
+        // Fold hash of the next root triangle into the hash of the whole data.
+        void append_root_hash(uint64_t root_hash);
+
+        // Clear the triangles and the bitstream, reset the hash.
+        void clear() { triangles_to_split.clear(); bitstream.clear(); hash = hash_seed; }
+
     private:
         friend class cereal::access;
-        template<class Archive> void serialize(Archive &ar) { ar(triangles_to_split, bitstream, used_states); }
+        template<class Archive> void serialize(Archive &ar) { ar(triangles_to_split, bitstream, used_states, hash); }
     };
 
     std::pair<std::vector<Vec3i32>, std::vector<Vec3i32>> precompute_all_neighbors() const;
@@ -517,6 +534,11 @@ private:
         std::vector<stl_triangle_vertex_indices>    &out_triangles) const;
     void get_facets_split_by_tjoints(const Vec3i32 &vertices, const Vec3i32 &neighbors, std::vector<stl_triangle_vertex_indices> &out_triangles) const;
 
+    // Indices of valid leaf triangles, in the order of m_triangles. Collected in parallel.
+    // If only_state < 0, one list for each EnforcerBlockerType is returned, otherwise a single list of triangles of only_state.
+    std::vector<std::vector<int>> collect_leaf_triangles(int only_state) const;
+    indexed_triangle_set          facets_from_triangles(const std::vector<int> &triangles) const;
+
     void get_seed_fill_contour_recursive(int facet_idx, const Vec3i32 &neighbors, const Vec3i32 &neighbors_propagated, std::vector<Vec2i32> &edges_out) const;
 
     int m_free_triangles_head { -1 };
@@ -51,6 +51,10 @@ public:
     /// This method throws exactly like finish_entry() does.
     void add_entry(const std::string& name, const void* data, size_t bytes);
 
+    /// Same as above, with the compression level overridden for this entry.
+    /// Already compressed data (PNG images) are better stored with NO_COMPRESSION.
+    void add_entry(const std::string& name, const void* data, size_t bytes, e_compression level);
+
     // Writing data to the archive works like with standard streams. The target
     // within the zip file is the entry created with the add_entry method.
 
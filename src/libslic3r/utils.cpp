@@ -1002,7 +1002,7 @@ bool is_idx_file(const boost::filesystem::directory_entry &dir_entry)
 //BBS: refine gcode appendix
 bool is_gcode_file(const std::string &path)
 {
-	return boost::iends_with(path, ".gcode"); // || boost::iends_with(path, ".g");
+	return boost::iends_with(path, ".gcode") || boost::iends_with(path, ".obgcode"); // || boost::iends_with(path, ".g");
 }
 
 //BBS: add json support
@@ -20,11 +20,13 @@
 #include "libslic3r/SLAPrint.hpp"
 #include "libslic3r/Utils.hpp"
 #include "libslic3r/GCode/PostProcessor.hpp"
+#include "libslic3r/GCode/BinaryGCode.hpp"
 #include "libslic3r/Format/SL1.hpp"
 #include "libslic3r/Thread.hpp"
 #include "libslic3r/libslic3r.h"
 
 #include <cassert>
+#include <cstring>
 #include <stdexcept>
 #include <cctype>
 
@@ -803,7 +805,7 @@ void BackgroundSlicingProcess::finalize_gcode()
 	// is calculated for the unprocessed G-code and it references lines in the memory mapped G-code file by line numbers.
 	// export_path may be changed by the post-processing script as well if the post processing script decides so, see GH #6042.
 	bool post_processed = run_post_process_scripts(output_path, true, "File", export_path, m_fff_print->full_print_config());
-	auto remove_post_processed_temp_file = [post_processed, &output_path]() {
+	auto remove_post_processed_temp_file = [&post_processed, &output_path]() {
 		if (post_processed)
 			try {
 				boost::filesystem::remove(output_path);
@@ -813,6 +815,20 @@ void BackgroundSlicingProcess::finalize_gcode()
 	};
     m_print->set_status(99, _utf8(L("Successfully executed post-processing script")));
 
+	// The binary G-code is converted from the post processed G-code, the G-code viewer keeps mapping the ASCII one.
+	if (m_fff_print->config().binary_gcode.value) {
+		std::string binary_path = output_path + BinaryGCode::FileExtension;
+		try {
+			BinaryGCode::convert_ascii_to_binary(output_path, binary_path);
+		} catch (const std::exception &ex) {
+			remove_post_processed_temp_file();
+			throw Slic3r::ExportError(GUI::format(_L("Conversion of the G-code to binary G-code failed.\nError message: %1%"), ex.what()));
+		}
+		remove_post_processed_temp_file();
+		output_path    = binary_path;
+		post_processed = true;
+	}
+
 	//FIXME localize the messages
 	std::string error_message;
 	int copy_ret_val = CopyFileResult::SUCCESS;
@@ -861,6 +877,27 @@ void BackgroundSlicingProcess::export_gcode()
 	std::string export_path = m_fff_print->print_statistics().finalize_output_path(m_export_path);
 	std::string output_path = m_temp_output_path;
 
+	// The line numbers are added to a copy of the G-code before it is converted to binary G-code.
+	const bool binary_gcode = m_fff_print->config().binary_gcode.value;
+	if (binary_gcode) {
+		std::string ascii_path  = m_temp_output_path + ".ascii";
+		std::string binary_path = m_temp_output_path + BinaryGCode::FileExtension;
+		std::string error_message;
+		try {
+			if (copy_file(m_temp_output_path, ascii_path, error_message) != SUCCESS)
+				throw Slic3r::RuntimeError(error_message);
+			gcode_add_line_number(ascii_path, m_fff_print->full_print_config());
+			BinaryGCode::convert_ascii_to_binary(ascii_path, binary_path);
+		} catch (const std::exception &ex) {
+			boost::system::error_code ec;
+			boost::filesystem::remove(ascii_path, ec);
+			throw Slic3r::ExportError((boost::format(_utf8(L("Conversion of the G-code to binary G-code failed.\nError message: %1%"))) % ex.what()).str());
+		}
+		boost::system::error_code ec;
+		boost::filesystem::remove(ascii_path, ec);
+		output_path = binary_path;
+	}
+
 	//FIXME localize the messages
 	std::string error_message;
 	int copy_ret_val = CopyFileResult::SUCCESS;
@@ -870,8 +907,16 @@ void BackgroundSlicingProcess::export_gcode()
 	}
 	catch (...)
 	{
+		if (binary_gcode) {
+			boost::system::error_code ec;
+			boost::filesystem::remove(output_path, ec);
+		}
 		throw Slic3r::ExportError(_utf8(L("Unknown error when exporting G-code.")));
 	}
+	if (binary_gcode) {
+		boost::system::error_code ec;
+		boost::filesystem::remove(output_path, ec);
+	}
 	switch (copy_ret_val) {
 	case CopyFileResult::SUCCESS: break; // no error
 	case CopyFileResult::FAIL_COPY_FILE:
@@ -903,7 +948,8 @@ void BackgroundSlicingProcess::export_gcode()
 	wxQueueEvent(GUI::wxGetApp().mainframe->m_plater, evt);
 
 	// BBS: to be checked. Whether use export_path or output_path.
-	gcode_add_line_number(export_path, m_fff_print->full_print_config());
+	if (!binary_gcode)
+		gcode_add_line_number(export_path, m_fff_print->full_print_config());
 
 }
 
@@ -935,6 +981,10 @@ void BackgroundSlicingProcess::prepare_upload()
                                              m_fff_print->full_print_config()))
 			    m_upload_job.upload_data.upload_path = output_name_str;
 			}
+            // The binary G-code is not read by the print hosts, the plain G-code is uploaded.
+            std::string upload_path = m_upload_job.upload_data.upload_path.string();
+            if (boost::iends_with(upload_path, BinaryGCode::FileExtension))
+                m_upload_job.upload_data.upload_path = upload_path.substr(0, upload_path.size() - strlen(BinaryGCode::FileExtension)) + ".gcode";
 		}
     } else {
         m_upload_job.upload_data.upload_path = m_sla_print->print_statistics().finalize_output_path(m_upload_job.upload_data.upload_path.string());
@@ -9,6 +9,7 @@
 #include "libslic3r/Utils.hpp"
 #include "libslic3r/LocalesUtils.hpp"
 #include "libslic3r/PresetBundle.hpp"
+#include "libslic3r/GCode/ToolpathLod.hpp"
 //BBS: add convex hull logic for toolpath check
 #include "libslic3r/Geometry/ConvexHull.hpp"
 
@@ -35,10 +36,12 @@
 #include <boost/nowide/fstream.hpp>
 #include <wx/progdlg.h>
 #include <wx/numformatter.h>
+#include <tbb/parallel_for.h>
 
 #include <array>
 #include <algorithm>
 #include <chrono>
+#include <limits>
 
 namespace Slic3r {
 namespace GUI {
@@ -218,6 +221,25 @@ void GCodeViewer::TBuffer::reset()
     paths.clear();
     render_paths.clear();
     model.reset();
+
+    for (Lod& lod : lods) {
+        lod.reset();
+    }
+    lods.clear();
+    lod_complement_render_paths.clear();
+}
+
+void GCodeViewer::TBuffer::Lod::reset()
+{
+    vertices.reset();
+    for (IBuffer& buffer : indices) {
+        buffer.reset();
+    }
+
+    indices.clear();
+    ranges.clear();
+    paths_first_range.clear();
+    render_paths.clear();
 }
 
 void GCodeViewer::TBuffer::add_path(const GCodeProcessorResult::MoveVertex& move, unsigned int b_id, size_t i_id, size_t s_id)
@@ -484,8 +506,8 @@ void GCodeViewer::SequentialView::Marker::render(int canvas_width, int canvas_he
 
 void GCodeViewer::SequentialView::GCodeWindow::load_gcode(const std::string& filename, const std::vector<size_t> &lines_ends)
 {
-    assert(! m_file.is_open());
-    if (m_file.is_open())
+    assert(! m_file.is_open() && ! m_binary);
+    if (m_file.is_open() || m_binary)
         return;
 
     m_filename   = filename;
@@ -496,8 +518,13 @@ void GCodeViewer::SequentialView::GCodeWindow::load_gcode(const std::string& fil
 
     try
     {
-        m_file.open(boost::filesystem::path(m_filename));
-        BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << ": mapping file " << m_filename;
+        if (BinaryGCode::is_binary_gcode_file(m_filename)) {
+            m_binary = std::make_unique<BinaryGCode::Reader>(m_filename);
+            BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << ": opened binary file " << m_filename;
+        } else {
+            m_file.open(boost::filesystem::path(m_filename));
+            BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << ": mapping file " << m_filename;
+        }
     }
     catch (...)
     {
@@ -519,7 +546,7 @@ void GCodeViewer::SequentialView::GCodeWindow::render(float top, float bottom, f
             const size_t start        = id == 1 ? 0 : m_lines_ends[id - 2];
             const size_t original_len = m_lines_ends[id - 1] - start;
             const size_t len          = std::min(original_len, (size_t) 55);
-            std::string  gline(m_file.data() + start, len);
+            std::string  gline = m_binary ? m_binary->read_text(start, len) : std::string(m_file.data() + start, len);
 
             // If original line is longer than 55 characters, truncate and append "..."
             if (original_len > 55)
@@ -676,6 +703,7 @@ void GCodeViewer::SequentialView::GCodeWindow::stop_mapping_file()
         m_file.close();
         BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << ": finished mapping file " << m_filename;
     }
+    m_binary.reset();
 }
 void GCodeViewer::SequentialView::render(const bool has_render_path, float legend_height, int canvas_width, int canvas_height, int right_margin, const EViewType& view_type)
 {
@@ -2069,7 +2097,8 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
     static const size_t IBUFFER_THRESHOLD_BYTES = 64 * 1024 * 1024;
 
     //BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(",build_volume center{%1%, %2%}, moves count %3%\n")%build_volume.bed_center().x() % build_volume.bed_center().y() %gcode_result.moves.size();
-    auto log_memory_usage = [this](const std::string& label, const std::vector<MultiVertexBuffer>& vertices, const std::vector<MultiIndexBuffer>& indices) {
+    // vertex and index buffers are released as soon as they are sent to gpu, so the peak of the cpu memory they use is logged
+    auto memory_usage = [](const std::vector<MultiVertexBuffer>& vertices, const std::vector<MultiIndexBuffer>& indices) {
         int64_t vertices_size = 0;
         for (const MultiVertexBuffer& buffers : vertices) {
             for (const VertexBuffer& buffer : buffers) {
@@ -2084,8 +2113,9 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
             }
             //BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format("indices count %1%\n")%buffers.size();
         }
-        log_memory_used(label, vertices_size + indices_size);
+        return vertices_size + indices_size;
     };
+    int64_t max_memory_usage = 0;
 
     // format data into the buffers to be rendered as lines
     auto add_vertices_as_line = [](const GCodeProcessorResult::MoveVertex& prev, const GCodeProcessorResult::MoveVertex& curr, VertexBuffer& vertices) {
@@ -2491,100 +2521,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
     size_t seams_count = 0;
     std::vector<size_t> biased_seams_ids;
 
-    // toolpaths data -> extract vertices from result
     for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessorResult::MoveVertex& curr = gcode_result.moves[i];
-        if (curr.type == EMoveType::Seam) {
-            ++seams_count;
+        if (gcode_result.moves[i].type == EMoveType::Seam)
             biased_seams_ids.push_back(i - biased_seams_ids.size() - 1);
-        }
-
-        size_t move_id = i - seams_count;
-
-        // skip first vertex
-        if (i == 0)
-            continue;
-
-        const GCodeProcessorResult::MoveVertex& prev = gcode_result.moves[i - 1];
-
-        // update progress dialog
-        ++progress_count;
-        if (progress_dialog != nullptr && progress_count % progress_threshold == 0) {
-            progress_dialog->Update(int(100.0f * float(i) / (2.0f * float(m_moves_count))),
-                _L("Generating geometry vertex data") + ": " + wxNumberFormatter::ToString(100.0 * double(i) / double(m_moves_count), 0, wxNumberFormatter::Style_None) + "%");
-            progress_dialog->Fit();
-            progress_count = 0;
-        }
-
-        const unsigned char id = buffer_id(curr.type);
-        TBuffer& t_buffer = m_buffers[id];
-        MultiVertexBuffer& v_multibuffer = vertices[id];
-        InstanceBuffer& inst_buffer = instances[id];
-        InstanceIdBuffer& inst_id_buffer = instances_ids[id];
-        InstancesOffsets& inst_offsets = instances_offsets[id];
-
-        /*if (i%1000 == 1) {
-            BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":i=%1%, buffer_id %2% render_type %3%, gcode_id %4%\n")
-                %i %(int)id %(int)t_buffer.render_primitive_type %curr.gcode_id;
-        }*/
-
-        // ensure there is at least one vertex buffer
-        if (v_multibuffer.empty())
-            v_multibuffer.push_back(VertexBuffer());
-
-        // if adding the vertices for the current segment exceeds the threshold size of the current vertex buffer
-        // add another vertex buffer
-        // BBS: get the point number and then judge whether the remaining buffer is enough
-        size_t points_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points.size() + 1 : 1;
-        size_t vertices_size_to_add = (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel) ? t_buffer.model.data.vertices_size_bytes() : points_num * t_buffer.max_vertices_per_segment_size_bytes();
-        if (v_multibuffer.back().size() * sizeof(float) > t_buffer.vertices.max_size_bytes() - vertices_size_to_add) {
-            v_multibuffer.push_back(VertexBuffer());
-            if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle) {
-                Path& last_path = t_buffer.paths.back();
-                if (prev.type == curr.type && last_path.matches(curr))
-                    last_path.add_sub_path(prev, static_cast<unsigned int>(v_multibuffer.size()) - 1, 0, move_id - 1);
-            }
-        }
-
-        VertexBuffer& v_buffer = v_multibuffer.back();
-
-        switch (t_buffer.render_primitive_type)
-        {
-        case TBuffer::ERenderPrimitiveType::Line:     { add_vertices_as_line(prev, curr, v_buffer); break; }
-        case TBuffer::ERenderPrimitiveType::Triangle: { add_vertices_as_solid(prev, curr, t_buffer, static_cast<unsigned int>(v_multibuffer.size()) - 1, v_buffer, move_id); break; }
-        case TBuffer::ERenderPrimitiveType::InstancedModel:
-        {
-            add_model_instance(curr, inst_buffer, inst_id_buffer, move_id);
-            inst_offsets.push_back(prev.position - curr.position);
-#if ENABLE_GCODE_VIEWER_STATISTICS
-            ++m_statistics.instances_count;
-#endif // ENABLE_GCODE_VIEWER_STATISTICS
-            break;
-        }
-        case TBuffer::ERenderPrimitiveType::BatchedModel:
-        {
-            add_vertices_as_model_batch(curr, t_buffer.model.data, v_buffer, inst_buffer, inst_id_buffer, move_id);
-            inst_offsets.push_back(prev.position - curr.position);
-#if ENABLE_GCODE_VIEWER_STATISTICS
-            ++m_statistics.batched_count;
-#endif // ENABLE_GCODE_VIEWER_STATISTICS
-            break;
-        }
-        }
-
-        // collect options zs for later use
-        if (curr.type == EMoveType::Pause_Print || curr.type == EMoveType::Custom_GCode) {
-            const float* const last_z = options_zs.empty() ? nullptr : &options_zs.back();
-            if (last_z == nullptr || curr.position[2] < *last_z - EPSILON || *last_z + EPSILON < curr.position[2])
-                options_zs.emplace_back(curr.position[2]);
-        }
     }
 
-    /*for (size_t b = 0; b < vertices.size(); ++b) {
-        MultiVertexBuffer& v_multibuffer = vertices[b];
-        BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":b=%1%, vertex buffer count %2%\n")
-            %b %v_multibuffer.size();
-    }*/
     auto extract_move_id = [&biased_seams_ids](size_t id) {
         size_t new_id = size_t(-1);
         auto it = std::lower_bound(biased_seams_ids.begin(), biased_seams_ids.end(), id);
@@ -2599,13 +2540,14 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         return (new_id == size_t(-1)) ? id : new_id;
     };
     //BBS: generate map from ssid to move id in advance to reduce computation
+    //the corners of the paths are smoothed while extracting the vertices, so the map is needed from the beginning
     m_ssid_to_moveid_map.clear();
     m_ssid_to_moveid_map.reserve( m_moves_count - biased_seams_ids.size());
     for (size_t i = 0; i < m_moves_count - biased_seams_ids.size(); i++)
         m_ssid_to_moveid_map.push_back(extract_move_id(i));
 
-    //BBS: smooth toolpaths corners for the given TBuffer using triangles
-    auto smooth_triangle_toolpaths_corners = [&gcode_result, this](const TBuffer& t_buffer, MultiVertexBuffer& v_multibuffer) {
+    //BBS: smooth toolpaths corners for the given path of a TBuffer using triangles
+    auto smooth_triangle_toolpath_corners = [&gcode_result, this](const TBuffer& t_buffer, const Path& path, MultiVertexBuffer& v_multibuffer) {
         auto extract_position_at = [](const VertexBuffer& vertices, size_t offset) {
             return Vec3f(vertices[offset + 0], vertices[offset + 1], vertices[offset + 2]);
         };
@@ -2699,130 +2641,264 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         };
 
         size_t vertex_size_floats = t_buffer.vertices.vertex_size_floats();
-        for (const Path& path : t_buffer.paths) {
-            //BBS: the two segments of the path sharing the current vertex may belong
-            //to two different vertex buffers
-            size_t prev_sub_path_id = 0;
-            size_t next_sub_path_id = 0;
-            const size_t path_vertices_count = path.vertices_count();
-            const float half_width = 0.5f * path.width;
-            // BBS: modify a lot to support arc move which has internal points
-            for (size_t j = 1; j < path_vertices_count; ++j) {
-                size_t curr_s_id = path.sub_paths.front().first.s_id + j;
-                size_t move_id = m_ssid_to_moveid_map[curr_s_id];
-                int interpolation_points_num = gcode_result.moves[move_id].is_arc_move_with_interpolation_points()?
-                                                    gcode_result.moves[move_id].interpolation_points.size() : 0;
-                int loop_num = interpolation_points_num;
-                //BBS: select the subpaths which contains the previous/next segments
-                if (!path.sub_paths[prev_sub_path_id].contains(curr_s_id))
-                    ++prev_sub_path_id;
-                if (j == path_vertices_count - 1) {
-                    if (!gcode_result.moves[move_id].is_arc_move_with_interpolation_points())
-                        break;   // BBS: the last move has no internal point.
-                    loop_num--;  //BBS: don't need to handle the endpoint of the last arc move of path
-                    next_sub_path_id = prev_sub_path_id;
-                } else {
-                    if (!path.sub_paths[next_sub_path_id].contains(curr_s_id + 1))
-                        ++next_sub_path_id;
+        //BBS: the two segments of the path sharing the current vertex may belong
+        //to two different vertex buffers
+        size_t prev_sub_path_id = 0;
+        size_t next_sub_path_id = 0;
+        const size_t path_vertices_count = path.vertices_count();
+        const float half_width = 0.5f * path.width;
+        // BBS: modify a lot to support arc move which has internal points
+        for (size_t j = 1; j < path_vertices_count; ++j) {
+            size_t curr_s_id = path.sub_paths.front().first.s_id + j;
+            size_t move_id = m_ssid_to_moveid_map[curr_s_id];
+            int interpolation_points_num = gcode_result.moves[move_id].is_arc_move_with_interpolation_points()?
+                                                gcode_result.moves[move_id].interpolation_points.size() : 0;
+            int loop_num = interpolation_points_num;
+            //BBS: select the subpaths which contains the previous/next segments
+            if (!path.sub_paths[prev_sub_path_id].contains(curr_s_id))
+                ++prev_sub_path_id;
+            if (j == path_vertices_count - 1) {
+                if (!gcode_result.moves[move_id].is_arc_move_with_interpolation_points())
+                    break;   // BBS: the last move has no internal point.
+                loop_num--;  //BBS: don't need to handle the endpoint of the last arc move of path
+                next_sub_path_id = prev_sub_path_id;
+            } else {
+                if (!path.sub_paths[next_sub_path_id].contains(curr_s_id + 1))
+                    ++next_sub_path_id;
+            }
+            const Path::Sub_Path& prev_sub_path = path.sub_paths[prev_sub_path_id];
+            const Path::Sub_Path& next_sub_path = path.sub_paths[next_sub_path_id];
+
+            // BBS: smooth triangle toolpaths corners including arc move which has internal interpolation point
+            for (int k = 0; k <= loop_num; k++) {
+                const Vec3f& prev = k==0?
+                                    gcode_result.moves[move_id - 1].position :
+                                    gcode_result.moves[move_id].interpolation_points[k-1];
+                const Vec3f& curr = k==interpolation_points_num?
+                                    gcode_result.moves[move_id].position :
+                                    gcode_result.moves[move_id].interpolation_points[k];
+                const Vec3f& next = k < interpolation_points_num - 1?
+                                    gcode_result.moves[move_id].interpolation_points[k+1]:
+                                    (k == interpolation_points_num - 1? gcode_result.moves[move_id].position :
+                                    (gcode_result.moves[move_id + 1].is_arc_move_with_interpolation_points()?
+                                    gcode_result.moves[move_id + 1].interpolation_points[0] :
+                                    gcode_result.moves[move_id + 1].position));
+
+                const Vec3f prev_dir = (curr - prev).normalized();
+                const Vec3f prev_right = Vec3f(prev_dir.y(), -prev_dir.x(), 0.0f).normalized();
+                const Vec3f prev_up = prev_right.cross(prev_dir);
+
+                const Vec3f next_dir = (next - curr).normalized();
+
+                const bool is_right_turn = prev_up.dot(prev_dir.cross(next_dir)) <= 0.0f;
+                const float cos_dir = prev_dir.dot(next_dir);
+                // whether the angle between adjacent segments is greater than 45 degrees
+                const bool is_sharp = cos_dir < 0.7071068f;
+
+                float displacement = 0.0f;
+                if (cos_dir > -0.9998477f) {
+                    // if the angle between adjacent segments is smaller than 179 degrees
+                    Vec3f med_dir = (prev_dir + next_dir).normalized();
+                    displacement = half_width * ::tan(::acos(std::clamp(next_dir.dot(med_dir), -1.0f, 1.0f)));
                 }
-                const Path::Sub_Path& prev_sub_path = path.sub_paths[prev_sub_path_id];
-                const Path::Sub_Path& next_sub_path = path.sub_paths[next_sub_path_id];
-
-                // BBS: smooth triangle toolpaths corners including arc move which has internal interpolation point
-                for (int k = 0; k <= loop_num; k++) {
-                    const Vec3f& prev = k==0?
-                                        gcode_result.moves[move_id - 1].position :
-                                        gcode_result.moves[move_id].interpolation_points[k-1];
-                    const Vec3f& curr = k==interpolation_points_num?
-                                        gcode_result.moves[move_id].position :
-                                        gcode_result.moves[move_id].interpolation_points[k];
-                    const Vec3f& next = k < interpolation_points_num - 1?
-                                        gcode_result.moves[move_id].interpolation_points[k+1]:
-                                        (k == interpolation_points_num - 1? gcode_result.moves[move_id].position :
-                                        (gcode_result.moves[move_id + 1].is_arc_move_with_interpolation_points()?
-                                        gcode_result.moves[move_id + 1].interpolation_points[0] :
-                                        gcode_result.moves[move_id + 1].position));
-
-                    const Vec3f prev_dir = (curr - prev).normalized();
-                    const Vec3f prev_right = Vec3f(prev_dir.y(), -prev_dir.x(), 0.0f).normalized();
-                    const Vec3f prev_up = prev_right.cross(prev_dir);
-
-                    const Vec3f next_dir = (next - curr).normalized();
-
-                    const bool is_right_turn = prev_up.dot(prev_dir.cross(next_dir)) <= 0.0f;
-                    const float cos_dir = prev_dir.dot(next_dir);
-                    // whether the angle between adjacent segments is greater than 45 degrees
-                    const bool is_sharp = cos_dir < 0.7071068f;
-
-                    float displacement = 0.0f;
-                    if (cos_dir > -0.9998477f) {
-                        // if the angle between adjacent segments is smaller than 179 degrees
-                        Vec3f med_dir = (prev_dir + next_dir).normalized();
-                        displacement = half_width * ::tan(::acos(std::clamp(next_dir.dot(med_dir), -1.0f, 1.0f)));
-                    }
 
-                    const float sq_prev_length = (curr - prev).squaredNorm();
-                    const float sq_next_length = (next - curr).squaredNorm();
-                    const float sq_displacement = sqr(displacement);
-                    const bool can_displace = displacement > 0.0f && sq_displacement < sq_prev_length&& sq_displacement < sq_next_length;
-                    bool is_internal_point = interpolation_points_num > k;
+                const float sq_prev_length = (curr - prev).squaredNorm();
+                const float sq_next_length = (next - curr).squaredNorm();
+                const float sq_displacement = sqr(displacement);
+                const bool can_displace = displacement > 0.0f && sq_displacement < sq_prev_length&& sq_displacement < sq_next_length;
+                bool is_internal_point = interpolation_points_num > k;
+
+                if (can_displace) {
+                    // displacement to apply to the vertices to match
+                    Vec3f displacement_vec = displacement * prev_dir;
+                    // matches inner corner vertices
+                    if (is_right_turn)
+                        match_right_vertices_with_internal_point(prev_sub_path, next_sub_path, curr_s_id, is_internal_point, k, vertex_size_floats, -displacement_vec);
+                    else
+                        match_left_vertices_with_internal_point(prev_sub_path, next_sub_path, curr_s_id, is_internal_point, k, vertex_size_floats, -displacement_vec);
 
-                    if (can_displace) {
-                        // displacement to apply to the vertices to match
-                        Vec3f displacement_vec = displacement * prev_dir;
-                        // matches inner corner vertices
+                    if (!is_sharp) {
+                        //BBS: matches outer corner vertices
                         if (is_right_turn)
-                            match_right_vertices_with_internal_point(prev_sub_path, next_sub_path, curr_s_id, is_internal_point, k, vertex_size_floats, -displacement_vec);
+                            match_left_vertices_with_internal_point(prev_sub_path, next_sub_path, curr_s_id, is_internal_point, k, vertex_size_floats, displacement_vec);
                         else
-                            match_left_vertices_with_internal_point(prev_sub_path, next_sub_path, curr_s_id, is_internal_point, k, vertex_size_floats, -displacement_vec);
-
-                        if (!is_sharp) {
-                            //BBS: matches outer corner vertices
-                            if (is_right_turn)
-                                match_left_vertices_with_internal_point(prev_sub_path, next_sub_path, curr_s_id, is_internal_point, k, vertex_size_floats, displacement_vec);
-                            else
-                                match_right_vertices_with_internal_point(prev_sub_path, next_sub_path, curr_s_id, is_internal_point, k, vertex_size_floats, displacement_vec);
-                        }
+                            match_right_vertices_with_internal_point(prev_sub_path, next_sub_path, curr_s_id, is_internal_point, k, vertex_size_floats, displacement_vec);
                     }
                 }
             }
         }
     };
 
+    // The vertices data of a TBuffer are sent to gpu and released as soon as they are final, so that only the vertex buffers
+    // of the paths still being extracted are kept in memory.
+    // Count of vertex buffers already sent to gpu, for each TBuffer
+    std::vector<size_t> sent_vertices_count(m_buffers.size(), 0);
+    auto send_vertices_to_gpu = [&](size_t tbuffer_id, size_t buffers_count) {
+        TBuffer& t_buffer = m_buffers[tbuffer_id];
+        if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::InstancedModel || sent_vertices_count[tbuffer_id] >= buffers_count)
+            return;
+
+        max_memory_usage = std::max(max_memory_usage, memory_usage(vertices, indices));
+        MultiVertexBuffer& v_multibuffer = vertices[tbuffer_id];
+        for (size_t& i = sent_vertices_count[tbuffer_id]; i < buffers_count; ++i) {
+            VertexBuffer& v_buffer = v_multibuffer[i];
+            if (tbuffer_id == buffer_id(EMoveType::Wipe)) {
+                // move the wipe toolpaths half height up to render them on proper position
+                for (size_t j = 2; j < v_buffer.size(); j += 3) {
+                    v_buffer[j] += 0.5f * GCodeProcessor::Wipe_Height;
+                }
+            }
+
+            const size_t size_elements = v_buffer.size();
+            const size_t size_bytes = size_elements * sizeof(float);
+            const size_t vertices_count = size_elements / t_buffer.vertices.vertex_size_floats();
+            t_buffer.vertices.count += vertices_count;
+
 #if ENABLE_GCODE_VIEWER_STATISTICS
-    auto load_vertices_time = std::chrono::high_resolution_clock::now();
-    m_statistics.load_vertices = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
+            m_statistics.total_vertices_gpu_size += static_cast<int64_t>(size_bytes);
+            m_statistics.max_vbuffer_gpu_size = std::max(m_statistics.max_vbuffer_gpu_size, static_cast<int64_t>(size_bytes));
+            ++m_statistics.vbuffers_count;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 
-    // smooth toolpaths corners for TBuffers using triangles
-    for (size_t i = 0; i < m_buffers.size(); ++i) {
-        const TBuffer& t_buffer = m_buffers[i];
-        if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle) {
-            smooth_triangle_toolpaths_corners(t_buffer, vertices[i]);
+            GLuint id = 0;
+            glsafe(::glGenBuffers(1, &id));
+            glsafe(::glBindBuffer(GL_ARRAY_BUFFER, id));
+            glsafe(::glBufferData(GL_ARRAY_BUFFER, size_bytes, v_buffer.data(), GL_STATIC_DRAW));
+            glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
+
+            t_buffer.vertices.vbos.push_back(static_cast<unsigned int>(id));
+            t_buffer.vertices.sizes.push_back(size_bytes);
+
+            // dismiss, no more needed
+            VertexBuffer().swap(v_buffer);
         }
-    }
+    };
 
-    // dismiss, no more needed
-    std::vector<size_t>().swap(biased_seams_ids);
+    // Count of paths whose corners have been already smoothed, for each TBuffer using triangles
+    std::vector<size_t> smoothed_paths_count(m_buffers.size(), 0);
+
+    // toolpaths data -> extract vertices from result
+    for (size_t i = 0; i < m_moves_count; ++i) {
+        const GCodeProcessorResult::MoveVertex& curr = gcode_result.moves[i];
+        if (curr.type == EMoveType::Seam)
+            ++seams_count;
+
+        size_t move_id = i - seams_count;
 
-    for (MultiVertexBuffer& v_multibuffer : vertices) {
-        for (VertexBuffer& v_buffer : v_multibuffer) {
-            v_buffer.shrink_to_fit();
+        // skip first vertex
+        if (i == 0)
+            continue;
+
+        const GCodeProcessorResult::MoveVertex& prev = gcode_result.moves[i - 1];
+
+        // update progress dialog
+        ++progress_count;
+        if (progress_dialog != nullptr && progress_count % progress_threshold == 0) {
+            progress_dialog->Update(int(100.0f * float(i) / (2.0f * float(m_moves_count))),
+                _L("Generating geometry vertex data") + ": " + wxNumberFormatter::ToString(100.0 * double(i) / double(m_moves_count), 0, wxNumberFormatter::Style_None) + "%");
+            progress_dialog->Fit();
+            progress_count = 0;
         }
-    }
 
-    // move the wipe toolpaths half height up to render them on proper position
-    MultiVertexBuffer& wipe_vertices = vertices[buffer_id(EMoveType::Wipe)];
-    for (VertexBuffer& v_buffer : wipe_vertices) {
-        for (size_t i = 2; i < v_buffer.size(); i += 3) {
-            v_buffer[i] += 0.5f * GCodeProcessor::Wipe_Height;
+        const unsigned char id = buffer_id(curr.type);
+        TBuffer& t_buffer = m_buffers[id];
+        MultiVertexBuffer& v_multibuffer = vertices[id];
+        InstanceBuffer& inst_buffer = instances[id];
+        InstanceIdBuffer& inst_id_buffer = instances_ids[id];
+        InstancesOffsets& inst_offsets = instances_offsets[id];
+
+        /*if (i%1000 == 1) {
+            BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":i=%1%, buffer_id %2% render_type %3%, gcode_id %4%\n")
+                %i %(int)id %(int)t_buffer.render_primitive_type %curr.gcode_id;
+        }*/
+
+        // ensure there is at least one vertex buffer
+        if (v_multibuffer.empty())
+            v_multibuffer.push_back(VertexBuffer());
+
+        // if adding the vertices for the current segment exceeds the threshold size of the current vertex buffer
+        // add another vertex buffer
+        // BBS: get the point number and then judge whether the remaining buffer is enough
+        size_t points_num = curr.is_arc_move_with_interpolation_points() ? curr.interpolation_points.size() + 1 : 1;
+        size_t vertices_size_to_add = (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel) ? t_buffer.model.data.vertices_size_bytes() : points_num * t_buffer.max_vertices_per_segment_size_bytes();
+        if (v_multibuffer.back().size() * sizeof(float) > t_buffer.vertices.max_size_bytes() - vertices_size_to_add) {
+            v_multibuffer.push_back(VertexBuffer());
+            if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle) {
+                Path& last_path = t_buffer.paths.back();
+                if (prev.type == curr.type && last_path.matches(curr))
+                    last_path.add_sub_path(prev, static_cast<unsigned int>(v_multibuffer.size()) - 1, 0, move_id - 1);
+            }
+        }
+
+        VertexBuffer& v_buffer = v_multibuffer.back();
+
+        switch (t_buffer.render_primitive_type)
+        {
+        case TBuffer::ERenderPrimitiveType::Line:     { add_vertices_as_line(prev, curr, v_buffer); break; }
+        case TBuffer::ERenderPrimitiveType::Triangle: { add_vertices_as_solid(prev, curr, t_buffer, static_cast<unsigned int>(v_multibuffer.size()) - 1, v_buffer, move_id); break; }
+        case TBuffer::ERenderPrimitiveType::InstancedModel:
+        {
+            add_model_instance(curr, inst_buffer, inst_id_buffer, move_id);
+            inst_offsets.push_back(prev.position - curr.position);
+#if ENABLE_GCODE_VIEWER_STATISTICS
+            ++m_statistics.instances_count;
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+            break;
+        }
+        case TBuffer::ERenderPrimitiveType::BatchedModel:
+        {
+            add_vertices_as_model_batch(curr, t_buffer.model.data, v_buffer, inst_buffer, inst_id_buffer, move_id);
+            inst_offsets.push_back(prev.position - curr.position);
+#if ENABLE_GCODE_VIEWER_STATISTICS
+            ++m_statistics.batched_count;
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+            break;
+        }
+        }
+
+        if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle) {
+            // all the paths but the last one are complete, so their corners can be smoothed
+            // and the vertex buffers preceding the last path will not change anymore
+            for (size_t& j = smoothed_paths_count[id]; j + 1 < t_buffer.paths.size(); ++j) {
+                smooth_triangle_toolpath_corners(t_buffer, t_buffer.paths[j], v_multibuffer);
+            }
+            if (!t_buffer.paths.empty())
+                send_vertices_to_gpu(id, t_buffer.paths.back().sub_paths.front().first.b_id);
+        }
+        else
+            send_vertices_to_gpu(id, v_multibuffer.size() - 1);
+
+        // collect options zs for later use
+        if (curr.type == EMoveType::Pause_Print || curr.type == EMoveType::Custom_GCode) {
+            const float* const last_z = options_zs.empty() ? nullptr : &options_zs.back();
+            if (last_z == nullptr || curr.position[2] < *last_z - EPSILON || *last_z + EPSILON < curr.position[2])
+                options_zs.emplace_back(curr.position[2]);
         }
     }
 
-    // send vertices data to gpu, where needed
+    /*for (size_t b = 0; b < vertices.size(); ++b) {
+        MultiVertexBuffer& v_multibuffer = vertices[b];
+        BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":b=%1%, vertex buffer count %2%\n")
+            %b %v_multibuffer.size();
+    }*/
+
+#if ENABLE_GCODE_VIEWER_STATISTICS
+    auto load_vertices_time = std::chrono::high_resolution_clock::now();
+    m_statistics.load_vertices = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+
+    // smooth the corners of the last paths of TBuffers using triangles and send the remaining vertices data to gpu, where needed
     for (size_t i = 0; i < m_buffers.size(); ++i) {
         TBuffer& t_buffer = m_buffers[i];
-        if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::InstancedModel) {
+        if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle) {
+            for (size_t& j = smoothed_paths_count[i]; j < t_buffer.paths.size(); ++j) {
+                smooth_triangle_toolpath_corners(t_buffer, t_buffer.paths[j], vertices[i]);
+            }
+        }
+        send_vertices_to_gpu(i, vertices[i].size());
+
+        if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::InstancedModel ||
+            t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel) {
             const InstanceBuffer& inst_buffer = instances[i];
             if (!inst_buffer.empty()) {
                 t_buffer.model.instances.buffer = inst_buffer;
@@ -2830,45 +2906,16 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
                 t_buffer.model.instances.offsets = instances_offsets[i];
             }
         }
-        else {
-            if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::BatchedModel) {
-                const InstanceBuffer& inst_buffer = instances[i];
-                if (!inst_buffer.empty()) {
-                    t_buffer.model.instances.buffer = inst_buffer;
-                    t_buffer.model.instances.s_ids = instances_ids[i];
-                    t_buffer.model.instances.offsets = instances_offsets[i];
-                }
-            }
-            const MultiVertexBuffer& v_multibuffer = vertices[i];
-            for (const VertexBuffer& v_buffer : v_multibuffer) {
-                const size_t size_elements = v_buffer.size();
-                const size_t size_bytes = size_elements * sizeof(float);
-                const size_t vertices_count = size_elements / t_buffer.vertices.vertex_size_floats();
-                t_buffer.vertices.count += vertices_count;
-
-#if ENABLE_GCODE_VIEWER_STATISTICS
-                m_statistics.total_vertices_gpu_size += static_cast<int64_t>(size_bytes);
-                m_statistics.max_vbuffer_gpu_size = std::max(m_statistics.max_vbuffer_gpu_size, static_cast<int64_t>(size_bytes));
-                ++m_statistics.vbuffers_count;
-#endif // ENABLE_GCODE_VIEWER_STATISTICS
-
-                GLuint id = 0;
-                glsafe(::glGenBuffers(1, &id));
-                glsafe(::glBindBuffer(GL_ARRAY_BUFFER, id));
-                glsafe(::glBufferData(GL_ARRAY_BUFFER, size_bytes, v_buffer.data(), GL_STATIC_DRAW));
-                glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
-
-                t_buffer.vertices.vbos.push_back(static_cast<unsigned int>(id));
-                t_buffer.vertices.sizes.push_back(size_bytes);
-            }
-        }
     }
 
+    // dismiss, no more needed
+    std::vector<size_t>().swap(biased_seams_ids);
+
 #if ENABLE_GCODE_VIEWER_STATISTICS
     auto smooth_vertices_time = std::chrono::high_resolution_clock::now();
     m_statistics.smooth_vertices = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - load_vertices_time).count();
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
-    log_memory_usage("Loaded G-code generated vertex buffers ", vertices, indices);
+    log_memory_used("Loaded G-code generated vertex buffers, peak ", max_memory_usage);
 
     // dismiss vertices data, no more needed
     std::vector<MultiVertexBuffer>().swap(vertices);
@@ -2890,6 +2937,44 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
     using VboIndexList = std::vector<unsigned int>;
     std::vector<VboIndexList> vbo_indices(m_buffers.size());
 
+    // As the vertices data, the indices data of a TBuffer are sent to gpu and released as soon as they are final.
+    // Count of index buffers already sent to gpu, for each TBuffer
+    std::vector<size_t> sent_indices_count(m_buffers.size(), 0);
+    max_memory_usage = 0;
+    auto send_indices_to_gpu = [&](size_t tbuffer_id, size_t buffers_count) {
+        TBuffer& t_buffer = m_buffers[tbuffer_id];
+        if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::InstancedModel || sent_indices_count[tbuffer_id] >= buffers_count)
+            return;
+
+        max_memory_usage = std::max(max_memory_usage, memory_usage(vertices, indices));
+        MultiIndexBuffer& i_multibuffer = indices[tbuffer_id];
+        for (size_t& i = sent_indices_count[tbuffer_id]; i < buffers_count; ++i) {
+            IndexBuffer& i_buffer = i_multibuffer[i];
+            const size_t size_elements = i_buffer.size();
+            const size_t size_bytes = size_elements * sizeof(IBufferType);
+
+            // stores index buffer informations into TBuffer
+            t_buffer.indices.push_back(IBuffer());
+            IBuffer& ibuf = t_buffer.indices.back();
+            ibuf.count = size_elements;
+            ibuf.vbo = vbo_indices[tbuffer_id][i];
+
+#if ENABLE_GCODE_VIEWER_STATISTICS
+            m_statistics.total_indices_gpu_size += static_cast<int64_t>(size_bytes);
+            m_statistics.max_ibuffer_gpu_size = std::max(m_statistics.max_ibuffer_gpu_size, static_cast<int64_t>(size_bytes));
+            ++m_statistics.ibuffers_count;
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+
+            glsafe(::glGenBuffers(1, &ibuf.ibo));
+            glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibuf.ibo));
+            glsafe(::glBufferData(GL_ELEMENT_ARRAY_BUFFER, size_bytes, i_buffer.data(), GL_STATIC_DRAW));
+            glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+
+            // dismiss, no more needed
+            IndexBuffer().swap(i_buffer);
+        }
+    };
+
     seams_count = 0;
 
     for (size_t i = 0; i < m_moves_count; ++i) {
@@ -2937,6 +3022,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         if (i_multibuffer.back().size() * sizeof(IBufferType) >= IBUFFER_THRESHOLD_BYTES - indiced_size_to_add) {
             i_multibuffer.push_back(IndexBuffer());
             vbo_index_list.push_back(t_buffer.vertices.vbos[curr_vertex_buffer.first]);
+            send_indices_to_gpu(id, i_multibuffer.size() - 1);
             if (t_buffer.render_primitive_type != TBuffer::ERenderPrimitiveType::BatchedModel) {
                 Path& last_path = t_buffer.paths.back();
                 last_path.add_sub_path(prev, static_cast<unsigned int>(i_multibuffer.size()) - 1, 0, move_id - 1);
@@ -2953,6 +3039,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
             ++curr_vertex_buffer.first;
             curr_vertex_buffer.second = 0;
             vbo_index_list.push_back(t_buffer.vertices.vbos[curr_vertex_buffer.first]);
+            send_indices_to_gpu(id, i_multibuffer.size() - 1);
 
             if (t_buffer.render_primitive_type != TBuffer::ERenderPrimitiveType::BatchedModel) {
                 Path& last_path = t_buffer.paths.back();
@@ -2981,39 +3068,9 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         }
     }
 
-    for (MultiIndexBuffer& i_multibuffer : indices) {
-        for (IndexBuffer& i_buffer : i_multibuffer) {
-            i_buffer.shrink_to_fit();
-        }
-    }
-
-    // toolpaths data -> send indices data to gpu
+    // toolpaths data -> send the remaining indices data to gpu
     for (size_t i = 0; i < m_buffers.size(); ++i) {
-        TBuffer& t_buffer = m_buffers[i];
-        if (t_buffer.render_primitive_type != TBuffer::ERenderPrimitiveType::InstancedModel) {
-            const MultiIndexBuffer& i_multibuffer = indices[i];
-            for (const IndexBuffer& i_buffer : i_multibuffer) {
-                const size_t size_elements = i_buffer.size();
-                const size_t size_bytes = size_elements * sizeof(IBufferType);
-
-                // stores index buffer informations into TBuffer
-                t_buffer.indices.push_back(IBuffer());
-                IBuffer& ibuf = t_buffer.indices.back();
-                ibuf.count = size_elements;
-                ibuf.vbo = vbo_indices[i][t_buffer.indices.size() - 1];
-
-#if ENABLE_GCODE_VIEWER_STATISTICS
-                m_statistics.total_indices_gpu_size += static_cast<int64_t>(size_bytes);
-                m_statistics.max_ibuffer_gpu_size = std::max(m_statistics.max_ibuffer_gpu_size, static_cast<int64_t>(size_bytes));
-                ++m_statistics.ibuffers_count;
-#endif // ENABLE_GCODE_VIEWER_STATISTICS
-
-                glsafe(::glGenBuffers(1, &ibuf.ibo));
-                glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibuf.ibo));
-                glsafe(::glBufferData(GL_ELEMENT_ARRAY_BUFFER, size_bytes, i_buffer.data(), GL_STATIC_DRAW));
-                glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
-            }
-        }
+        send_indices_to_gpu(i, indices[i].size());
     }
 
     if (progress_dialog != nullptr) {
@@ -3028,12 +3085,11 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
 
     auto update_segments_count = [&](EMoveType type, int64_t& count) {
         unsigned int id = buffer_id(type);
-        const MultiIndexBuffer& buffers = indices[id];
+        const TBuffer& t_buffer = m_buffers[id];
         int64_t indices_count = 0;
-        for (const IndexBuffer& buffer : buffers) {
-            indices_count += buffer.size();
+        for (const IBuffer& buffer : t_buffer.indices) {
+            indices_count += buffer.count;
         }
-        const TBuffer& t_buffer = m_buffers[id];
         if (t_buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle)
             indices_count -= static_cast<int64_t>(12 * t_buffer.paths.size()); // remove the starting + ending caps = 4 triangles
 
@@ -3047,11 +3103,14 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
     m_statistics.load_indices = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - smooth_vertices_time).count();
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 
-    log_memory_usage("Loaded G-code generated indices buffers ", vertices, indices);
+    log_memory_used("Loaded G-code generated indices buffers, peak ", max_memory_usage);
 
     // dismiss indices data, no more needed
     std::vector<MultiIndexBuffer>().swap(indices);
 
+    // toolpaths data -> build the simplified levels of detail of the extrusion paths
+    load_toolpaths_lods(gcode_result);
+
     // layers zs / roles / extruder ids -> extract from result
     size_t last_travel_s_id = 0;
     seams_count = 0;
@@ -3130,6 +3189,182 @@ void GCodeViewer::load_toolpaths(const GCodeProcessorResult& gcode_result, const
         progress_dialog->Destroy();
 }
 
+void GCodeViewer::load_toolpaths_lods(const GCodeProcessorResult& gcode_result)
+{
+    // max deviation of the levels of detail from the full detail extrusion paths, in mm
+    static const std::vector<float> Lod_Tolerances = { 0.1f, 0.4f, 1.6f };
+
+    TBuffer& t_buffer = m_buffers[buffer_id(EMoveType::Extrude)];
+    if (t_buffer.render_primitive_type != TBuffer::ERenderPrimitiveType::Triangle || t_buffer.paths.empty())
+        return;
+
+    // simplify the paths in parallel, for all the levels at once
+    // points of the path kept by each level: simplified[level][path id]
+    std::vector<std::vector<std::vector<Vec3f>>> simplified(Lod_Tolerances.size(), std::vector<std::vector<Vec3f>>(t_buffer.paths.size()));
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, t_buffer.paths.size()), [this, &gcode_result, &t_buffer, &simplified](const tbb::blocked_range<size_t>& range) {
+        std::vector<Vec3f> polyline;
+        for (size_t path_id = range.begin(); path_id < range.end(); ++path_id) {
+            // same vertices of the full detail path
+            const Path& path = t_buffer.paths[path_id];
+            polyline.assign(1, path.sub_paths.front().first.position);
+            for (size_t s_id = path.sub_paths.front().first.s_id + 1; s_id <= path.sub_paths.back().last.s_id; ++s_id) {
+                const GCodeProcessorResult::MoveVertex& move = gcode_result.moves[m_ssid_to_moveid_map[s_id]];
+                if (move.is_arc_move_with_interpolation_points())
+                    polyline.insert(polyline.end(), move.interpolation_points.begin(), move.interpolation_points.end());
+                polyline.push_back(move.position);
+            }
+
+            const std::vector<float> errors = toolpath_lod_errors(polyline, Lod_Tolerances.front());
+            for (size_t level = 0; level < Lod_Tolerances.size(); ++level) {
+                std::vector<Vec3f>& points = simplified[level][path_id];
+                for (size_t i = 0; i < polyline.size(); ++i) {
+                    if (errors[i] > Lod_Tolerances[level])
+                        points.push_back(polyline[i]);
+                }
+            }
+        }
+    });
+
+    auto store_vertex = [](VertexBuffer& vertices, const Vec3f& position, const Vec3f& normal) {
+        // append position
+        vertices.push_back(position.x());
+        vertices.push_back(position.y());
+        vertices.push_back(position.z());
+        // append normal
+        vertices.push_back(normal.x());
+        vertices.push_back(normal.y());
+        vertices.push_back(normal.z());
+    };
+    auto store_triangle = [](IndexBuffer& indices, size_t i1, size_t i2, size_t i3) {
+        indices.push_back(static_cast<IBufferType>(i1));
+        indices.push_back(static_cast<IBufferType>(i2));
+        indices.push_back(static_cast<IBufferType>(i3));
+    };
+
+    // format data of the points [begin, end) of the path to be rendered as a solid with the same section of the full detail one,
+    // sharing the vertices between consecutive segments, with caps at the ends of the path only
+    auto add_path_as_solid = [&](const Path& path, const std::vector<Vec3f>& points, size_t begin, size_t end, VertexBuffer& vertices, IndexBuffer& indices) {
+        const size_t first_vertex = vertices.size() / 6;
+        const float half_width = 0.5f * path.width;
+        const float half_height = 0.5f * path.height;
+        Vec3f right = Vec3f::UnitX();
+        for (size_t i = begin; i < end; ++i) {
+            // the section is orthogonal to the mean direction of the segments sharing the point
+            Vec3f dir = Vec3f::Zero();
+            if (i > 0)
+                dir += (points[i] - points[i - 1]).normalized();
+            if (i + 1 < points.size())
+                dir += (points[i + 1] - points[i]).normalized();
+            dir.normalize();
+            const Vec3f dir_right = Vec3f(dir.y(), -dir.x(), 0.0f);
+            if (dir_right.squaredNorm() > 0.0f)
+                right = dir_right.normalized();
+            Vec3f up = right.cross(dir);
+            if (up.squaredNorm() == 0.0f)
+                up = Vec3f::UnitZ();
+            const Vec3f pos = points[i] - half_height * up;
+            store_vertex(vertices, pos + half_height * up, up);
+            store_vertex(vertices, pos + half_width * right, right);
+            store_vertex(vertices, pos - half_height * up, -up);
+            store_vertex(vertices, pos - half_width * right, -right);
+        }
+
+        if (begin == 0) {
+            // starting cap triangles
+            store_triangle(indices, first_vertex + 0, first_vertex + 2, first_vertex + 1);
+            store_triangle(indices, first_vertex + 0, first_vertex + 3, first_vertex + 2);
+        }
+        for (size_t i = 0; i + 1 < end - begin; ++i) {
+            // stem triangles
+            const size_t a = first_vertex + 4 * i;
+            const size_t b = a + 4;
+            for (size_t k = 0; k < 4; ++k) {
+                const size_t k1 = (k + 1) % 4;
+                store_triangle(indices, a + k, a + k1, b + k);
+                store_triangle(indices, a + k1, b + k1, b + k);
+            }
+        }
+        if (end == points.size()) {
+            // ending cap triangles
+            const size_t b = first_vertex + 4 * (end - begin - 1);
+            store_triangle(indices, b + 0, b + 2, b + 3);
+            store_triangle(indices, b + 0, b + 1, b + 2);
+        }
+    };
+
+    t_buffer.lods.resize(Lod_Tolerances.size());
+    for (size_t level = 0; level < Lod_Tolerances.size(); ++level) {
+        TBuffer::Lod& lod = t_buffer.lods[level];
+        lod.tolerance = Lod_Tolerances[level];
+        lod.vertices.format = t_buffer.vertices.format;
+        lod.paths_first_range.reserve(t_buffer.paths.size() + 1);
+
+        VertexBuffer v_buffer;
+        IndexBuffer i_buffer;
+        auto send_to_gpu = [
+#if ENABLE_GCODE_VIEWER_STATISTICS
+            this,
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+            &lod, &v_buffer, &i_buffer]() {
+            if (i_buffer.empty())
+                return;
+
+            const size_t v_size_bytes = v_buffer.size() * sizeof(float);
+            GLuint vbo = 0;
+            glsafe(::glGenBuffers(1, &vbo));
+            glsafe(::glBindBuffer(GL_ARRAY_BUFFER, vbo));
+            glsafe(::glBufferData(GL_ARRAY_BUFFER, v_size_bytes, v_buffer.data(), GL_STATIC_DRAW));
+            glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
+            lod.vertices.vbos.push_back(static_cast<unsigned int>(vbo));
+            lod.vertices.sizes.push_back(v_size_bytes);
+            lod.vertices.count += v_buffer.size() / lod.vertices.vertex_size_floats();
+
+            const size_t i_size_bytes = i_buffer.size() * sizeof(IBufferType);
+            lod.indices.push_back(IBuffer());
+            IBuffer& ibuf = lod.indices.back();
+            ibuf.vbo = static_cast<unsigned int>(vbo);
+            ibuf.count = i_buffer.size();
+            glsafe(::glGenBuffers(1, &ibuf.ibo));
+            glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibuf.ibo));
+            glsafe(::glBufferData(GL_ELEMENT_ARRAY_BUFFER, i_size_bytes, i_buffer.data(), GL_STATIC_DRAW));
+            glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+
+#if ENABLE_GCODE_VIEWER_STATISTICS
+            m_statistics.total_vertices_gpu_size += static_cast<int64_t>(v_size_bytes);
+            m_statistics.total_indices_gpu_size += static_cast<int64_t>(i_size_bytes);
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+
+            v_buffer.clear();
+            i_buffer.clear();
+        };
+
+        // max count of points fitting into a vertex buffer, 4 vertices per point
+        const size_t max_points = lod.vertices.max_size_bytes() / (4 * lod.vertices.vertex_size_bytes());
+        for (size_t path_id = 0; path_id < t_buffer.paths.size(); ++path_id) {
+            lod.paths_first_range.push_back(lod.ranges.size());
+            std::vector<Vec3f>& points = simplified[level][path_id];
+            // the points of a path are split into chunks fitting into the vertex buffers,
+            // consecutive chunks share their end point
+            for (size_t begin = 0; begin + 1 < points.size();) {
+                if (v_buffer.size() / (4 * lod.vertices.vertex_size_floats()) + 2 > max_points)
+                    send_to_gpu();
+                const size_t end = std::min(points.size(), begin + max_points - v_buffer.size() / (4 * lod.vertices.vertex_size_floats()));
+                const size_t first_index = i_buffer.size();
+                add_path_as_solid(t_buffer.paths[path_id], points, begin, end, v_buffer, i_buffer);
+                lod.ranges.push_back({ static_cast<unsigned int>(lod.indices.size()), first_index * sizeof(IBufferType), static_cast<unsigned int>(i_buffer.size() - first_index) });
+                begin = end - 1;
+            }
+            // dismiss, no more needed
+            std::vector<Vec3f>().swap(points);
+        }
+        lod.paths_first_range.push_back(lod.ranges.size());
+        send_to_gpu();
+
+        BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << boost::format(": level of detail with tolerance %1% mm, vertices count %2% (full detail %3%)")
+            % lod.tolerance % lod.vertices.count % t_buffer.vertices.count;
+    }
+}
+
 void GCodeViewer::load_shells(const Print& print, bool initialized, bool force_previewing)
 {
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": initialized=%1%, force_previewing=%2%")%initialized %force_previewing;
@@ -3358,6 +3593,10 @@ void GCodeViewer::refresh_render_paths(bool keep_sequential_current_first, bool
         TBuffer& buffer = const_cast<TBuffer&>(m_buffers[b]);
         // reset render paths
         buffer.render_paths.clear();
+        buffer.lod_complement_render_paths.clear();
+        for (TBuffer::Lod& lod : buffer.lods) {
+            lod.render_paths.clear();
+        }
 
         if (!buffer.visible)
             continue;
@@ -3557,6 +3796,23 @@ m_no_render_path = false;
             render_path = const_cast<RenderPath*>(&buffer.render_paths.back());
         }
 
+        // the levels of detail contain the paths entirely shown by the sequential view,
+        // the other paths are rendered with full detail together with them
+        const bool use_lods = !buffer.lods.empty() &&
+            m_sequential_view.current.first <= path.sub_paths.front().first.s_id && path.sub_paths.back().last.s_id <= m_sequential_view.current.last;
+        if (use_lods && sub_path_id == 0) {
+            for (TBuffer::Lod& lod : buffer.lods) {
+                for (size_t r = lod.paths_first_range[path_id]; r < lod.paths_first_range[path_id + 1]; ++r) {
+                    const TBuffer::Lod::Range& range = lod.ranges[r];
+                    const RenderPath lod_key{ tbuffer_id, color, range.ibuffer_id, path_id };
+                    if (lod.render_paths.empty() || !RenderPathPropertyEqual()(lod.render_paths.back(), lod_key))
+                        lod.render_paths.emplace_back(lod_key);
+                    lod.render_paths.back().sizes.push_back(range.count);
+                    lod.render_paths.back().offsets.push_back(range.offset);
+                }
+            }
+        }
+
         unsigned int delta_1st = 0;
         if (sub_path.first.s_id < m_sequential_view.current.first && m_sequential_view.current.first <= sub_path.last.s_id)
             delta_1st = static_cast<unsigned int>(m_sequential_view.current.first - sub_path.first.s_id);
@@ -3608,6 +3864,14 @@ m_no_render_path = false;
 
         render_path->offsets.push_back(static_cast<size_t>((sub_path.first.i_id + delta_1st) * sizeof(IBufferType)));
 
+        if (!buffer.lods.empty() && !use_lods) {
+            std::vector<RenderPath>& complement_render_paths = buffer.lod_complement_render_paths;
+            if (complement_render_paths.empty() || !RenderPathPropertyEqual()(complement_render_paths.back(), key))
+                complement_render_paths.emplace_back(key);
+            complement_render_paths.back().sizes.push_back(render_path->sizes.back());
+            complement_render_paths.back().offsets.push_back(render_path->offsets.back());
+        }
+
 #if 0
         // check sizes and offsets against index buffer size on gpu
         GLint buffer_size;
@@ -3936,6 +4200,81 @@ void GCodeViewer::render_toolpaths()
         return (zoom < 5.0) ? 1.0 : (1.0 + 5.0 * (zoom - 5.0) / (100.0 - 5.0));
     };
 
+    auto render_as_paths = [&](const TBuffer& buffer, const VBuffer& vertices, const std::vector<IBuffer>& indices, std::vector<RenderPath>& render_paths,
+        GLShaderProgram& shader, int position_id, int normal_id, int uniform_color) {
+        auto it_path = render_paths.begin();
+        for (unsigned int ibuffer_id = 0; ibuffer_id < static_cast<unsigned int>(indices.size()); ++ibuffer_id) {
+            const IBuffer& i_buffer = indices[ibuffer_id];
+            // Skip all paths with ibuffer_id < ibuffer_id.
+            for (; it_path != render_paths.end() && it_path->ibuffer_id < ibuffer_id; ++it_path);
+            if (it_path == render_paths.end() || it_path->ibuffer_id > ibuffer_id)
+                // Not found. This shall not happen.
+                continue;
+
+            glsafe(::glBindBuffer(GL_ARRAY_BUFFER, i_buffer.vbo));
+            if (position_id != -1) {
+                glsafe(::glVertexAttribPointer(position_id, vertices.position_size_floats(), GL_FLOAT, GL_FALSE, vertices.vertex_size_bytes(), (const void*)vertices.position_offset_bytes()));
+                glsafe(::glEnableVertexAttribArray(position_id));
+            }
+            const bool has_normals = vertices.normal_size_floats() > 0;
+            if (has_normals) {
+                if (normal_id != -1) {
+                    glsafe(::glVertexAttribPointer(normal_id, vertices.normal_size_floats(), GL_FLOAT, GL_FALSE, vertices.vertex_size_bytes(), (const void*)vertices.normal_offset_bytes()));
+                    glsafe(::glEnableVertexAttribArray(normal_id));
+                }
+            }
+
+            glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, i_buffer.ibo));
+
+            // Render all elements with it_path->ibuffer_id == ibuffer_id, possible with varying colors.
+            switch (buffer.render_primitive_type)
+            {
+            case TBuffer::ERenderPrimitiveType::Line: {
+                glsafe(::glLineWidth(static_cast<GLfloat>(line_width(zoom))));
+                render_as_lines(it_path, render_paths.end(), shader, uniform_color);
+                break;
+            }
+            case TBuffer::ERenderPrimitiveType::Triangle: {
+                render_as_triangles(it_path, render_paths.end(), shader, uniform_color);
+                break;
+            }
+            default: { break; }
+            }
+
+            glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+
+            if (normal_id != -1)
+                glsafe(::glDisableVertexAttribArray(normal_id));
+            if (position_id != -1)
+                glsafe(::glDisableVertexAttribArray(position_id));
+            glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
+        }
+    };
+
+    // size in mm of a pixel at the point of the toolpaths closest to the camera, used to select the levels of detail,
+    // zero if it cannot be determined
+    auto pixel_size_at_paths = [this, &camera]() {
+        const std::array<int, 4>& viewport = camera.get_viewport();
+        const double p11 = camera.get_projection_matrix().matrix()(1, 1);
+        if (!m_paths_bounding_box.defined || viewport[3] <= 0 || p11 <= 0.0)
+            return 0.0f;
+
+        // size of a pixel at unit distance from the camera for perspective cameras, everywhere for ortho cameras
+        const double unit_pixel_size = 2.0 / (p11 * static_cast<double>(viewport[3]));
+        if (camera.get_type() == Camera::EType::Ortho)
+            return static_cast<float>(unit_pixel_size);
+
+        double min_depth = std::numeric_limits<double>::max();
+        for (int i = 0; i < 8; ++i) {
+            const Vec3d corner((i & 1) ? m_paths_bounding_box.max.x() : m_paths_bounding_box.min.x(),
+                               (i & 2) ? m_paths_bounding_box.max.y() : m_paths_bounding_box.min.y(),
+                               (i & 4) ? m_paths_bounding_box.max.z() : m_paths_bounding_box.min.z());
+            min_depth = std::min(min_depth, -(camera.get_view_matrix() * corner).z());
+        }
+        return (min_depth > 0.0) ? static_cast<float>(min_depth * unit_pixel_size) : 0.0f;
+    };
+    const float lods_pixel_size = pixel_size_at_paths();
+
     const unsigned char begin_id = buffer_id(EMoveType::Retract);
     const unsigned char end_id   = buffer_id(EMoveType::Count);
 
@@ -3971,53 +4310,24 @@ void GCodeViewer::render_toolpaths()
             const int normal_id   = shader->get_attrib_location("v_normal");
             const int uniform_color = shader->get_uniform_location("uniform_color");
 
-            auto it_path = buffer.render_paths.begin();
-            for (unsigned int ibuffer_id = 0; ibuffer_id < static_cast<unsigned int>(buffer.indices.size()); ++ibuffer_id) {
-                const IBuffer& i_buffer = buffer.indices[ibuffer_id];
-                // Skip all paths with ibuffer_id < ibuffer_id.
-                for (; it_path != buffer.render_paths.end() && it_path->ibuffer_id < ibuffer_id; ++it_path);
-                if (it_path == buffer.render_paths.end() || it_path->ibuffer_id > ibuffer_id)
-                    // Not found. This shall not happen.
-                    continue;
-
-                glsafe(::glBindBuffer(GL_ARRAY_BUFFER, i_buffer.vbo));
-                if (position_id != -1) {
-                    glsafe(::glVertexAttribPointer(position_id, buffer.vertices.position_size_floats(), GL_FLOAT, GL_FALSE, buffer.vertices.vertex_size_bytes(), (const void*)buffer.vertices.position_offset_bytes()));
-                    glsafe(::glEnableVertexAttribArray(position_id));
+            // use the coarsest level of detail whose deviation from the full detail stays below one pixel
+            TBuffer::Lod* lod = nullptr;
+            if (!buffer.lods.empty() && lods_pixel_size > 0.0f) {
+                std::vector<float> tolerances;
+                for (const TBuffer::Lod& l : buffer.lods) {
+                    tolerances.push_back(l.tolerance);
                 }
-                const bool has_normals = buffer.vertices.normal_size_floats() > 0;
-                if (has_normals) {
-                    if (normal_id != -1) {
-                        glsafe(::glVertexAttribPointer(normal_id, buffer.vertices.normal_size_floats(), GL_FLOAT, GL_FALSE, buffer.vertices.vertex_size_bytes(), (const void*)buffer.vertices.normal_offset_bytes()));
-                        glsafe(::glEnableVertexAttribArray(normal_id));
-                    }
-                }
-
-                glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, i_buffer.ibo));
-
-                // Render all elements with it_path->ibuffer_id == ibuffer_id, possible with varying colors.
-                switch (buffer.render_primitive_type)
-                {
-                case TBuffer::ERenderPrimitiveType::Line: {
-                    glsafe(::glLineWidth(static_cast<GLfloat>(line_width(zoom))));
-                    render_as_lines(it_path, buffer.render_paths.end(), *shader, uniform_color);
-                    break;
-                }
-                case TBuffer::ERenderPrimitiveType::Triangle: {
-                    render_as_triangles(it_path, buffer.render_paths.end(), *shader, uniform_color);
-                    break;
-                }
-                default: { break; }
-                }
-
-                glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+                const size_t level = select_toolpath_lod(tolerances, lods_pixel_size);
+                if (level < buffer.lods.size())
+                    lod = &buffer.lods[level];
+            }
 
-                if (normal_id != -1)
-                    glsafe(::glDisableVertexAttribArray(normal_id));
-                if (position_id != -1)
-                    glsafe(::glDisableVertexAttribArray(position_id));
-                glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
+            if (lod != nullptr) {
+                render_as_paths(buffer, lod->vertices, lod->indices, lod->render_paths, *shader, position_id, normal_id, uniform_color);
+                render_as_paths(buffer, buffer.vertices, buffer.indices, buffer.lod_complement_render_paths, *shader, position_id, normal_id, uniform_color);
             }
+            else
+                render_as_paths(buffer, buffer.vertices, buffer.indices, buffer.render_paths, *shader, position_id, normal_id, uniform_color);
         }
 
         shader->stop_using();
@@ -3,6 +3,7 @@
 
 #include "3DScene.hpp"
 #include "libslic3r/GCode/GCodeProcessor.hpp"
+#include "libslic3r/GCode/BinaryGCode.hpp"
 #include "libslic3r/GCode/ThumbnailData.hpp"
 #include "IMSlider.hpp"
 #include "GLModel.hpp"
@@ -323,6 +324,38 @@ class GCodeViewer
         std::vector<RenderPath> render_paths;
         bool visible{ false };
 
+        // Simplified level of detail of the paths, rendered in place of the full detail when zoomed out
+        struct Lod
+        {
+            // Indices of a path contained into one of the index buffers
+            struct Range
+            {
+                // Index of the buffer in Lod::indices
+                unsigned int ibuffer_id{ 0 };
+                // offset in bytes of the first index
+                size_t offset{ 0 };
+                // count of indices
+                unsigned int count{ 0 };
+            };
+
+            // max deviation from the full detail paths, in mm
+            float tolerance{ 0.0f };
+            VBuffer vertices;
+            std::vector<IBuffer> indices;
+            // ranges of the path with index i in TBuffer::paths are [ranges[paths_first_range[i]], ranges[paths_first_range[i + 1]])
+            std::vector<Range> ranges;
+            std::vector<size_t> paths_first_range;
+            std::vector<RenderPath> render_paths;
+
+            void reset();
+        };
+
+        // levels of detail, sorted by ascending tolerance
+        std::vector<Lod> lods;
+        // render paths of the paths shown only partially by the sequential view, which are rendered with full detail
+        // together with the levels of detail
+        std::vector<RenderPath> lod_complement_render_paths;
+
         void reset();
 
         // b_id index of buffer contained in this->indices
@@ -644,6 +677,8 @@ public:
             size_t m_last_lines_size{ 0 };
             std::string m_filename;
             boost::iostreams::mapped_file_source m_file;
+            // Set instead of m_file for a binary G-code, whose blocks are decompressed on demand.
+            std::unique_ptr<BinaryGCode::Reader> m_binary;
             // map for accessing data in file by line number
             std::vector<size_t> m_lines_ends;
             // current visible lines
@@ -907,6 +942,7 @@ public:
 
 private:
     void load_toolpaths(const GCodeProcessorResult& gcode_result, const BuildVolume& build_volume, const std::vector<BoundingBoxf3>& exclude_bounding_box);
+    void load_toolpaths_lods(const GCodeProcessorResult& gcode_result);
     //BBS: always load shell at preview
     //void load_shells(const Print& print);
     void refresh_render_paths(bool keep_sequential_current_first, bool keep_sequential_current_last) const;
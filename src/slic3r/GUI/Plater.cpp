@@ -11269,9 +11269,10 @@ void Plater::priv::undo_redo_to(std::vector<UndoRedo::Snapshot>::const_iterator
         // BBS: add partplate logic
         if (this->printer_technology == ptFFF) {
             const DynamicPrintConfig& config = wxGetApp().preset_bundle->prints.get_edited_preset().config;
-            const DynamicPrintConfig& proj_cfg = wxGetApp().preset_bundle->project_config;
-            ConfigOptionFloats* tower_x_opt = const_cast<ConfigOptionFloats*>(proj_cfg.option<ConfigOptionFloats>("wipe_tower_x"));
-            ConfigOptionFloats* tower_y_opt = const_cast<ConfigOptionFloats*>(proj_cfg.option<ConfigOptionFloats>("wipe_tower_y"));
+            DynamicPrintConfig& proj_cfg = wxGetApp().preset_bundle->project_config;
+            // Non-const access marks the wipe tower options of the project config as modified.
+            ConfigOptionFloats* tower_x_opt = proj_cfg.option<ConfigOptionFloats>("wipe_tower_x");
+            ConfigOptionFloats* tower_y_opt = proj_cfg.option<ConfigOptionFloats>("wipe_tower_y");
             // BBS: don't support wipe tower rotation
             //double current_rotation = proj_cfg.opt_float("wipe_tower_rotation_angle");
             bool need_update = false;
@@ -13585,7 +13586,7 @@ void ProjectDropDialog::on_dpi_changed(const wxRect& suggested_rect)
 bool Plater::load_files(const wxArrayString& filenames)
 {
     const std::regex pattern_drop(".*[.](stp|step|stl|oltp|obj|amf|3mf|svg|zip)", std::regex::icase);
-    const std::regex pattern_gcode_drop(".*[.](gcode|g)", std::regex::icase);
+    const std::regex pattern_gcode_drop(".*[.](gcode|obgcode|g)", std::regex::icase);
 
     std::vector<fs::path> normal_paths;
     std::vector<fs::path> gcode_paths;
@@ -14666,11 +14667,13 @@ void Plater::export_stl(bool extended, bool selection_only, bool multi_stls)
                               csg::mpartsPositive | csg::mpartsNegative | csg::mpartsDoSplits);
 
         auto csgrange = range(csgmesh);
+        // Parts converted by the check are reused by the booleans.
+        csg::CGALMeshCache cgal_cache;
         if (csg::is_all_positive(csgrange)) {
             mesh = TriangleMesh{csg::csgmesh_merge_positive_parts(csgrange)};
-        } else if (std::get<2>(csg::check_csgmesh_booleans(csgrange)) == csgrange.end()) {
+        } else if (std::get<2>(csg::check_csgmesh_booleans(csgrange, false, &cgal_cache)) == csgrange.end()) {
             try {
-                auto cgalm = csg::perform_csgmesh_booleans(csgrange);
+                auto cgalm = csg::perform_csgmesh_booleans(csgrange, &cgal_cache);
                 mesh = MeshBoolean::cgal::cgal_to_triangle_mesh(*cgalm);
             } catch (...) {}
         }
@@ -1,7 +1,9 @@
 #include <catch2/catch_all.hpp>
 
 #include <memory>
+#include <random>
 
+#include "libslic3r/GCode.hpp"
 #include "libslic3r/GCodeWriter.hpp"
 
 using namespace Slic3r;
@@ -94,3 +96,59 @@ SCENARIO("set_speed emits values with fixed-point output.", "[GCodeWriter]") {
         }
     }
 }
+
+TEST_CASE("Extruding a polyline in a batch produces the same G-code as extruding it by segments", "[GCodeWriter]") {
+    const bool relative_e = GENERATE(false, true);
+    auto make_writer = [relative_e]() {
+        auto writer = std::make_unique<GCodeWriter>();
+        writer->config.use_relative_e_distances.value = relative_e;
+        writer->set_extruders({ 0 });
+        writer->set_extruder(0);
+        writer->set_xy_offset(12.5, -7.25);
+        return writer;
+    };
+
+    // Infill like zig-zag with short and zero length segments in between.
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<coord_t> dist(-scale_(0.005), scale_(0.005));
+    Points points;
+    for (coord_t i = 0; i < 2000; ++ i) {
+        points.emplace_back(scale_(i % 2 ? 100. : 10.), scale_(0.4 * i));
+        if (i % 7 == 0)
+            points.emplace_back(points.back());
+        if (i % 11 == 0)
+            points.emplace_back(points.back() + Point(dist(rng), dist(rng)));
+    }
+    const Vec2d  origin(90.125, 100.5);
+    const Vec2d  extruder_offset(0.5, -1.);
+    const double e_per_mm = 0.0332;
+    const std::string comment = "infill";
+
+    auto extrude_by_segments = [&](GCodeWriter &writer) {
+        std::string gcode;
+        for (const Line &line : Polyline(points).lines()) {
+            const double line_length = line.length() * SCALING_FACTOR;
+            if (line_length < EPSILON)
+                continue;
+            gcode += writer.extrude_to_xy(unscale(line.b) + origin - extruder_offset, e_per_mm * line_length, comment);
+        }
+        return gcode;
+    };
+    std::vector<Vec2d>  segment_points;
+    std::vector<double> segment_dEs;
+    auto extrude_in_batch = [&](GCodeWriter &writer) {
+        std::string gcode;
+        GCode::extrusion_segments(points, 0, points.size() - 1, origin, extruder_offset, e_per_mm, segment_points, segment_dEs);
+        writer.extrude_polyline_to_xy(segment_points, segment_dEs, comment, false, gcode);
+        return gcode;
+    };
+
+    std::unique_ptr<GCodeWriter> by_segments = make_writer();
+    std::unique_ptr<GCodeWriter> in_batch    = make_writer();
+    REQUIRE(extrude_in_batch(*in_batch) == extrude_by_segments(*by_segments));
+    REQUIRE(in_batch->filament()->E() == by_segments->filament()->E());
+    REQUIRE(in_batch->get_position() == by_segments->get_position());
+
+    BENCHMARK("extrude by segments") { return extrude_by_segments(*by_segments); };
+    BENCHMARK("extrude in batch") { return extrude_in_batch(*in_batch); };
+}
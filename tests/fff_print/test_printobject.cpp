@@ -3,6 +3,11 @@
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/MultiMaterialSegmentation.hpp"
+#include "libslic3r/TriangleSelector.hpp"
+#include "libslic3r/SliceDataCache.hpp"
+
+#include <boost/filesystem.hpp>
 
 #include "test_data.hpp"
 
@@ -87,3 +92,153 @@ SCENARIO("PrintObject: object layer heights", "[PrintObject][.]") {
 #endif
     }
 }
+
+SCENARIO("PrintObject: mesh slices are reused", "[PrintObject]") {
+    GIVEN("20mm cube") {
+        Slic3r::Print      print;
+        Slic3r::Model      model;
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, config);
+        print.process();
+        const MeshSlicesCache &cache  = print.mesh_slices_cache();
+        const size_t           misses = cache.misses();
+        REQUIRE(misses > 0);
+        REQUIRE(cache.hits() == 0);
+        const size_t layers = print.objects().front()->layer_count();
+
+        WHEN("a setting applied after slicing the mesh changes") {
+            config.set_deserialize_strict({ { "xy_contour_compensation", 0.1 } });
+            print.apply(model, config);
+            print.process();
+            THEN("the object is sliced again from the cached mesh slices") {
+                REQUIRE(cache.misses() == misses);
+                REQUIRE(cache.hits() == misses);
+                REQUIRE(print.objects().front()->layer_count() == layers);
+            }
+        }
+        WHEN("the layer height changes") {
+            config.set_deserialize_strict({ { "layer_height", 0.3 } });
+            print.apply(model, config);
+            print.process();
+            THEN("the mesh is sliced again and the previous slices are replaced") {
+                REQUIRE(cache.misses() == 2 * misses);
+                REQUIRE(cache.hits() == 0);
+                REQUIRE(cache.size() == misses);
+            }
+        }
+        WHEN("a copy of the object with a different infill is added") {
+            ModelObject *copy = model.add_object(*model.objects.front());
+            copy->config.set("sparse_infill_density", 40);
+            copy->instances.front()->set_offset(copy->instances.front()->get_offset() + Vec3d(40., 0., 0.));
+            print.apply(model, config);
+            print.process();
+            THEN("the copy reuses the mesh slices of the first object") {
+                REQUIRE(print.objects().size() == 2);
+                REQUIRE(cache.misses() == misses);
+                REQUIRE(cache.hits() == misses);
+                REQUIRE(print.objects().back()->layer_count() == layers);
+            }
+        }
+    }
+}
+
+SCENARIO("PrintObject: sliced objects are restored from the slicing cache", "[PrintObject]") {
+    GIVEN("20mm cube sliced into an empty cache") {
+        const boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("slice_cache_%%%%-%%%%");
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        size_t             layers = 0;
+        {
+            Slic3r::Print  print;
+            Slic3r::Model  model;
+            SliceDataCache cache(dir.string(), 0);
+            Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, config);
+            REQUIRE(cache.load(print) == 0);
+            REQUIRE(cache.stats().misses == 1);
+            print.process();
+            REQUIRE(cache.store(print) == 0);
+            REQUIRE(cache.stats().stored == 1);
+            layers = print.objects().front()->layer_count();
+        }
+        WHEN("the cube is sliced again with another start G-code") {
+            config.set_deserialize_strict({ { "machine_start_gcode", "G28 ; home" } });
+            Slic3r::Print  print;
+            Slic3r::Model  model;
+            SliceDataCache cache(dir.string(), 0);
+            Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, config);
+            THEN("the object is restored from the cache") {
+                REQUIRE(cache.load(print) == 0);
+                REQUIRE(cache.stats().hits == 1);
+                REQUIRE(print.objects().front()->layer_count() == layers);
+                print.process(nullptr, true);
+                REQUIRE(print.objects().front()->layer_count() == layers);
+            }
+        }
+        WHEN("the cube is sliced again with another layer height") {
+            config.set_deserialize_strict({ { "layer_height", 0.3 } });
+            Slic3r::Print  print;
+            Slic3r::Model  model;
+            SliceDataCache cache(dir.string(), 1);
+            Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, config);
+            THEN("the object is sliced and the least recently used entry is evicted") {
+                REQUIRE(cache.load(print) == 0);
+                REQUIRE(cache.stats().misses == 1);
+                print.process();
+                REQUIRE(cache.store(print) == 0);
+                REQUIRE(cache.stats().evicted == 2);
+            }
+        }
+        boost::system::error_code ec;
+        boost::filesystem::remove_all(dir, ec);
+    }
+}
+
+SCENARIO("PrintObject: painted segmentation cache follows the number of filaments", "[PrintObject]") {
+    GIVEN("20mm cube with one side painted by the second filament and the opposite side by the third one") {
+        Slic3r::Print      print;
+        Slic3r::Model      model;
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, config);
+
+        ModelVolume            &volume = *model.objects.front()->volumes.front();
+        const TriangleMesh     &mesh   = volume.mesh();
+        TriangleSelector        selector(mesh);
+        for (int facet_idx = 0; facet_idx < int(mesh.its.indices.size()); ++ facet_idx) {
+            const Vec3f normal = its_face_normal(mesh.its, facet_idx);
+            if (normal.x() > 0.5f)
+                selector.set_facet(facet_idx, EnforcerBlockerType::Extruder2);
+            else if (normal.x() < -0.5f)
+                selector.set_facet(facet_idx, EnforcerBlockerType::Extruder3);
+        }
+        volume.mmu_segmentation_facets.set(selector);
+        print.apply(model, config);
+        print.process();
+
+        const PrintObject &object  = *print.objects().front();
+        auto               segment = [&object](size_t num_facets_states, PaintedSegmentationCache *cache) {
+            return segmentation_by_painting(object, [](const ModelVolume &mv) -> ModelVolumeFacetsInfo { return { mv.mmu_segmentation_facets, mv.is_mm_painted(), false }; },
+                                            num_facets_states, 0.f, 0.f, false, IncludeTopAndBottomLayers::No, []() {}, cache);
+        };
+        // The segmentation is indexed by layer and by filament, the unpainted state is left out.
+        auto painted_layers = [](const std::vector<std::vector<ExPolygons>> &segmentation, size_t filament_idx) {
+            return std::count_if(segmentation.begin(), segmentation.end(), [filament_idx](const std::vector<ExPolygons> &layer) {
+                return layer.size() > filament_idx && ! layer[filament_idx].empty();
+            });
+        };
+
+        PaintedSegmentationCache cache;
+        const std::vector<std::vector<ExPolygons>> three_filaments = segment(4, &cache);
+        REQUIRE(painted_layers(three_filaments, 1) > 0);
+        REQUIRE(painted_layers(three_filaments, 2) > 0);
+
+        WHEN("the same painting is segmented for two filaments only") {
+            const std::vector<std::vector<ExPolygons>> two_filaments = segment(3, &cache);
+            THEN("the facets of the third filament are not reused from the cache") {
+                REQUIRE(two_filaments.size() == object.layer_count());
+                for (const std::vector<ExPolygons> &layer : two_filaments)
+                    REQUIRE(layer.size() == 2);
+                REQUIRE(painted_layers(two_filaments, 1) > 0);
+                REQUIRE(two_filaments == segment(3, nullptr));
+            }
+        }
+    }
+}
@@ -1,5 +1,6 @@
 #include <catch2/catch_all.hpp>
 
+#include "libslic3r/Brim.hpp"
 #include "libslic3r/GCodeReader.hpp"
 #include "libslic3r/Config.hpp"
 #include "libslic3r/Geometry.hpp"
@@ -269,3 +270,43 @@ SCENARIO("Original Slic3r Skirt/Brim tests", "[SkirtBrim][.]") {
         }
     }
 }
+
+SCENARIO("Brim areas are reused while the first layer does not change", "[SkirtBrim]") {
+    GIVEN("A 20mm cube with an outer brim") {
+        DynamicPrintConfig config = Slic3r::DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "brim_type",   "outer_only" },
+            { "brim_width",  5 },
+            { "skirt_loops", 0 }
+        });
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, config);
+        print.process();
+        const PrintObject *object = print.objects().front();
+        REQUIRE(object->brim_areas_cache);
+        // Keep the areas alive, so that they are not mistaken for areas allocated at the same address.
+        const std::shared_ptr<const PrintObjectBrimAreas> areas      = object->brim_areas_cache;
+        const size_t                                      brim_loops = print.get_brimMap().at(object->id()).entities.size();
+        REQUIRE(brim_loops > 0);
+
+        WHEN("the object is moved") {
+            model.objects.front()->instances.front()->set_offset(model.objects.front()->instances.front()->get_offset() + Vec3d(10., 5., 0.));
+            print.apply(model, config);
+            print.process();
+            THEN("the same brim is produced from the cached areas") {
+                REQUIRE(print.objects().front()->brim_areas_cache == areas);
+                REQUIRE(print.get_brimMap().at(print.objects().front()->id()).entities.size() == brim_loops);
+            }
+        }
+        WHEN("the brim width changes") {
+            config.set_deserialize_strict({ { "brim_width", 8 } });
+            print.apply(model, config);
+            print.process();
+            THEN("the brim areas are produced again") {
+                REQUIRE(print.objects().front()->brim_areas_cache != areas);
+                REQUIRE(print.get_brimMap().at(print.objects().front()->id()).entities.size() > brim_loops);
+            }
+        }
+    }
+}
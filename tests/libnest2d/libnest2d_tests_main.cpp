@@ -1225,3 +1225,62 @@ TEST_CASE("Test for biggest bounding box area", "[Nesting][NestKernels][.]")
     REQUIRE(pile.size() == N);
     REQUIRE(bb.area() == double(N) * N * W * W);
 }
+
+TEST_CASE("Cached NFPs give the same layout", "[Nesting][NestKernels]")
+{
+    static const constexpr Slic3r::ClipperLib::cInt W = 10000000;
+
+    auto make_input = [] {
+        std::vector<Item> input;
+        for (size_t i = 0; i < 12; ++i) input.emplace_back(RectangleItem{2 * W, W});
+        for (size_t i = 0; i < 6; ++i) input.emplace_back(RectangleItem{W, W});
+        return input;
+    };
+
+    auto bin = Box(250000000, 210000000);
+
+    NfpPlacer::Config pconfig;
+    pconfig.rotations = {0., Pi / 2.};
+
+    std::vector<Item> uncached = make_input();
+    size_t bins = nest(uncached, bin, W / 10, NestConfig{pconfig});
+
+    pconfig.nfp_cache = std::make_shared<placers::NfpCache<PolygonImpl>>();
+    std::vector<Item> cached = make_input();
+    size_t cached_bins = nest(cached, bin, W / 10, NestConfig{pconfig});
+
+    REQUIRE(bins == cached_bins);
+    for (size_t i = 0; i < uncached.size(); ++i) {
+        REQUIRE(cached[i].binId() == uncached[i].binId());
+        REQUIRE(cached[i].translation() == uncached[i].translation());
+        REQUIRE(double(cached[i].rotation()) == Catch::Approx(double(uncached[i].rotation())));
+    }
+}
+
+TEST_CASE("Cached NFPs are reused only for the same outlines", "[Nesting][NestKernels]")
+{
+    using Cache = placers::NfpCache<PolygonImpl>;
+    static const constexpr Slic3r::ClipperLib::cInt W = 10000000;
+
+    PolygonImpl square = RectangleItem{W, W}.rawShape();
+    PolygonImpl moved  = square;
+    shapelike::translate(moved, PointImpl{3 * W, W});
+    PolygonImpl holed = square;
+    shapelike::holes(holed).emplace_back(Slic3r::Polygon{{W / 4, W / 4}, {W / 4, 3 * W / 4}, {3 * W / 4, 3 * W / 4}, {3 * W / 4, W / 4}});
+
+    Cache           cache;
+    Cache::ShapeKey square_key = Cache::shapeKey(square);
+    cache.insert(square_key, square_key, PointImpl{0, 0}, square);
+
+    // The outline does not depend on where the shape is.
+    PolygonImpl nfp;
+    REQUIRE(cache.find(Cache::shapeKey(moved), square_key, PointImpl{W, W}, nfp));
+    REQUIRE(shapelike::area(nfp) == Catch::Approx(shapelike::area(square)));
+
+    // Holes are part of the outline, even if the hashes collide.
+    Cache::ShapeKey holed_key = Cache::shapeKey(holed);
+    REQUIRE(holed_key.hash != square_key.hash);
+    holed_key.hash = square_key.hash;
+    REQUIRE(!cache.find(holed_key, square_key, PointImpl{0, 0}, nfp));
+    REQUIRE(!cache.find(square_key, holed_key, PointImpl{0, 0}, nfp));
+}
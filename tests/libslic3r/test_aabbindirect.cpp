@@ -4,6 +4,8 @@
 #include <libslic3r/TriangleMesh.hpp>
 #include <libslic3r/AABBTreeIndirect.hpp>
 
+#include <random>
+
 using namespace Slic3r;
 
 TEST_CASE("Building a tree over a box, ray caster and closest query", "[AABBIndirect]")
@@ -58,3 +60,107 @@ TEST_CASE("Building a tree over a box, ray caster and closest query", "[AABBIndi
     REQUIRE(closest_point.y() == Catch::Approx(0.5));
     REQUIRE(closest_point.z() == Catch::Approx(1.));
 }
+
+template<typename TreeType>
+static size_t intersect_rays_first_hit(const indexed_triangle_set &its, const TreeType &tree, const std::vector<Vec3d> &origins, const std::vector<Vec3d> &dirs, std::vector<igl::Hit> &hits)
+{
+    size_t num_hits = 0;
+    hits.assign(origins.size(), igl::Hit { -1, -1, 0.f, 0.f, 0.f });
+    for (size_t i = 0; i < origins.size(); ++ i)
+        if (AABBTreeIndirect::intersect_ray_first_hit(its.vertices, its.indices, tree, origins[i], dirs[i], hits[i]))
+            ++ num_hits;
+        else
+            hits[i].id = -1;
+    return num_hits;
+}
+
+template<typename TreeType>
+static void squared_distances(const indexed_triangle_set &its, const TreeType &tree, const std::vector<Vec3d> &points,
+    std::vector<double> &sqr_dists, std::vector<size_t> &idxs, std::vector<Vec3d> &closest_points)
+{
+    sqr_dists.resize(points.size());
+    idxs.resize(points.size());
+    closest_points.resize(points.size());
+    for (size_t i = 0; i < points.size(); ++ i)
+        sqr_dists[i] = AABBTreeIndirect::squared_distance_to_indexed_triangle_set(its.vertices, its.indices, tree, points[i], idxs[i], closest_points[i]);
+}
+
+TEST_CASE("Wide tree gives the same results as the binary tree", "[AABBIndirect]")
+{
+    indexed_triangle_set its = its_make_sphere(10., 2. * PI / 60.);
+
+    auto tree      = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(its.vertices, its.indices);
+    auto wide_tree = AABBTreeIndirect::WideTree3f(tree);
+    REQUIRE(! wide_tree.empty());
+
+    std::mt19937                           rng(0);
+    std::uniform_real_distribution<double> dist(-15., 15.);
+    std::vector<Vec3d>                     origins, dirs;
+    for (size_t i = 0; i < 500; ++ i) {
+        origins.emplace_back(dist(rng), dist(rng), dist(rng));
+        dirs.emplace_back(Vec3d(dist(rng), dist(rng), dist(rng)).normalized());
+    }
+
+    std::vector<igl::Hit> hits, wide_hits;
+    size_t num_hits      = intersect_rays_first_hit(its, tree, origins, dirs, hits);
+    size_t num_wide_hits = intersect_rays_first_hit(its, wide_tree, origins, dirs, wide_hits);
+    REQUIRE(num_hits > 0);
+    REQUIRE(num_hits == num_wide_hits);
+    for (size_t i = 0; i < hits.size(); ++ i) {
+        REQUIRE((hits[i].id < 0) == (wide_hits[i].id < 0));
+        if (hits[i].id >= 0)
+            REQUIRE(wide_hits[i].t == Catch::Approx(hits[i].t));
+    }
+
+    for (size_t i = 0; i < origins.size(); ++ i) {
+        std::vector<igl::Hit> all_hits, all_wide_hits;
+        AABBTreeIndirect::intersect_ray_all_hits(its.vertices, its.indices, tree, origins[i], dirs[i], all_hits);
+        AABBTreeIndirect::intersect_ray_all_hits(its.vertices, its.indices, wide_tree, origins[i], dirs[i], all_wide_hits);
+        REQUIRE(all_hits.size() == all_wide_hits.size());
+        for (size_t j = 0; j < all_hits.size(); ++ j)
+            REQUIRE(all_wide_hits[j].t == Catch::Approx(all_hits[j].t));
+    }
+
+    std::vector<double> sqr_dists, wide_sqr_dists;
+    std::vector<size_t> idxs, wide_idxs;
+    std::vector<Vec3d>  points, wide_points;
+    squared_distances(its, tree, origins, sqr_dists, idxs, points);
+    squared_distances(its, wide_tree, origins, wide_sqr_dists, wide_idxs, wide_points);
+    for (size_t i = 0; i < origins.size(); ++ i) {
+        REQUIRE(wide_sqr_dists[i] == Catch::Approx(sqr_dists[i]));
+        REQUIRE((wide_points[i] - points[i]).norm() == Catch::Approx(0.).margin(1e-6));
+    }
+}
+
+TEST_CASE("Benchmark AABB tree queries", "[AABBIndirect]")
+{
+    // Dense sphere, similar to the meshes queried by the SLA support generator, hollowing and seam placer.
+    indexed_triangle_set its = its_make_sphere(10., 2. * PI / 360.);
+
+    auto tree      = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(its.vertices, its.indices);
+    auto wide_tree = AABBTreeIndirect::WideTree3f(tree);
+
+    std::mt19937                           rng(0);
+    std::uniform_real_distribution<double> dist(-15., 15.);
+    std::vector<Vec3d>                     origins, dirs;
+    for (size_t i = 0; i < 2000; ++ i) {
+        origins.emplace_back(dist(rng), dist(rng), dist(rng));
+        dirs.emplace_back(Vec3d(dist(rng), dist(rng), dist(rng)).normalized());
+    }
+
+    std::vector<igl::Hit> hits;
+    BENCHMARK("first hit, binary tree") { return intersect_rays_first_hit(its, tree, origins, dirs, hits); };
+    BENCHMARK("first hit, wide tree") { return intersect_rays_first_hit(its, wide_tree, origins, dirs, hits); };
+
+    std::vector<double> sqr_dists;
+    std::vector<size_t> idxs;
+    std::vector<Vec3d>  points;
+    BENCHMARK("squared distance, binary tree") {
+        squared_distances(its, tree, origins, sqr_dists, idxs, points);
+        return sqr_dists.front();
+    };
+    BENCHMARK("squared distance, wide tree") {
+        squared_distances(its, wide_tree, origins, sqr_dists, idxs, points);
+        return sqr_dists.front();
+    };
+}
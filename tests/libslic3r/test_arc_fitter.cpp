@@ -0,0 +1,81 @@
+#include <catch2/catch_all.hpp>
+
+#include "libslic3r/ArcFitter.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Slic3r;
+
+// Points of an arc around the origin, sampled every step mm.
+static Points arc_points(double radius, double start_angle, double sweep, double step)
+{
+    const size_t num_points = size_t(std::ceil(std::abs(sweep) * radius / step)) + 1;
+    Points       out;
+    out.reserve(num_points);
+    for (size_t i = 0; i < num_points; ++ i) {
+        const double angle = start_angle + sweep * double(i) / double(num_points - 1);
+        out.emplace_back(Point::new_scale(radius * std::cos(angle), radius * std::sin(angle)));
+    }
+    return out;
+}
+
+// The fitted parts follow each other and cover all the points.
+static bool covers_points(const std::vector<PathFittingData> &result, const Points &points)
+{
+    if (result.empty() || result.front().start_point_index != 0 || result.back().end_point_index != points.size() - 1)
+        return false;
+    for (size_t i = 1; i < result.size(); ++ i)
+        if (result[i].start_point_index != result[i - 1].end_point_index)
+            return false;
+    return true;
+}
+
+TEST_CASE("Arc fitting of a dense arc", "[ArcFitter]") {
+    const Points points = arc_points(20., 0.3, 1.5 * M_PI, 0.5);
+    std::vector<PathFittingData> result;
+    ArcFitter::do_arc_fitting(points, result, scale_(0.01));
+
+    REQUIRE(covers_points(result, points));
+    REQUIRE(result.size() == 1);
+    REQUIRE(result.front().path_type == EMovePathType::Arc_move_ccw);
+    REQUIRE(result.front().arc_data.center.cast<double>().norm() < scale_(0.01));
+    REQUIRE(std::abs(result.front().arc_data.radius - scale_(20.)) < scale_(0.01));
+}
+
+TEST_CASE("Arc fitting of arcs joined by a straight line", "[ArcFitter]") {
+    // Clockwise quarter from (0, 10) to (10, 0), a line down to (10, -9.5), counter clockwise quarter to (20, -19.5).
+    Points points = arc_points(10., 0.5 * M_PI, - 0.5 * M_PI, 0.3);
+    for (int i = 0; i < 19; ++ i)
+        points.emplace_back(points.back() + Point::new_scale(0., -0.5));
+    const Points second_arc = arc_points(10., M_PI, 0.5 * M_PI, 0.3);
+    const Point  offset     = points.back() - second_arc.front();
+    for (size_t i = 1; i < second_arc.size(); ++ i)
+        points.emplace_back(second_arc[i] + offset);
+
+    std::vector<PathFittingData> result;
+    ArcFitter::do_arc_fitting(points, result, scale_(0.01));
+
+    REQUIRE(covers_points(result, points));
+    REQUIRE(std::count_if(result.begin(), result.end(), [](const PathFittingData &data) { return data.path_type == EMovePathType::Arc_move_cw; }) >= 1);
+    REQUIRE(std::count_if(result.begin(), result.end(), [](const PathFittingData &data) { return data.path_type == EMovePathType::Arc_move_ccw; }) >= 1);
+    REQUIRE(std::count_if(result.begin(), result.end(), [](const PathFittingData &data) { return data.path_type == EMovePathType::Linear_move; }) >= 1);
+}
+
+TEST_CASE("Arc fitting of dense curved paths", "[ArcFitter][Benchmark]") {
+    // Spiral with a slowly changing radius sampled every 0.3mm, like the walls of a high resolution curved mesh.
+    Points points;
+    for (size_t i = 0; i < 20000; ++ i) {
+        const double angle = 0.01 * double(i);
+        const double radius = 30. + 0.5 * angle;
+        points.emplace_back(Point::new_scale(radius * std::cos(angle), radius * std::sin(angle)));
+    }
+    std::vector<PathFittingData> result;
+    ArcFitter::do_arc_fitting(points, result, scale_(0.01));
+    REQUIRE(covers_points(result, points));
+
+    BENCHMARK("do_arc_fitting") {
+        ArcFitter::do_arc_fitting(points, result, scale_(0.01));
+        return result.size();
+    };
+}
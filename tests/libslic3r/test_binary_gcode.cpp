@@ -0,0 +1,201 @@
+#include <catch2/catch_all.hpp>
+
+#include <libslic3r/GCode/BinaryGCode.hpp>
+#include <libslic3r/GCode/Thumbnails.hpp>
+#include <libslic3r/GCodeReader.hpp>
+#include <libslic3r/Exception.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+using namespace Slic3r;
+
+static std::string temp_gcode_path(const char *extension)
+{
+    return (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path(std::string("binary_gcode_%%%%-%%%%") + extension)).string();
+}
+
+static void write_file(const std::string &path, const std::string &data)
+{
+    FILE *f = boost::nowide::fopen(path.c_str(), "wb");
+    REQUIRE(f != nullptr);
+    REQUIRE(::fwrite(data.data(), 1, data.size(), f) == data.size());
+    ::fclose(f);
+}
+
+static std::string read_file(const std::string &path)
+{
+    FILE *f = boost::nowide::fopen(path.c_str(), "rb");
+    REQUIRE(f != nullptr);
+    std::string data;
+    char        buffer[4096];
+    for (size_t cnt; (cnt = ::fread(buffer, 1, sizeof(buffer), f)) > 0;)
+        data.append(buffer, cnt);
+    ::fclose(f);
+    return data;
+}
+
+static std::string make_thumbnail_block()
+{
+    std::string image(3000, '\0');
+    for (size_t i = 0; i < image.size(); ++ i)
+        image[i] = char(i * 7 % 251);
+    return GCodeThumbnails::thumbnail_block_to_gcode("thumbnail", 32, 24, image.data(), image.size());
+}
+
+static std::string make_gcode(size_t layers, size_t moves_per_layer, std::string &text_without_thumbnail)
+{
+    std::string header = "; HEADER_BLOCK_START\n; generated by OrcaSlicer 2.3.0\n; total layer number: " + std::to_string(layers) +
+                         "\n; HEADER_BLOCK_END\n\n";
+    std::string body   = "G28\nG90\n";
+    for (size_t layer = 0; layer < layers; ++ layer) {
+        body += ";LAYER_CHANGE\n;Z:" + std::to_string(0.2 * double(layer + 1)).substr(0, 4) + "\n";
+        for (size_t i = 0; i < moves_per_layer; ++ i)
+            body += "G1 X" + std::to_string(i % 200) + " Y" + std::to_string((i * 3) % 200) + " E0.0" + std::to_string(i % 10) + " ; move\n";
+    }
+    body += "; CONFIG_BLOCK_START\n; layer_height = 0.2\n; nozzle_diameter = 0.4,0.4\n; CONFIG_BLOCK_END\n";
+    text_without_thumbnail = header + body;
+    return header + make_thumbnail_block() + body;
+}
+
+static std::string metadata_value(const BinaryGCode::Metadata &metadata, const std::string &key)
+{
+    for (const auto &[k, v] : metadata)
+        if (k == key)
+            return v;
+    return {};
+}
+
+TEST_CASE("Binary G-code round trip", "[BinaryGCode]")
+{
+    std::string       text;
+    const std::string gcode      = make_gcode(50, 300, text);
+    const std::string ascii_path = temp_gcode_path(".gcode");
+    const std::string bin_path   = temp_gcode_path(BinaryGCode::FileExtension);
+    const std::string back_path  = temp_gcode_path(".gcode");
+    write_file(ascii_path, gcode);
+
+    BinaryGCode::WriterParams params;
+    params.block_size      = 4096;
+    params.parallel_blocks = 4;
+    BinaryGCode::convert_ascii_to_binary(ascii_path, bin_path, params);
+    REQUIRE(BinaryGCode::is_binary_gcode_file(bin_path));
+    REQUIRE(! BinaryGCode::is_binary_gcode_file(ascii_path));
+    REQUIRE(boost::filesystem::file_size(bin_path) < gcode.size() / 2);
+
+    SECTION("Converting back restores the G-code byte for byte") {
+        BinaryGCode::convert_binary_to_ascii(bin_path, back_path);
+        REQUIRE(read_file(back_path) == gcode);
+    }
+
+    SECTION("Thumbnails and metadata are stored in their own blocks") {
+        BinaryGCode::Reader reader(bin_path);
+        REQUIRE(reader.thumbnails().size() == 1);
+        REQUIRE(reader.thumbnails().front().tag == "thumbnail");
+        REQUIRE(reader.thumbnails().front().width == 32);
+        REQUIRE(reader.thumbnails().front().height == 24);
+        REQUIRE(reader.thumbnails().front().data.size() == 3000);
+        REQUIRE(metadata_value(reader.file_metadata(), "generated by") == "OrcaSlicer 2.3.0");
+        REQUIRE(metadata_value(reader.file_metadata(), "total layer number") == "50");
+        REQUIRE(metadata_value(reader.print_metadata(), "layer_height") == "0.2");
+        REQUIRE(metadata_value(reader.print_metadata(), "nozzle_diameter") == "0.4,0.4");
+    }
+
+    SECTION("Lines, text and layers are reached at random") {
+        BinaryGCode::Reader reader(bin_path);
+        REQUIRE(reader.blocks_count() > 1);
+        REQUIRE(reader.text_size() == text.size());
+        REQUIRE(reader.lines_count() == size_t(std::count(text.begin(), text.end(), '\n')));
+        REQUIRE(reader.read_text(0, text.size()) == text);
+        REQUIRE(reader.read_text(10000, 12345) == text.substr(10000, 12345));
+        REQUIRE(reader.read_text(text.size() - 10, 100) == text.substr(text.size() - 10));
+
+        std::vector<size_t> line_starts{ 0 };
+        for (size_t i = 0; i < text.size(); ++ i)
+            if (text[i] == '\n')
+                line_starts.emplace_back(i + 1);
+        REQUIRE(reader.read_lines(1000, 1500) == text.substr(line_starts[1000], line_starts[1500] - line_starts[1000]));
+
+        REQUIRE(reader.layers().size() == 50);
+        REQUIRE(reader.layers()[9].z == Catch::Approx(2.f));
+        const std::string layer = reader.read_layer(9);
+        REQUIRE(layer.rfind(";LAYER_CHANGE\n;Z:2.00\n", 0) == 0);
+        REQUIRE(std::count(layer.begin(), layer.end(), '\n') == 302);
+    }
+
+    SECTION("GCodeReader reads the same lines as from the ASCII G-code") {
+        std::vector<std::string> ascii_lines, binary_lines;
+        std::vector<size_t>      binary_lines_ends;
+        GCodeReader              reader;
+        REQUIRE(reader.parse_file(ascii_path, [&ascii_lines](GCodeReader &, const GCodeReader::GCodeLine &line) { ascii_lines.emplace_back(line.raw()); }));
+        REQUIRE(reader.parse_file(bin_path, [&binary_lines](GCodeReader &, const GCodeReader::GCodeLine &line) { binary_lines.emplace_back(line.raw()); },
+                                  binary_lines_ends));
+        // The thumbnail is not a part of the G-code text of the binary G-code.
+        REQUIRE(ascii_lines.size() == binary_lines.size() + size_t(std::count(gcode.begin(), gcode.end(), '\n') - std::count(text.begin(), text.end(), '\n')));
+        REQUIRE(binary_lines.back() == ascii_lines.back());
+        REQUIRE(binary_lines_ends.size() == binary_lines.size());
+        REQUIRE(binary_lines_ends.back() == text.size());
+    }
+
+    SECTION("A corrupted block is detected") {
+        std::string data = read_file(bin_path);
+        data[data.size() / 2] ^= 0x5a;
+        write_file(bin_path, data);
+        BinaryGCode::Reader reader(bin_path);
+        std::string block;
+        auto read_all = [&reader, &block]() {
+            for (size_t i = 0; i < reader.blocks_count(); ++ i)
+                reader.read_block(i, block);
+        };
+        REQUIRE_THROWS_AS(read_all(), Slic3r::RuntimeError);
+    }
+
+    SECTION("A block declaring a huge uncompressed size is rejected") {
+        std::string data = read_file(bin_path);
+        auto get_u32 = [&data](size_t pos) {
+            return uint32_t(uint8_t(data[pos])) | (uint32_t(uint8_t(data[pos + 1])) << 8) | (uint32_t(uint8_t(data[pos + 2])) << 16) | (uint32_t(uint8_t(data[pos + 3])) << 24);
+        };
+        // Skip the file header and the blocks in front of the first G-code block.
+        size_t pos = 16;
+        while (pos + 16 <= data.size() && uint8_t(data[pos]) != uint8_t(BinaryGCode::BlockType::GCode))
+            pos += 16 + get_u32(pos + 8);
+        REQUIRE(pos + 16 <= data.size());
+        data[pos + 4] = data[pos + 5] = data[pos + 6] = data[pos + 7] = char(0xff);
+        write_file(bin_path, data);
+        BinaryGCode::Reader reader(bin_path);
+        std::string block;
+        REQUIRE_THROWS_AS(reader.read_block(0, block), Slic3r::RuntimeError);
+    }
+
+    boost::system::error_code ec;
+    boost::filesystem::remove(ascii_path, ec);
+    boost::filesystem::remove(bin_path, ec);
+    boost::filesystem::remove(back_path, ec);
+}
+
+TEST_CASE("A G-code not written by us keeps its thumbnail as text", "[BinaryGCode]")
+{
+    const std::string gcode      = "; THUMBNAIL_BLOCK_START\n; some text\nG1 X1\n; THUMBNAIL_BLOCK_END\nG1 X2\n";
+    const std::string ascii_path = temp_gcode_path(".gcode");
+    const std::string bin_path   = temp_gcode_path(BinaryGCode::FileExtension);
+    const std::string back_path  = temp_gcode_path(".gcode");
+    write_file(ascii_path, gcode);
+
+    BinaryGCode::convert_ascii_to_binary(ascii_path, bin_path);
+    {
+        BinaryGCode::Reader reader(bin_path);
+        REQUIRE(reader.thumbnails().empty());
+        REQUIRE(reader.read_text(0, reader.text_size()) == gcode);
+    }
+    BinaryGCode::convert_binary_to_ascii(bin_path, back_path);
+    REQUIRE(read_file(back_path) == gcode);
+
+    boost::system::error_code ec;
+    boost::filesystem::remove(ascii_path, ec);
+    boost::filesystem::remove(bin_path, ec);
+    boost::filesystem::remove(back_path, ec);
+}
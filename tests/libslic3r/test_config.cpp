@@ -8,6 +8,7 @@
 #include <cereal/types/string.hpp> 
 #include <cereal/types/vector.hpp> 
 #include <cereal/archives/binary.hpp>
+#include <utility>
 
 using namespace Slic3r;
 
@@ -265,6 +266,87 @@ SCENARIO("DynamicPrintConfig serialization", "[Config]") {
     }
 }
 
+SCENARIO("Static config diffs match the generic diff", "[Config]") {
+    GIVEN("A PrintConfig and a full DynamicPrintConfig with a few options modified") {
+        PrintConfig        config;
+        DynamicPrintConfig full_config = DynamicPrintConfig::full_print_config();
+        full_config.set_deserialize_strict({ { "skirt_loops", "3" }, { "nozzle_diameter", "0.6" }, { "wipe_tower_x", "20" } });
+        // An option not known to PrintConfig is skipped by both diffs.
+        full_config.set_deserialize_strict("sparse_infill_density", "35%");
+        WHEN("Diffed against the dynamic config") {
+            t_config_option_keys generic = config.ConfigBase::diff(full_config);
+            t_config_option_keys fast    = config.diff(full_config);
+            THEN("Both diffs report the same keys") {
+                REQUIRE(fast == generic);
+                REQUIRE(std::find(fast.begin(), fast.end(), "skirt_loops") != fast.end());
+                REQUIRE(std::find(fast.begin(), fast.end(), "sparse_infill_density") == fast.end());
+            }
+        }
+        WHEN("Diffed against a static config of the same type") {
+            PrintConfig other;
+            other.apply(full_config, true);
+            THEN("Both diffs report the same keys") {
+                REQUIRE(config.diff(other) == config.ConfigBase::diff(other));
+                REQUIRE(other.diff(other).empty());
+            }
+        }
+    }
+}
+
+SCENARIO("Diffing the changed groups of options matches the full diff", "[Config]") {
+    GIVEN("Two full print configs differing in a few options") {
+        DynamicPrintConfig current_config = DynamicPrintConfig::full_print_config();
+        DynamicPrintConfig new_config     = current_config;
+        new_config.set_deserialize_strict({ { "skirt_loops", "3" }, { "wall_loops", "5" } });
+        auto changed_groups_diff = [](const DynamicPrintConfig &lhs, const DynamicPrintConfig &rhs) {
+            t_config_option_keys diff;
+            size_t               num_compared = 0;
+            lhs.iterate_changed_groups(rhs, [&diff, &num_compared](const t_config_option_key &opt_key, const ConfigOption *l, const ConfigOption *r) {
+                ++ num_compared;
+                if (r == nullptr || *l != *r)
+                    diff.emplace_back(opt_key);
+            });
+            return std::make_pair(diff, num_compared);
+        };
+        WHEN("The changed groups are diffed") {
+            auto [diff, num_compared] = changed_groups_diff(new_config, current_config);
+            THEN("The changed options are found comparing a fraction of the options") {
+                REQUIRE(diff == new_config.diff(current_config));
+                REQUIRE(diff.size() == 2);
+                REQUIRE(num_compared < new_config.size() / 4);
+            }
+        }
+        WHEN("An option is modified after the configs were diffed") {
+            changed_groups_diff(new_config, current_config);
+            new_config.option<ConfigOptionInt>("skirt_loops")->value = 0;
+            current_config.set_deserialize_strict("wall_loops", "5");
+            THEN("The modification is found") {
+                REQUIRE(changed_groups_diff(new_config, current_config).first == t_config_option_keys{ "skirt_loops" });
+            }
+        }
+        WHEN("A config is copied") {
+            changed_groups_diff(new_config, current_config);
+            DynamicPrintConfig copy = new_config;
+            THEN("No option of the copy is compared") {
+                REQUIRE(changed_groups_diff(copy, new_config).second == 0);
+            }
+            THEN("Reading the options of the copy does not modify it") {
+                REQUIRE(std::as_const(copy).opt_string("filament_type", 0u) == std::as_const(new_config).opt_string("filament_type", 0u));
+                REQUIRE(std::as_const(copy).opt_int("skirt_loops") == 3);
+                REQUIRE(changed_groups_diff(copy, new_config).second == 0);
+            }
+        }
+        WHEN("A config is composed by applying another config") {
+            DynamicPrintConfig composed;
+            composed.apply(new_config);
+            THEN("No option of the composed config is compared") {
+                REQUIRE(changed_groups_diff(composed, new_config).second == 0);
+                REQUIRE(composed.diff(new_config).empty());
+            }
+        }
+    }
+}
+
 // SCENARIO("DynamicPrintConfig JSON serialization", "[Config]") {
 //     WHEN("DynamicPrintConfig is serialized and deserialized") {
 // 	auto now = std::chrono::high_resolution_clock::now();
@@ -0,0 +1,101 @@
+#include <catch2/catch_all.hpp>
+
+#include <libslic3r/FilamentGroup.hpp>
+
+using namespace Slic3r;
+
+// Too many filaments to enumerate the groups, thus they are clustered and refined by the local search.
+static FilamentGroupContext make_context(int num_filaments)
+{
+    FilamentGroupContext ctx;
+
+    FlushMatrix flush(num_filaments, std::vector<float>(num_filaments, 0.f));
+    for (int i = 0; i < num_filaments; ++ i)
+        for (int j = 0; j < num_filaments; ++ j)
+            if (i != j)
+                flush[i][j] = float(100 + (i * 37 + j * 101) % 500);
+    ctx.model_info.flush_matrix = { flush, flush };
+
+    for (int layer = 0; layer < 60; ++ layer) {
+        std::vector<unsigned int> filaments;
+        for (int i = 0; i < num_filaments; ++ i)
+            if ((layer * 7 + i * 3) % 5 < 2)
+                filaments.emplace_back(i);
+        ctx.model_info.layer_filaments.emplace_back(std::move(filaments));
+    }
+    for (int i = 0; i < num_filaments; ++ i) {
+        FilamentGroupUtils::FilamentInfo info;
+        info.type       = "PLA";
+        info.is_support = false;
+        ctx.model_info.filament_info.emplace_back(info);
+        // Distinct filaments, thus none of them are merged before grouping.
+        ctx.model_info.filament_ids.emplace_back("GFL" + std::to_string(10 + i));
+    }
+    ctx.model_info.unprintable_filaments = { {}, {} };
+
+    ctx.machine_info.max_group_size         = { 16, 16 };
+    ctx.machine_info.machine_filament_info  = { {}, {} };
+    ctx.machine_info.master_extruder_id     = 0;
+
+    ctx.group_info.total_filament_num  = num_filaments;
+    ctx.group_info.max_gap_threshold   = 0.01;
+    ctx.group_info.strategy            = FGStrategy::BestCost;
+    ctx.group_info.mode                = FGMode::FlushMode;
+    ctx.group_info.ignore_ext_filament = false;
+    return ctx;
+}
+
+TEST_CASE("Filament groups of many filaments are deterministic", "[FilamentGroup]")
+{
+    const FilamentGroupContext ctx = make_context(14);
+
+    int              cost_first  = 0;
+    int              cost_second = 0;
+    std::vector<int> first       = FilamentGroup(ctx).calc_filament_group_for_flush(&cost_first);
+    std::vector<int> second      = FilamentGroup(ctx).calc_filament_group_for_flush(&cost_second);
+    REQUIRE(first.size() == 14);
+    REQUIRE(first == second);
+    REQUIRE(cost_first == cost_second);
+}
+
+TEST_CASE("Refining filament groups never raises the flush volume", "[FilamentGroup]")
+{
+    FilamentGroupContext ctx = make_context(14);
+
+    ctx.group_info.max_flush_evaluations = 0;
+    int clustered_cost = 0;
+    FilamentGroup(ctx).calc_filament_group_for_flush(&clustered_cost);
+
+    ctx.group_info.max_flush_evaluations = 512;
+    int refined_cost = 0;
+    FilamentGroup(ctx).calc_filament_group_for_flush(&refined_cost);
+    REQUIRE(refined_cost <= clustered_cost);
+}
+
+TEST_CASE("Filament groups of a repeated slice are reused", "[FilamentGroup]")
+{
+    const FilamentGroupContext ctx = make_context(14);
+
+    const size_t     hits        = FilamentGroup::cache_hits();
+    const size_t     misses      = FilamentGroup::cache_misses();
+    int              cost_first  = 0;
+    int              cost_second = 0;
+    std::vector<int> first       = FilamentGroup(ctx).calc_filament_group(&cost_first);
+    std::vector<int> second      = FilamentGroup(ctx).calc_filament_group(&cost_second);
+    REQUIRE(FilamentGroup::cache_misses() == misses + 1);
+    REQUIRE(FilamentGroup::cache_hits() == hits + 1);
+    REQUIRE(first == second);
+    REQUIRE(cost_first == cost_second);
+
+    // Changing the flush volumes or the extruder limits groups the filaments again.
+    FilamentGroupContext changed_flush = ctx;
+    changed_flush.model_info.flush_matrix[1][2][3] += 50.f;
+    FilamentGroup(changed_flush).calc_filament_group();
+    REQUIRE(FilamentGroup::cache_misses() == misses + 2);
+
+    FilamentGroupContext changed_limits = ctx;
+    changed_limits.machine_info.max_group_size = { 8, 16 };
+    FilamentGroup(changed_limits).calc_filament_group();
+    REQUIRE(FilamentGroup::cache_misses() == misses + 3);
+    REQUIRE(FilamentGroup::cache_hits() == hits + 1);
+}
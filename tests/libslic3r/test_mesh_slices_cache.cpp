@@ -0,0 +1,82 @@
+#include <catch2/catch_all.hpp>
+
+#include <libslic3r/MeshSlicesCache.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+
+#include <cmath>
+#include <memory>
+
+using namespace Slic3r;
+
+// Layers of a 10mm square, as if sliced from a prism.
+static std::vector<ExPolygons> square_slices(size_t num_layers)
+{
+    const coord_t           a = scaled<coord_t>(10.);
+    std::vector<ExPolygons> out(num_layers, ExPolygons{ ExPolygon(Polygon({ { 0, 0 }, { a, 0 }, { a, a }, { 0, a } })) });
+    return out;
+}
+
+static MeshSlicingParamsEx rotated_params(double angle)
+{
+    MeshSlicingParamsEx params;
+    params.trafo = Transform3d::Identity() * Eigen::AngleAxisd(angle, Vec3d::UnitZ());
+    return params;
+}
+
+TEST_CASE("Mesh slices are shared with the cache", "[MeshSlicesCache]")
+{
+    MeshSlicesCache          cache;
+    auto                     mesh     = std::make_shared<const TriangleMesh>();
+    const std::vector<float> zs       = { 0.2f, 0.4f, 0.6f };
+    size_t                   num_runs = 0;
+    auto                     slice_fn = [&num_runs, &zs]() { ++ num_runs; return square_slices(zs.size()); };
+
+    MeshSlicesCache::SlicesPtr first  = cache.slice(mesh, zs, rotated_params(0.), slice_fn);
+    MeshSlicesCache::SlicesPtr second = cache.slice(mesh, zs, rotated_params(0.), slice_fn);
+    REQUIRE(num_runs == 1);
+    REQUIRE(first == second);
+    REQUIRE(first->size() == zs.size());
+    REQUIRE(cache.hits() == 1);
+    REQUIRE(cache.misses() == 1);
+    REQUIRE(cache.bytes() > 0);
+
+    // The model releases the mesh.
+    mesh.reset();
+    cache.prune();
+    REQUIRE(cache.size() == 0);
+    REQUIRE(cache.bytes() == 0);
+    // The slices handed out stay valid.
+    REQUIRE(first->size() == zs.size());
+}
+
+TEST_CASE("Mesh slices of past transformations are released", "[MeshSlicesCache]")
+{
+    const std::vector<float> zs       = { 0.2f, 0.4f, 0.6f, 0.8f };
+    size_t                   num_runs = 0;
+    auto                     slice_fn = [&num_runs, &zs]() { ++ num_runs; return square_slices(zs.size()); };
+
+    // Measure the size of a single set of slices.
+    size_t set_bytes = 0;
+    {
+        MeshSlicesCache cache;
+        cache.slice(std::make_shared<const TriangleMesh>(), zs, rotated_params(0.), slice_fn);
+        set_bytes = cache.bytes();
+    }
+
+    // The mesh is kept alive by the model while the object is rotated through many poses.
+    MeshSlicesCache cache(2 * set_bytes + set_bytes / 2);
+    auto            mesh = std::make_shared<const TriangleMesh>();
+    for (int i = 0; i < 20; ++ i)
+        cache.slice(mesh, zs, rotated_params(0.1 * i), slice_fn);
+    REQUIRE(cache.size() == 2);
+    REQUIRE(cache.bytes() <= 2 * set_bytes + set_bytes / 2);
+
+    // The most recent poses are kept.
+    num_runs = 0;
+    cache.slice(mesh, zs, rotated_params(0.1 * 19), slice_fn);
+    cache.slice(mesh, zs, rotated_params(0.1 * 18), slice_fn);
+    REQUIRE(num_runs == 0);
+    cache.slice(mesh, zs, rotated_params(0.), slice_fn);
+    REQUIRE(num_runs == 1);
+    REQUIRE(cache.size() == 2);
+}
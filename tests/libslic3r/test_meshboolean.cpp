@@ -3,6 +3,7 @@
 
 #include <libslic3r/TriangleMesh.hpp>
 #include <libslic3r/MeshBoolean.hpp>
+#include <libslic3r/CSGMesh/PerformCSGMeshBooleans.hpp>
 
 using namespace Slic3r;
 
@@ -23,3 +24,109 @@ TEST_CASE("CGAL and TriangleMesh conversions", "[MeshBoolean]") {
     
     REQUIRE(! MeshBoolean::cgal::does_self_intersect(M));
 }
+
+static indexed_triangle_set transformed(const indexed_triangle_set &its, const Transform3f &trafo)
+{
+    indexed_triangle_set ret = its;
+    its_transform(ret, trafo, true);
+    return ret;
+}
+
+TEST_CASE("CSG parts evaluated in a tree match sequential booleans", "[MeshBoolean]") {
+    indexed_triangle_set plate = its_make_cube(10., 10., 2.);
+    indexed_triangle_set hole  = its_make_cube(1., 1., 4.);
+    indexed_triangle_set cube  = its_make_cube(2., 2., 2.);
+
+    std::vector<Transform3f> hole_trafos;
+    for (int i = 0; i < 5; ++ i)
+        hole_trafos.emplace_back(Transform3f(Eigen::Translation3f(1.f + 1.5f * i, 4.5f, -1.f)));
+    const Transform3f cube_trafo(Eigen::Translation3f(7.f, 7.f, 1.5f));
+
+    auto make_parts = [&]() {
+        std::vector<csg::CSGPart> parts;
+        parts.emplace_back(&plate, csg::CSGType::Union);
+        for (const Transform3f &trafo : hole_trafos)
+            parts.emplace_back(&hole, csg::CSGType::Difference, trafo);
+        parts.emplace_back(&cube, csg::CSGType::Union, cube_trafo);
+        return parts;
+    };
+    auto sequential = [&]() {
+        TriangleMesh ret(plate);
+        for (const Transform3f &trafo : hole_trafos)
+            MeshBoolean::cgal::minus(ret, TriangleMesh(transformed(hole, trafo)));
+        MeshBoolean::cgal::plus(ret, TriangleMesh(transformed(cube, cube_trafo)));
+        return ret;
+    };
+    csg::CGALMeshCache cache;
+    auto evaluate = [&cache](const std::vector<csg::CSGPart> &parts) {
+        auto cgalm = csg::perform_csgmesh_booleans(Range{parts.begin(), parts.end()}, &cache);
+        REQUIRE(cgalm);
+        return MeshBoolean::cgal::cgal_to_triangle_mesh(*cgalm);
+    };
+
+    TriangleMesh expected = sequential();
+    std::vector<csg::CSGPart> parts = make_parts();
+    TriangleMesh result = evaluate(parts);
+    REQUIRE(result.volume() == Catch::Approx(expected.volume()));
+
+    SECTION("Evaluating again reuses the cached result") {
+        REQUIRE(cache.size() > 0);
+        TriangleMesh again = evaluate(parts);
+        REQUIRE(again.its.indices.size() == result.its.indices.size());
+        REQUIRE(again.volume() == Catch::Approx(result.volume()));
+    }
+
+    SECTION("Moving a part recomputes the boolean") {
+        hole_trafos[2] = Transform3f(Eigen::Translation3f(4.f, 1.f, -1.f));
+        parts = make_parts();
+        expected = sequential();
+        result = evaluate(parts);
+        REQUIRE(result.volume() == Catch::Approx(expected.volume()));
+    }
+
+    SECTION("Parenthesized parts") {
+        // plate - (hole + hole)
+        std::vector<csg::CSGPart> parts;
+        parts.emplace_back(&plate, csg::CSGType::Union);
+        csg::CSGPart part_begin{{}, csg::CSGType::Difference};
+        part_begin.stack_operation = csg::CSGStackOp::Push;
+        parts.emplace_back(std::move(part_begin));
+        parts.emplace_back(&hole, csg::CSGType::Union, hole_trafos[0]);
+        parts.emplace_back(&hole, csg::CSGType::Union, hole_trafos[1]);
+        csg::CSGPart part_end{{}};
+        part_end.stack_operation = csg::CSGStackOp::Pop;
+        parts.emplace_back(std::move(part_end));
+
+        result = evaluate(parts);
+        REQUIRE(result.volume() == Catch::Approx(200.f - 2 * 2.f));
+    }
+}
+
+TEST_CASE("A part without a mesh does not empty an intersection", "[MeshBoolean]") {
+    indexed_triangle_set plate = its_make_cube(10., 10., 2.);
+
+    std::vector<csg::CSGPart> parts;
+    parts.emplace_back(&plate, csg::CSGType::Union);
+    parts.emplace_back(csg::CSGPart{{}, csg::CSGType::Intersection});
+
+    auto cgalm = csg::perform_csgmesh_booleans(Range{parts.begin(), parts.end()});
+    REQUIRE(cgalm);
+    REQUIRE(MeshBoolean::cgal::cgal_to_triangle_mesh(*cgalm).volume() == Catch::Approx(200.f));
+}
+
+TEST_CASE("CGAL mesh cache stays within its memory budget", "[MeshBoolean]") {
+    indexed_triangle_set cube = its_make_cube(1., 1., 1.);
+    auto                 cgalm = MeshBoolean::cgal::triangle_mesh_to_cgal(cube);
+    REQUIRE(cgalm);
+    const size_t mesh_bytes = MeshBoolean::cgal::memory_size(*cgalm);
+
+    csg::CGALMeshCache cache(3 * mesh_bytes);
+    for (int i = 0; i < 10; ++ i)
+        cache.store(cache.part_key(cube, Transform3f(Eigen::Translation3f(float(i), 0.f, 0.f))), *cgalm);
+    REQUIRE(cache.size() == 3);
+    REQUIRE(cache.bytes() <= 3 * mesh_bytes);
+
+    // The most recent entries are kept.
+    REQUIRE(cache.find(cache.part_key(cube, Transform3f(Eigen::Translation3f(9.f, 0.f, 0.f)))));
+    REQUIRE(! cache.find(cache.part_key(cube, Transform3f(Eigen::Translation3f(0.f, 0.f, 0.f)))));
+}
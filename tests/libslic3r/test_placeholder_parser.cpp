@@ -30,6 +30,30 @@ SCENARIO("Placeholder parser scripting", "[PlaceholderParser]") {
     SECTION("nested config options (legacy syntax)") { REQUIRE(parser.process("[nozzle_temperature[foo]]") == "357"); }
     SECTION("array reference") { REQUIRE(parser.process("{nozzle_temperature[foo]}") == "357"); }
     SECTION("whitespaces and newlines are maintained") { REQUIRE(parser.process("test [ nozzle_temperature [foo] ] \n hu") == "test 357 \n hu"); }
+    SECTION("literal text only") { REQUIRE(parser.process("G28 ; home all\nG1 Z5 F3000 ; lift } ]\n") == "G28 ; home all\nG1 Z5 F3000 ; lift } ]\n"); }
+    SECTION("cached template evaluated twice") {
+        const std::string templ = "M104 S{nozzle_temperature[foo]}\nM109 S[nozzle_temperature[bar]] ; \"}\"\n";
+        REQUIRE(parser.process(templ) == "M104 S357\nM109 S363 ; \"}\"\n");
+        REQUIRE(parser.process(templ) == "M104 S357\nM109 S363 ; \"}\"\n");
+    }
+    SECTION("braces inside a string literal") { REQUIRE(parser.process("a{\"}{]\"}b") == "a}{]b"); }
+    SECTION("if block spanning literal text") { REQUIRE(parser.process("{if foo == 0}one{else}other{endif}\n") == "one\n"); }
+    SECTION("elsif block spanning literal text") { REQUIRE(parser.process("G28\n{if foo == 1}one\n{elsif bar == 2}two {bar}\n{else}other\n{endif}G1 Z5\n") == "G28\ntwo 2\nG1 Z5\n"); }
+    SECTION("nested if blocks spanning literal text") {
+        const std::string templ = "{if bar == 2}a\n{if foo == 1}b\n{else}c {foo}\n{endif}d\n{else}e\n{endif}";
+        REQUIRE(parser.process(templ) == "a\nc 0\nd\n");
+        REQUIRE(parser.process(templ) == "a\nc 0\nd\n");
+    }
+    SECTION("error line of a macro between literal text") {
+        std::string message;
+        try {
+            parser.process("G28\nG1 Z5\n{if foo == 0}\n{undefined_variable}\n{endif}");
+        } catch (const PlaceholderParserError &ex) {
+            message = ex.what();
+        }
+        REQUIRE(message.find("Parsing error at line 4") != std::string::npos);
+    }
+    SECTION("syntax error in a macro between literal text") { REQUIRE_THROWS(parser.process("G28\n{2 *}\nG1 Z5\n")); }
 
     // Test the math expressions.
     SECTION("math: 2*3") { REQUIRE(parser.process("{2*3}") == "6"); }
@@ -238,5 +262,38 @@ SCENARIO("Placeholder parser variables", "[PlaceholderParser]") {
             "{size(myints)}";
         REQUIRE(parser.process(script, 0, nullptr, nullptr, nullptr) == "6");
     }
+    SECTION("a runtime error does not evaluate the template twice") {
+        REQUIRE(parser.process("{global counter = 0}", 0, nullptr, nullptr, &context_with_global_dict) == "");
+        REQUIRE_THROWS(parser.process("{counter = counter + 1}G1 X10\n{undefined_variable}\n", 0, nullptr, nullptr, &context_with_global_dict));
+        REQUIRE(parser.process("{counter}", 0, nullptr, nullptr, &context_with_global_dict) == "1");
+    }
     SECTION("if else completely empty") { REQUIRE(parser.process("{if false then elsif false then else endif}", 0, nullptr, nullptr, nullptr) == ""); }
 }
+
+TEST_CASE("Placeholder parser per call latency", "[PlaceholderParser]") {
+    PlaceholderParser parser;
+    auto config = DynamicPrintConfig::full_print_config();
+    config.set_deserialize_strict({ { "nozzle_temperature", "210;215;220;225" } });
+    parser.apply_config(config);
+    parser.set("layer_num", 12);
+    parser.set("layer_z", 2.4);
+
+    // Typical layer change G-code of a printer profile: mostly literal text with a few macros.
+    const std::string layer_change =
+        ";AFTER_LAYER_CHANGE\n"
+        ";{layer_z}\n"
+        "G92 E0 ; reset extruder\n"
+        "{if layer_num == 1}M104 S{nozzle_temperature[0]} ; first layer done{endif}\n";
+    const std::string timelapse =
+        ";TIMELAPSE_TAKE_FRAME\n"
+        "G1 Z{layer_z + 0.4} F600\n"
+        "G1 X250 Y250 F12000\n"
+        "M400 P300\n"
+        "M971 S11 C10 O0 ; layer {layer_num}\n"
+        "G1 Z{layer_z} F600\n";
+
+    REQUIRE(parser.process(timelapse) == parser.process(timelapse));
+
+    BENCHMARK("layer change with if block") { return parser.process(layer_change); };
+    BENCHMARK("timelapse") { return parser.process(timelapse); };
+}
@@ -0,0 +1,86 @@
+#include <catch2/catch_all.hpp>
+
+#include <libslic3r/GCode/ToolpathLod.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace Slic3r;
+
+// Points kept by the simplification with the given tolerance.
+static std::vector<Vec3f> simplified(const std::vector<Vec3f> &polyline, const std::vector<float> &errors, float tolerance)
+{
+    std::vector<Vec3f> out;
+    for (size_t i = 0; i < polyline.size(); ++ i)
+        if (errors[i] > tolerance)
+            out.emplace_back(polyline[i]);
+    return out;
+}
+
+static float distance_to_polyline(const Vec3f &pt, const std::vector<Vec3f> &polyline)
+{
+    float out = std::numeric_limits<float>::max();
+    for (size_t i = 1; i < polyline.size(); ++ i) {
+        const Vec3f v = polyline[i] - polyline[i - 1];
+        const float t = std::clamp((pt - polyline[i - 1]).dot(v) / v.squaredNorm(), 0.f, 1.f);
+        out = std::min(out, (pt - (polyline[i - 1] + t * v)).norm());
+    }
+    return out;
+}
+
+TEST_CASE("Collinear toolpath points are removed", "[ToolpathLod]")
+{
+    std::vector<Vec3f> line;
+    for (int i = 0; i <= 100; ++ i)
+        line.emplace_back(0.1f * float(i), 5.f, 0.2f);
+    const std::vector<float> errors = toolpath_lod_errors(line, 0.01f);
+    const std::vector<Vec3f> out    = simplified(line, errors, 0.01f);
+    REQUIRE(out.size() == 2);
+    REQUIRE(out.front() == line.front());
+    REQUIRE(out.back() == line.back());
+}
+
+TEST_CASE("Simplified toolpath levels stay within their tolerance", "[ToolpathLod]")
+{
+    // A circle of 10 mm radius approximated by segments of about 0.1 mm, as the interpolation points of an arc.
+    std::vector<Vec3f> circle;
+    for (int i = 0; i <= 628; ++ i)
+        circle.emplace_back(10.f * std::cos(0.01f * float(i)), 10.f * std::sin(0.01f * float(i)), 0.2f);
+
+    const std::vector<float> tolerances = { 0.01f, 0.1f, 0.4f, 1.6f };
+    const std::vector<float> errors     = toolpath_lod_errors(circle, tolerances.front());
+    size_t                   prev_count = circle.size() + 1;
+    for (float tolerance : tolerances) {
+        const std::vector<Vec3f> out = simplified(circle, errors, tolerance);
+        // Each level is coarser than the previous one.
+        REQUIRE(out.size() < prev_count);
+        REQUIRE(out.size() >= 2);
+        prev_count = out.size();
+        REQUIRE(out.front() == circle.front());
+        REQUIRE(out.back() == circle.back());
+        for (const Vec3f &pt : circle)
+            REQUIRE(distance_to_polyline(pt, out) <= tolerance + EPSILON);
+    }
+}
+
+TEST_CASE("Short toolpaths are kept", "[ToolpathLod]")
+{
+    REQUIRE(toolpath_lod_errors({}, 0.1f).empty());
+    const std::vector<float> errors = toolpath_lod_errors({ Vec3f(0.f, 0.f, 0.2f), Vec3f(1.f, 0.f, 0.2f) }, 0.1f);
+    REQUIRE(errors.size() == 2);
+    REQUIRE(errors.front() > 1e6f);
+    REQUIRE(errors.back() > 1e6f);
+}
+
+TEST_CASE("Toolpath level of detail is selected by the pixel size", "[ToolpathLod]")
+{
+    const std::vector<float> tolerances = { 0.1f, 0.4f, 1.6f };
+    // Zoomed in, the full detail is shown.
+    REQUIRE(select_toolpath_lod(tolerances, 0.05f) == tolerances.size());
+    REQUIRE(select_toolpath_lod(tolerances, 0.1f) == 0);
+    REQUIRE(select_toolpath_lod(tolerances, 0.5f) == 1);
+    REQUIRE(select_toolpath_lod(tolerances, 10.f) == 2);
+    // A larger error on the screen allows a coarser level.
+    REQUIRE(select_toolpath_lod(tolerances, 0.5f, 4.f) == 2);
+}
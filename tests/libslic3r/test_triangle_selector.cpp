@@ -0,0 +1,44 @@
+#include <catch2/catch_all.hpp>
+
+#include <libslic3r/TriangleSelector.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+
+using namespace Slic3r;
+
+static TriangleSelector::TriangleSplittingData paint_cube(const TriangleMesh &mesh, EnforcerBlockerType state)
+{
+    TriangleSelector selector(mesh);
+    for (int facet_idx = 0; facet_idx < int(mesh.its.indices.size()); facet_idx += 2)
+        selector.set_facet(facet_idx, state);
+    return selector.serialize();
+}
+
+TEST_CASE("Equal paintings compare equal", "[TriangleSelector]")
+{
+    const TriangleMesh mesh(its_make_cube(20., 20., 20.));
+    const TriangleSelector::TriangleSplittingData first  = paint_cube(mesh, EnforcerBlockerType::Extruder2);
+    const TriangleSelector::TriangleSplittingData second = paint_cube(mesh, EnforcerBlockerType::Extruder2);
+    REQUIRE(first.hash == second.hash);
+    REQUIRE(first == second);
+    REQUIRE(first != paint_cube(mesh, EnforcerBlockerType::Extruder3));
+}
+
+TEST_CASE("Paintings with colliding hashes do not compare equal", "[TriangleSelector]")
+{
+    const TriangleMesh mesh(its_make_cube(20., 20., 20.));
+    const TriangleSelector::TriangleSplittingData painted = paint_cube(mesh, EnforcerBlockerType::Extruder2);
+
+    SECTION("Differing bitstreams") {
+        TriangleSelector::TriangleSplittingData other = painted;
+        other.bitstream.back() = ! other.bitstream.back();
+        REQUIRE(other.hash == painted.hash);
+        REQUIRE(other != painted);
+    }
+
+    SECTION("Differing used states") {
+        TriangleSelector::TriangleSplittingData other = painted;
+        other.used_states[size_t(EnforcerBlockerType::Extruder5)] = true;
+        REQUIRE(other.hash == painted.hash);
+        REQUIRE(other != painted);
+    }
+}
@@ -0,0 +1,157 @@
+#include <catch2/catch_all.hpp>
+
+#include <libslic3r/Feature/Interlocking/VoxelGrid.hpp>
+#include <libslic3r/Feature/Interlocking/VoxelUtils.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <unordered_set>
+
+using namespace Slic3r;
+
+namespace {
+
+struct GridPoint3Hash
+{
+    size_t operator()(const GridPoint3 &p) const noexcept { return size_t(p.x()) * 73856093 ^ size_t(p.y()) * 19349663 ^ size_t(p.z()) * 83492791; }
+};
+using CellSet = std::unordered_set<GridPoint3, GridPoint3Hash>;
+
+std::vector<GridPoint3> sorted(std::vector<GridPoint3> cells)
+{
+    std::sort(cells.begin(), cells.end(), [](const GridPoint3 &l, const GridPoint3 &r) {
+        return std::lexicographical_compare(l.data(), l.data() + 3, r.data(), r.data() + 3);
+    });
+    return cells;
+}
+
+std::vector<GridPoint3> sorted(const CellSet &cells) { return sorted(std::vector<GridPoint3>(cells.begin(), cells.end())); }
+
+CellSet random_cells(size_t count, coord_t range, unsigned seed)
+{
+    std::mt19937                           rng(seed);
+    std::uniform_int_distribution<coord_t> dist(-range, range);
+    CellSet                                cells;
+    while (cells.size() < count)
+        cells.emplace(dist(rng), dist(rng), dist(rng));
+    return cells;
+}
+
+VoxelGrid to_grid(const CellSet &cells)
+{
+    VoxelGrid grid;
+    for (const GridPoint3 &p : cells)
+        grid.insert(p);
+    return grid;
+}
+
+// Outlines of two cylinders touching each other along x, as the two bodies of a dual material print.
+std::vector<ExPolygons> two_bodies(size_t layers_count)
+{
+    std::vector<ExPolygons> layers(layers_count);
+    for (size_t layer_nr = 0; layer_nr < layers_count; ++ layer_nr)
+        for (double cx : { -10., 10. }) {
+            Polygon circle;
+            for (size_t i = 0; i < 200; ++ i) {
+                const double a = 2. * PI * double(i) / 200.;
+                circle.append(Point(scaled(cx + 10. * std::cos(a)), scaled(10. * std::sin(a))));
+            }
+            layers[layer_nr].emplace_back(circle);
+        }
+    return layers;
+}
+
+} // namespace
+
+TEST_CASE("VoxelGrid stores the same cells as a hash set", "[Interlocking]")
+{
+    const CellSet cells = random_cells(3000, 40, 1);
+    VoxelGrid     grid  = to_grid(cells);
+    REQUIRE(grid.size() == cells.size());
+    REQUIRE(sorted(grid.cells()) == sorted(cells));
+    REQUIRE(grid.contains(*cells.begin()));
+    REQUIRE(! grid.insert(*cells.begin()));
+
+    SECTION("Boolean operations") {
+        const CellSet other = random_cells(3000, 40, 2);
+        CellSet       expected_and, expected_diff, expected_or = cells;
+        for (const GridPoint3 &p : other)
+            expected_or.emplace(p);
+        for (const GridPoint3 &p : cells)
+            (other.count(p) ? expected_and : expected_diff).emplace(p);
+
+        VoxelGrid grid_and = grid;
+        grid_and &= to_grid(other);
+        REQUIRE(sorted(grid_and.cells()) == sorted(expected_and));
+        VoxelGrid grid_diff = grid;
+        grid_diff -= to_grid(other);
+        REQUIRE(sorted(grid_diff.cells()) == sorted(expected_diff));
+        VoxelGrid grid_or = grid;
+        grid_or |= to_grid(other);
+        REQUIRE(sorted(grid_or.cells()) == sorted(expected_or));
+        // Bricks emptied by the boolean operations are removed.
+        grid_diff -= grid;
+        REQUIRE(grid_diff.empty());
+        REQUIRE(grid_diff == VoxelGrid());
+    }
+
+    SECTION("Dilation processes the same cells as VoxelUtils::dilate()") {
+        const VoxelUtils vu(Vec3crd(100, 100, 4));
+        for (DilationKernel::Type type : { DilationKernel::Type::CUBE, DilationKernel::Type::DIAMOND, DilationKernel::Type::PRISM })
+            for (coord_t size : { 1, 2, 3, 4, 7, 10 }) {
+                const DilationKernel kernel(GridPoint3(size, size, size), type);
+                CellSet                               expected;
+                const std::function<bool(GridPoint3)> emplacer = [&expected](GridPoint3 p) { expected.emplace(p); return true; };
+                const auto                            dilated  = vu.dilate(kernel, emplacer);
+                for (const GridPoint3 &p : cells)
+                    dilated(p);
+                REQUIRE(sorted(grid.dilated(kernel).cells()) == sorted(expected));
+            }
+    }
+
+    SECTION("Erasing the cells below a height") {
+        grid.erase_below(-3);
+        std::vector<GridPoint3> expected;
+        for (const GridPoint3 &p : sorted(cells))
+            if (p.z() >= -3)
+                expected.emplace_back(p);
+        REQUIRE(sorted(grid.cells()) == expected);
+    }
+}
+
+TEST_CASE("Dilating a raster gives the cells of walkDilatedPolygons", "[Interlocking]")
+{
+    const std::vector<ExPolygons> layers = two_bodies(40);
+    const VoxelUtils              vu(Vec3crd(scaled(0.8), scaled(0.8), 4));
+    for (coord_t size : { 2, 3 }) {
+        const DilationKernel kernel(GridPoint3(size, size, size), DilationKernel::Type::PRISM);
+        CellSet              expected;
+        VoxelGrid            raw;
+        for (size_t layer_nr = 0; layer_nr < layers.size(); ++ layer_nr) {
+            vu.walkDilatedPolygons(layers[layer_nr], coord_t(layer_nr), kernel, [&expected](GridPoint3 p) { expected.emplace(p); return true; });
+            vu.walkKernelAlignedPolygons(layers[layer_nr], coord_t(layer_nr), kernel, [&raw](GridPoint3 p) { raw.insert(p); return true; });
+        }
+        REQUIRE(sorted(raw.dilated(kernel).cells()) == sorted(expected));
+    }
+}
+
+TEST_CASE("Benchmark interlocking voxel dilation", "[Interlocking]")
+{
+    const std::vector<ExPolygons> layers = two_bodies(200);
+    const VoxelUtils              vu(Vec3crd(scaled(0.8), scaled(0.8), 4));
+    const DilationKernel          kernel(GridPoint3(4, 4, 4), DilationKernel::Type::PRISM);
+
+    BENCHMARK("hash set of dilated cells") {
+        CellSet cells;
+        for (size_t layer_nr = 0; layer_nr < layers.size(); ++ layer_nr)
+            vu.walkDilatedPolygons(layers[layer_nr], coord_t(layer_nr), kernel, [&cells](GridPoint3 p) { cells.emplace(p); return true; });
+        return cells.size();
+    };
+    BENCHMARK("brick grid dilated at once") {
+        VoxelGrid raw;
+        for (size_t layer_nr = 0; layer_nr < layers.size(); ++ layer_nr)
+            vu.walkKernelAlignedPolygons(layers[layer_nr], coord_t(layer_nr), kernel, [&raw](GridPoint3 p) { raw.insert(p); return true; });
+        return raw.dilated(kernel).size();
+    };
+}